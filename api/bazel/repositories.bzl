@@ -29,6 +29,11 @@ def api_dependencies():
         name = "opencensus_proto",
         locations = REPOSITORY_LOCATIONS,
     )
+    envoy_http_archive(
+        name = "opentelemetry_proto",
+        locations = REPOSITORY_LOCATIONS,
+        build_file_content = OPENTELEMETRY_BUILD_CONTENT,
+    )
     envoy_http_archive(
         name = "rules_proto",
         locations = REPOSITORY_LOCATIONS,
@@ -79,6 +84,52 @@ go_proto_library(
 )
 """
 
+OPENTELEMETRY_BUILD_CONTENT = """
+load("@envoy_api//bazel:api_build_system.bzl", "api_cc_py_proto_library")
+
+api_cc_py_proto_library(
+    name = "common",
+    srcs = [
+        "opentelemetry/proto/common/v1/common.proto",
+    ],
+    visibility = ["//visibility:public"],
+)
+
+api_cc_py_proto_library(
+    name = "resource",
+    srcs = [
+        "opentelemetry/proto/resource/v1/resource.proto",
+    ],
+    deps = [
+        ":common",
+    ],
+    visibility = ["//visibility:public"],
+)
+
+api_cc_py_proto_library(
+    name = "metrics",
+    srcs = [
+        "opentelemetry/proto/metrics/v1/metrics.proto",
+    ],
+    deps = [
+        ":common",
+        ":resource",
+    ],
+    visibility = ["//visibility:public"],
+)
+
+api_cc_py_proto_library(
+    name = "metrics_service",
+    srcs = [
+        "opentelemetry/proto/collector/metrics/v1/metrics_service.proto",
+    ],
+    deps = [
+        ":metrics",
+    ],
+    visibility = ["//visibility:public"],
+)
+"""
+
 ZIPKINAPI_BUILD_CONTENT = """
 
 load("@envoy_api//bazel:api_build_system.bzl", "api_cc_py_proto_library")
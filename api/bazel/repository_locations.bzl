@@ -4,6 +4,10 @@ BAZEL_SKYLIB_SHA256 = "1dde365491125a3db70731e25658dfdd3bc5dbdfd11b840b3e987ecf0
 OPENCENSUS_PROTO_GIT_SHA = "be218fb6bd674af7519b1850cdf8410d8cbd48e8"  # Dec 20, 2019
 OPENCENSUS_PROTO_SHA256 = "e3bbdc94375e86c0edfb2fc5851507e08a3f26ee725ffff7c5c0e73264bdfcde"
 
+# The SHA256 sum of the v0.11.0 archive is not pinned yet, and check_repositories.sh fails on it.
+OPENTELEMETRY_PROTO_RELEASE = "0.11.0"
+OPENTELEMETRY_PROTO_SHA256 = ""
+
 PGV_GIT_SHA = "ab56c3dd1cf9b516b62c5087e1ec1471bd63631e"  # Mar 11, 2020
 PGV_SHA256 = "3be12077affd1ebf8787001f5fba545cc5f1b914964dab4e0cc77c43fba03b41"
 
@@ -53,6 +57,11 @@ REPOSITORY_LOCATIONS = dict(
         strip_prefix = "opencensus-proto-" + OPENCENSUS_PROTO_GIT_SHA + "/src",
         urls = ["https://github.com/census-instrumentation/opencensus-proto/archive/" + OPENCENSUS_PROTO_GIT_SHA + ".tar.gz"],
     ),
+    opentelemetry_proto = dict(
+        sha256 = OPENTELEMETRY_PROTO_SHA256,
+        strip_prefix = "opentelemetry-proto-" + OPENTELEMETRY_PROTO_RELEASE,
+        urls = ["https://github.com/open-telemetry/opentelemetry-proto/archive/v" + OPENTELEMETRY_PROTO_RELEASE + ".tar.gz"],
+    ),
     rules_proto = dict(
         sha256 = RULES_PROTO_SHA256,
         strip_prefix = "rules_proto-" + RULES_PROTO_GIT_SHA + "",
@@ -14,7 +14,7 @@
 namespace Envoy {
 namespace Filesystem {
 
-using FlagSet = std::bitset<4>;
+using FlagSet = std::bitset<5>;
 
 /**
  * Abstraction for a basic file on disk.
@@ -28,6 +28,7 @@ public:
     Write,
     Create,
     Append,
+    Truncate,
   };
 
   /**
@@ -45,6 +46,14 @@ public:
    */
   virtual Api::IoCallSizeResult write(absl::string_view buffer) PURE;
 
+  /**
+   * Flush the data written to the file to its storage device. The file must be explicitly opened
+   * before syncing.
+   *
+   * @return bool whether the sync succeeded
+   */
+  virtual Api::IoCallBoolResult sync() PURE;
+
   /**
    * Close the file.
    *
@@ -111,6 +120,16 @@ public:
    */
   virtual std::string fileReadToEnd(const std::string& path) PURE;
 
+  /**
+   * Rename a file, replacing the file at the new path if any. On POSIX systems the replacement is
+   * atomic, so that the new path refers to either file at all times.
+   * @param old_path the path of the file to rename.
+   * @param new_path the new path of the file.
+   * @return bool whether the rename succeeded
+   */
+  virtual Api::IoCallBoolResult rename(const std::string& old_path,
+                                       const std::string& new_path) PURE;
+
   /**
    * @path file path to split
    * @return PathSplitResult containing the parent directory of the input path and the file name
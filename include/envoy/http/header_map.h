@@ -93,18 +93,26 @@ using LowerCaseStrPairVector =
  */
 using InlineHeaderVector = absl::InlinedVector<char, 128>;
 
+/**
+ * An immutable, reference counted string which may back many HeaderStrings at once, i.e. the header
+ * values which a codec decodes repeatedly on the same connection.
+ */
+using SharedHeaderString = std::shared_ptr<const std::string>;
+
 /**
  * Convenient type for the underlying type of HeaderString that allows a variant
- * between string_view and the InlinedVector.
+ * between string_view, the InlinedVector and a shared string.
  */
-using VariantHeader = absl::variant<absl::string_view, InlineHeaderVector>;
+using VariantHeader = absl::variant<absl::string_view, InlineHeaderVector, SharedHeaderString>;
 
 /**
  * This is a string implementation for use in header processing. It is heavily optimized for
- * performance. It supports 2 different types of storage and can switch between them:
+ * performance. It supports 3 different types of storage and can switch between them:
  * 1) A reference.
  * 2) An InlinedVector (an optimized interned string for small strings, but allows heap
  * allocation if needed).
+ * 3) A shared string, which is immutable and is copied into an InlinedVector before being
+ * modified.
  */
 class HeaderString {
 public:
@@ -196,6 +204,13 @@ public:
    */
   void setReference(absl::string_view ref_value);
 
+  /**
+   * Set the value of the string to a shared string, without copying it. This overwrites any
+   * existing string.
+   * @param shared_value supplies the shared string, which must not be null.
+   */
+  void setShared(SharedHeaderString shared_value);
+
   /**
    * @return whether the string is a reference or an InlinedVector.
    */
@@ -216,7 +231,7 @@ public:
   bool operator!=(absl::string_view rhs) const { return getStringView() != rhs; }
 
 private:
-  enum class Type { Reference, Inline };
+  enum class Type { Reference, Inline, Shared };
 
   VariantHeader buffer_;
 
@@ -59,6 +59,20 @@ public:
   virtual void onBelowWriteBufferLowWatermark() PURE;
 };
 
+/**
+ * Callbacks of a connection whose socket is read by its owner rather than by the connection.
+ * @see Connection::startRawIo().
+ */
+class RawIoCallbacks {
+public:
+  virtual ~RawIoCallbacks() = default;
+
+  /**
+   * Called when the socket of the connection may have become readable or writable.
+   */
+  virtual void onRawIoReady() PURE;
+};
+
 /**
  * Type of connection close to perform.
  */
@@ -301,6 +315,35 @@ public:
    *         occurred an empty string is returned.
    */
   virtual absl::string_view transportFailureReason() const PURE;
+
+  /**
+   * @return the I/O handle of the socket of the connection if its data can be forwarded without
+   *         going through the connection (i.e. with splice()), or nullptr otherwise. This requires
+   *         that the transport socket reads and writes plaintext straight from and to the socket,
+   *         that no data is buffered in the connection, and that no network filter besides the
+   *         single read filter of the caller sees the data of the connection.
+   */
+  virtual IoHandle* rawIoHandle() PURE;
+
+  /**
+   * Hands the reads of the socket over to the caller, which reads the socket through
+   * rawIoHandle() from then on. The connection stops reading its socket, and calls the callbacks
+   * instead whenever the socket may have become readable or writable, starting with a call from
+   * the dispatcher for the data which already arrived. The caller may also write to the socket
+   * directly as long as nothing is written through the connection, and half-closes the socket by
+   * writing end of stream through the connection. Must only be called when rawIoHandle() returns
+   * the I/O handle.
+   * @param callbacks supplies the callbacks, which must outlive the connection, its closing, or
+   *        the call to stopRawIo().
+   */
+  virtual void startRawIo(RawIoCallbacks& callbacks) PURE;
+
+  /**
+   * Takes the reads of the socket back from the callbacks passed to startRawIo(), which are not
+   * called anymore. The connection reads its socket again unless reads are disabled. May be called
+   * after the connection was closed.
+   */
+  virtual void stopRawIo() PURE;
 };
 
 using ConnectionPtr = std::unique_ptr<Connection>;
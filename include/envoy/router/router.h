@@ -413,7 +413,7 @@ public:
 };
 
 class RateLimitPolicy;
-class Config;
+class CommonConfig;
 
 /**
  * All route specific config returned by the method at
@@ -449,9 +449,11 @@ public:
   virtual const RateLimitPolicy& rateLimitPolicy() const PURE;
 
   /**
-   * @return const Config& the RouteConfiguration that owns this virtual host.
+   * @return const CommonConfig& the parts of the RouteConfiguration that owns this virtual host
+   *         which are common to all of its virtual hosts. Virtual hosts which did not change may
+   *         be shared by successive versions of a RouteConfiguration.
    */
-  virtual const Config& routeConfig() const PURE;
+  virtual const CommonConfig& routeConfig() const PURE;
 
   /**
    * @return const RouteSpecificFilterConfig* the per-filter config pre-processed object for
@@ -958,23 +960,11 @@ public:
 using RouteConstSharedPtr = std::shared_ptr<const Route>;
 
 /**
- * The router configuration.
+ * The parts of the router configuration which are common to all of its virtual hosts.
  */
-class Config {
+class CommonConfig {
 public:
-  virtual ~Config() = default;
-
-  /**
-   * Based on the incoming HTTP request headers, determine the target route (containing either a
-   * route entry or a direct response entry) for the request.
-   * @param headers supplies the request headers.
-   * @param random_value supplies the random seed to use if a runtime choice is required. This
-   *        allows stable choices between calls if desired.
-   * @return the route or nullptr if there is no matching route for the request.
-   */
-  virtual RouteConstSharedPtr route(const Http::RequestHeaderMap& headers,
-                                    const StreamInfo::StreamInfo& stream_info,
-                                    uint64_t random_value) const PURE;
+  virtual ~CommonConfig() = default;
 
   /**
    * Return a list of headers that will be cleaned from any requests that are not from an internal
@@ -1000,6 +990,24 @@ public:
   virtual bool mostSpecificHeaderMutationsWins() const PURE;
 };
 
+/**
+ * The router configuration.
+ */
+class Config : public CommonConfig {
+public:
+  /**
+   * Based on the incoming HTTP request headers, determine the target route (containing either a
+   * route entry or a direct response entry) for the request.
+   * @param headers supplies the request headers.
+   * @param random_value supplies the random seed to use if a runtime choice is required. This
+   *        allows stable choices between calls if desired.
+   * @return the route or nullptr if there is no matching route for the request.
+   */
+  virtual RouteConstSharedPtr route(const Http::RequestHeaderMap& headers,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    uint64_t random_value) const PURE;
+};
+
 using ConfigConstSharedPtr = std::shared_ptr<const Config>;
 
 } // namespace Router
@@ -5,6 +5,7 @@
 
 #include "envoy/common/pure.h"
 #include "envoy/event/dispatcher.h"
+#include "envoy/ssl/context_manager.h"
 #include "envoy/stats/allocator.h"
 #include "envoy/stats/store.h"
 #include "envoy/thread/thread.h"
@@ -74,6 +75,14 @@ public:
    */
   virtual ServerStatsFromParent mergeParentStatsIfAny(Stats::StoreRoot& stats_store) PURE;
 
+  /**
+   * Retrieve the TLS sessions of upstream connections cached by our parent process, and add them
+   * to the cache of context_manager, so that upstream connections keep resuming sessions across
+   * the restart. Does nothing if there is not currently a parent.
+   * @param context_manager the context manager whose client contexts will use the sessions.
+   */
+  virtual void importParentTlsSessions(Ssl::ContextManager& context_manager) PURE;
+
   /**
    * Shutdown the half of our hot restarter that acts as a parent.
    */
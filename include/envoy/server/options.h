@@ -195,6 +195,17 @@ public:
    */
   virtual bool fakeSymbolTableEnabled() const PURE;
 
+  /**
+   * @return the path of the file backing the memory-mapped stats region, or empty if counters and
+   *         gauges are allocated on the heap.
+   */
+  virtual const std::string& statsRegionPath() const PURE;
+
+  /**
+   * @return the number of stat slots in the memory-mapped stats region.
+   */
+  virtual uint32_t statsRegionSlots() const PURE;
+
   /**
    * @return bool indicating whether cpuset size should determine the number of worker threads.
    */
@@ -61,6 +61,12 @@ public:
    */
   virtual unsigned maxProtocolVersion() const PURE;
 
+  /**
+   * @return true if record protection should be offloaded to the kernel once the handshake
+   *         completes, when the kernel and the negotiated parameters allow it.
+   */
+  virtual bool kernelTlsOffload() const PURE;
+
   /**
    * @return true if the ContextConfig is able to provide secrets to create SSL context,
    * and false if dynamic secrets are expected but are not downloaded from SDS server yet.
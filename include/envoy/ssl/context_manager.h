@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <string>
 
 #include "envoy/common/time.h"
 #include "envoy/config/typed_config.h"
@@ -9,6 +10,8 @@
 #include "envoy/ssl/private_key/private_key.h"
 #include "envoy/stats/scope.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Ssl {
 
@@ -47,6 +50,24 @@ public:
    * context manager.
    */
   virtual PrivateKeyMethodManager& privateKeyMethodManager() PURE;
+
+  /**
+   * Iterate through the TLS sessions of upstream connections cached by the client contexts, to
+   * hand them to another process.
+   * @param callback supplies the callback called with the cache key and the serialized form of
+   *        each session.
+   */
+  virtual void
+  iterateSessions(std::function<void(const std::string& key, absl::string_view session)> callback)
+      PURE;
+
+  /**
+   * Add a TLS session of upstream connections, handed from another process, to the cache of the
+   * client contexts.
+   * @param key supplies the cache key of the session.
+   * @param session supplies the serialized session.
+   */
+  virtual void importSession(const std::string& key, absl::string_view session) PURE;
 };
 
 using ContextManagerPtr = std::unique_ptr<ContextManager>;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -136,6 +137,21 @@ public:
    * Returns the bucket summary representation.
    */
   virtual const std::string bucketSummary() const PURE;
+
+  /**
+   * Function called with the lower bound and the width of a bin of the histogram, and the number
+   * of samples in it.
+   */
+  using BinFn = std::function<void(double lower_bound, double width, uint64_t count)>;
+
+  /**
+   * Iterates the non-empty bins of the underlying log-linear histogram, which have two significant
+   * decimal digits, in increasing order of value.
+   * @param cumulative supplies whether to iterate the bins of all the samples merged so far rather
+   *        than the ones of the flush interval.
+   * @param fn supplies the function called for each bin.
+   */
+  virtual void forEachBin(bool cumulative, const BinFn& fn) const PURE;
 };
 
 using ParentHistogramSharedPtr = RefcountPtr<ParentHistogram>;
@@ -102,6 +102,17 @@ public:
   virtual SlotPtr allocateSlot() PURE;
 };
 
+/**
+ * A batch of slot updates, started by Instance::batchUpdates(). The updates are posted to the
+ * worker threads when the batch is destroyed.
+ */
+class UpdateBatch {
+public:
+  virtual ~UpdateBatch() = default;
+};
+
+using UpdateBatchPtr = std::unique_ptr<UpdateBatch>;
+
 /**
  * Interface for getting and setting thread local data as well as registering a thread
  */
@@ -134,6 +145,17 @@ public:
    * @return Event::Dispatcher& the thread local dispatcher.
    */
   virtual Event::Dispatcher& dispatcher() PURE;
+
+  /**
+   * Batches the updates which the main thread makes to slots, via Slot::set() and
+   * Slot::runOnAllThreads(), until the returned batch is destroyed. The callbacks of these updates
+   * still run on the main thread immediately, but are posted to each worker thread as a single
+   * callback which runs them in order once the batch is destroyed, rather than one post per update
+   * and worker. Batches may be nested, in which case the updates are posted once the outermost
+   * batch is destroyed.
+   * @return UpdateBatchPtr the batch, which must be destroyed on the main thread.
+   */
+  virtual UpdateBatchPtr batchUpdates() PURE;
 };
 
 } // namespace ThreadLocal
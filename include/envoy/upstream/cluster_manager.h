@@ -18,6 +18,7 @@
 #include "envoy/http/async_client.h"
 #include "envoy/http/conn_pool.h"
 #include "envoy/local_info/local_info.h"
+#include "envoy/protobuf/message_validator.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/secret/secret_manager.h"
 #include "envoy/server/admin.h"
@@ -68,6 +69,64 @@ public:
 
 using ClusterUpdateCallbacksHandlePtr = std::unique_ptr<ClusterUpdateCallbacksHandle>;
 
+/**
+ * The outcome of an on-demand cluster discovery request.
+ */
+enum class ClusterDiscoveryStatus {
+  // The cluster was discovered and is available on the requesting thread.
+  Available,
+  // The cluster was not available on the requesting thread before the request timed out.
+  Timeout,
+  // The config source does not have the cluster, or rejected the update which carried it.
+  Missing,
+};
+
+/**
+ * Called on the requesting thread when an on-demand cluster discovery request completes.
+ */
+using ClusterDiscoveryCallback = std::function<void(ClusterDiscoveryStatus)>;
+using ClusterDiscoveryCallbackPtr = std::unique_ptr<ClusterDiscoveryCallback>;
+
+/**
+ * ClusterDiscoveryCallbackHandle is a RAII wrapper for a pending on-demand cluster discovery
+ * request. Deleting the handle before the request completes cancels the callback of the request.
+ */
+class ClusterDiscoveryCallbackHandle {
+public:
+  virtual ~ClusterDiscoveryCallbackHandle() = default;
+};
+
+using ClusterDiscoveryCallbackHandlePtr = std::unique_ptr<ClusterDiscoveryCallbackHandle>;
+
+/**
+ * A handle to an on-demand CDS subscription allocated by the cluster manager, through which
+ * workers request the clusters they do not know yet.
+ */
+class OdCdsApiHandle {
+public:
+  virtual ~OdCdsApiHandle() = default;
+
+  /**
+   * Request the discovery of a cluster which is not known on the calling thread. The cluster is
+   * added to the cluster manager once it is received and warmed, at which point the callback runs
+   * on the calling thread with ClusterDiscoveryStatus::Available.
+   *
+   * @param name is the name of the cluster to discover.
+   * @param callback is run on the calling thread when the request completes.
+   * @param timeout is how long to wait for the cluster before running the callback with
+   * ClusterDiscoveryStatus::Timeout. The callback runs earlier with ClusterDiscoveryStatus::Missing
+   * if the config source does not have the cluster.
+   * @return ClusterDiscoveryCallbackHandlePtr a RAII that cancels the request when deleted, or
+   * nullptr if the cluster is already known on the calling thread, in which case the callback is
+   * not run.
+   */
+  virtual ClusterDiscoveryCallbackHandlePtr
+  requestOnDemandClusterDiscovery(const std::string& name, ClusterDiscoveryCallbackPtr callback,
+                                  std::chrono::milliseconds timeout) PURE;
+};
+
+using OdCdsApiHandleSharedPtr = std::shared_ptr<OdCdsApiHandle>;
+
 class ClusterManagerFactory;
 
 /**
@@ -227,6 +286,24 @@ public:
    * @return Config::SubscriptionFactory& the subscription factory.
    */
   virtual Config::SubscriptionFactory& subscriptionFactory() PURE;
+
+  /**
+   * Allocate an on-demand CDS subscription, which subscribes to clusters as they are first
+   * requested through the returned handle. Must be called on the main thread.
+   *
+   * @param odcds_config is the configuration source of the on-demand clusters.
+   * @param idle_timeout is how long a cluster added on demand may go without requests and
+   * connections before it is removed again. Clusters are kept if it is not set.
+   * @param validation_visitor is used to validate the received clusters.
+   * @return OdCdsApiHandleSharedPtr the handle to request clusters through, which may be shared
+   * with the workers. The subscription is shared by all the callers with the same configuration
+   * source and idle timeout, so that the clusters it added keep being tracked when the callers
+   * which requested them are replaced.
+   */
+  virtual OdCdsApiHandleSharedPtr
+  allocateOdCdsApi(const envoy::config::core::v3::ConfigSource& odcds_config,
+                   absl::optional<std::chrono::milliseconds> idle_timeout,
+                   ProtobufMessage::ValidationVisitor& validation_visitor) PURE;
 };
 
 using ClusterManagerPtr = std::unique_ptr<ClusterManager>;
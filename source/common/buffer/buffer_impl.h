@@ -8,6 +8,7 @@
 #include "envoy/buffer/buffer.h"
 #include "envoy/network/io_handle.h"
 
+#include "common/buffer/slice_allocator.h"
 #include "common/common/assert.h"
 #include "common/common/non_copyable.h"
 #include "common/common/utility.h"
@@ -240,6 +241,12 @@ public:
     return slice;
   }
 
+  // The storage of slices comes from the per-thread free lists of SliceAllocator.
+  static void* operator new(size_t object_size, size_t data_size_bytes) {
+    return SliceAllocator::allocate(object_size + data_size_bytes);
+  }
+  static void operator delete(void* address) { SliceAllocator::deallocate(address); }
+
 private:
   OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
 
@@ -249,9 +256,11 @@ private:
    * @return a recommended slice size, in bytes.
    */
   static uint64_t sliceSize(uint64_t data_size) {
-    static constexpr uint64_t PageSize = 4096;
-    const uint64_t num_pages = (sizeof(OwnedSlice) + data_size + PageSize - 1) / PageSize;
-    return num_pages * PageSize - sizeof(OwnedSlice);
+    // The block of the slice, allocator header included, is sized in whole pages.
+    static constexpr uint64_t PageSize = SliceAllocator::PageSize;
+    static constexpr uint64_t Overhead = SliceAllocator::HeaderSize + sizeof(OwnedSlice);
+    const uint64_t num_pages = (Overhead + data_size + PageSize - 1) / PageSize;
+    return num_pages * PageSize - Overhead;
   }
 
   uint8_t storage_[];
@@ -0,0 +1,177 @@
+#include "common/buffer/slice_allocator.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <new>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Buffer {
+
+namespace {
+
+struct alignas(SliceAllocator::HeaderSize) BlockHeader {
+  // Size of the block, header included.
+  uint64_t size_;
+};
+static_assert(sizeof(BlockHeader) == SliceAllocator::HeaderSize, "unexpected block header size");
+static_assert(SliceAllocator::HeaderSize % alignof(std::max_align_t) == 0,
+              "block header misaligns the storage of blocks");
+
+struct FreeBlock {
+  FreeBlock* next_;
+};
+
+// Counters of a thread. Only the thread owning them writes them, so they are updated with a plain
+// load and store rather than a read-modify-write, and are atomic only to be read by stats().
+struct ThreadStats {
+  void add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+  void subtract(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) - value, std::memory_order_relaxed);
+  }
+  SliceAllocator::Stats load() const {
+    SliceAllocator::Stats stats;
+    stats.allocated_blocks_ = allocated_blocks_.load(std::memory_order_relaxed);
+    stats.reused_blocks_ = reused_blocks_.load(std::memory_order_relaxed);
+    stats.cached_bytes_ = cached_bytes_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  std::atomic<uint64_t> allocated_blocks_{};
+  std::atomic<uint64_t> reused_blocks_{};
+  std::atomic<uint64_t> cached_bytes_{};
+};
+
+// The counters of all the live threads, and the sum of the counters of the threads which exited.
+struct StatsRegistry {
+  Thread::MutexBasicLockable mutex_;
+  std::list<const ThreadStats*> threads_ ABSL_GUARDED_BY(mutex_);
+  uint64_t exited_allocated_blocks_ ABSL_GUARDED_BY(mutex_){};
+  uint64_t exited_reused_blocks_ ABSL_GUARDED_BY(mutex_){};
+};
+
+// Leaked, so that it outlives the threads which exit during the destruction of static objects.
+StatsRegistry& statsRegistry() { MUTABLE_CONSTRUCT_ON_FIRST_USE(StatsRegistry); }
+
+struct ThreadCache {
+  ThreadCache();
+  ~ThreadCache();
+
+  std::array<FreeBlock*, SliceAllocator::NumSizeClasses> free_blocks_{};
+  std::array<uint32_t, SliceAllocator::NumSizeClasses> num_free_blocks_{};
+  ThreadStats stats_;
+  std::list<const ThreadStats*>::iterator registration_;
+};
+
+// Set once the cache of the thread is destroyed, so that slices freed later on during the exit of
+// the thread (i.e. by other thread local objects) go to the global allocator. Being trivially
+// destructible, it stays valid until the thread is gone.
+thread_local bool thread_cache_destroyed = false;
+thread_local ThreadCache thread_cache;
+
+ThreadCache::ThreadCache() {
+  StatsRegistry& registry = statsRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  registration_ = registry.threads_.insert(registry.threads_.end(), &stats_);
+}
+
+ThreadCache::~ThreadCache() {
+  for (FreeBlock* block : free_blocks_) {
+    while (block != nullptr) {
+      FreeBlock* next = block->next_;
+      ::operator delete(block);
+      block = next;
+    }
+  }
+  thread_cache_destroyed = true;
+
+  StatsRegistry& registry = statsRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  registry.threads_.erase(registration_);
+  registry.exited_allocated_blocks_ += stats_.allocated_blocks_.load(std::memory_order_relaxed);
+  registry.exited_reused_blocks_ += stats_.reused_blocks_.load(std::memory_order_relaxed);
+}
+
+// @return the size class of a block size, or NumSizeClasses if blocks of that size aren't cached.
+uint32_t sizeClass(uint64_t size) {
+  if (size % SliceAllocator::PageSize != 0 ||
+      size > SliceAllocator::NumSizeClasses * SliceAllocator::PageSize) {
+    return SliceAllocator::NumSizeClasses;
+  }
+  return size / SliceAllocator::PageSize - 1;
+}
+
+void* usableStorage(BlockHeader* header) { return header + 1; }
+
+} // namespace
+
+void* SliceAllocator::allocate(uint64_t size) {
+  const uint64_t block_size = size + HeaderSize;
+  const uint32_t size_class = sizeClass(block_size);
+  if (size_class == NumSizeClasses || thread_cache_destroyed) {
+    return usableStorage(new (::operator new(block_size)) BlockHeader{block_size});
+  }
+
+  ThreadCache& cache = thread_cache;
+  cache.stats_.add(cache.stats_.allocated_blocks_, 1);
+  FreeBlock* block = cache.free_blocks_[size_class];
+  if (block == nullptr) {
+    return usableStorage(new (::operator new(block_size)) BlockHeader{block_size});
+  }
+  cache.free_blocks_[size_class] = block->next_;
+  cache.num_free_blocks_[size_class]--;
+  cache.stats_.add(cache.stats_.reused_blocks_, 1);
+  cache.stats_.subtract(cache.stats_.cached_bytes_, block_size);
+  return usableStorage(new (block) BlockHeader{block_size});
+}
+
+void SliceAllocator::deallocate(void* block) {
+  BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+  const uint64_t block_size = header->size_;
+  const uint32_t size_class = sizeClass(block_size);
+  if (size_class == NumSizeClasses || thread_cache_destroyed) {
+    ::operator delete(header);
+    return;
+  }
+
+  ThreadCache& cache = thread_cache;
+  if (cache.num_free_blocks_[size_class] >= MaxFreeBlocksPerSizeClass) {
+    ::operator delete(header);
+    return;
+  }
+  FreeBlock* free_block = new (header) FreeBlock{cache.free_blocks_[size_class]};
+  cache.free_blocks_[size_class] = free_block;
+  cache.num_free_blocks_[size_class]++;
+  cache.stats_.add(cache.stats_.cached_bytes_, block_size);
+  ASSERT(cache.stats_.cached_bytes_.load(std::memory_order_relaxed) <= MaxCachedBytes);
+}
+
+SliceAllocator::Stats SliceAllocator::threadStats() {
+  return thread_cache_destroyed ? Stats{} : thread_cache.stats_.load();
+}
+
+SliceAllocator::Stats SliceAllocator::stats() {
+  StatsRegistry& registry = statsRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  Stats stats;
+  stats.allocated_blocks_ = registry.exited_allocated_blocks_;
+  stats.reused_blocks_ = registry.exited_reused_blocks_;
+  for (const ThreadStats* thread_stats : registry.threads_) {
+    const Stats thread = thread_stats->load();
+    stats.allocated_blocks_ += thread.allocated_blocks_;
+    stats.reused_blocks_ += thread.reused_blocks_;
+    stats.cached_bytes_ += thread.cached_bytes_;
+  }
+  return stats;
+}
+
+} // namespace Buffer
+} // namespace Envoy
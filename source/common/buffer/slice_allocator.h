@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * Allocator of the storage of buffer slices. Blocks are sized in whole pages, and the sizes which
+ * buffers churn through the most, from one to five pages, are served from free lists kept by each
+ * thread, so that a worker reuses the slices it drained without going through the global
+ * allocator. Other sizes always go through the global allocator. The 16KB reads of a connection
+ * take five pages, once the header of the block and the slice object are added to the data.
+ *
+ * A block goes to the free list of the thread which frees it, whichever thread allocated it, so
+ * that slices handed to another thread (i.e. a buffer posted to a worker) never take a lock to be
+ * freed. Each free list is bounded, so a thread never keeps more than MaxCachedBytes, and the
+ * blocks left in the free lists of a thread are released when it exits.
+ *
+ * Each block starts with a header of HeaderSize bytes recording its size, so that blocks are freed
+ * without their size being passed around.
+ */
+class SliceAllocator {
+public:
+  static constexpr uint64_t PageSize = 4096;
+  static constexpr uint64_t HeaderSize = 16;
+  static constexpr uint32_t NumSizeClasses = 5;
+  static constexpr uint32_t MaxFreeBlocksPerSizeClass = 16;
+  static constexpr uint64_t MaxCachedBytes =
+      MaxFreeBlocksPerSizeClass * PageSize * NumSizeClasses * (NumSizeClasses + 1) / 2;
+
+  /**
+   * Memory usage of the free lists. The counters are kept per thread, so that updating them never
+   * contends with other threads, and are only summed up when read.
+   */
+  struct Stats {
+    // Blocks of the sizes served from the free lists allocated, whether reused from them or not.
+    // Blocks of other sizes aren't counted.
+    uint64_t allocated_blocks_{};
+    // Blocks allocated which were reused from the free lists.
+    uint64_t reused_blocks_{};
+    // Bytes held in the free lists, headers included.
+    uint64_t cached_bytes_{};
+  };
+
+  /**
+   * @param size supplies the usable size of the block, in bytes. Blocks are only cached when size
+   *        plus HeaderSize is a whole number of pages.
+   * @return a block of at least size bytes, to be freed with deallocate().
+   */
+  static void* allocate(uint64_t size);
+
+  /**
+   * Frees a block returned by allocate(), from any thread.
+   * @param block supplies the block.
+   */
+  static void deallocate(void* block);
+
+  /**
+   * @return the memory usage of the free lists of the calling thread.
+   */
+  static Stats threadStats();
+
+  /**
+   * @return the memory usage of the free lists of all the threads. The blocks allocated by threads
+   *         which have exited are still counted.
+   */
+  static Stats stats();
+};
+
+} // namespace Buffer
+} // namespace Envoy
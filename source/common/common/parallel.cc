@@ -0,0 +1,36 @@
+#include "common/common/parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Thread {
+
+void parallelFor(ThreadFactory& thread_factory, size_t count, size_t min_range_size,
+                 uint32_t max_threads, const std::function<void(size_t)>& fn) {
+  ASSERT(min_range_size > 0);
+  const size_t threads =
+      std::max<size_t>(1, std::min<size_t>(max_threads, count / min_range_size));
+  const size_t range_size = threads > 1 ? (count + threads - 1) / threads : count;
+  const auto run_range = [&fn, count](size_t begin, size_t range_size) {
+    const size_t end = std::min(count, begin + range_size);
+    for (size_t i = begin; i < end; i++) {
+      fn(i);
+    }
+  };
+
+  std::vector<ThreadPtr> helpers;
+  for (size_t begin = range_size; begin < count; begin += range_size) {
+    helpers.push_back(thread_factory.createThread(
+        [&run_range, begin, range_size]() { run_range(begin, range_size); }));
+  }
+  run_range(0, range_size);
+  for (ThreadPtr& helper : helpers) {
+    helper->join();
+  }
+}
+
+} // namespace Thread
+} // namespace Envoy
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "envoy/thread/thread.h"
+
+namespace Envoy {
+namespace Thread {
+
+/**
+ * Runs a function for each index in [0, count), splitting the indexes in contiguous ranges which
+ * are run concurrently by the calling thread and short lived helper threads. This is meant for
+ * CPU bound work on large batches, such as decoding the resources of a large config update, which
+ * would otherwise stall the calling thread for long.
+ * @param thread_factory supplies the factory of the helper threads.
+ * @param count supplies the number of indexes.
+ * @param min_range_size supplies the minimum number of indexes worth a thread of their own, so that
+ *        small batches are run by the calling thread alone.
+ * @param max_threads supplies the maximum number of threads, including the calling thread.
+ * @param fn supplies the function to run for each index. It must be safe to run concurrently for
+ *        different indexes, and must not throw.
+ */
+void parallelFor(ThreadFactory& thread_factory, size_t count, size_t min_range_size,
+                 uint32_t max_threads, const std::function<void(size_t)>& fn);
+
+} // namespace Thread
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/config/grpc_mux_impl.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 #include "envoy/service/discovery/v3/discovery.pb.h"
@@ -9,6 +10,9 @@
 #include "common/memory/utils.h"
 #include "common/protobuf/protobuf.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
 namespace Envoy {
 namespace Config {
 
@@ -17,12 +21,17 @@ GrpcMuxImpl::GrpcMuxImpl(const LocalInfo::LocalInfo& local_info,
                          const Protobuf::MethodDescriptor& service_method,
                          envoy::config::core::v3::ApiVersion transport_api_version,
                          Runtime::RandomGenerator& random, Stats::Scope& scope,
-                         const RateLimitSettings& rate_limit_settings, bool skip_subsequent_node)
+                         const RateLimitSettings& rate_limit_settings, bool skip_subsequent_node,
+                         SnapshotCachePtr snapshot_cache)
     : grpc_stream_(this, std::move(async_client), service_method, random, dispatcher, scope,
                    rate_limit_settings),
       local_info_(local_info), skip_subsequent_node_(skip_subsequent_node),
-      first_stream_request_(true), transport_api_version_(transport_api_version) {
+      first_stream_request_(true), transport_api_version_(transport_api_version),
+      snapshot_cache_(std::move(snapshot_cache)) {
   Config::Utility::checkLocalInfo("ads", local_info);
+  if (snapshot_cache_ != nullptr) {
+    snapshot_timer_ = dispatcher.createTimer([this]() -> void { replaySnapshots(); });
+  }
 }
 
 void GrpcMuxImpl::start() { grpc_stream_.establishNewStream(); }
@@ -83,6 +92,15 @@ GrpcMuxWatchPtr GrpcMuxImpl::addWatch(const std::string& type_url,
     api_state_[type_url].request_.mutable_node()->MergeFrom(local_info_.node());
     api_state_[type_url].subscribed_ = true;
     subscriptions_.emplace_back(type_url);
+    if (snapshot_cache_ != nullptr) {
+      api_state_[type_url].snapshot_ = snapshot_cache_->load(type_url);
+    }
+  }
+
+  // The snapshot is replayed from the dispatcher rather than from within the subscription start,
+  // which is also when the management server's responses are delivered.
+  if (api_state_[type_url].snapshot_ != nullptr) {
+    snapshot_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 
   // This will send an updated request on each subscription.
@@ -134,6 +152,9 @@ void GrpcMuxImpl::onDiscoveryResponse(
     // protocol violation
     return;
   }
+  // The management server's response supersedes the snapshot, which is not replayed anymore.
+  seedSnapshot(type_url);
+  api_state_[type_url].snapshot_.reset();
   if (api_state_[type_url].watches_.empty()) {
     // update the nonce as we are processing this response.
     api_state_[type_url].request_.set_response_nonce(message->nonce());
@@ -152,47 +173,16 @@ void GrpcMuxImpl::onDiscoveryResponse(
     }
     return;
   }
+  bool accepted = false;
+  bool named = false;
+  std::vector<std::string> resource_names;
   try {
-    // To avoid O(n^2) explosion (e.g. when we have 1000s of EDS watches), we
-    // build a map here from resource name to resource and then walk watches_.
-    // We have to walk all watches (and need an efficient map as a result) to
-    // ensure we deliver empty config updates when a resource is dropped.
-    std::unordered_map<std::string, ProtobufWkt::Any> resources;
-    SubscriptionCallbacks& callbacks = api_state_[type_url].watches_.front()->callbacks_;
-    for (const auto& resource : message->resources()) {
-      if (type_url != resource.type_url()) {
-        throw EnvoyException(
-            fmt::format("{} does not match the message-wide type URL {} in DiscoveryResponse {}",
-                        resource.type_url(), type_url, message->DebugString()));
-      }
-      const std::string resource_name = callbacks.resourceName(resource);
-      resources.emplace(resource_name, resource);
-    }
-    for (auto watch : api_state_[type_url].watches_) {
-      // onConfigUpdate should be called in all cases for single watch xDS (Cluster and
-      // Listener) even if the message does not have resources so that update_empty stat
-      // is properly incremented and state-of-the-world semantics are maintained.
-      if (watch->resources_.empty()) {
-        watch->callbacks_.onConfigUpdate(message->resources(), message->version_info());
-        continue;
-      }
-      Protobuf::RepeatedPtrField<ProtobufWkt::Any> found_resources;
-      for (const auto& watched_resource_name : watch->resources_) {
-        auto it = resources.find(watched_resource_name);
-        if (it != resources.end()) {
-          found_resources.Add()->MergeFrom(it->second);
-        }
-      }
-      // onConfigUpdate should be called only on watches(clusters/routes) that have
-      // updates in the message for EDS/RDS.
-      if (!found_resources.empty()) {
-        watch->callbacks_.onConfigUpdate(found_resources, message->version_info());
-      }
-    }
+    named = onResources(*message, api_state_[type_url].watches_, resource_names);
     // TODO(mattklein123): In the future if we start tracking per-resource versions, we
     // would do that tracking here.
     api_state_[type_url].request_.set_version_info(message->version_info());
     Memory::Utils::tryShrinkHeap();
+    accepted = true;
   } catch (const EnvoyException& e) {
     for (auto watch : api_state_[type_url].watches_) {
       watch->callbacks_.onConfigUpdateFailed(
@@ -204,6 +194,127 @@ void GrpcMuxImpl::onDiscoveryResponse(
   }
   api_state_[type_url].request_.set_response_nonce(message->nonce());
   queueDiscoveryRequest(type_url);
+  if (!accepted || snapshot_cache_ == nullptr) {
+    return;
+  }
+  // The response is handed over to the snapshot cache's thread, which serializes it. The responses
+  // of the type URLs whose resources are requested by name may only hold some of them, so they are
+  // merged into the snapshot rather than replacing it.
+  if (!named) {
+    snapshot_cache_->store(std::move(message));
+    return;
+  }
+  absl::flat_hash_set<std::string> subscribed_names;
+  for (const GrpcMuxWatchImpl* watch : api_state_[type_url].watches_) {
+    subscribed_names.insert(watch->resources_.begin(), watch->resources_.end());
+  }
+  snapshot_cache_->merge(std::move(message), std::move(resource_names),
+                         std::move(subscribed_names));
+}
+
+void GrpcMuxImpl::seedSnapshot(const std::string& type_url) {
+  ApiState& api_state = api_state_[type_url];
+  if (api_state.snapshot_ == nullptr ||
+      std::none_of(api_state.watches_.begin(), api_state.watches_.end(),
+                   [](const GrpcMuxWatchImpl* watch) { return !watch->resources_.empty(); })) {
+    return;
+  }
+  // The responses merged into the snapshot start from the loaded one, which may hold resources
+  // that the management server only sends later.
+  std::vector<std::string> resource_names;
+  resource_names.reserve(api_state.snapshot_->resources().size());
+  try {
+    for (const auto& resource : api_state.snapshot_->resources()) {
+      resource_names.push_back(api_state.watches_.front()->callbacks_.resourceName(resource));
+    }
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "Not merging into the snapshot of {}: {}", type_url, e.what());
+    return;
+  }
+  snapshot_cache_->seed(std::move(api_state.snapshot_), std::move(resource_names));
+}
+
+bool GrpcMuxImpl::onResources(const envoy::service::discovery::v3::DiscoveryResponse& message,
+                              const std::list<GrpcMuxWatchImpl*>& watches,
+                              std::vector<std::string>& resource_names) {
+  const std::string& type_url = message.type_url();
+  // To avoid O(n^2) explosion (e.g. when we have 1000s of EDS watches), we
+  // build a map here from resource name to resource and then walk watches.
+  // We have to walk all watches (and need an efficient map as a result) to
+  // ensure we deliver empty config updates when a resource is dropped.
+  // The map points into the message rather than copying its resources, and is only built if a
+  // watch names the resources it wants. Wildcard (e.g. CDS and LDS) responses, which are the
+  // largest, are handed to their watch as they were received.
+  const bool any_named_watch =
+      std::any_of(watches.begin(), watches.end(),
+                  [](const GrpcMuxWatchImpl* watch) { return !watch->resources_.empty(); });
+  absl::flat_hash_map<std::string, const ProtobufWkt::Any*> resources;
+  SubscriptionCallbacks& callbacks = watches.front()->callbacks_;
+  for (const auto& resource : message.resources()) {
+    if (type_url != resource.type_url()) {
+      throw EnvoyException(
+          fmt::format("{} does not match the message-wide type URL {} in DiscoveryResponse {}",
+                      resource.type_url(), type_url, message.DebugString()));
+    }
+    if (any_named_watch) {
+      resource_names.push_back(callbacks.resourceName(resource));
+      resources.emplace(resource_names.back(), &resource);
+    }
+  }
+  for (auto watch : watches) {
+    // onConfigUpdate should be called in all cases for single watch xDS (Cluster and
+    // Listener) even if the message does not have resources so that update_empty stat
+    // is properly incremented and state-of-the-world semantics are maintained.
+    if (watch->resources_.empty()) {
+      watch->callbacks_.onConfigUpdate(message.resources(), message.version_info());
+      continue;
+    }
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> found_resources;
+    for (const auto& watched_resource_name : watch->resources_) {
+      auto it = resources.find(watched_resource_name);
+      if (it != resources.end()) {
+        found_resources.Add()->CopyFrom(*it->second);
+      }
+    }
+    // onConfigUpdate should be called only on watches(clusters/routes) that have
+    // updates in the message for EDS/RDS.
+    if (!found_resources.empty()) {
+      watch->callbacks_.onConfigUpdate(found_resources, message.version_info());
+    }
+  }
+  return any_named_watch;
+}
+
+void GrpcMuxImpl::replaySnapshots() {
+  // Snapshots are replayed in subscription order, which follows Envoy's dependency ordering. The
+  // subscriptions made while replaying (e.g. EDS for the replayed clusters) are appended, and
+  // replayed within the same pass.
+  for (const auto& type_url : subscriptions_) {
+    ApiState& api_state = api_state_[type_url];
+    if (api_state.snapshot_ == nullptr) {
+      continue;
+    }
+    std::list<GrpcMuxWatchImpl*> watches;
+    for (auto watch : api_state.watches_) {
+      if (!watch->snapshot_replayed_) {
+        watch->snapshot_replayed_ = true;
+        watches.push_back(watch);
+      }
+    }
+    if (watches.empty()) {
+      continue;
+    }
+    ENVOY_LOG(info, "Replaying the snapshot of {} at version {}", type_url,
+              api_state.snapshot_->version_info());
+    try {
+      std::vector<std::string> resource_names;
+      onResources(*api_state.snapshot_, watches, resource_names);
+    } catch (const EnvoyException& e) {
+      // The watches keep waiting for the management server.
+      ENVOY_LOG(warn, "Discarding the snapshot of {}: {}", type_url, e.what());
+      api_state.snapshot_.reset();
+    }
+  }
 }
 
 void GrpcMuxImpl::onWriteable() { drainRequests(); }
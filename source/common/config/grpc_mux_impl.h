@@ -2,12 +2,14 @@
 
 #include <queue>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/api/v2/discovery.pb.h"
 #include "envoy/common/time.h"
 #include "envoy/config/grpc_mux.h"
 #include "envoy/config/subscription.h"
 #include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/grpc/status.h"
 #include "envoy/service/discovery/v3/discovery.pb.h"
 #include "envoy/upstream/cluster_manager.h"
@@ -16,6 +18,7 @@
 #include "common/common/logger.h"
 #include "common/config/api_version.h"
 #include "common/config/grpc_stream.h"
+#include "common/config/snapshot_cache.h"
 #include "common/config/utility.h"
 
 namespace Envoy {
@@ -32,7 +35,8 @@ public:
               Event::Dispatcher& dispatcher, const Protobuf::MethodDescriptor& service_method,
               envoy::config::core::v3::ApiVersion transport_api_version,
               Runtime::RandomGenerator& random, Stats::Scope& scope,
-              const RateLimitSettings& rate_limit_settings, bool skip_subsequent_node);
+              const RateLimitSettings& rate_limit_settings, bool skip_subsequent_node,
+              SnapshotCachePtr snapshot_cache);
   ~GrpcMuxImpl() override = default;
 
   void start() override;
@@ -97,6 +101,8 @@ private:
     SubscriptionCallbacks& callbacks_;
     const std::string type_url_;
     GrpcMuxImpl& parent_;
+    // Was the snapshot of the type URL replayed to this watch?
+    bool snapshot_replayed_{};
 
   private:
     std::list<GrpcMuxWatchImpl*>& watches_;
@@ -114,8 +120,24 @@ private:
     bool pending_{};
     // Has this API been tracked in subscriptions_?
     bool subscribed_{};
+    // Response loaded from the snapshot cache, replayed to the watches until the management server
+    // responds.
+    std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse> snapshot_;
   };
 
+  // Delivers the resources of a response to the given watches of its type URL. Returns whether the
+  // watches request their resources by name, in which case the name of each resource of the
+  // response is appended to resource_names. Throws an EnvoyException if the response is invalid
+  // or rejected.
+  bool onResources(const envoy::service::discovery::v3::DiscoveryResponse& message,
+                   const std::list<GrpcMuxWatchImpl*>& watches,
+                   std::vector<std::string>& resource_names);
+  // Hands the loaded snapshot of a type URL whose resources are requested by name over to the
+  // snapshot cache, which merges the accepted responses into it.
+  void seedSnapshot(const std::string& type_url);
+  // Replays the loaded snapshots to the watches they were not replayed to yet.
+  void replaySnapshots();
+
   // Request queue management logic.
   void queueDiscoveryRequest(const std::string& queue_item);
   void clearRequestQueue();
@@ -135,6 +157,9 @@ private:
   // This string is a type URL.
   std::queue<std::string> request_queue_;
   const envoy::config::core::v3::ApiVersion transport_api_version_;
+  // Null unless the accepted responses are snapshotted.
+  const SnapshotCachePtr snapshot_cache_;
+  Event::TimerPtr snapshot_timer_;
 };
 
 class NullGrpcMuxImpl : public GrpcMux,
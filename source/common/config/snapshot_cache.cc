@@ -0,0 +1,256 @@
+#include "common/config/snapshot_cache.h"
+
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+#include "common/filesystem/file_shared_impl.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Config {
+
+namespace {
+
+// The length and the hash of the serialized response, following SnapshotCache::FileHeader.
+constexpr size_t ChecksumSize = 2 * sizeof(uint64_t);
+
+// Writes all of the data to the file, retrying on partial writes.
+Api::IoCallBoolResult writeAll(Filesystem::File& file, absl::string_view data) {
+  while (!data.empty()) {
+    Api::IoCallSizeResult result = file.write(data);
+    if (result.rc_ < 0) {
+      return {false, std::move(result.err_)};
+    }
+    data.remove_prefix(result.rc_);
+  }
+  return Filesystem::resultSuccess<bool>(true);
+}
+
+} // namespace
+
+SnapshotCache::SnapshotCache(const std::string& path, Api::Api& api) : path_(path), api_(api) {
+  if (!api_.fileSystem().directoryExists(path_)) {
+    throw EnvoyException(fmt::format("ADS snapshot path '{}' is not a directory", path_));
+  }
+  write_thread_ = api_.threadFactory().createThread([this]() -> void { writeThreadFunc(); });
+}
+
+SnapshotCache::~SnapshotCache() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    pending_event_.notifyOne();
+  }
+  write_thread_->join();
+}
+
+std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>
+SnapshotCache::load(const std::string& type_url) {
+  const std::string path = snapshotPath(type_url);
+  if (!api_.fileSystem().fileExists(path)) {
+    return nullptr;
+  }
+  std::string contents;
+  try {
+    contents = api_.fileSystem().fileReadToEnd(path);
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "Unable to read the snapshot of {}: {}", type_url, e.what());
+    return nullptr;
+  }
+  auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+  uint64_t length = 0;
+  uint64_t hash = 0;
+  absl::string_view serialized;
+  if (absl::StartsWith(contents, FileHeader) &&
+      contents.size() >= FileHeader.size() + ChecksumSize) {
+    ::memcpy(&length, contents.data() + FileHeader.size(), sizeof(length));
+    ::memcpy(&hash, contents.data() + FileHeader.size() + sizeof(length), sizeof(hash));
+    serialized = absl::string_view(contents).substr(FileHeader.size() + ChecksumSize);
+  }
+  if (serialized.size() != length || length == 0 || HashUtil::xxHash64(serialized) != hash ||
+      !response->ParseFromArray(serialized.data(), serialized.size()) ||
+      response->type_url() != type_url) {
+    ENVOY_LOG(warn, "Ignoring the invalid snapshot of {} at {}", type_url, path);
+    return nullptr;
+  }
+  ENVOY_LOG(info, "Loaded the snapshot of {} at version {}", type_url, response->version_info());
+  return response;
+}
+
+void SnapshotCache::store(
+    std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& response) {
+  const std::string type_url = response->type_url();
+  queue(type_url, {UpdateType::Store, std::move(response), {}, {}});
+}
+
+void SnapshotCache::merge(
+    std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& response,
+    std::vector<std::string>&& resource_names,
+    absl::flat_hash_set<std::string>&& subscribed_names) {
+  ASSERT(resource_names.size() == static_cast<size_t>(response->resources().size()));
+  const std::string type_url = response->type_url();
+  queue(type_url, {UpdateType::Merge, std::move(response), std::move(resource_names),
+                   std::move(subscribed_names)});
+}
+
+void SnapshotCache::seed(
+    std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& response,
+    std::vector<std::string>&& resource_names) {
+  ASSERT(resource_names.size() == static_cast<size_t>(response->resources().size()));
+  const std::string type_url = response->type_url();
+  queue(type_url, {UpdateType::Seed, std::move(response), std::move(resource_names), {}});
+}
+
+void SnapshotCache::queue(const std::string& type_url, Update&& update) {
+  Thread::LockGuard lock(lock_);
+  std::vector<Update>& updates = pending_[type_url];
+  if (update.type_ == UpdateType::Store) {
+    // The response replaces whatever is pending.
+    updates.clear();
+  }
+  updates.push_back(std::move(update));
+  pending_event_.notifyOne();
+}
+
+void SnapshotCache::flush() {
+  Thread::LockGuard lock(lock_);
+  while (!pending_.empty() || writing_) {
+    written_event_.wait(lock_);
+  }
+}
+
+std::string SnapshotCache::snapshotPath(absl::string_view type_url) const {
+  // Type URLs are of the form type.googleapis.com/<message name>, and the message name is enough
+  // to tell them apart.
+  const size_t pos = type_url.rfind('/');
+  if (pos != absl::string_view::npos) {
+    type_url.remove_prefix(pos + 1);
+  }
+  return absl::StrCat(path_, "/", type_url, ".snapshot");
+}
+
+void SnapshotCache::apply(const std::string& type_url, std::vector<Update>& updates) {
+  bool changed = false;
+  for (Update& update : updates) {
+    if (update.type_ == UpdateType::Store) {
+      merged_.erase(type_url);
+      write(*update.response_);
+      continue;
+    }
+    if (update.type_ == UpdateType::Seed && merged_.contains(type_url)) {
+      continue;
+    }
+
+    MergedSnapshot& merged = merged_[type_url];
+    merged.version_info_ = update.response_->version_info();
+    for (int i = 0; i < update.response_->resources().size(); i++) {
+      merged.resources_[update.resource_names_[i]].Swap(
+          update.response_->mutable_resources(i));
+    }
+    if (update.type_ == UpdateType::Merge) {
+      for (auto it = merged.resources_.begin(); it != merged.resources_.end();) {
+        if (update.subscribed_names_.contains(it->first)) {
+          ++it;
+        } else {
+          it = merged.resources_.erase(it);
+        }
+      }
+      changed = true;
+    }
+  }
+  if (!changed) {
+    return;
+  }
+
+  const MergedSnapshot& merged = merged_[type_url];
+  envoy::service::discovery::v3::DiscoveryResponse response;
+  response.set_type_url(type_url);
+  response.set_version_info(merged.version_info_);
+  for (const auto& resource : merged.resources_) {
+    response.add_resources()->CopyFrom(resource.second);
+  }
+  write(response);
+}
+
+void SnapshotCache::write(const envoy::service::discovery::v3::DiscoveryResponse& response) {
+  // The snapshot is written next to the file it replaces, synced, and then renamed over it, so
+  // that a crash midway leaves either snapshot in place rather than a partially written one.
+  const std::string path = snapshotPath(response.type_url());
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  const std::string serialized = response.SerializeAsString();
+  const uint64_t length = serialized.size();
+  const uint64_t hash = HashUtil::xxHash64(serialized);
+  char checksum[ChecksumSize];
+  ::memcpy(checksum, &length, sizeof(length));
+  ::memcpy(checksum + sizeof(length), &hash, sizeof(hash));
+
+  Filesystem::FilePtr file = api_.fileSystem().createFile(temp_path);
+  const Api::IoCallBoolResult open_result = file->open(
+      (1 << Filesystem::File::Operation::Write) | (1 << Filesystem::File::Operation::Create) |
+      (1 << Filesystem::File::Operation::Truncate));
+  if (!open_result.rc_) {
+    ENVOY_LOG(warn, "Unable to open {} for the snapshot of {}: {}", temp_path, response.type_url(),
+              open_result.err_->getErrorDetails());
+    return;
+  }
+  Api::IoCallBoolResult write_result = writeAll(*file, FileHeader);
+  if (write_result.rc_) {
+    write_result = writeAll(*file, absl::string_view(checksum, ChecksumSize));
+  }
+  if (write_result.rc_) {
+    write_result = writeAll(*file, serialized);
+  }
+  if (write_result.rc_) {
+    write_result = file->sync();
+  }
+  file->close();
+  if (!write_result.rc_) {
+    ENVOY_LOG(warn, "Unable to write the snapshot of {} to {}: {}", response.type_url(),
+              temp_path, write_result.err_->getErrorDetails());
+    return;
+  }
+  const Api::IoCallBoolResult rename_result = api_.fileSystem().rename(temp_path, path);
+  if (!rename_result.rc_) {
+    ENVOY_LOG(warn, "Unable to rename the snapshot of {} to {}: {}", response.type_url(), path,
+              rename_result.err_->getErrorDetails());
+    return;
+  }
+  ENVOY_LOG(debug, "Wrote the snapshot of {} at version {}", response.type_url(),
+            response.version_info());
+}
+
+void SnapshotCache::writeThreadFunc() {
+  while (true) {
+    absl::flat_hash_map<std::string, std::vector<Update>> updates;
+    {
+      Thread::LockGuard lock(lock_);
+      while (pending_.empty() && !exit_) {
+        pending_event_.wait(lock_);
+      }
+      if (pending_.empty()) {
+        ASSERT(exit_);
+        return;
+      }
+      updates.swap(pending_);
+      writing_ = true;
+    }
+
+    for (auto& type_updates : updates) {
+      apply(type_updates.first, type_updates.second);
+    }
+
+    {
+      Thread::LockGuard lock(lock_);
+      writing_ = false;
+      written_event_.notifyAll();
+    }
+  }
+}
+
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/protobuf/protobuf.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Config {
+
+class SnapshotCache;
+using SnapshotCachePtr = std::unique_ptr<SnapshotCache>;
+
+/**
+ * On-disk snapshot of the accepted DiscoveryResponses of each type URL, from which a GrpcMuxImpl
+ * boots before the management server responds. The snapshot of a type URL whose responses hold all
+ * of its resources (e.g. CDS and LDS) is the last response, while the snapshot of a type URL whose
+ * resources are requested by name (e.g. EDS and RDS) merges the responses per resource name.
+ * Snapshots are written to a file per type URL by a dedicated thread, so that the main thread
+ * never waits on their serialization nor on the disk.
+ */
+class SnapshotCache : Logger::Loggable<Logger::Id::config> {
+public:
+  /**
+   * @param path is the directory holding the snapshot files, which must exist.
+   * @param api supplies the file system and the thread factory.
+   */
+  SnapshotCache(const std::string& path, Api::Api& api);
+  // Writes the responses still pending before returning.
+  ~SnapshotCache();
+
+  /**
+   * Reads the snapshot of a type URL.
+   * @param type_url is the type URL of the snapshot.
+   * @return the response last stored for the type URL, or nullptr if there is none or it cannot be
+   *         read.
+   */
+  std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>
+  load(const std::string& type_url);
+
+  /**
+   * Queues a response to be written as the snapshot of its type URL. The response replaces the
+   * snapshot, and any response of the same type URL which is still waiting to be written.
+   * @param response is the accepted response.
+   */
+  void store(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& response);
+
+  /**
+   * Queues a response to be merged into the snapshot of its type URL. Its resources replace the
+   * resources of the snapshot with the same names, and the resources which are not subscribed to
+   * anymore are dropped from the snapshot.
+   * @param response is the accepted response.
+   * @param resource_names supplies the name of each resource of the response, in order.
+   * @param subscribed_names supplies the names of the resources still subscribed to.
+   */
+  void merge(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& response,
+             std::vector<std::string>&& resource_names,
+             absl::flat_hash_set<std::string>&& subscribed_names);
+
+  /**
+   * Sets the resources which responses merged into the snapshot of a type URL are merged with,
+   * unless a response was merged already. This is the loaded snapshot, which is on disk already.
+   * @param response is the loaded snapshot.
+   * @param resource_names supplies the name of each resource of the snapshot, in order.
+   */
+  void seed(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& response,
+            std::vector<std::string>&& resource_names);
+
+  /**
+   * Blocks until all the responses stored so far are written.
+   */
+  void flush();
+
+  // The header which starts every snapshot file, so that files of an incompatible layout are
+  // ignored rather than misread. It is followed by the length and the xxHash64 of the serialized
+  // response, both 64-bit in native byte order, so that a truncated or corrupted file is ignored
+  // too.
+  static constexpr absl::string_view FileHeader = "envoy xds snapshot v2\n";
+
+private:
+  enum class UpdateType { Store, Merge, Seed };
+
+  struct Update {
+    UpdateType type_;
+    std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse> response_;
+    std::vector<std::string> resource_names_;
+    absl::flat_hash_set<std::string> subscribed_names_;
+  };
+
+  // The resources of a type URL whose responses are merged, by name.
+  struct MergedSnapshot {
+    std::string version_info_;
+    std::map<std::string, ProtobufWkt::Any> resources_;
+  };
+
+  void queue(const std::string& type_url, Update&& update);
+  std::string snapshotPath(absl::string_view type_url) const;
+  // Applies the updates of a type URL, and writes the resulting snapshot if it changed.
+  void apply(const std::string& type_url, std::vector<Update>& updates);
+  void write(const envoy::service::discovery::v3::DiscoveryResponse& response);
+  void writeThreadFunc();
+
+  const std::string path_;
+  Api::Api& api_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar pending_event_;
+  Thread::CondVar written_event_;
+  // The updates waiting for the write thread, in order, by type URL.
+  absl::flat_hash_map<std::string, std::vector<Update>> pending_ ABSL_GUARDED_BY(lock_);
+  // Only accessed by the write thread.
+  absl::flat_hash_map<std::string, MergedSnapshot> merged_;
+  bool writing_ ABSL_GUARDED_BY(lock_){};
+  bool exit_ ABSL_GUARDED_BY(lock_){};
+  Thread::ThreadPtr write_thread_;
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -60,7 +60,7 @@ SubscriptionPtr SubscriptionFactoryImpl::subscriptionFromConfigSource(
                   ->create(),
               dispatcher_, sotwGrpcMethod(type_url), api_config_source.transport_api_version(),
               random_, scope, Utility::parseRateLimitSettings(api_config_source),
-              api_config_source.set_node_on_first_message_only()),
+              api_config_source.set_node_on_first_message_only(), nullptr),
           callbacks, stats, type_url, dispatcher_, Utility::configSourceInitialFetchTimeout(config),
           /*is_aggregated*/ false);
     case envoy::config::core::v3::ApiConfigSource::DELTA_GRPC: {
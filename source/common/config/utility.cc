@@ -35,6 +35,30 @@ std::string Utility::truncateGrpcStatusMessage(absl::string_view error_message)
                      error_message.length() > kProtobufErrMsgLen ? "...(truncated)" : "");
 }
 
+std::string Utility::resourceNameFromAny(const ProtobufWkt::Any& resource,
+                                         int name_field_number) {
+  using Protobuf::internal::WireFormatLite;
+  Protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t*>(resource.value().data()),
+                                       resource.value().size());
+  std::string name;
+  // As when parsing, the last occurrence of the field wins.
+  while (const uint32_t tag = input.ReadTag()) {
+    if (WireFormatLite::GetTagFieldNumber(tag) == name_field_number &&
+        WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      if (!WireFormatLite::ReadString(&input, &name)) {
+        break;
+      }
+    } else if (!WireFormatLite::SkipField(&input, tag)) {
+      break;
+    }
+  }
+  if (!input.ConsumedEntireMessage()) {
+    throw EnvoyException(
+        fmt::format("Unable to read the name of a {} resource", resource.type_url()));
+  }
+  return name;
+}
+
 void Utility::translateApiConfigSource(
     const std::string& cluster, uint32_t refresh_delay_ms, const std::string& api_type,
     envoy::config::core::v3::ApiConfigSource& api_config_source) {
@@ -302,6 +302,19 @@ public:
    */
   static std::string truncateGrpcStatusMessage(absl::string_view error_message);
 
+  /**
+   * Reads the name of an xDS resource from its serialized form, skipping over the rest of the
+   * resource rather than unpacking it. This is meant for subscriptions to look up the resources
+   * of large updates by name before unpacking them.
+   * @param resource supplies the resource.
+   * @param name_field_number supplies the number of the top level string field which holds the
+   *        name in every version of the resource type.
+   * @return std::string the name, or an empty string if the resource has none.
+   * @throw EnvoyException if the resource is malformed.
+   */
+  static std::string resourceNameFromAny(const ProtobufWkt::Any& resource,
+                                         int name_field_number);
+
   /**
    * Create TagProducer instance. Check all tag names for conflicts to avoid
    * unexpected tag name overwriting.
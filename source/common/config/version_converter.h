@@ -43,6 +43,19 @@ public:
    */
   static void upgrade(const Protobuf::Message& prev_message, Protobuf::Message& next_message);
 
+  /**
+   * Track the original type of a message parsed from the wire format of an
+   * earlier version of its type, as upgrade() does, to support
+   * recoverOriginal(). Since upgrading is a wire-level reinterpretation, this
+   * allows the wire input of an earlier version to be parsed directly into
+   * the later version, without materializing the earlier version message.
+   *
+   * @param prev_descriptor descriptor of the earlier version of the message.
+   * @param next_message next version message parsed from the earlier version.
+   */
+  static void annotateWithOriginalType(const Protobuf::Descriptor& prev_descriptor,
+                                       Protobuf::Message& next_message);
+
   /**
    * Downgrade a message to the previous version. If no previous version exists,
    * the given message is copied in the return value. This is not super
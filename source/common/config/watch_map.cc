@@ -58,6 +58,16 @@ void WatchMap::onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>
   if (watches_.empty()) {
     return;
   }
+  if (watches_.size() == 1 && wildcard_watches_.size() == 1) {
+    // A single, wildcard watch (i.e. Cluster or Listener) is interested in every resource, so the
+    // update, typically the largest there is, is handed to it as is rather than copied. Its
+    // onConfigUpdate is always called, even if just a no-op, to properly maintain
+    // state-of-the-world semantics and the update_empty stat.
+    Watch* watch = *watches_.begin();
+    watch->callbacks_.onConfigUpdate(resources, version_info);
+    watch->state_of_the_world_empty_ = resources.empty();
+    return;
+  }
   SubscriptionCallbacks& name_getter = (*watches_.begin())->callbacks_;
 
   // Build a map from watches, to the set of updated resources that each watch cares about. Each
@@ -72,19 +82,15 @@ void WatchMap::onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>
     }
   }
 
-  const bool map_is_single_wildcard = (watches_.size() == 1 && wildcard_watches_.size() == 1);
   // We just bundled up the updates into nice per-watch packages. Now, deliver them.
   for (auto& watch : watches_) {
     const auto this_watch_updates = per_watch_updates.find(watch);
     if (this_watch_updates == per_watch_updates.end()) {
       // This update included no resources this watch cares about.
-      // 1) If there is only a single, wildcard watch (i.e. Cluster or Listener), always call
-      //    its onConfigUpdate even if just a no-op, to properly maintain state-of-the-world
-      //    semantics and the update_empty stat.
-      // 2) If this watch previously had some resources, it means this update is removing all
+      // 1) If this watch previously had some resources, it means this update is removing all
       //    of this watch's resources, so the watch must be informed with an onConfigUpdate.
-      // 3) Otherwise, we can skip onConfigUpdate for this watch.
-      if (map_is_single_wildcard || !watch->state_of_the_world_empty_) {
+      // 2) Otherwise, we can skip onConfigUpdate for this watch.
+      if (!watch->state_of_the_world_empty_) {
         watch->callbacks_.onConfigUpdate({}, version_info);
         watch->state_of_the_world_empty_ = true;
       }
@@ -11,7 +11,6 @@
 #include "envoy/network/listener.h"
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/libevent_scheduler.h"
@@ -22,7 +21,9 @@
 #include "common/network/dns_impl.h"
 #include "common/network/listener_impl.h"
 #include "common/network/udp_listener_impl.h"
+#include "common/profiler/sampling_profiler.h"
 
+#include "absl/types/optional.h"
 #include "event2/event.h"
 
 #ifdef ENVOY_HANDLE_SIGNALS
@@ -180,14 +181,10 @@ SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
-  }
-
-  if (do_post) {
+  // Only the first post since the callbacks were last run wakes the event loop up. Activating the
+  // timer from another thread takes the lock of the event base and notifies it through its own
+  // eventfd, so the later posts only push to the queue until the callbacks run.
+  if (post_queue_.push(std::move(callback))) {
     post_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 }
@@ -200,6 +197,14 @@ void DispatcherImpl::run(RunType type) {
   // not guarantee that events are run in any particular order. So even if we post() and call
   // event_base_once() before some other event, the other event might get called first.
   runPostCallbacks();
+  // Sample the thread while it runs the event loop, tagging samples with the tracked object. A
+  // blocking run is the event loop of a dispatcher thread, which runs once for the lifetime of the
+  // thread and is registered so that a profiler started later samples it. Non-blocking runs are
+  // short, and only registered while the profiler runs, so that they don't pay for it otherwise.
+  absl::optional<Profiler::SamplingProfiler::ThreadRegistration> profiler_registration;
+  if (type != RunType::NonBlock || Profiler::SamplingProfiler::isRunning()) {
+    profiler_registration.emplace(name_, current_object_);
+  }
   base_scheduler_.run(type);
 }
 
@@ -214,22 +219,10 @@ void DispatcherImpl::updateApproximateMonotonicTimeInternal() {
 }
 
 void DispatcherImpl::runPostCallbacks() {
-  while (true) {
-    // It is important that this declaration is inside the body of the loop so that the callback is
-    // destructed while post_lock_ is not held. If callback is declared outside the loop and reused
-    // for each iteration, the previous iteration's callback is destructed when callback is
-    // re-assigned, which happens while holding the lock. This can lead to a deadlock (via
-    // recursive mutex acquisition) if destroying the callback runs a destructor, which through some
-    // callstack calls post() on this dispatcher.
-    std::function<void()> callback;
-    {
-      Thread::LockGuard lock(post_lock_);
-      if (post_callbacks_.empty()) {
-        return;
-      }
-      callback = post_callbacks_.front();
-      post_callbacks_.pop_front();
-    }
+  // Rearm before popping, so that a callback posted from now on, including by the callbacks run
+  // here, wakes the event loop up again if it isn't popped by this run.
+  post_queue_.rearm();
+  while (PostCb callback = post_queue_.pop()) {
     callback();
   }
 }
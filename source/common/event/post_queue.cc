@@ -0,0 +1,66 @@
+#include "common/event/post_queue.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Event {
+
+PostQueue::PostQueue() : back_(&stub_), front_(&stub_) {}
+
+PostQueue::~PostQueue() {
+  // Callbacks which never ran are destroyed with the queue.
+  while (pop()) {
+  }
+}
+
+bool PostQueue::push(PostCb callback) {
+  // An empty callback would read as an empty queue when popped.
+  ASSERT(callback);
+  pushNode(*new Node(std::move(callback)));
+  // The node is linked before the flag is set, so a pop after rearm() either finds the node, or
+  // this push sees the rearmed flag and asks for another wakeup.
+  return !wakeup_pending_.exchange(true, std::memory_order_acq_rel);
+}
+
+void PostQueue::rearm() { wakeup_pending_.exchange(false, std::memory_order_acq_rel); }
+
+void PostQueue::pushNode(Node& node) {
+  node.next_.store(nullptr, std::memory_order_relaxed);
+  Node* previous = back_.exchange(&node, std::memory_order_acq_rel);
+  // Until this store, the node is pushed but not reachable from the front of the queue.
+  previous->next_.store(&node, std::memory_order_release);
+}
+
+PostCb PostQueue::pop() {
+  Node* front = front_;
+  Node* next = front->next_.load(std::memory_order_acquire);
+  if (front == &stub_) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+    front_ = next;
+    front = next;
+    next = next->next_.load(std::memory_order_acquire);
+  }
+
+  if (next == nullptr) {
+    // The front node is the last reachable one. Popping it would leave nothing to push after, so
+    // push the stub node first, unless a producer is already pushing after the front node.
+    if (front != back_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    pushNode(stub_);
+    next = front->next_.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return nullptr;
+    }
+  }
+
+  front_ = next;
+  PostCb callback = std::move(front->callback_);
+  delete front;
+  return callback;
+}
+
+} // namespace Event
+} // namespace Envoy
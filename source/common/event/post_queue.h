@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Lock-free queue of the callbacks posted to a dispatcher, which any thread may push to and only
+ * the thread of the dispatcher pops from. The callbacks are held by nodes linked through a pointer
+ * of their own, so that pushing is a single exchange on the back of the queue rather than a
+ * contended lock, and callbacks are moved in and out of the queue rather than copied.
+ *
+ * Pushing tells whether the dispatcher needs to be woken up, so that the posts made while the
+ * dispatcher is busy are batched into a single wakeup.
+ */
+class PostQueue : NonCopyable {
+public:
+  PostQueue();
+  ~PostQueue();
+
+  /**
+   * Pushes a callback. Thread safe.
+   * @return whether the dispatcher must be woken up to pop the callback, i.e. whether this is the
+   *         first push since popping was last rearmed.
+   */
+  bool push(PostCb callback);
+
+  /**
+   * Rearms the wakeup before popping, so that the next push from then on asks for a wakeup again.
+   * Must only be called from the thread which pops.
+   */
+  void rearm();
+
+  /**
+   * Pops the callback at the front of the queue. Must only be called from the thread which pops.
+   * @return the callback, or an empty callback if the queue is empty, or if the front callback is
+   *         still being pushed, in which case its push asks for a wakeup.
+   */
+  PostCb pop();
+
+private:
+  struct Node {
+    Node() = default;
+    explicit Node(PostCb&& callback) : callback_(std::move(callback)) {}
+
+    std::atomic<Node*> next_{};
+    PostCb callback_;
+  };
+
+  void pushNode(Node& node);
+
+  // The stub node is in the queue whenever it would be empty, so that the front and back of the
+  // queue always point to a node, and is pushed again whenever the last node is popped.
+  Node stub_;
+  // The last pushed node, which producers exchange to push.
+  std::atomic<Node*> back_;
+  // The next node to pop, which is only accessed by the thread which pops.
+  Node* front_;
+  std::atomic<bool> wakeup_pending_{};
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -23,6 +23,12 @@ Api::IoCallSizeResult FileSharedImpl::write(absl::string_view buffer) {
   return rc != -1 ? resultSuccess<ssize_t>(rc) : resultFailure<ssize_t>(rc, errno);
 };
 
+Api::IoCallBoolResult FileSharedImpl::sync() {
+  ASSERT(isOpen());
+
+  return syncFile() ? resultSuccess<bool>(true) : resultFailure<bool>(false, errno);
+}
+
 Api::IoCallBoolResult FileSharedImpl::close() {
   ASSERT(isOpen());
 
@@ -3,6 +3,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -46,6 +47,10 @@ FileImplPosix::FlagsAndMode FileImplPosix::translateFlag(FlagSet in) {
     mode |= S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
   }
 
+  if (in.test(File::Operation::Truncate)) {
+    out |= O_TRUNC;
+  }
+
   if (in.test(File::Operation::Append)) {
     out |= O_APPEND;
   }
@@ -61,6 +66,8 @@ FileImplPosix::FlagsAndMode FileImplPosix::translateFlag(FlagSet in) {
   return {out, mode};
 }
 
+bool FileImplPosix::syncFile() { return ::fsync(fd_) == 0; }
+
 bool FileImplPosix::closeFile() { return ::close(fd_) != -1; }
 
 FilePtr InstanceImplPosix::createFile(const std::string& path) {
@@ -108,6 +115,12 @@ std::string InstanceImplPosix::fileReadToEnd(const std::string& path) {
   return file_string.str();
 }
 
+Api::IoCallBoolResult InstanceImplPosix::rename(const std::string& old_path,
+                                                const std::string& new_path) {
+  return ::rename(old_path.c_str(), new_path.c_str()) == 0 ? resultSuccess<bool>(true)
+                                                           : resultFailure<bool>(false, errno);
+}
+
 PathSplitResult InstanceImplPosix::splitPathFromFilename(absl::string_view path) {
   size_t last_slash = path.rfind('/');
   if (last_slash == std::string::npos) {
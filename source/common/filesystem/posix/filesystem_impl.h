@@ -25,6 +25,7 @@ protected:
   FlagsAndMode translateFlag(FlagSet in);
   void openFile(FlagSet flags) override;
   ssize_t writeFile(absl::string_view buffer) override;
+  bool syncFile() override;
   bool closeFile() override;
 
 private:
@@ -39,6 +40,7 @@ public:
   bool directoryExists(const std::string& path) override;
   ssize_t fileSize(const std::string& path) override;
   std::string fileReadToEnd(const std::string& path) override;
+  Api::IoCallBoolResult rename(const std::string& old_path, const std::string& new_path) override;
   PathSplitResult splitPathFromFilename(absl::string_view path) override;
   bool illegalPath(const std::string& path) override;
 
@@ -42,6 +42,10 @@ FileImplWin32::FlagsAndMode FileImplWin32::translateFlag(FlagSet in) {
     pmode |= _S_IREAD | _S_IWRITE;
   }
 
+  if (in.test(File::Operation::Truncate)) {
+    out |= _O_TRUNC;
+  }
+
   if (in.test(File::Operation::Append)) {
     out |= _O_APPEND;
   }
@@ -57,6 +61,8 @@ FileImplWin32::FlagsAndMode FileImplWin32::translateFlag(FlagSet in) {
   return {out, pmode};
 }
 
+bool FileImplWin32::syncFile() { return ::_commit(fd_) == 0; }
+
 bool FileImplWin32::closeFile() { return ::_close(fd_) != -1; }
 
 FilePtr InstanceImplWin32::createFile(const std::string& path) {
@@ -104,6 +110,14 @@ std::string InstanceImplWin32::fileReadToEnd(const std::string& path) {
   return file_string.str();
 }
 
+Api::IoCallBoolResult InstanceImplWin32::rename(const std::string& old_path,
+                                                const std::string& new_path) {
+  // Unlike POSIX rename(), the CRT rename() fails when the new path exists.
+  return ::MoveFileEx(old_path.c_str(), new_path.c_str(), MOVEFILE_REPLACE_EXISTING)
+             ? resultSuccess<bool>(true)
+             : resultFailure<bool>(false, ::GetLastError());
+}
+
 PathSplitResult InstanceImplWin32::splitPathFromFilename(absl::string_view path) {
   size_t last_slash = path.find_last_of(":/\\");
   if (last_slash == std::string::npos) {
@@ -37,6 +37,10 @@ InlineHeaderVector& get_in_vec(VariantHeader& buffer) {
 const InlineHeaderVector& get_in_vec(const VariantHeader& buffer) {
   return absl::get<InlineHeaderVector>(buffer);
 }
+
+const SharedHeaderString& get_shared(const VariantHeader& buffer) {
+  return absl::get<SharedHeaderString>(buffer);
+}
 } // namespace
 
 // Initialize as a Type::Inline
@@ -69,10 +73,13 @@ void HeaderString::append(const char* data, uint32_t data_size) {
   ASSERT(validHeaderString(absl::string_view(data, data_size)));
 
   switch (type()) {
-  case Type::Reference: {
+  case Type::Reference:
+  case Type::Shared: {
     // Rather than be too clever and optimize this uncommon case, we switch to
     // Inline mode and copy.
-    const absl::string_view prev = get_str_view(buffer_);
+    const SharedHeaderString shared =
+        type() == Type::Shared ? get_shared(buffer_) : SharedHeaderString();
+    const absl::string_view prev = getStringView();
     buffer_ = InlineHeaderVector();
     // Assigning new_capacity to avoid resizing when appending the new data
     get_in_vec(buffer_).reserve(new_capacity);
@@ -100,6 +107,9 @@ absl::string_view HeaderString::getStringView() const {
   if (type() == Type::Reference) {
     return get_str_view(buffer_);
   }
+  if (type() == Type::Shared) {
+    return *get_shared(buffer_);
+  }
   ASSERT(type() == Type::Inline);
   return {get_in_vec(buffer_).data(), get_in_vec(buffer_).size()};
 }
@@ -107,6 +117,8 @@ absl::string_view HeaderString::getStringView() const {
 void HeaderString::clear() {
   if (type() == Type::Inline) {
     get_in_vec(buffer_).clear();
+  } else if (type() == Type::Shared) {
+    buffer_ = InlineHeaderVector();
   }
 }
 
@@ -114,7 +126,7 @@ void HeaderString::setCopy(const char* data, uint32_t size) {
   ASSERT(validHeaderString(absl::string_view(data, size)));
 
   if (!absl::holds_alternative<InlineHeaderVector>(buffer_)) {
-    // Switching from Type::Reference to Type::Inline
+    // Switching from Type::Reference or Type::Shared to Type::Inline
     buffer_ = InlineHeaderVector();
   }
 
@@ -137,8 +149,8 @@ void HeaderString::setInteger(uint64_t value) {
   char inner_buffer[MaxIntegerLength];
   const uint32_t int_length = StringUtil::itoa(inner_buffer, MaxIntegerLength, value);
 
-  if (type() == Type::Reference) {
-    // Switching from Type::Reference to Type::Inline
+  if (type() != Type::Inline) {
+    // Switching from Type::Reference or Type::Shared to Type::Inline
     buffer_ = InlineHeaderVector();
   }
   ASSERT((get_in_vec(buffer_).capacity()) > MaxIntegerLength);
@@ -150,22 +162,33 @@ void HeaderString::setReference(absl::string_view ref_value) {
   ASSERT(valid());
 }
 
+void HeaderString::setShared(SharedHeaderString shared_value) {
+  ASSERT(shared_value != nullptr);
+  buffer_ = std::move(shared_value);
+  ASSERT(valid());
+}
+
 uint32_t HeaderString::size() const {
   if (type() == Type::Reference) {
     return get_str_view(buffer_).size();
   }
+  if (type() == Type::Shared) {
+    return get_shared(buffer_)->size();
+  }
   ASSERT(type() == Type::Inline);
   return get_in_vec(buffer_).size();
 }
 
 HeaderString::Type HeaderString::type() const {
-  // buffer_.index() is correlated with the order of Reference and Inline in the
+  // buffer_.index() is correlated with the order of Reference, Inline and Shared in the
   // enum.
-  ASSERT(buffer_.index() == 0 || buffer_.index() == 1);
+  ASSERT(buffer_.index() <= 2);
   ASSERT((buffer_.index() == 0 && absl::holds_alternative<absl::string_view>(buffer_)) ||
          (buffer_.index() != 0));
   ASSERT((buffer_.index() == 1 && absl::holds_alternative<InlineHeaderVector>(buffer_)) ||
          (buffer_.index() != 1));
+  ASSERT((buffer_.index() == 2 && absl::holds_alternative<SharedHeaderString>(buffer_)) ||
+         (buffer_.index() != 2));
   return Type(buffer_.index());
 }
 
@@ -327,7 +327,8 @@ ssize_t ConnectionImpl::StreamImpl::onDataSourceRead(uint64_t length, uint32_t*
     return NGHTTP2_ERR_DEFERRED;
   } else {
     *data_flags |= NGHTTP2_DATA_FLAG_NO_COPY;
-    if (local_end_stream_ && pending_send_data_.length() <= length) {
+    const uint64_t frame_length = dataFrameLength(length);
+    if (local_end_stream_ && pending_send_data_.length() == frame_length) {
       *data_flags |= NGHTTP2_DATA_FLAG_EOF;
       if (pending_trailers_to_encode_) {
         // We need to tell the library to not set end stream so that we can emit the trailers.
@@ -337,10 +338,34 @@ ssize_t ConnectionImpl::StreamImpl::onDataSourceRead(uint64_t length, uint32_t*
       }
     }
 
-    return std::min(length, pending_send_data_.length());
+    return frame_length;
   }
 }
 
+uint64_t ConnectionImpl::StreamImpl::dataFrameLength(uint64_t length) {
+  if (pending_send_data_.length() <= length) {
+    return pending_send_data_.length();
+  }
+
+  // onDataSourceSend() moves whole slices of the pending data into the output without copying, but
+  // has to copy the part of a slice which ends up in a DATA frame when the frame ends in the middle
+  // of the slice. So end the frame on the last slice boundary it can hold instead, unless that
+  // would leave the frame less than half full, as smaller frames cost more frame headers and count
+  // towards the outbound frame limits.
+  static const uint64_t MAX_DATA_FRAME_SLICES = 16;
+  uint64_t whole_slices_length = 0;
+  for (const Buffer::RawSlice& slice : pending_send_data_.getRawSlices(MAX_DATA_FRAME_SLICES)) {
+    if (whole_slices_length + slice.len_ > length) {
+      break;
+    }
+    whole_slices_length += slice.len_;
+  }
+  if (whole_slices_length == 0 || whole_slices_length < length / 2) {
+    return length;
+  }
+  return whole_slices_length;
+}
+
 int ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t length) {
   // In this callback we are writing out a raw DATA frame without copying. nghttp2 assumes that we
   // "just know" that the frame header is 9 bytes.
@@ -1020,13 +1045,13 @@ ConnectionImpl::Http2Callbacks::Http2Callbacks() {
       callbacks_,
       [](nghttp2_session*, const nghttp2_frame* frame, const uint8_t* raw_name, size_t name_length,
          const uint8_t* raw_value, size_t value_length, uint8_t, void* user_data) -> int {
-        // TODO PERF: Can reference count here to avoid copies.
+        ConnectionImpl* connection = static_cast<ConnectionImpl*>(user_data);
         HeaderString name;
         name.setCopy(reinterpret_cast<const char*>(raw_name), name_length);
         HeaderString value;
-        value.setCopy(reinterpret_cast<const char*>(raw_value), value_length);
-        return static_cast<ConnectionImpl*>(user_data)->onHeader(frame, std::move(name),
-                                                                 std::move(value));
+        connection->header_value_cache_.setValue(
+            value, absl::string_view(reinterpret_cast<const char*>(raw_value), value_length));
+        return connection->onHeader(frame, std::move(name), std::move(value));
       });
 
   nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
@@ -19,6 +19,7 @@
 #include "common/common/logger.h"
 #include "common/http/codec_helper.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http2/header_value_cache.h"
 #include "common/http/http2/metadata_decoder.h"
 #include "common/http/http2/metadata_encoder.h"
 #include "common/http/utility.h"
@@ -187,6 +188,7 @@ protected:
 
     StreamImpl* base() { return this; }
     ssize_t onDataSourceRead(uint64_t length, uint32_t* data_flags);
+    uint64_t dataFrameLength(uint64_t length);
     int onDataSourceSend(const uint8_t* framehd, size_t length);
     void resetStreamWorker(StreamResetReason reason);
     static void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
@@ -397,6 +399,8 @@ protected:
 
   std::list<StreamImplPtr> active_streams_;
   nghttp2_session* session_{};
+  // Shares the long header values repeated across the streams of the connection.
+  HeaderValueCache header_value_cache_;
   CodecStats stats_;
   Network::Connection& connection_;
   const uint32_t max_headers_kb_;
@@ -0,0 +1,31 @@
+#include "common/http/http2/header_value_cache.h"
+
+#include <memory>
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+void HeaderValueCache::setValue(HeaderString& header_string, absl::string_view value) {
+  static const uint64_t inline_capacity = InlineHeaderVector().capacity();
+  if (value.size() <= inline_capacity || value.size() > MaxValueSize) {
+    header_string.setCopy(value);
+    return;
+  }
+
+  auto it = values_.find(value);
+  if (it == values_.end()) {
+    if (cache_size_ + value.size() > MaxCacheSize) {
+      values_.clear();
+      cache_size_ = 0;
+    }
+    auto shared = std::make_shared<const std::string>(value);
+    it = values_.emplace(*shared, std::move(shared)).first;
+    cache_size_ += value.size();
+  }
+  header_string.setShared(it->second);
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
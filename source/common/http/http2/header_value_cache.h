@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/http/header_map.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * Cache of the header values decoded on an HTTP/2 connection, so that a value repeated by every
+ * request or response of the connection, such as an authorization token or a user agent, is shared
+ * by their header maps rather than copied into each of them.
+ *
+ * Only values too long to be held inline by a HeaderString are cached, as copying shorter ones
+ * costs less than looking them up. The cache is emptied once it holds more than its maximum size,
+ * so that values which don't repeat can't keep it full.
+ */
+class HeaderValueCache {
+public:
+  // The longest value cached, so that a few large values can't take the whole cache.
+  static constexpr uint64_t MaxValueSize = 4096;
+  // The size of the values cached, past which the cache is emptied.
+  static constexpr uint64_t MaxCacheSize = 16384;
+
+  /**
+   * Sets a header string to a value, shared with the header strings previously set to the same
+   * value when it is cached.
+   * @param header_string supplies the header string to set.
+   * @param value supplies the value, which is copied if it isn't cached.
+   */
+  void setValue(HeaderString& header_string, absl::string_view value);
+
+  /**
+   * @return the number of values cached.
+   */
+  uint64_t size() const { return values_.size(); }
+
+private:
+  // The keys refer to the cached strings, which don't move.
+  absl::flat_hash_map<absl::string_view, SharedHeaderString> values_;
+  uint64_t cache_size_{};
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -333,6 +333,10 @@ void ConnectionImpl::readDisable(bool disable) {
       // If readDisable is called on a closed connection, do not crash.
       return;
     }
+    if (raw_io_callbacks_ != nullptr) {
+      // The socket is watched on behalf of the raw I/O callbacks regardless.
+      return;
+    }
 
     // If half-close semantics are enabled, we never want early close notifications; we
     // always want to read all available data, even if the other side has closed.
@@ -353,6 +357,10 @@ void ConnectionImpl::readDisable(bool disable) {
       // If readDisable is called on a closed connection, do not crash.
       return;
     }
+    if (raw_io_callbacks_ != nullptr) {
+      // The socket is read by the owner of the raw I/O callbacks.
+      return;
+    }
 
     // We never ask for both early close and read at the same time. If we are reading, we want to
     // consume all available data.
@@ -522,7 +530,13 @@ void ConnectionImpl::onFileEvent(uint32_t events) {
 
   // It's possible for a write event callback to close the socket (which will cause fd_ to be -1).
   // In this case ignore write event processing.
-  if (ioHandle().isOpen() && (events & Event::FileReadyType::Read)) {
+  if (!ioHandle().isOpen()) {
+    return;
+  }
+  if (raw_io_callbacks_ != nullptr) {
+    // The socket is read, and written to, by the owner of the callbacks.
+    raw_io_callbacks_->onRawIoReady();
+  } else if (events & Event::FileReadyType::Read) {
     onReadReady();
   }
 }
@@ -674,6 +688,46 @@ absl::string_view ConnectionImpl::transportFailureReason() const {
   return transport_socket_->failureReason();
 }
 
+IoHandle* ConnectionImpl::rawIoHandle() {
+  if (state() != State::Open || connecting_ || read_buffer_.length() > 0 ||
+      write_buffer_->length() > 0 || write_end_stream_ || !filter_manager_.singleReadFilter() ||
+      dynamic_cast<RawBufferSocket*>(transport_socket_.get()) == nullptr) {
+    return nullptr;
+  }
+  return &ioHandle();
+}
+
+void ConnectionImpl::startRawIo(RawIoCallbacks& callbacks) {
+  ASSERT(rawIoHandle() != nullptr);
+  ASSERT(raw_io_callbacks_ == nullptr);
+  ENVOY_CONN_LOG(debug, "socket reads handed over", *this);
+  raw_io_callbacks_ = &callbacks;
+  // Regardless of whether reads are disabled, the socket is watched for both reads and writes on
+  // behalf of the callbacks. The data which arrived while nothing read the socket won't trigger
+  // the edge triggered events, so the callbacks are also called once from the dispatcher.
+  file_event_->setEnabled(Event::FileReadyType::Read | Event::FileReadyType::Write);
+  file_event_->activate(Event::FileReadyType::Read);
+}
+
+void ConnectionImpl::stopRawIo() {
+  ASSERT(raw_io_callbacks_ != nullptr);
+  raw_io_callbacks_ = nullptr;
+  if (state() != State::Open || file_event_ == nullptr) {
+    return;
+  }
+  ENVOY_CONN_LOG(debug, "socket reads taken back", *this);
+  if (read_enabled_) {
+    file_event_->setEnabled(Event::FileReadyType::Read | Event::FileReadyType::Write);
+    // Data which arrived since the callbacks last read the socket won't trigger the edge
+    // triggered events, so it is read once from the dispatcher.
+    file_event_->activate(Event::FileReadyType::Read);
+  } else if (detect_early_close_ && !enable_half_close_) {
+    file_event_->setEnabled(Event::FileReadyType::Write | Event::FileReadyType::Closed);
+  } else {
+    file_event_->setEnabled(Event::FileReadyType::Write);
+  }
+}
+
 void ConnectionImpl::flushWriteBuffer() {
   if (state() == State::Open && write_buffer_->length() > 0) {
     onWriteReady();
@@ -90,6 +90,9 @@ public:
   StreamInfo::StreamInfo& streamInfo() override { return stream_info_; }
   const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
   absl::string_view transportFailureReason() const override;
+  IoHandle* rawIoHandle() override;
+  void startRawIo(RawIoCallbacks& callbacks) override;
+  void stopRawIo() override;
 
   // Network::FilterManagerConnection
   void rawWrite(Buffer::Instance& data, bool end_stream) override;
@@ -173,6 +176,8 @@ private:
   uint64_t last_read_buffer_size_{};
   uint64_t last_write_buffer_size_{};
   Buffer::Instance* current_write_buffer_{};
+  // Set once the socket is read by the owner of the callbacks rather than by the connection.
+  RawIoCallbacks* raw_io_callbacks_{};
   uint32_t read_disable_count_{0};
   bool read_enabled_ : 1;
   bool above_high_watermark_ : 1;
@@ -106,6 +106,11 @@ public:
   void addFilter(FilterSharedPtr filter);
   void addReadFilter(ReadFilterSharedPtr filter);
   bool initializeReadFilters();
+  // Returns whether the data of the connection goes through at most one read filter, and no write
+  // filter.
+  bool singleReadFilter() const {
+    return upstream_filters_.size() <= 1 && downstream_filters_.empty();
+  }
   void onRead();
   FilterStatus onWrite();
 
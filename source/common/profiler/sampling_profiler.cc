@@ -0,0 +1,520 @@
+#include "common/profiler/sampling_profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <typeinfo>
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+#include "common/common/macros.h"
+#include "common/common/thread.h"
+
+#include "absl/debugging/stacktrace.h"
+#include "absl/debugging/symbolize.h"
+
+#ifdef __linux__
+#include <cxxabi.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Older glibc headers only expose the thread ID of a sigevent through the union.
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace Envoy {
+namespace Profiler {
+
+namespace {
+
+// Minimal protobuf wire format encoding, which is all that is needed to write a pprof profile
+// without depending on its generated code.
+enum WireType : uint32_t { Varint = 0, LengthDelimited = 2 };
+
+void appendVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+void appendTag(std::string& out, uint32_t field, WireType wire_type) {
+  appendVarint(out, (static_cast<uint64_t>(field) << 3) | wire_type);
+}
+
+void appendVarintField(std::string& out, uint32_t field, uint64_t value) {
+  // Zero is the default, which need not be written.
+  if (value != 0) {
+    appendTag(out, field, Varint);
+    appendVarint(out, value);
+  }
+}
+
+void appendBytesField(std::string& out, uint32_t field, absl::string_view value) {
+  appendTag(out, field, LengthDelimited);
+  appendVarint(out, value.size());
+  out.append(value.data(), value.size());
+}
+
+template <class T>
+void appendPackedField(std::string& out, uint32_t field, const std::vector<T>& values) {
+  std::string packed;
+  for (const T value : values) {
+    appendVarint(packed, static_cast<uint64_t>(value));
+  }
+  appendBytesField(out, field, packed);
+}
+
+std::string valueType(int64_t type, int64_t unit) {
+  std::string value_type;
+  appendVarintField(value_type, 1, type);
+  appendVarintField(value_type, 2, unit);
+  return value_type;
+}
+
+std::string symbolizeAddress(const void* address) {
+  char name[1024];
+  if (absl::Symbolize(address, name, sizeof(name))) {
+    return name;
+  }
+  return fmt::format("{}", address);
+}
+
+} // namespace
+
+PprofProfileBuilder::PprofProfileBuilder(uint64_t period_ns, SymbolizeCb symbolize)
+    : period_ns_(period_ns), symbolize_(symbolize ? symbolize : symbolizeAddress) {
+  // The first string of the table must be empty.
+  stringId("");
+}
+
+int64_t PprofProfileBuilder::stringId(absl::string_view value) {
+  auto it = string_ids_.find(value);
+  if (it != string_ids_.end()) {
+    return it->second;
+  }
+  const int64_t id = strings_.size();
+  strings_.emplace_back(value);
+  string_ids_.emplace(value, id);
+  return id;
+}
+
+uint64_t PprofProfileBuilder::locationId(const void* address, bool is_return_address) {
+  const uint64_t key = reinterpret_cast<uintptr_t>(address);
+  auto it = location_ids_.find(key);
+  if (it != location_ids_.end()) {
+    return it->second;
+  }
+
+  // A return address points past the call, which may already be in the next line or function.
+  const void* call_address =
+      is_return_address ? static_cast<const char*>(address) - 1 : static_cast<const char*>(address);
+  const int64_t name = stringId(symbolize_(call_address));
+  auto function_it = function_ids_.find(name);
+  uint64_t function_id;
+  if (function_it != function_ids_.end()) {
+    function_id = function_it->second;
+  } else {
+    functions_.push_back(name);
+    function_id = functions_.size();
+    function_ids_.emplace(name, function_id);
+  }
+
+  locations_.emplace_back(key, function_id);
+  const uint64_t id = locations_.size();
+  location_ids_.emplace(key, id);
+  return id;
+}
+
+void PprofProfileBuilder::addSample(const std::vector<const void*>& frames,
+                                    absl::string_view thread, absl::string_view scope) {
+  Sample sample;
+  sample.location_ids_.reserve(frames.size());
+  for (size_t i = 0; i < frames.size(); ++i) {
+    // Only the innermost frame is the interrupted instruction, the others are return addresses.
+    sample.location_ids_.push_back(locationId(frames[i], i > 0));
+  }
+  sample.thread_ = stringId(thread);
+  sample.scope_ = scope.empty() ? 0 : stringId(scope);
+
+  std::string key;
+  for (const uint64_t id : sample.location_ids_) {
+    appendVarint(key, id);
+  }
+  appendVarint(key, 0);
+  appendVarint(key, sample.thread_);
+  appendVarint(key, sample.scope_);
+  auto it = sample_index_.find(key);
+  if (it != sample_index_.end()) {
+    samples_[it->second].count_++;
+    return;
+  }
+  sample.count_ = 1;
+  sample_index_.emplace(std::move(key), samples_.size());
+  samples_.push_back(std::move(sample));
+}
+
+std::string PprofProfileBuilder::serialize(int64_t time_ns, int64_t duration_ns) const {
+  // The builder only ever adds strings while samples are added, so looking these up again here
+  // would need a non-const stringId(). Instead they are appended to a copy of the string table.
+  std::vector<std::string> strings = strings_;
+  auto add_string = [&strings](absl::string_view value) -> int64_t {
+    strings.emplace_back(value);
+    return strings.size() - 1;
+  };
+  const int64_t samples = add_string("samples");
+  const int64_t count = add_string("count");
+  const int64_t cpu = add_string("cpu");
+  const int64_t nanoseconds = add_string("nanoseconds");
+  const int64_t thread = add_string("thread");
+  const int64_t scope = add_string("scope");
+
+  std::string profile;
+  appendBytesField(profile, 1, valueType(samples, count));
+  appendBytesField(profile, 1, valueType(cpu, nanoseconds));
+
+  for (const Sample& sample : samples_) {
+    std::string encoded;
+    appendPackedField(encoded, 1, sample.location_ids_);
+    appendPackedField(encoded, 2,
+                      std::vector<int64_t>{sample.count_,
+                                           sample.count_ * static_cast<int64_t>(period_ns_)});
+    std::string label;
+    appendVarintField(label, 1, thread);
+    appendVarintField(label, 2, sample.thread_);
+    appendBytesField(encoded, 3, label);
+    if (sample.scope_ != 0) {
+      label.clear();
+      appendVarintField(label, 1, scope);
+      appendVarintField(label, 2, sample.scope_);
+      appendBytesField(encoded, 3, label);
+    }
+    appendBytesField(profile, 2, encoded);
+  }
+
+  for (size_t i = 0; i < locations_.size(); ++i) {
+    std::string line;
+    appendVarintField(line, 1, locations_[i].second);
+    std::string location;
+    appendVarintField(location, 1, i + 1);
+    appendVarintField(location, 3, locations_[i].first);
+    appendBytesField(location, 4, line);
+    appendBytesField(profile, 4, location);
+  }
+
+  for (size_t i = 0; i < functions_.size(); ++i) {
+    std::string function;
+    appendVarintField(function, 1, i + 1);
+    appendVarintField(function, 2, functions_[i]);
+    appendVarintField(function, 3, functions_[i]);
+    appendBytesField(profile, 5, function);
+  }
+
+  for (const std::string& value : strings) {
+    appendBytesField(profile, 6, value);
+  }
+  appendVarintField(profile, 9, time_ns);
+  appendVarintField(profile, 10, duration_ns);
+  appendBytesField(profile, 11, valueType(cpu, nanoseconds));
+  appendVarintField(profile, 12, period_ns_);
+  return profile;
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct RecordedSample {
+  std::atomic<uint32_t> sequence_{0};
+  uint32_t depth_;
+  uint64_t time_ns_;
+  const std::type_info* scope_type_;
+  void* frames_[SamplingProfiler::MaxStackDepth];
+};
+
+struct ThreadState {
+  ThreadState(const std::string& name, const ScopeTrackedObject* const& current_object)
+      : name_(name), current_object_(&current_object), tid_(::syscall(SYS_gettid)) {
+    const int rc = pthread_getcpuclockid(pthread_self(), &cpu_clock_);
+    RELEASE_ASSERT(rc == 0, "");
+  }
+
+  const std::string name_;
+  const ScopeTrackedObject* const* const current_object_;
+  const pid_t tid_;
+  clockid_t cpu_clock_;
+  timer_t timer_{};
+  bool has_timer_{false};
+  bool exited_{false};
+  // Registration this one is nested in on the same thread, restored when it ends.
+  ThreadState* previous_{};
+  // Allocated the first time the profiler is started while the thread is registered.
+  std::unique_ptr<RecordedSample[]> samples_;
+  std::atomic<uint64_t> next_sample_{0};
+};
+
+struct ProfilerState {
+  Thread::MutexBasicLockable mutex_;
+  std::list<std::unique_ptr<ThreadState>> threads_ ABSL_GUARDED_BY(mutex_);
+  uint32_t frequency_hz_ ABSL_GUARDED_BY(mutex_){SamplingProfiler::DefaultFrequencyHz};
+  std::atomic<bool> running_{false};
+};
+
+ProfilerState& profilerState() { MUTABLE_CONSTRUCT_ON_FIRST_USE(ProfilerState); }
+
+// Read by the signal handler to find the ring of the interrupted thread.
+thread_local ThreadState* current_thread_state = nullptr;
+
+uint64_t monotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// Must only do async-signal-safe work.
+void handleProfilingSignal(int, siginfo_t*, void* context) {
+  const int saved_errno = errno;
+  ThreadState* state = current_thread_state;
+  if (state != nullptr && state->samples_ != nullptr &&
+      profilerState().running_.load(std::memory_order_relaxed)) {
+    RecordedSample& sample =
+        state->samples_[state->next_sample_.fetch_add(1, std::memory_order_relaxed) %
+                        SamplingProfiler::SamplesPerThread];
+    // The sequence is odd while the sample is being written, see collectSamples().
+    const uint32_t sequence = sample.sequence_.load(std::memory_order_relaxed) + 1;
+    sample.sequence_.store(sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    sample.depth_ = absl::GetStackTraceWithContext(sample.frames_, SamplingProfiler::MaxStackDepth,
+                                                   /* skip_count = */ 1, context, nullptr);
+    sample.time_ns_ = monotonicNs();
+    const ScopeTrackedObject* object = *state->current_object_;
+    sample.scope_type_ = object != nullptr ? &typeid(*object) : nullptr;
+    sample.sequence_.store(sequence + 1, std::memory_order_release);
+  }
+  errno = saved_errno;
+}
+
+void installSignalHandler() {
+  // The handler is checked on every start rather than installed once, as another user of SIGPROF,
+  // such as the gperftools CPU profiler, may have replaced it since the previous run.
+  struct sigaction current {};
+  int rc = sigaction(SIGPROF, nullptr, &current);
+  RELEASE_ASSERT(rc == 0, "");
+  if ((current.sa_flags & SA_SIGINFO) != 0 && current.sa_sigaction == handleProfilingSignal) {
+    return;
+  }
+  // The handler is never removed: a signal generated by a timer may still be pending after the
+  // timer is deleted, and the default disposition of SIGPROF terminates the process.
+  struct sigaction action {};
+  action.sa_sigaction = handleProfilingSignal;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  rc = sigaction(SIGPROF, &action, nullptr);
+  RELEASE_ASSERT(rc == 0, "");
+}
+
+bool startTimer(ThreadState& state, uint32_t frequency_hz) {
+  ASSERT(!state.has_timer_);
+  if (state.samples_ == nullptr) {
+    state.samples_ = std::make_unique<RecordedSample[]>(SamplingProfiler::SamplesPerThread);
+  }
+
+  sigevent event{};
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = state.tid_;
+  if (timer_create(state.cpu_clock_, &event, &state.timer_) != 0) {
+    return false;
+  }
+  state.has_timer_ = true;
+
+  itimerspec spec{};
+  const uint64_t interval_ns = 1000000000 / frequency_hz;
+  spec.it_interval.tv_sec = interval_ns / 1000000000;
+  spec.it_interval.tv_nsec = interval_ns % 1000000000;
+  spec.it_value = spec.it_interval;
+  return timer_settime(state.timer_, 0, &spec, nullptr) == 0;
+}
+
+void stopTimer(ThreadState& state) {
+  if (state.has_timer_) {
+    timer_delete(state.timer_);
+    state.has_timer_ = false;
+  }
+}
+
+std::string demangle(const std::type_info& type) {
+  int status = 0;
+  std::unique_ptr<char, decltype(&::free)> demangled(
+      abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), ::free);
+  return status == 0 && demangled != nullptr ? demangled.get() : type.name();
+}
+
+} // namespace
+
+bool SamplingProfiler::supported() { return true; }
+
+bool SamplingProfiler::start(uint32_t frequency_hz) {
+  ASSERT(frequency_hz > 0 && frequency_hz <= MaxFrequencyHz);
+  ProfilerState& profiler = profilerState();
+  Thread::LockGuard lock(profiler.mutex_);
+  if (profiler.running_) {
+    return false;
+  }
+  installSignalHandler();
+
+  // Discard the samples of the previous run, and the threads which have exited since.
+  profiler.threads_.remove_if([](const std::unique_ptr<ThreadState>& state) {
+    return state->exited_;
+  });
+  for (auto& state : profiler.threads_) {
+    if (state->samples_ != nullptr) {
+      for (uint32_t i = 0; i < SamplesPerThread; ++i) {
+        state->samples_[i].sequence_.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  profiler.frequency_hz_ = frequency_hz;
+  profiler.running_ = true;
+  bool started = true;
+  for (auto& state : profiler.threads_) {
+    started = startTimer(*state, frequency_hz) && started;
+  }
+  if (!started) {
+    for (auto& state : profiler.threads_) {
+      stopTimer(*state);
+    }
+    profiler.running_ = false;
+  }
+  return started;
+}
+
+void SamplingProfiler::stop() {
+  ProfilerState& profiler = profilerState();
+  Thread::LockGuard lock(profiler.mutex_);
+  profiler.running_ = false;
+  for (auto& state : profiler.threads_) {
+    stopTimer(*state);
+  }
+}
+
+bool SamplingProfiler::isRunning() { return profilerState().running_; }
+
+std::string SamplingProfiler::pprofProfile(absl::optional<std::chrono::nanoseconds> max_age) {
+  ProfilerState& profiler = profilerState();
+  Thread::LockGuard lock(profiler.mutex_);
+  const uint64_t now_ns = monotonicNs();
+  const uint64_t min_time_ns =
+      max_age.has_value() && static_cast<uint64_t>(max_age->count()) < now_ns
+          ? now_ns - max_age->count()
+          : 0;
+  uint64_t oldest_ns = now_ns;
+  PprofProfileBuilder builder(1000000000 / profiler.frequency_hz_);
+  absl::flat_hash_map<const std::type_info*, std::string> scope_names;
+  std::vector<const void*> frames;
+  frames.reserve(MaxStackDepth);
+
+  for (const auto& state : profiler.threads_) {
+    if (state->samples_ == nullptr) {
+      continue;
+    }
+    for (uint32_t i = 0; i < SamplesPerThread; ++i) {
+      // Samples are written by signal handlers on the sampled thread without any locking, so they
+      // are read optimistically and discarded if they were written to in the meantime.
+      const RecordedSample& sample = state->samples_[i];
+      const uint32_t sequence = sample.sequence_.load(std::memory_order_acquire);
+      if (sequence == 0 || sequence % 2 != 0) {
+        continue;
+      }
+      const uint32_t depth = std::min(sample.depth_, MaxStackDepth);
+      frames.assign(sample.frames_, sample.frames_ + depth);
+      const uint64_t time_ns = sample.time_ns_;
+      const std::type_info* scope_type = sample.scope_type_;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sample.sequence_.load(std::memory_order_relaxed) != sequence || time_ns < min_time_ns ||
+          frames.empty()) {
+        continue;
+      }
+
+      oldest_ns = std::min(oldest_ns, time_ns);
+      absl::string_view scope;
+      if (scope_type != nullptr) {
+        auto it = scope_names.find(scope_type);
+        if (it == scope_names.end()) {
+          it = scope_names.emplace(scope_type, demangle(*scope_type)).first;
+        }
+        scope = it->second;
+      }
+      builder.addSample(frames, state->name_, scope);
+    }
+  }
+
+  const int64_t time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+  return builder.serialize(time_ns, now_ns - oldest_ns);
+}
+
+SamplingProfiler::ThreadRegistration::ThreadRegistration(
+    const std::string& name, const ScopeTrackedObject* const& current_object)
+    : state_(new ThreadState(name, current_object)) {
+  ThreadState* state = static_cast<ThreadState*>(state_);
+  ProfilerState& profiler = profilerState();
+  Thread::LockGuard lock(profiler.mutex_);
+  profiler.threads_.emplace_back(state);
+  state->previous_ = current_thread_state;
+  current_thread_state = state;
+  if (profiler.running_ && !startTimer(*state, profiler.frequency_hz_)) {
+    // The profiler keeps running for the other threads, so this one is only left out.
+    const int error = errno;
+    stopTimer(*state);
+    ENVOY_LOG_MISC(warn, "unable to sample thread {} for the running profiler: {}", name,
+                   ::strerror(error));
+  }
+}
+
+SamplingProfiler::ThreadRegistration::~ThreadRegistration() {
+  ThreadState* state = static_cast<ThreadState*>(state_);
+  ProfilerState& profiler = profilerState();
+  Thread::LockGuard lock(profiler.mutex_);
+  stopTimer(*state);
+  current_thread_state = state->previous_;
+  if (state->samples_ == nullptr) {
+    // Nothing was recorded, so there is no reason to keep the state around.
+    profiler.threads_.remove_if(
+        [state](const std::unique_ptr<ThreadState>& entry) { return entry.get() == state; });
+  } else {
+    // Keep the samples of the thread until the profiler is started again.
+    state->exited_ = true;
+  }
+}
+
+#else
+
+bool SamplingProfiler::supported() { return false; }
+bool SamplingProfiler::start(uint32_t) { return false; }
+void SamplingProfiler::stop() {}
+bool SamplingProfiler::isRunning() { return false; }
+std::string SamplingProfiler::pprofProfile(absl::optional<std::chrono::nanoseconds>) {
+  return PprofProfileBuilder(1000000000 / DefaultFrequencyHz).serialize(0, 0);
+}
+SamplingProfiler::ThreadRegistration::ThreadRegistration(const std::string&,
+                                                         const ScopeTrackedObject* const&)
+    : state_(nullptr) {}
+SamplingProfiler::ThreadRegistration::~ThreadRegistration() = default;
+
+#endif
+
+} // namespace Profiler
+} // namespace Envoy
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "envoy/common/scope_tracker.h"
+
+#include "common/common/non_copyable.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Profiler {
+
+/**
+ * Process wide sampling CPU profiler. While running, each registered thread is interrupted at a
+ * fixed rate of its own CPU time, and the interrupted stack is recorded into a fixed size ring
+ * owned by that thread, along with the type of the ScopeTrackedObject the thread's dispatcher was
+ * working on, if any. The rings can be turned into a pprof profile at any time without stopping
+ * the profiler, so it can be left running in production.
+ *
+ * Sampling is only supported on Linux, where it uses per-thread CPU time timers delivering
+ * SIGPROF. It cannot run at the same time as the gperftools CPU profiler, which uses the same
+ * signal.
+ */
+class SamplingProfiler {
+public:
+  // Number of samples kept per thread. Older samples are overwritten.
+  static constexpr uint32_t SamplesPerThread = 1024;
+  // Deepest stack recorded for a sample, deeper frames are dropped.
+  static constexpr uint32_t MaxStackDepth = 32;
+  static constexpr uint32_t DefaultFrequencyHz = 99;
+  static constexpr uint32_t MaxFrequencyHz = 1000;
+
+  /**
+   * @return whether sampling is supported on this platform.
+   */
+  static bool supported();
+
+  /**
+   * Start sampling the registered threads, discarding previously recorded samples.
+   * @param frequency_hz supplies the number of samples per second of CPU time of each thread.
+   * @return whether the profiler was started.
+   */
+  static bool start(uint32_t frequency_hz);
+
+  /**
+   * Stop sampling. Recorded samples are kept until the profiler is started again.
+   */
+  static void stop();
+
+  /**
+   * @return whether the profiler is running.
+   */
+  static bool isRunning();
+
+  /**
+   * Builds a pprof profile out of the recorded samples.
+   * @param max_age supplies, if set, the age of the oldest sample to include.
+   * @return the serialized perftools.profiles.Profile protobuf.
+   */
+  static std::string pprofProfile(absl::optional<std::chrono::nanoseconds> max_age);
+
+  /**
+   * Registers the calling thread for sampling for the lifetime of the object. If the profiler is
+   * running but the thread cannot be sampled, a warning is logged and the thread is left out until
+   * the profiler is started again.
+   */
+  class ThreadRegistration : NonCopyable {
+  public:
+    /**
+     * @param name supplies the name of the thread, which labels its samples.
+     * @param current_object supplies the slot holding the object the thread is working on, which
+     *        must outlive the registration. It is read from the signal handler on the registered
+     *        thread, so it must only be updated by that thread.
+     */
+    ThreadRegistration(const std::string& name, const ScopeTrackedObject* const& current_object);
+    ~ThreadRegistration();
+
+  private:
+    void* const state_;
+  };
+};
+
+/**
+ * Builds a profile in the pprof format (https://github.com/google/pprof/blob/master/proto/
+ * profile.proto) out of CPU samples. Identical samples are aggregated.
+ */
+class PprofProfileBuilder {
+public:
+  using SymbolizeCb = std::function<std::string(const void* address)>;
+
+  /**
+   * @param period_ns supplies the CPU time represented by each sample.
+   * @param symbolize supplies the function used to name frames. The default uses the symbols of
+   *        the running binary.
+   */
+  explicit PprofProfileBuilder(uint64_t period_ns, SymbolizeCb symbolize = nullptr);
+
+  /**
+   * Adds a sample.
+   * @param frames supplies the stack, innermost frame first.
+   * @param thread supplies the name of the thread the sample was taken on.
+   * @param scope supplies the type of the object the thread was working on, or empty.
+   */
+  void addSample(const std::vector<const void*>& frames, absl::string_view thread,
+                 absl::string_view scope);
+
+  /**
+   * @param time_ns supplies the time the profile was collected, in nanoseconds since the epoch.
+   * @param duration_ns supplies the period of time covered by the profile.
+   * @return the serialized profile.
+   */
+  std::string serialize(int64_t time_ns, int64_t duration_ns) const;
+
+private:
+  struct Sample {
+    std::vector<uint64_t> location_ids_;
+    int64_t thread_;
+    int64_t scope_;
+    int64_t count_;
+  };
+
+  int64_t stringId(absl::string_view value);
+  uint64_t locationId(const void* address, bool is_return_address);
+
+  const uint64_t period_ns_;
+  const SymbolizeCb symbolize_;
+  std::vector<std::string> strings_;
+  absl::flat_hash_map<std::string, int64_t> string_ids_;
+  // Address and function name ID of each location, indexed by location ID - 1.
+  std::vector<std::pair<uint64_t, uint64_t>> locations_;
+  absl::flat_hash_map<uint64_t, uint64_t> location_ids_;
+  // Name string ID of each function, indexed by function ID - 1.
+  std::vector<int64_t> functions_;
+  absl::flat_hash_map<int64_t, uint64_t> function_ids_;
+  std::vector<Sample> samples_;
+  absl::flat_hash_map<std::string, size_t> sample_index_;
+};
+
+} // namespace Profiler
+} // namespace Envoy
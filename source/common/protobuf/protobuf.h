@@ -28,6 +28,7 @@
 #include "google/protobuf/util/time_util.h"
 #include "google/protobuf/util/type_resolver.h"
 #include "google/protobuf/util/type_resolver_util.h"
+#include "google/protobuf/wire_format_lite.h"
 #include "google/protobuf/wrappers.pb.h"
 
 namespace Envoy {
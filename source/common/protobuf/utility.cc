@@ -1,5 +1,7 @@
 #include "common/protobuf/utility.h"
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <numeric>
 
@@ -9,6 +11,7 @@
 
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
+#include "common/common/macros.h"
 #include "common/config/api_type_oracle.h"
 #include "common/config/version_converter.h"
 #include "common/protobuf/message_validator_impl.h"
@@ -129,6 +132,12 @@ public:
   ApiBoostRetryException(const std::string& message) : EnvoyException(message) {}
 };
 
+// Builds the dynamic messages of the earlier versions of messages. The prototypes of a factory are
+// built on first use for each type, so the factory is shared rather than rebuilt for every message.
+Protobuf::DynamicMessageFactory& earlierVersionMessageFactory() {
+  MUTABLE_CONSTRUCT_ON_FIRST_USE(Protobuf::DynamicMessageFactory);
+}
+
 // Apply a function transforming a message (e.g. loading JSON into the message).
 // First we try with the message's earlier type, and if unsuccessful (or no
 // earlier) type, then the current type. This allows us to take a v3 Envoy
@@ -145,8 +154,11 @@ void tryWithApiBoosting(MessageXformFn f, Protobuf::Message& message) {
     return;
   }
 
-  Protobuf::DynamicMessageFactory dmf;
-  auto earlier_message = ProtobufTypes::MessagePtr(dmf.GetPrototype(earlier_version_desc)->New());
+  // The earlier version message is discarded once upgraded, so its whole tree is allocated on an
+  // arena and freed at once.
+  Protobuf::Arena arena;
+  Protobuf::Message* earlier_message =
+      earlierVersionMessageFactory().GetPrototype(earlier_version_desc)->New(&arena);
   ASSERT(earlier_message != nullptr);
   try {
     // Try apply f with an earlier version of the message, then upgrade the
@@ -256,18 +268,392 @@ ProtoValidationException::ProtoValidationException(const std::string& validation
   ENVOY_LOG_MISC(debug, "Proto validation error; throwing {}", what());
 }
 
-size_t MessageUtil::hash(const Protobuf::Message& message) {
-  std::string text_format;
+namespace {
+
+// Unpacks the value of a google.protobuf.Any of a type known to the generated pool.
+// @return the unpacked message, or nullptr if the type isn't known or the value doesn't parse.
+std::unique_ptr<Protobuf::Message> unpackKnownAny(absl::string_view type_url,
+                                                  absl::string_view value) {
+  const Protobuf::Descriptor* descriptor =
+      Protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          std::string(TypeUtil::typeUrlToDescriptorFullName(type_url)));
+  if (descriptor == nullptr) {
+    return nullptr;
+  }
+  const Protobuf::Message* prototype =
+      Protobuf::MessageFactory::generated_factory()->GetPrototype(descriptor);
+  if (prototype == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<Protobuf::Message> unpacked(prototype->New());
+  if (!unpacked->ParseFromArray(value.data(), value.size())) {
+    return nullptr;
+  }
+  return unpacked;
+}
+
+/**
+ * Appends a deterministic encoding of a message to a buffer, which is hashed at once. The set
+ * fields are walked in field number order with reflection, each message being prefixed with its
+ * number of fields and each string with its length so that no two messages encode the same. Map
+ * entries are in no particular order, so each entry is hashed on its own and the entry hashes are
+ * encoded in order. Known types in google.protobuf.Any are unpacked, as their serialization isn't
+ * deterministic. Reflection is used rather than downcasting google.protobuf.Any, since messages
+ * may come from a DynamicMessageFactory.
+ */
+class MessageHashEncoder {
+public:
+  static uint64_t hash(const Protobuf::Message& message) {
+    std::string buffer;
+    MessageHashEncoder(buffer).encodeMessage(message);
+    return HashUtil::xxHash64(buffer);
+  }
+
+  static std::string encodeUnknownFields(const Protobuf::UnknownFieldSet& unknown_fields) {
+    std::string buffer;
+    MessageHashEncoder(buffer).encodeUnknownFieldSet(unknown_fields);
+    return buffer;
+  }
+
+private:
+  explicit MessageHashEncoder(std::string& buffer) : buffer_(buffer) {}
+
+  template <class T> void append(T value) {
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void appendString(absl::string_view value) {
+    append<uint64_t>(value.size());
+    buffer_.append(value.data(), value.size());
+  }
+
+  void encodeMessage(const Protobuf::Message& message) {
+    const Protobuf::Reflection* reflection = message.GetReflection();
+    if (message.GetDescriptor() == ProtobufWkt::Any::descriptor()) {
+      encodeAny(message, *reflection);
+      return;
+    }
+
+    std::vector<const Protobuf::FieldDescriptor*> fields;
+    reflection->ListFields(message, &fields);
+    append<uint32_t>(fields.size());
+    for (const Protobuf::FieldDescriptor* field : fields) {
+      append<int32_t>(field->number());
+      if (field->is_map()) {
+        encodeMap(message, *reflection, *field);
+      } else if (field->is_repeated()) {
+        const int size = reflection->FieldSize(message, field);
+        append<int32_t>(size);
+        for (int i = 0; i < size; i++) {
+          encodeValue(message, *reflection, *field, i);
+        }
+      } else {
+        encodeValue(message, *reflection, *field, -1);
+      }
+    }
+    encodeUnknownFieldSet(reflection->GetUnknownFields(message));
+  }
+
+  void encodeAny(const Protobuf::Message& any, const Protobuf::Reflection& reflection) {
+    const Protobuf::Descriptor* descriptor = any.GetDescriptor();
+    std::string type_url_scratch;
+    std::string value_scratch;
+    const std::string& type_url = reflection.GetStringReference(
+        any, descriptor->FindFieldByNumber(ProtobufWkt::Any::kTypeUrlFieldNumber),
+        &type_url_scratch);
+    const std::string& value = reflection.GetStringReference(
+        any, descriptor->FindFieldByNumber(ProtobufWkt::Any::kValueFieldNumber), &value_scratch);
+    appendString(type_url);
+    const std::unique_ptr<Protobuf::Message> unpacked = unpackKnownAny(type_url, value);
+    append<bool>(unpacked != nullptr);
+    if (unpacked != nullptr) {
+      encodeMessage(*unpacked);
+    } else {
+      appendString(value);
+    }
+  }
+
+  void encodeMap(const Protobuf::Message& message, const Protobuf::Reflection& reflection,
+                 const Protobuf::FieldDescriptor& field) {
+    const int size = reflection.FieldSize(message, &field);
+    std::vector<uint64_t> entry_hashes;
+    entry_hashes.reserve(size);
+    for (int i = 0; i < size; i++) {
+      entry_hashes.push_back(hash(reflection.GetRepeatedMessage(message, &field, i)));
+    }
+    std::sort(entry_hashes.begin(), entry_hashes.end());
+    append<int32_t>(size);
+    for (const uint64_t entry_hash : entry_hashes) {
+      append<uint64_t>(entry_hash);
+    }
+  }
+
+  // Encodes a singular field if index is negative, or the value at index of a repeated field.
+  void encodeValue(const Protobuf::Message& message, const Protobuf::Reflection& reflection,
+                   const Protobuf::FieldDescriptor& field, int index) {
+    const bool singular = index < 0;
+    switch (field.cpp_type()) {
+    case Protobuf::FieldDescriptor::CPPTYPE_INT32:
+      append(singular ? reflection.GetInt32(message, &field)
+                      : reflection.GetRepeatedInt32(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_INT64:
+      append(singular ? reflection.GetInt64(message, &field)
+                      : reflection.GetRepeatedInt64(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      append(singular ? reflection.GetUInt32(message, &field)
+                      : reflection.GetRepeatedUInt32(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      append(singular ? reflection.GetUInt64(message, &field)
+                      : reflection.GetRepeatedUInt64(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      append(singular ? reflection.GetDouble(message, &field)
+                      : reflection.GetRepeatedDouble(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      append(singular ? reflection.GetFloat(message, &field)
+                      : reflection.GetRepeatedFloat(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      append(singular ? reflection.GetBool(message, &field)
+                      : reflection.GetRepeatedBool(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_ENUM:
+      append(singular ? reflection.GetEnumValue(message, &field)
+                      : reflection.GetRepeatedEnumValue(message, &field, index));
+      break;
+    case Protobuf::FieldDescriptor::CPPTYPE_STRING: {
+      std::string scratch;
+      appendString(singular ? reflection.GetStringReference(message, &field, &scratch)
+                            : reflection.GetRepeatedStringReference(message, &field, index,
+                                                                    &scratch));
+      break;
+    }
+    case Protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+      encodeMessage(singular ? reflection.GetMessage(message, &field)
+                             : reflection.GetRepeatedMessage(message, &field, index));
+      break;
+    }
+  }
+
+  void encodeUnknownFieldSet(const Protobuf::UnknownFieldSet& unknown_fields) {
+    append<int32_t>(unknown_fields.field_count());
+    for (int i = 0; i < unknown_fields.field_count(); i++) {
+      const Protobuf::UnknownField& unknown_field = unknown_fields.field(i);
+      append<int32_t>(unknown_field.number());
+      append<int32_t>(unknown_field.type());
+      switch (unknown_field.type()) {
+      case Protobuf::UnknownField::TYPE_VARINT:
+        append(unknown_field.varint());
+        break;
+      case Protobuf::UnknownField::TYPE_FIXED32:
+        append(unknown_field.fixed32());
+        break;
+      case Protobuf::UnknownField::TYPE_FIXED64:
+        append(unknown_field.fixed64());
+        break;
+      case Protobuf::UnknownField::TYPE_LENGTH_DELIMITED:
+        appendString(unknown_field.length_delimited());
+        break;
+      case Protobuf::UnknownField::TYPE_GROUP:
+        encodeUnknownFieldSet(unknown_field.group());
+        break;
+      }
+    }
+  }
+
+  std::string& buffer_;
+};
 
-  {
-    Protobuf::TextFormat::Printer printer;
-    printer.SetExpandAny(true);
-    printer.SetUseFieldNumber(true);
-    printer.SetSingleLineMode(true);
-    printer.PrintToString(message, &text_format);
+bool messagesEqual(const Protobuf::Message& lhs, const Protobuf::Message& rhs);
+
+bool anysEqual(const Protobuf::Message& lhs, const Protobuf::Message& rhs) {
+  const Protobuf::Reflection* reflection = lhs.GetReflection();
+  const Protobuf::Descriptor* descriptor = lhs.GetDescriptor();
+  const Protobuf::FieldDescriptor* type_url_field =
+      descriptor->FindFieldByNumber(ProtobufWkt::Any::kTypeUrlFieldNumber);
+  const Protobuf::FieldDescriptor* value_field =
+      descriptor->FindFieldByNumber(ProtobufWkt::Any::kValueFieldNumber);
+  std::string lhs_scratch;
+  std::string rhs_scratch;
+  const std::string& type_url = reflection->GetStringReference(lhs, type_url_field, &lhs_scratch);
+  if (type_url != rhs.GetReflection()->GetStringReference(rhs, type_url_field, &rhs_scratch)) {
+    return false;
+  }
+
+  const std::string& lhs_value = reflection->GetStringReference(lhs, value_field, &lhs_scratch);
+  const std::string& rhs_value =
+      rhs.GetReflection()->GetStringReference(rhs, value_field, &rhs_scratch);
+  if (lhs_value == rhs_value) {
+    return true;
+  }
+  // The values may still be different serializations of equal messages.
+  const std::unique_ptr<Protobuf::Message> lhs_unpacked = unpackKnownAny(type_url, lhs_value);
+  const std::unique_ptr<Protobuf::Message> rhs_unpacked = unpackKnownAny(type_url, rhs_value);
+  return lhs_unpacked != nullptr && rhs_unpacked != nullptr &&
+         messagesEqual(*lhs_unpacked, *rhs_unpacked);
+}
+
+bool mapsEqual(const Protobuf::Message& lhs, const Protobuf::Message& rhs,
+               const Protobuf::FieldDescriptor& field) {
+  // Map entries are in no particular order, so match them up by hash. The keys of a map are unique,
+  // so entries only share a hash on collisions, which are all searched.
+  using HashedEntry = std::pair<uint64_t, const Protobuf::Message*>;
+  const auto hashed_entries = [&field](const Protobuf::Message& message) {
+    const Protobuf::Reflection* reflection = message.GetReflection();
+    std::vector<HashedEntry> entries;
+    entries.reserve(reflection->FieldSize(message, &field));
+    for (int i = 0; i < reflection->FieldSize(message, &field); i++) {
+      const Protobuf::Message& entry = reflection->GetRepeatedMessage(message, &field, i);
+      entries.emplace_back(MessageHashEncoder::hash(entry), &entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const HashedEntry& a, const HashedEntry& b) {
+      return a.first < b.first;
+    });
+    return entries;
+  };
+  const std::vector<HashedEntry> lhs_entries = hashed_entries(lhs);
+  const std::vector<HashedEntry> rhs_entries = hashed_entries(rhs);
+  if (lhs_entries.size() != rhs_entries.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs_entries.size(); i++) {
+    if (lhs_entries[i].first != rhs_entries[i].first) {
+      return false;
+    }
+    if (messagesEqual(*lhs_entries[i].second, *rhs_entries[i].second)) {
+      continue;
+    }
+    bool found = false;
+    for (size_t j = 0; j < rhs_entries.size() && !found; j++) {
+      found = rhs_entries[j].first == lhs_entries[i].first &&
+              messagesEqual(*lhs_entries[i].second, *rhs_entries[j].second);
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compares a singular field if index is negative, or the values at index of a repeated field.
+bool valuesEqual(const Protobuf::Message& lhs, const Protobuf::Message& rhs,
+                 const Protobuf::FieldDescriptor& field, int index) {
+  const Protobuf::Reflection& l = *lhs.GetReflection();
+  const Protobuf::Reflection& r = *rhs.GetReflection();
+  const bool singular = index < 0;
+  switch (field.cpp_type()) {
+  case Protobuf::FieldDescriptor::CPPTYPE_INT32:
+    return singular ? l.GetInt32(lhs, &field) == r.GetInt32(rhs, &field)
+                    : l.GetRepeatedInt32(lhs, &field, index) ==
+                          r.GetRepeatedInt32(rhs, &field, index);
+  case Protobuf::FieldDescriptor::CPPTYPE_INT64:
+    return singular ? l.GetInt64(lhs, &field) == r.GetInt64(rhs, &field)
+                    : l.GetRepeatedInt64(lhs, &field, index) ==
+                          r.GetRepeatedInt64(rhs, &field, index);
+  case Protobuf::FieldDescriptor::CPPTYPE_UINT32:
+    return singular ? l.GetUInt32(lhs, &field) == r.GetUInt32(rhs, &field)
+                    : l.GetRepeatedUInt32(lhs, &field, index) ==
+                          r.GetRepeatedUInt32(rhs, &field, index);
+  case Protobuf::FieldDescriptor::CPPTYPE_UINT64:
+    return singular ? l.GetUInt64(lhs, &field) == r.GetUInt64(rhs, &field)
+                    : l.GetRepeatedUInt64(lhs, &field, index) ==
+                          r.GetRepeatedUInt64(rhs, &field, index);
+  case Protobuf::FieldDescriptor::CPPTYPE_DOUBLE: {
+    // Floating point values are compared bitwise, like they are hashed, so that NaN equals itself.
+    const double a = singular ? l.GetDouble(lhs, &field) : l.GetRepeatedDouble(lhs, &field, index);
+    const double b = singular ? r.GetDouble(rhs, &field) : r.GetRepeatedDouble(rhs, &field, index);
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_FLOAT: {
+    const float a = singular ? l.GetFloat(lhs, &field) : l.GetRepeatedFloat(lhs, &field, index);
+    const float b = singular ? r.GetFloat(rhs, &field) : r.GetRepeatedFloat(rhs, &field, index);
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_BOOL:
+    return singular ? l.GetBool(lhs, &field) == r.GetBool(rhs, &field)
+                    : l.GetRepeatedBool(lhs, &field, index) ==
+                          r.GetRepeatedBool(rhs, &field, index);
+  case Protobuf::FieldDescriptor::CPPTYPE_ENUM:
+    return singular ? l.GetEnumValue(lhs, &field) == r.GetEnumValue(rhs, &field)
+                    : l.GetRepeatedEnumValue(lhs, &field, index) ==
+                          r.GetRepeatedEnumValue(rhs, &field, index);
+  case Protobuf::FieldDescriptor::CPPTYPE_STRING: {
+    std::string lhs_scratch;
+    std::string rhs_scratch;
+    return singular ? l.GetStringReference(lhs, &field, &lhs_scratch) ==
+                          r.GetStringReference(rhs, &field, &rhs_scratch)
+                    : l.GetRepeatedStringReference(lhs, &field, index, &lhs_scratch) ==
+                          r.GetRepeatedStringReference(rhs, &field, index, &rhs_scratch);
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+    return singular ? messagesEqual(l.GetMessage(lhs, &field), r.GetMessage(rhs, &field))
+                    : messagesEqual(l.GetRepeatedMessage(lhs, &field, index),
+                                    r.GetRepeatedMessage(rhs, &field, index));
   }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+bool messagesEqual(const Protobuf::Message& lhs, const Protobuf::Message& rhs) {
+  if (&lhs == &rhs) {
+    return true;
+  }
+  if (lhs.GetDescriptor() != rhs.GetDescriptor()) {
+    return false;
+  }
+  if (lhs.GetDescriptor() == ProtobufWkt::Any::descriptor()) {
+    return anysEqual(lhs, rhs);
+  }
+
+  const Protobuf::Reflection* lhs_reflection = lhs.GetReflection();
+  const Protobuf::Reflection* rhs_reflection = rhs.GetReflection();
+  std::vector<const Protobuf::FieldDescriptor*> lhs_fields;
+  std::vector<const Protobuf::FieldDescriptor*> rhs_fields;
+  lhs_reflection->ListFields(lhs, &lhs_fields);
+  rhs_reflection->ListFields(rhs, &rhs_fields);
+  if (lhs_fields != rhs_fields) {
+    return false;
+  }
+  for (const Protobuf::FieldDescriptor* field : lhs_fields) {
+    if (field->is_map()) {
+      if (!mapsEqual(lhs, rhs, *field)) {
+        return false;
+      }
+    } else if (field->is_repeated()) {
+      const int size = lhs_reflection->FieldSize(lhs, field);
+      if (size != rhs_reflection->FieldSize(rhs, field)) {
+        return false;
+      }
+      for (int i = 0; i < size; i++) {
+        if (!valuesEqual(lhs, rhs, *field, i)) {
+          return false;
+        }
+      }
+    } else if (!valuesEqual(lhs, rhs, *field, -1)) {
+      return false;
+    }
+  }
+
+  const Protobuf::UnknownFieldSet& lhs_unknown_fields = lhs_reflection->GetUnknownFields(lhs);
+  const Protobuf::UnknownFieldSet& rhs_unknown_fields = rhs_reflection->GetUnknownFields(rhs);
+  if (lhs_unknown_fields.empty() && rhs_unknown_fields.empty()) {
+    return true;
+  }
+  return MessageHashEncoder::encodeUnknownFields(lhs_unknown_fields) ==
+         MessageHashEncoder::encodeUnknownFields(rhs_unknown_fields);
+}
+
+} // namespace
+
+size_t MessageUtil::hash(const Protobuf::Message& message) {
+  return MessageHashEncoder::hash(message);
+}
 
-  return HashUtil::xxHash64(text_format);
+bool MessageUtil::equal(const Protobuf::Message& lhs, const Protobuf::Message& rhs) {
+  return messagesEqual(lhs, rhs);
 }
 
 void MessageUtil::loadFromJson(const std::string& json, Protobuf::Message& message,
@@ -546,18 +932,16 @@ void MessageUtil::unpackTo(const ProtobufWkt::Any& any_message, Protobuf::Messag
   if (any_full_name != message.GetDescriptor()->full_name()) {
     const Protobuf::Descriptor* earlier_version_desc =
         Config::ApiTypeOracle::getEarlierVersionDescriptor(message.GetDescriptor()->full_name());
-    // If the earlier version matches, unpack and upgrade.
+    // If the earlier version matches, unpack and upgrade. Upgrading is a wire-level
+    // reinterpretation, so the earlier version is parsed directly as the later one rather than
+    // into an intermediate message which would be serialized again.
     if (earlier_version_desc != nullptr && any_full_name == earlier_version_desc->full_name()) {
-      Protobuf::DynamicMessageFactory dmf;
-      auto earlier_message =
-          ProtobufTypes::MessagePtr(dmf.GetPrototype(earlier_version_desc)->New());
-      ASSERT(earlier_message != nullptr);
-      if (!any_message.UnpackTo(earlier_message.get())) {
+      if (!message.ParseFromString(any_message.value())) {
         throw EnvoyException(fmt::format("Unable to unpack as {}: {}",
-                                         earlier_message->GetDescriptor()->full_name(),
+                                         earlier_version_desc->full_name(),
                                          any_message.DebugString()));
       }
-      Config::VersionConverter::upgrade(*earlier_message, message);
+      Config::VersionConverter::annotateWithOriginalType(*earlier_version_desc, message);
       return;
     }
   }
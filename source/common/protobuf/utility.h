@@ -192,7 +192,7 @@ public:
 
   // std::equals_to
   bool operator()(const Protobuf::Message& lhs, const Protobuf::Message& rhs) const {
-    return Protobuf::util::MessageDifferencer::Equivalent(lhs, rhs);
+    return equal(lhs, rhs);
   }
 
   class FileExtensionValues {
@@ -207,14 +207,23 @@ public:
   using FileExtensions = ConstSingleton<FileExtensionValues>;
 
   /**
-   * A hash function uses Protobuf::TextFormat to force deterministic serialization recursively
-   * including known types in google.protobuf.Any. See
+   * A hash function which walks the set fields of a message with reflection, so that equal messages
+   * hash the same however they were built or serialized: map entries are hashed regardless of their
+   * order, and known types in google.protobuf.Any are unpacked. See
    * https://github.com/protocolbuffers/protobuf/issues/5731 for the context.
    * Using this function is discouraged, see discussion in
    * https://github.com/envoyproxy/envoy/issues/8301.
    */
   static std::size_t hash(const Protobuf::Message& message);
 
+  /**
+   * Structural equality matching hash(): messages are equal if they have the same set fields with
+   * equal values, regardless of the order of map entries and of the serialization of known types in
+   * google.protobuf.Any. Unlike Protobuf::util::MessageDifferencer::Equivalent(), a set empty
+   * message field doesn't equal an unset one, as they hash differently.
+   */
+  static bool equal(const Protobuf::Message& lhs, const Protobuf::Message& rhs);
+
   static void loadFromJson(const std::string& json, Protobuf::Message& message,
                            ProtobufMessage::ValidationVisitor& validation_visitor,
                            bool do_boosting = true);
@@ -945,13 +945,14 @@ RouteConstSharedPtr ConnectRouteEntryImpl::matches(const Http::RequestHeaderMap&
 }
 
 VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& virtual_host,
-                                 const ConfigImpl& global_route_config,
+                                 const CommonConfigSharedPtr& global_route_config,
                                  Server::Configuration::ServerFactoryContext& factory_context,
-                                 Stats::Scope& scope, ProtobufMessage::ValidationVisitor& validator,
+                                 ProtobufMessage::ValidationVisitor& validator,
                                  bool validate_clusters)
-    : stat_name_pool_(factory_context.scope().symbolTable()),
+    : config_(virtual_host), stat_name_pool_(factory_context.scope().symbolTable()),
       stat_name_(stat_name_pool_.add(virtual_host.name())),
-      vcluster_scope_(scope.createScope(virtual_host.name() + ".vcluster")),
+      vcluster_scope_(
+          global_route_config->vhostScope().createScope(virtual_host.name() + ".vcluster")),
       rate_limit_policy_(virtual_host.rate_limits()), global_route_config_(global_route_config),
       request_headers_parser_(HeaderParser::configure(virtual_host.request_headers_to_add(),
                                                       virtual_host.request_headers_to_remove())),
@@ -1010,17 +1011,10 @@ VirtualHostImpl::VirtualHostImpl(const envoy::config::route::v3::VirtualHost& vi
     case envoy::config::route::v3::RouteMatch::PathSpecifierCase::PATH_SPECIFIER_NOT_SET:
       NOT_REACHED_GCOVR_EXCL_LINE;
     }
+  }
 
-    if (validate_clusters) {
-      routes_.back()->validateClusters(factory_context.clusterManager());
-      for (const auto& shadow_policy : routes_.back()->shadowPolicies()) {
-        ASSERT(!shadow_policy->cluster().empty());
-        if (!factory_context.clusterManager().get(shadow_policy->cluster())) {
-          throw EnvoyException(
-              fmt::format("route: unknown shadow cluster '{}'", shadow_policy->cluster()));
-        }
-      }
-    }
+  if (validate_clusters) {
+    validateClusters(factory_context.clusterManager());
   }
 
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
@@ -1064,7 +1058,20 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   }
 }
 
-const Config& VirtualHostImpl::routeConfig() const { return global_route_config_; }
+void VirtualHostImpl::validateClusters(Upstream::ClusterManager& cm) const {
+  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+    route->validateClusters(cm);
+    for (const auto& shadow_policy : route->shadowPolicies()) {
+      ASSERT(!shadow_policy->cluster().empty());
+      if (!cm.get(shadow_policy->cluster())) {
+        throw EnvoyException(
+            fmt::format("route: unknown shadow cluster '{}'", shadow_policy->cluster()));
+      }
+    }
+  }
+}
+
+const CommonConfig& VirtualHostImpl::routeConfig() const { return *global_route_config_; }
 
 const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::string& name) const {
   return per_filter_configs_.get(name);
@@ -1093,14 +1100,29 @@ const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(
 }
 
 RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& route_config,
-                           const ConfigImpl& global_route_config,
+                           const CommonConfigSharedPtr& global_route_config,
                            Server::Configuration::ServerFactoryContext& factory_context,
-                           ProtobufMessage::ValidationVisitor& validator, bool validate_clusters)
-    : vhost_scope_(factory_context.scope().createScope("vhost")) {
+                           ProtobufMessage::ValidationVisitor& validator, bool validate_clusters,
+                           const RouteMatcher* previous) {
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
-    VirtualHostSharedPtr virtual_host(new VirtualHostImpl(virtual_host_config, global_route_config,
-                                                          factory_context, *vhost_scope_, validator,
-                                                          validate_clusters));
+    const uint64_t hash = MessageUtil::hash(virtual_host_config);
+    VirtualHostSharedPtr virtual_host;
+    if (previous != nullptr) {
+      const auto reusable = previous->virtual_hosts_by_hash_.find(hash);
+      if (reusable != previous->virtual_hosts_by_hash_.end() &&
+          MessageUtil::equal(reusable->second->config(), virtual_host_config)) {
+        virtual_host = reusable->second;
+        if (validate_clusters) {
+          virtual_host->validateClusters(factory_context.clusterManager());
+        }
+      }
+    }
+    if (virtual_host == nullptr) {
+      virtual_host = std::make_shared<VirtualHostImpl>(virtual_host_config, global_route_config,
+                                                       factory_context, validator,
+                                                       validate_clusters);
+    }
+    virtual_hosts_by_hash_.emplace(hash, virtual_host);
     for (const std::string& domain_name : virtual_host_config.domains()) {
       const std::string domain = Http::LowerCaseString(domain_name).get();
       bool duplicate_found = false;
@@ -1230,17 +1252,11 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
   return nullptr;
 }
 
-ConfigImpl::ConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
-                       Server::Configuration::ServerFactoryContext& factory_context,
-                       ProtobufMessage::ValidationVisitor& validator,
-                       bool validate_clusters_default)
-    : name_(config.name()), symbol_table_(factory_context.scope().symbolTable()),
-      uses_vhds_(config.has_vhds()),
-      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()) {
-  route_matcher_ = std::make_unique<RouteMatcher>(
-      config, *this, factory_context, validator,
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default));
-
+CommonConfigImpl::CommonConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
+                                   Server::Configuration::ServerFactoryContext& factory_context)
+    : common_fields_(commonFields(config)), name_(config.name()), uses_vhds_(config.has_vhds()),
+      most_specific_header_mutations_wins_(config.most_specific_header_mutations_wins()),
+      vhost_scope_(factory_context.scope().createScope("vhost")) {
   for (const std::string& header : config.internal_only_headers()) {
     internal_only_headers_.push_back(Http::LowerCaseString(header));
   }
@@ -1251,6 +1267,41 @@ ConfigImpl::ConfigImpl(const envoy::config::route::v3::RouteConfiguration& confi
                                                      config.response_headers_to_remove());
 }
 
+envoy::config::route::v3::RouteConfiguration
+CommonConfigImpl::commonFields(const envoy::config::route::v3::RouteConfiguration& config) {
+  // Only the fields read by the constructor, so that the virtual hosts are not compared twice.
+  envoy::config::route::v3::RouteConfiguration common_config;
+  common_config.set_name(config.name());
+  *common_config.mutable_internal_only_headers() = config.internal_only_headers();
+  *common_config.mutable_request_headers_to_add() = config.request_headers_to_add();
+  *common_config.mutable_request_headers_to_remove() = config.request_headers_to_remove();
+  *common_config.mutable_response_headers_to_add() = config.response_headers_to_add();
+  *common_config.mutable_response_headers_to_remove() = config.response_headers_to_remove();
+  if (config.has_vhds()) {
+    *common_config.mutable_vhds() = config.vhds();
+  }
+  common_config.set_most_specific_header_mutations_wins(
+      config.most_specific_header_mutations_wins());
+  return common_config;
+}
+
+ConfigImpl::ConfigImpl(const envoy::config::route::v3::RouteConfiguration& config,
+                       Server::Configuration::ServerFactoryContext& factory_context,
+                       ProtobufMessage::ValidationVisitor& validator,
+                       bool validate_clusters_default, const ConfigImpl* previous) {
+  if (previous != nullptr && MessageUtil::equal(previous->shared_config_->commonFields(),
+                                                CommonConfigImpl::commonFields(config))) {
+    shared_config_ = previous->shared_config_;
+  } else {
+    shared_config_ = std::make_shared<CommonConfigImpl>(config, factory_context);
+    previous = nullptr;
+  }
+  route_matcher_ = std::make_unique<RouteMatcher>(
+      config, shared_config_, factory_context, validator,
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default),
+      previous != nullptr ? previous->route_matcher_.get() : nullptr);
+}
+
 namespace {
 
 RouteSpecificFilterConfigConstSharedPtr
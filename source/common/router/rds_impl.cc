@@ -233,8 +233,9 @@ RdsRouteConfigProviderImpl::RdsRouteConfigProviderImpl(
       tls_(factory_context.threadLocal().allocateSlot()) {
   ConfigConstSharedPtr initial_config;
   if (config_update_info_->configInfo().has_value()) {
-    initial_config = std::make_shared<ConfigImpl>(config_update_info_->routeConfiguration(),
-                                                  factory_context_, validator_, false);
+    main_thread_config_ = std::make_shared<ConfigImpl>(config_update_info_->routeConfiguration(),
+                                                       factory_context_, validator_, false);
+    initial_config = main_thread_config_;
   } else {
     initial_config = std::make_shared<NullConfigImpl>();
   }
@@ -257,8 +258,10 @@ Router::ConfigConstSharedPtr RdsRouteConfigProviderImpl::config() {
 }
 
 void RdsRouteConfigProviderImpl::onConfigUpdate() {
-  ConfigConstSharedPtr new_config(new ConfigImpl(config_update_info_->routeConfiguration(),
-                                                 factory_context_, validator_, false));
+  main_thread_config_ =
+      std::make_shared<ConfigImpl>(config_update_info_->routeConfiguration(), factory_context_,
+                                   validator_, false, main_thread_config_.get());
+  ConfigConstSharedPtr new_config = main_thread_config_;
   tls_->runOnAllThreads([new_config](ThreadLocal::ThreadLocalObjectSharedPtr previous)
                             -> ThreadLocal::ThreadLocalObjectSharedPtr {
     auto prev_config = std::dynamic_pointer_cast<ThreadLocalConfig>(previous);
@@ -272,7 +275,7 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
     return;
   }
 
-  const auto config = std::static_pointer_cast<const ConfigImpl>(new_config);
+  const auto& config = main_thread_config_;
   // Notifies connections that RouteConfiguration update has been propagated.
   // Callbacks processing is performed in FIFO order. The callback is skipped if alias used in
   // the VHDS update request do not match the aliases in the update response
@@ -299,7 +302,8 @@ void RdsRouteConfigProviderImpl::onConfigUpdate() {
 void RdsRouteConfigProviderImpl::validateConfig(
     const envoy::config::route::v3::RouteConfiguration& config) const {
   // TODO(lizan): consider cache the config here until onConfigUpdate.
-  ConfigImpl validation_config(config, factory_context_, validator_, false);
+  ConfigImpl validation_config(config, factory_context_, validator_, false,
+                               main_thread_config_.get());
 }
 
 // Schedules a VHDS request on the main thread and queues up the callback to use when the VHDS
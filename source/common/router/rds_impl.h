@@ -27,10 +27,12 @@
 #include "common/common/callback_impl.h"
 #include "common/common/cleanup.h"
 #include "common/common/logger.h"
+#include "common/config/utility.h"
 #include "common/init/manager_impl.h"
 #include "common/init/target_impl.h"
 #include "common/init/watcher_impl.h"
 #include "common/protobuf/utility.h"
+#include "common/router/config_impl.h"
 #include "common/router/route_config_update_receiver_impl.h"
 #include "common/router/vhds.h"
 
@@ -137,7 +139,8 @@ private:
   void onConfigUpdateFailed(Envoy::Config::ConfigUpdateFailureReason reason,
                             const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
-    return MessageUtil::anyConvert<envoy::config::route::v3::RouteConfiguration>(resource).name();
+    return Envoy::Config::Utility::resourceNameFromAny(
+        resource, envoy::config::route::v3::RouteConfiguration::kNameFieldNumber);
   }
 
   Common::CallbackHandle* addUpdateCallback(std::function<void()> callback) {
@@ -225,6 +228,8 @@ private:
   RouteConfigUpdatePtr& config_update_info_;
   Server::Configuration::ServerFactoryContext& factory_context_;
   ProtobufMessage::ValidationVisitor& validator_;
+  // The latest configuration. The next one reuses its virtual hosts which did not change.
+  std::shared_ptr<const ConfigImpl> main_thread_config_;
   ThreadLocal::SlotPtr tls_;
   std::list<UpdateOnDemandCallback> config_update_callbacks_;
 
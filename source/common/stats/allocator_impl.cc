@@ -228,6 +228,89 @@ private:
   std::atomic<uint64_t> value_{0};
 };
 
+// Counter whose value lives in a slot of a MappedStatsRegion, so it is shared with any other
+// process which maps the same region. Increments that have not been latched yet are tracked per
+// process, so each process only reports its own increments to its sinks.
+class MappedCounterImpl : public StatsSharedImpl<Counter> {
+public:
+  MappedCounterImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
+                    const StatNameTagVector& stat_name_tags, std::atomic<uint64_t>& value)
+      : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags), value_(value) {
+    // A value adopted from a previous process counts as a use, as it would have had it been
+    // merged from the parent over the hot restart RPC.
+    if (value_ != 0) {
+      flags_ |= Flags::Used;
+    }
+  }
+  ~MappedCounterImpl() override { alloc_.mapped_region_->release(&value_); }
+
+  void removeFromSetLockHeld() EXCLUSIVE_LOCKS_REQUIRED(alloc_.mutex_) override {
+    const size_t count = alloc_.counters_.erase(statName());
+    ASSERT(count == 1);
+  }
+
+  // Stats::Counter
+  void add(uint64_t amount) override {
+    value_ += amount;
+    pending_increment_ += amount;
+    flags_ |= Flags::Used;
+  }
+  void inc() override { add(1); }
+  uint64_t latch() override { return pending_increment_.exchange(0); }
+  void reset() override { value_ = 0; }
+  uint64_t value() const override { return value_; }
+
+private:
+  std::atomic<uint64_t>& value_;
+  std::atomic<uint64_t> pending_increment_{0};
+};
+
+// Accumulating gauge whose value lives in a slot of a MappedStatsRegion. Gauges with any other
+// import mode are not meant to be combined across processes and are always heap allocated.
+class MappedGaugeImpl : public StatsSharedImpl<Gauge> {
+public:
+  MappedGaugeImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
+                  const StatNameTagVector& stat_name_tags, std::atomic<uint64_t>& value)
+      : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags), value_(value) {
+    flags_ |= Flags::LogicAccumulate;
+    if (value_ != 0) {
+      flags_ |= Flags::Used;
+    }
+  }
+  ~MappedGaugeImpl() override { alloc_.mapped_region_->release(&value_); }
+
+  void removeFromSetLockHeld() override EXCLUSIVE_LOCKS_REQUIRED(alloc_.mutex_) {
+    const size_t count = alloc_.gauges_.erase(statName());
+    ASSERT(count == 1);
+  }
+
+  // Stats::Gauge
+  void add(uint64_t amount) override {
+    value_ += amount;
+    flags_ |= Flags::Used;
+  }
+  void dec() override { sub(1); }
+  void inc() override { add(1); }
+  void set(uint64_t value) override {
+    value_ = value;
+    flags_ |= Flags::Used;
+  }
+  void sub(uint64_t amount) override {
+    // Another process may have driven the shared value down concurrently, so unlike GaugeImpl
+    // this cannot assert that the value stays non-negative.
+    value_ -= amount;
+  }
+  uint64_t value() const override { return value_; }
+  ImportMode importMode() const override { return ImportMode::Accumulate; }
+  void mergeImportMode(ImportMode import_mode) override {
+    // Only Uninitialized may be merged into an established import mode.
+    ASSERT(import_mode == ImportMode::Accumulate || import_mode == ImportMode::Uninitialized);
+  }
+
+private:
+  std::atomic<uint64_t>& value_;
+};
+
 class TextReadoutImpl : public StatsSharedImpl<TextReadout> {
 public:
   TextReadoutImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
@@ -264,7 +347,14 @@ CounterSharedPtr AllocatorImpl::makeCounter(StatName name, StatName tag_extracte
   if (iter != counters_.end()) {
     return CounterSharedPtr(*iter);
   }
-  auto counter = CounterSharedPtr(new CounterImpl(name, *this, tag_extracted_name, stat_name_tags));
+  CounterSharedPtr counter;
+  std::atomic<uint64_t>* value = allocateMappedValue(name, MappedStatsRegion::Type::Counter);
+  if (value != nullptr) {
+    counter = CounterSharedPtr(
+        new MappedCounterImpl(name, *this, tag_extracted_name, stat_name_tags, *value));
+  } else {
+    counter = CounterSharedPtr(new CounterImpl(name, *this, tag_extracted_name, stat_name_tags));
+  }
   counters_.insert(counter.get());
   return counter;
 }
@@ -279,8 +369,17 @@ GaugeSharedPtr AllocatorImpl::makeGauge(StatName name, StatName tag_extracted_na
   if (iter != gauges_.end()) {
     return GaugeSharedPtr(*iter);
   }
-  auto gauge =
-      GaugeSharedPtr(new GaugeImpl(name, *this, tag_extracted_name, stat_name_tags, import_mode));
+  GaugeSharedPtr gauge;
+  std::atomic<uint64_t>* value = import_mode == Gauge::ImportMode::Accumulate
+                                     ? allocateMappedValue(name, MappedStatsRegion::Type::Gauge)
+                                     : nullptr;
+  if (value != nullptr) {
+    gauge = GaugeSharedPtr(
+        new MappedGaugeImpl(name, *this, tag_extracted_name, stat_name_tags, *value));
+  } else {
+    gauge =
+        GaugeSharedPtr(new GaugeImpl(name, *this, tag_extracted_name, stat_name_tags, import_mode));
+  }
   gauges_.insert(gauge.get());
   return gauge;
 }
@@ -300,6 +399,14 @@ TextReadoutSharedPtr AllocatorImpl::makeTextReadout(StatName name, StatName tag_
   return text_readout;
 }
 
+std::atomic<uint64_t>* AllocatorImpl::allocateMappedValue(StatName name,
+                                                          MappedStatsRegion::Type type) {
+  if (mapped_region_ == nullptr) {
+    return nullptr;
+  }
+  return mapped_region_->allocate(symbol_table_.toString(name), type);
+}
+
 bool AllocatorImpl::isMutexLockedForTest() {
   bool locked = mutex_.tryLock();
   if (locked) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include "envoy/stats/allocator.h"
@@ -7,6 +8,7 @@
 #include "envoy/stats/symbol_table.h"
 
 #include "common/common/thread_synchronizer.h"
+#include "common/stats/mapped_stats_region.h"
 #include "common/stats/metric_impl.h"
 
 #include "absl/container/flat_hash_set.h"
@@ -37,6 +39,14 @@ public:
   void debugPrint();
 #endif
 
+  /**
+   * Backs subsequently allocated counters and accumulating gauges with slots in a memory-mapped
+   * region, falling back to the heap for stats that do not fit. This must be called before any
+   * stats are allocated, and the region must outlive them.
+   * @param region supplies the region, or nullptr to allocate all stats on the heap.
+   */
+  void setMappedStatsRegion(MappedStatsRegion* region) { mapped_region_ = region; }
+
   /**
    * @return a thread synchronizer object used for reproducing a race-condition in tests.
    */
@@ -52,6 +62,8 @@ private:
   friend class CounterImpl;
   friend class GaugeImpl;
   friend class TextReadoutImpl;
+  friend class MappedCounterImpl;
+  friend class MappedGaugeImpl;
 
   struct HeapStatHash {
     using is_transparent = void; // NOLINT(readability-identifier-naming)
@@ -67,6 +79,8 @@ private:
     bool operator()(const Metric* a, StatName b) const { return a->statName() == b; }
   };
 
+  std::atomic<uint64_t>* allocateMappedValue(StatName name, MappedStatsRegion::Type type)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void removeCounterFromSetLockHeld(Counter* counter) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void removeGaugeFromSetLockHeld(Gauge* gauge) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void removeTextReadoutFromSetLockHeld(Counter* counter) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -81,6 +95,7 @@ private:
   StatSet<TextReadout> text_readouts_ GUARDED_BY(mutex_);
 
   SymbolTable& symbol_table_;
+  MappedStatsRegion* mapped_region_{};
 
   // A mutex is needed here to protect both the stats_ object from both
   // alloc() and free() operations. Although alloc() operations are called under existing locking,
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/stats/histogram.h"
+#include "envoy/stats/refcount_ptr.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats.h"
+
+#include "common/common/non_copyable.h"
+#include "common/stats/null_gauge.h"
+#include "common/stats/symbol_table_impl.h"
+#include "common/stats/utility.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Metric proxy which defers the creation of the backing metric in a scope until the first time
+ * the metric is written to. Until then, reads return zero and nothing is allocated in the store,
+ * so the metric does not show up in admin output or stats sinks.
+ *
+ * The name of the metric is answered from the stored name, without creating the backing metric.
+ * Tags are extracted by the store when it creates the backing metric, so until then the metric
+ * reports no tags and its full name as its tag extracted name.
+ *
+ * Concurrent first writes from multiple threads may race to create the backing metric. This is
+ * benign as the scope de-duplicates metrics by name and returns the same object to all callers.
+ */
+template <class BaseClass> class LazyMetricImpl : public BaseClass, NonCopyable {
+public:
+  // Metric
+  std::string name() const override { return constSymbolTable().toString(statName()); }
+  StatName statName() const override { return StatName(full_name_.get()); }
+  TagVector tags() const override {
+    const BaseClass* metric = materialized();
+    return metric != nullptr ? metric->tags() : TagVector();
+  }
+  std::string tagExtractedName() const override {
+    const BaseClass* metric = materialized();
+    return metric != nullptr ? metric->tagExtractedName() : name();
+  }
+  StatName tagExtractedStatName() const override {
+    const BaseClass* metric = materialized();
+    return metric != nullptr ? metric->tagExtractedStatName() : statName();
+  }
+  void iterateTagStatNames(const Metric::TagStatNameIterFn& fn) const override {
+    const BaseClass* metric = materialized();
+    if (metric != nullptr) {
+      metric->iterateTagStatNames(fn);
+    }
+  }
+  bool used() const override {
+    const BaseClass* metric = materialized();
+    return metric != nullptr && metric->used();
+  }
+  SymbolTable& symbolTable() override { return scope_.symbolTable(); }
+  const SymbolTable& constSymbolTable() const override { return scope_.constSymbolTable(); }
+
+  // RefcountInterface
+  void incRefCount() override { refcount_helper_.incRefCount(); }
+  bool decRefCount() override { return refcount_helper_.decRefCount(); }
+  uint32_t use_count() const override { return refcount_helper_.use_count(); }
+
+  /**
+   * @return whether the backing metric has been created in the scope.
+   */
+  bool isMaterialized() const { return materialized() != nullptr; }
+
+protected:
+  /**
+   * @param scope supplies the scope the backing metric is created in.
+   * @param prefix supplies the prefix of the scope.
+   * @param name supplies the name of the metric relative to the scope. The storage of the prefix
+   *        and the name must outlive the metric.
+   */
+  LazyMetricImpl(Scope& scope, StatName prefix, StatName name)
+      : scope_(scope), name_(name), full_name_(scope.symbolTable().join({prefix, name})) {}
+
+  /**
+   * @return the backing metric, creating it in the scope if needed.
+   */
+  BaseClass& metric() const {
+    BaseClass* metric = metric_.load(std::memory_order_acquire);
+    if (metric == nullptr) {
+      metric = &create();
+      metric_.store(metric, std::memory_order_release);
+    }
+    return *metric;
+  }
+
+  /**
+   * @return the backing metric if it has already been created, nullptr otherwise.
+   */
+  BaseClass* materialized() const { return metric_.load(std::memory_order_acquire); }
+
+  /**
+   * Creates (or looks up) the backing metric in the scope.
+   */
+  virtual BaseClass& create() const PURE;
+
+  Scope& scope_;
+  const StatName name_;
+
+private:
+  // The prefix joined with the name. This references the symbols of both, so it needs no symbols
+  // of its own.
+  const SymbolTable::StoragePtr full_name_;
+  mutable std::atomic<BaseClass*> metric_{nullptr};
+  RefcountHelper refcount_helper_;
+};
+
+/**
+ * Counter that is created in its scope on the first increment.
+ */
+class LazyCounterImpl : public LazyMetricImpl<Counter> {
+public:
+  LazyCounterImpl(Scope& scope, StatName prefix, StatName name)
+      : LazyMetricImpl<Counter>(scope, prefix, name) {}
+
+  // Stats::Counter
+  void add(uint64_t amount) override { metric().add(amount); }
+  void inc() override { metric().inc(); }
+  uint64_t latch() override {
+    Counter* counter = materialized();
+    return counter != nullptr ? counter->latch() : 0;
+  }
+  void reset() override {
+    Counter* counter = materialized();
+    if (counter != nullptr) {
+      counter->reset();
+    }
+  }
+  uint64_t value() const override {
+    const Counter* counter = materialized();
+    return counter != nullptr ? counter->value() : 0;
+  }
+
+private:
+  Counter& create() const override { return scope_.counterFromStatName(name_); }
+};
+
+/**
+ * Gauge that is created in its scope on the first write that leaves it non-zero. Setting a gauge
+ * which was never created to zero is a no-op, which lets membership style gauges on idle
+ * clusters stay unallocated.
+ */
+class LazyGaugeImpl : public LazyMetricImpl<Gauge> {
+public:
+  LazyGaugeImpl(Scope& scope, StatName prefix, StatName name, ImportMode import_mode)
+      : LazyMetricImpl<Gauge>(scope, prefix, name), import_mode_(import_mode) {}
+
+  // Stats::Gauge
+  void add(uint64_t amount) override { metric().add(amount); }
+  void dec() override { metric().dec(); }
+  void inc() override { metric().inc(); }
+  void set(uint64_t value) override {
+    if (value == 0 && !isMaterialized()) {
+      return;
+    }
+    metric().set(value);
+  }
+  void sub(uint64_t amount) override { metric().sub(amount); }
+  uint64_t value() const override {
+    const Gauge* gauge = materialized();
+    return gauge != nullptr ? gauge->value() : 0;
+  }
+  ImportMode importMode() const override {
+    const Gauge* gauge = materialized();
+    return gauge != nullptr ? gauge->importMode() : import_mode_;
+  }
+  void mergeImportMode(ImportMode import_mode) override { metric().mergeImportMode(import_mode); }
+
+private:
+  Gauge& create() const override { return scope_.gaugeFromStatName(name_, import_mode_); }
+
+  const ImportMode import_mode_;
+};
+
+/**
+ * Histogram that is created in its scope on the first recorded value.
+ */
+class LazyHistogramImpl : public LazyMetricImpl<Histogram> {
+public:
+  LazyHistogramImpl(Scope& scope, StatName prefix, StatName name, Unit unit)
+      : LazyMetricImpl<Histogram>(scope, prefix, name), unit_(unit) {}
+
+  // Stats::Histogram
+  Unit unit() const override { return unit_; }
+  void recordValue(uint64_t value) override { metric().recordValue(value); }
+
+private:
+  Histogram& create() const override { return scope_.histogramFromStatName(name_, unit_); }
+
+  const Unit unit_;
+};
+
+/**
+ * Interns the names of lazily created metrics relative to their scopes, so that the pools of many
+ * scopes with the same metrics share one copy of each name.
+ */
+class LazyMetricNames : NonCopyable {
+public:
+  explicit LazyMetricNames(SymbolTable& symbol_table) : pool_(symbol_table) {}
+
+  /**
+   * @return the interned name, which lives as long as this object.
+   */
+  StatName add(absl::string_view name) {
+    absl::MutexLock lock(&mutex_);
+    const auto it = names_.find(name);
+    if (it != names_.end()) {
+      return it->second;
+    }
+    const StatName stat_name = pool_.add(name);
+    names_.emplace(name, stat_name);
+    return stat_name;
+  }
+
+private:
+  absl::Mutex mutex_;
+  StatNamePool pool_ GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, StatName> names_ GUARDED_BY(mutex_);
+};
+
+/**
+ * Owns a set of lazily created metrics for a scope. This exposes the same factory methods as a
+ * Scope, so it can be passed to POOL_COUNTER() and friends from stats_macros.h to instantiate a
+ * stats struct whose members are only created in the scope when first written to. The pool must
+ * not outlive the scope or the set of names.
+ */
+class LazyMetricPool : NonCopyable {
+public:
+  /**
+   * @param scope supplies the scope the metrics are created in.
+   * @param prefix supplies the prefix the scope was created with.
+   * @param names supplies the names of the metrics relative to the scope, which can be shared by
+   *        the pools of many scopes with the same metrics.
+   */
+  LazyMetricPool(Scope& scope, absl::string_view prefix, LazyMetricNames& names)
+      : scope_(scope), prefix_(Utility::sanitizeStatsName(prefix), scope.symbolTable()),
+        names_(names) {}
+
+  Counter& counterFromString(const std::string& name) {
+    return add(std::make_unique<LazyCounterImpl>(scope_, prefix_.statName(), names_.add(name)));
+  }
+  Gauge& gaugeFromString(const std::string& name, Gauge::ImportMode import_mode) {
+    return add(std::make_unique<LazyGaugeImpl>(scope_, prefix_.statName(), names_.add(name),
+                                               import_mode));
+  }
+  Histogram& histogramFromString(const std::string& name, Histogram::Unit unit) {
+    return add(
+        std::make_unique<LazyHistogramImpl>(scope_, prefix_.statName(), names_.add(name), unit));
+  }
+  NullGaugeImpl& nullGauge(const std::string& name) { return scope_.nullGauge(name); }
+
+private:
+  template <class MetricType> MetricType& add(std::unique_ptr<MetricType>&& metric) {
+    MetricType& ref = *metric;
+    metrics_.emplace_back(std::move(metric));
+    return ref;
+  }
+
+  Scope& scope_;
+  StatNameManagedStorage prefix_;
+  LazyMetricNames& names_;
+  std::vector<std::unique_ptr<Metric>> metrics_;
+};
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,258 @@
+#include "common/stats/mapped_stats_region.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Stats {
+
+namespace {
+
+constexpr char Magic[8] = {'E', 'N', 'V', 'S', 'T', 'A', 'T', 'S'};
+
+// Number of times to yield while waiting for another process to finish claiming a slot before
+// giving up and letting the caller fall back to the heap. The claim is a handful of stores, so
+// this only trips if the other process died part way through. The caller holds the allocator
+// lock, so the wait is kept short and is paid at most once per stale slot.
+constexpr uint32_t MaxClaimWaitIterations = 100;
+
+enum SlotState : uint32_t { Empty = 0, Claiming = 1 };
+
+} // namespace
+
+struct MappedStatsRegion::Header {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t slot_size_;
+  uint64_t num_slots_;
+  std::atomic<uint64_t> num_used_slots_;
+  std::atomic<uint64_t> max_probe_length_;
+  uint8_t padding_[HeaderSize - 40];
+};
+
+struct MappedStatsRegion::Slot {
+  std::atomic<uint64_t> value_;
+  std::atomic<uint32_t> state_;
+  std::atomic<uint32_t> users_;
+  uint64_t name_hash_;
+  uint16_t name_length_;
+  char name_[SlotSize - SlotNameOffset];
+
+  absl::string_view name() const { return {name_, name_length_}; }
+};
+
+// The region is shared between processes, so the atomics must not fall back to a lock that lives
+// in only one of them, and the structs must match the documented layout exactly.
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics must be lock-free");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "unexpected atomic size");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "unexpected atomic size");
+
+MappedStatsRegion::MappedStatsRegion(const std::string& path, void* memory, size_t size)
+    : path_(path), memory_(memory), size_(size), header_(static_cast<Header*>(memory)) {
+  static_assert(sizeof(Header) == HeaderSize, "header does not match the documented layout");
+  static_assert(sizeof(Slot) == SlotSize, "slot does not match the documented layout");
+  static_assert(offsetof(Slot, name_) == SlotNameOffset,
+                "slot name is not at the documented offset");
+}
+
+MappedStatsRegion::~MappedStatsRegion() { ::munmap(memory_, size_); }
+
+std::unique_ptr<MappedStatsRegion> MappedStatsRegion::create(const std::string& path,
+                                                             uint32_t num_slots, bool reset) {
+  // A reset region is created in a new file rather than by truncating the existing one, which
+  // processes of an earlier hot restart chain may still have mapped.
+  if (reset && ::unlink(path.c_str()) == -1 && errno != ENOENT) {
+    throw EnvoyException(
+        fmt::format("cannot remove stats region {}: {}", path, ::strerror(errno)));
+  }
+  int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (reset ? O_CREAT | O_EXCL : 0),
+                  S_IRUSR | S_IWUSR | S_IRGRP);
+  bool initialize = reset;
+  if (fd == -1 && !reset && errno == ENOENT) {
+    fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP);
+    initialize = true;
+  }
+  if (fd == -1) {
+    throw EnvoyException(fmt::format("cannot open stats region {}: {}", path, ::strerror(errno)));
+  }
+
+  size_t size;
+  if (initialize) {
+    size = HeaderSize + static_cast<size_t>(num_slots) * SlotSize;
+    // A sparse file zero-fills the slots, which is the empty state.
+    if (::ftruncate(fd, size) == -1) {
+      const int error = errno;
+      ::close(fd);
+      throw EnvoyException(fmt::format("cannot size stats region {}: {}", path, ::strerror(error)));
+    }
+  } else {
+    struct stat stat_buf;
+    if (::fstat(fd, &stat_buf) == -1 || static_cast<size_t>(stat_buf.st_size) < HeaderSize) {
+      ::close(fd);
+      throw EnvoyException(fmt::format("stats region {} is truncated", path));
+    }
+    size = stat_buf.st_size;
+  }
+
+  void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const int mmap_error = errno;
+  // The mapping stays valid once the descriptor is closed.
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    throw EnvoyException(
+        fmt::format("cannot map stats region {}: {}", path, ::strerror(mmap_error)));
+  }
+
+  std::unique_ptr<MappedStatsRegion> region(new MappedStatsRegion(path, memory, size));
+  Header& header = *region->header_;
+  if (initialize) {
+    header.version_ = Version;
+    header.slot_size_ = SlotSize;
+    header.num_slots_ = num_slots;
+    header.num_used_slots_.store(0);
+    header.max_probe_length_.store(0);
+    // Scrapers check the magic last, so a partially initialized region is never trusted.
+    std::atomic_thread_fence(std::memory_order_release);
+    ::memcpy(header.magic_, Magic, sizeof(Magic));
+  } else if (::memcmp(header.magic_, Magic, sizeof(Magic)) != 0 || header.version_ != Version ||
+             header.slot_size_ != SlotSize ||
+             HeaderSize + header.num_slots_ * SlotSize != size || header.num_slots_ == 0) {
+    // The destructor unmaps the region.
+    throw EnvoyException(fmt::format(
+        "stats region {} has an incompatible layout; was it created by a different version "
+        "of Envoy?",
+        path));
+  }
+  return region;
+}
+
+MappedStatsRegion::Slot* MappedStatsRegion::slot(uint64_t index) const {
+  return reinterpret_cast<Slot*>(static_cast<char*>(memory_) + HeaderSize + index * SlotSize);
+}
+
+uint64_t MappedStatsRegion::numSlots() const { return header_->num_slots_; }
+
+uint64_t MappedStatsRegion::numUsedSlots() const { return header_->num_used_slots_.load(); }
+
+std::atomic<uint64_t>* MappedStatsRegion::allocate(absl::string_view name, Type type) {
+  if (name.size() > maxNameLength()) {
+    return nullptr;
+  }
+
+  const uint64_t hash = HashUtil::xxHash64(name);
+  const uint64_t num_slots = numSlots();
+  // Once every slot is claimed, only the stats already in the region can be found, all within the
+  // longest probe sequence of a claim, so fail fast rather than probing the whole region for each
+  // new stat. The acquire load pairs with the release increment of each claim, which follows its
+  // update of the longest probe sequence.
+  const uint64_t max_probes =
+      header_->num_used_slots_.load(std::memory_order_acquire) >= num_slots
+          ? std::min(num_slots, header_->max_probe_length_.load(std::memory_order_relaxed))
+          : num_slots;
+  for (uint64_t probe = 0; probe < max_probes; ++probe) {
+    Slot& candidate = *slot((hash + probe) % num_slots);
+    uint32_t state = candidate.state_.load(std::memory_order_acquire);
+    if (state == Empty &&
+        candidate.state_.compare_exchange_strong(state, Claiming, std::memory_order_acquire)) {
+      candidate.value_.store(0, std::memory_order_relaxed);
+      candidate.users_.store(1, std::memory_order_relaxed);
+      candidate.name_hash_ = hash;
+      candidate.name_length_ = name.size();
+      ::memcpy(candidate.name_, name.data(), name.size());
+      candidate.state_.store(static_cast<uint32_t>(type), std::memory_order_release);
+      uint64_t max_probe_length = header_->max_probe_length_.load(std::memory_order_relaxed);
+      while (max_probe_length < probe + 1 &&
+             !header_->max_probe_length_.compare_exchange_weak(max_probe_length, probe + 1,
+                                                               std::memory_order_relaxed)) {
+      }
+      header_->num_used_slots_.fetch_add(1, std::memory_order_release);
+      return &candidate.value_;
+    }
+
+    if (state == Claiming && !waitForClaim(candidate, (hash + probe) % num_slots, state)) {
+      return nullptr;
+    }
+
+    if (candidate.name_hash_ != hash || candidate.name() != name) {
+      continue;
+    }
+    if (state != static_cast<uint32_t>(type)) {
+      return nullptr;
+    }
+    // The value is kept even if no process was referencing the slot, as the child of a hot
+    // restart may only create a stat after the parent which last updated it has exited.
+    candidate.users_.fetch_add(1, std::memory_order_relaxed);
+    return &candidate.value_;
+  }
+  return nullptr;
+}
+
+bool MappedStatsRegion::waitForClaim(const Slot& candidate, uint64_t index, uint32_t& state) {
+  {
+    Thread::LockGuard lock(stale_claims_mutex_);
+    if (stale_claims_.contains(index)) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < MaxClaimWaitIterations; ++i) {
+    std::this_thread::yield();
+    state = candidate.state_.load(std::memory_order_acquire);
+    if (state != Claiming) {
+      return true;
+    }
+  }
+  // The claimer is presumed dead, so later allocations probing past the slot fall back to the heap
+  // right away instead of waiting again.
+  Thread::LockGuard lock(stale_claims_mutex_);
+  stale_claims_.insert(index);
+  return false;
+}
+
+void MappedStatsRegion::release(std::atomic<uint64_t>* value) {
+  // value_ is the first member of the slot.
+  Slot* released = reinterpret_cast<Slot*>(value);
+  ASSERT(released->users_.load() > 0);
+  released->users_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+const MappedStatsRegion::Slot* MappedStatsRegion::find(absl::string_view name,
+                                                       uint64_t hash) const {
+  const uint64_t num_slots = numSlots();
+  // No stat lies further than the longest probe sequence of a claim from its hash.
+  const uint64_t max_probes =
+      std::min(num_slots, header_->max_probe_length_.load(std::memory_order_acquire));
+  for (uint64_t probe = 0; probe < max_probes; ++probe) {
+    const Slot& candidate = *slot((hash + probe) % num_slots);
+    const uint32_t state = candidate.state_.load(std::memory_order_acquire);
+    if (state == Empty) {
+      return nullptr;
+    }
+    if (state != Claiming && candidate.name_hash_ == hash && candidate.name() == name) {
+      return &candidate;
+    }
+  }
+  return nullptr;
+}
+
+bool MappedStatsRegion::contains(absl::string_view name) const {
+  return name.size() <= maxNameLength() && find(name, HashUtil::xxHash64(name)) != nullptr;
+}
+
+} // namespace Stats
+} // namespace Envoy
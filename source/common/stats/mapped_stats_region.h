@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * A file-backed, memory-mapped region holding the values of counters and gauges. When every
+ * process in a hot restart chain maps the same file, a stat with a given name is backed by the
+ * same slot in all of them, so the child picks up where the parent left off without the parent
+ * having to export the value, and increments from a draining parent keep accruing into the same
+ * slot. Because the layout is fixed and versioned, external read-only tools can also map the file
+ * and read current values without going through the admin endpoint.
+ *
+ * Layout, all integers in native byte order:
+ *
+ *   Header (64 bytes):
+ *     char[8]  magic, "ENVSTATS"
+ *     uint32   layout version, see Version
+ *     uint32   slot size in bytes, see SlotSize
+ *     uint64   number of slots
+ *     uint64   number of slots that have been claimed
+ *     uint64   longest probe sequence of a claim, in slots
+ *
+ *   Followed by an array of slots (256 bytes each):
+ *     uint64   value
+ *     uint32   state: 0=empty, 1=being claimed, 2=counter, 3=gauge
+ *     uint32   number of live processes referencing the slot
+ *     uint64   xxHash64 of the name
+ *     uint16   name length
+ *     char[]   the name, not nul-terminated
+ *
+ * Slots are found by open addressing with linear probing on the name hash. A slot is claimed with
+ * a compare-and-swap on its state, and its name is published by the release store of the final
+ * state, so readers must load the state with acquire semantics before looking at the name. Lookups
+ * stop after the longest probe sequence of a claim, so that a full region fails fast. Slots are
+ * never returned to the empty state, and keep their value when no process references them: a stat
+ * that is deleted and later created again with the same name continues from where it was.
+ *
+ * Allocation fails, and the caller should fall back to a heap allocated stat, when the region is
+ * full, the name does not fit in a slot, the name is already used by a stat of another type, or the
+ * probe sequence of the name runs into a slot left being claimed by a process which died.
+ */
+class MappedStatsRegion : NonCopyable {
+public:
+  static constexpr uint32_t Version = 2;
+  static constexpr uint32_t SlotSize = 256;
+  static constexpr uint32_t HeaderSize = 64;
+
+  enum class Type : uint32_t { Counter = 2, Gauge = 3 };
+
+  ~MappedStatsRegion();
+
+  /**
+   * Maps the region stored in a file.
+   * @param path supplies the path of the backing file.
+   * @param num_slots supplies the number of slots when the region is created.
+   * @param reset supplies whether to discard any existing contents and create a fresh region in a
+   *        new file, which is what the first process of a hot restart chain does. Otherwise an
+   *        existing region is adopted, and it is created only if the file does not exist yet.
+   * @return the mapped region.
+   * @throw EnvoyException if the file cannot be mapped or holds an incompatible layout.
+   */
+  static std::unique_ptr<MappedStatsRegion> create(const std::string& path, uint32_t num_slots,
+                                                   bool reset);
+
+  /**
+   * Finds the slot holding a stat, claiming an empty one if the name is not in the region yet.
+   * The caller holds a reference on the returned slot until it calls release().
+   * @param name supplies the full name of the stat.
+   * @param type supplies the type of the stat.
+   * @return the value of the slot, or nullptr if the stat cannot be held in the region.
+   */
+  std::atomic<uint64_t>* allocate(absl::string_view name, Type type);
+
+  /**
+   * Drops a reference on a slot previously returned by allocate().
+   * @param value supplies the value returned by allocate().
+   */
+  void release(std::atomic<uint64_t>* value);
+
+  /**
+   * @return whether a stat with the given name is held in the region.
+   */
+  bool contains(absl::string_view name) const;
+
+  /**
+   * @return the number of slots in the region.
+   */
+  uint64_t numSlots() const;
+
+  /**
+   * @return the number of slots that have been claimed.
+   */
+  uint64_t numUsedSlots() const;
+
+  /**
+   * @return the longest stat name that fits in a slot.
+   */
+  static constexpr uint32_t maxNameLength() { return SlotSize - SlotNameOffset; }
+
+private:
+  struct Header;
+  struct Slot;
+
+  static constexpr uint32_t SlotNameOffset = 26;
+
+  MappedStatsRegion(const std::string& path, void* memory, size_t size);
+
+  Slot* slot(uint64_t index) const;
+  const Slot* find(absl::string_view name, uint64_t hash) const;
+  // Waits for another process to finish claiming the slot at the given index, updating the state
+  // of the slot. Returns false if the claim was given up on, now or by an earlier call.
+  bool waitForClaim(const Slot& candidate, uint64_t index, uint32_t& state);
+
+  const std::string path_;
+  void* const memory_;
+  const size_t size_;
+  Header* const header_;
+  Thread::MutexBasicLockable stale_claims_mutex_;
+  // The slots whose claim was given up on by this process.
+  absl::flat_hash_set<uint64_t> stale_claims_ GUARDED_BY(stale_claims_mutex_);
+};
+
+using MappedStatsRegionPtr = std::unique_ptr<MappedStatsRegion>;
+
+} // namespace Stats
+} // namespace Envoy
@@ -29,6 +29,7 @@ static constexpr uint32_t Low7Bits = 0x7f;
 // a symbol table lock, and would rather pay extra memory overhead to store the
 // tokens as fully elaborated strings.
 static constexpr Symbol FirstValidSymbol = 1;
+static constexpr Symbol InvalidSymbol = 0;
 static constexpr uint8_t LiteralStringIndicator = 0;
 
 uint64_t StatName::dataSize() const {
@@ -158,7 +159,7 @@ void SymbolTableImpl::Encoding::decodeTokens(
 std::vector<absl::string_view> SymbolTableImpl::decodeStrings(const SymbolTable::Storage array,
                                                               uint64_t size) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   Encoding::decodeTokens(
       array, size,
       [this, &strings](Symbol symbol)
@@ -209,17 +210,36 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
+  if (recent_lookup_capacity_.load(std::memory_order_relaxed) != 0) {
+    Thread::LockGuard lock(recent_lookups_lock_);
+    recent_lookups_.lookup(name);
+  }
+
   // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
+  // ref-counts in this. Usually all the tokens are already in the table, so we
+  // first try to resolve them holding the lock in shared mode, which lets
+  // threads encode names concurrently.
+  bool all_found = true;
   {
-    Thread::LockGuard lock(lock_);
-    recent_lookups_.lookup(name);
+    absl::ReaderMutexLock lock(&lock_);
     for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
+      const Symbol symbol = lookupSymbol(token);
+      all_found &= symbol != InvalidSymbol;
+      symbols.push_back(symbol);
+    }
+  }
+
+  // Any tokens which were missing are added with the lock held exclusively.
+  if (!all_found) {
+    absl::WriterMutexLock lock(&lock_);
+    for (uint64_t i = 0; i < tokens.size(); ++i) {
+      if (symbols[i] == InvalidSymbol) {
+        // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+        // length below some threshold, say 4 bytes. It might be preferable not to
+        // reserve Symbols for every 3 digit number found (for example) in ipv4
+        // addresses.
+        symbols[i] = toSymbol(tokens[i]);
+      }
     }
   }
 
@@ -228,7 +248,7 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
 }
 
 uint64_t SymbolTableImpl::numSymbols() const {
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   ASSERT(encode_map_.size() == decode_map_.size());
   return encode_map_.size();
 }
@@ -246,7 +266,9 @@ void SymbolTableImpl::incRefCount(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
+  // The caller already holds a reference to each symbol, so none of them can
+  // be erased concurrently, and bumping the ref-counts only needs a shared lock.
+  absl::ReaderMutexLock lock(&lock_);
   for (Symbol symbol : symbols) {
     auto decode_search = decode_map_.find(symbol);
     ASSERT(decode_search != decode_map_.end());
@@ -262,23 +284,49 @@ void SymbolTableImpl::free(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
-  for (Symbol symbol : symbols) {
+  // Dropping the ref-counts only needs a shared lock. Symbols which are no
+  // longer referenced are collected so they can be erased afterwards.
+  SymbolVec unreferenced;
+  {
+    absl::ReaderMutexLock lock(&lock_);
+    for (Symbol symbol : symbols) {
+      auto decode_search = decode_map_.find(symbol);
+      ASSERT(decode_search != decode_map_.end());
+
+      auto encode_search = encode_map_.find(decode_search->second->toStringView());
+      ASSERT(encode_search != encode_map_.end());
+
+      // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
+      // symbol_table_speed_test.cc, relative to breaking out the decrement into a
+      // separate step, likely due to the non-trivial dereferences in EXPR.
+      if (--encode_search->second.ref_count_ == 0) {
+        unreferenced.push_back(symbol);
+      }
+    }
+  }
+
+  if (unreferenced.empty()) {
+    return;
+  }
+
+  // If that was the last remaining client usage of a symbol, erase the current
+  // mappings and add the now-unused symbol to the reuse pool. Between dropping
+  // the shared lock and taking the exclusive one, another thread may have
+  // re-encoded the token, or even re-encoded, freed and erased it, in which
+  // case the symbol may already have been recycled for a different token. So
+  // we only erase symbols which are still present and unreferenced.
+  absl::WriterMutexLock lock(&lock_);
+  for (Symbol symbol : unreferenced) {
     auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
+    if (decode_search == decode_map_.end()) {
+      continue;
+    }
 
     auto encode_search = encode_map_.find(decode_search->second->toStringView());
     ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
+    if (encode_search->second.ref_count_ == 0) {
       encode_map_.erase(encode_search);
+      decode_map_.erase(decode_search);
       pool_.push(symbol);
     }
   }
@@ -288,10 +336,10 @@ uint64_t SymbolTableImpl::getRecentLookups(const RecentLookupsFn& iter) const {
   uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
-  // access recent_lookups_, so we buffer in name_count_map.
+  // We don't want to hold recent_lookups_lock_ while calling the iterator, but
+  // we need it to access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(recent_lookups_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
@@ -341,17 +389,18 @@ DynamicSpans SymbolTableImpl::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTableImpl::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.setCapacity(capacity);
+  recent_lookup_capacity_.store(capacity, std::memory_order_relaxed);
 }
 
 void SymbolTableImpl::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   recent_lookups_.clear();
 }
 
 uint64_t SymbolTableImpl::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(recent_lookups_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -380,15 +429,35 @@ Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
     newSymbol();
   } else {
     // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
+    // refcount at that location. This may revive a symbol whose ref-count dropped to zero in a
+    // concurrent free() which has not yet erased it; free() re-checks before erasing.
     result = encode_find->second.symbol_;
     ++(encode_find->second.ref_count_);
   }
   return result;
 }
 
+Symbol SymbolTableImpl::lookupSymbol(absl::string_view sv) {
+  auto encode_find = encode_map_.find(sv);
+  if (encode_find == encode_map_.end()) {
+    return InvalidSymbol;
+  }
+
+  // Only bump the ref-count if it is non-zero. A zero ref-count means a
+  // concurrent free() released the last reference and is about to erase the
+  // symbol, so it can only be revived with the lock held exclusively.
+  std::atomic<uint32_t>& ref_count = encode_find->second.ref_count_;
+  uint32_t count = ref_count.load(std::memory_order_relaxed);
+  do {
+    if (count == 0) {
+      return InvalidSymbol;
+    }
+  } while (!ref_count.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+  return encode_find->second.symbol_;
+}
+
 absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const
-    EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    SHARED_LOCKS_REQUIRED(lock_) {
   auto search = decode_map_.find(symbol);
   RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
   return search->second->toStringView();
@@ -424,7 +493,7 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTableImpl::debugPrint() const {
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   std::vector<Symbol> symbols;
   for (const auto& p : decode_map_) {
     symbols.push_back(p.first);
@@ -433,7 +502,8 @@ void SymbolTableImpl::debugPrint() const {
   for (Symbol symbol : symbols) {
     const InlineString& token = *decode_map_.find(symbol)->second;
     const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(),
+                   shared_symbol.ref_count_.load());
   }
 }
 #endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <stack>
@@ -24,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -216,12 +218,22 @@ private:
   struct SharedSymbol {
     SharedSymbol(Symbol symbol) : symbol_(symbol), ref_count_(1) {}
 
+    // The ref-count is atomic so it can be adjusted while lock_ is held in
+    // shared mode. Entries are only moved when the encode map is rehashed,
+    // which requires lock_ to be held exclusively.
+    SharedSymbol(SharedSymbol&& src) noexcept
+        : symbol_(src.symbol_), ref_count_(src.ref_count_.load(std::memory_order_relaxed)) {}
+
     Symbol symbol_;
-    uint32_t ref_count_;
+    std::atomic<uint32_t> ref_count_;
   };
 
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  // Looking up existing symbols -- encoding names whose tokens are all in the
+  // table already, decoding, and adjusting ref-counts -- holds this lock in
+  // shared mode, so workers creating stat names do not serialize on it. It is
+  // only held exclusively to insert new tokens, and to erase tokens whose
+  // ref-count dropped to zero.
+  mutable absl::Mutex lock_;
 
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
@@ -246,13 +258,23 @@ private:
    */
   Symbol toSymbol(absl::string_view sv) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  /**
+   * Looks up the symbol for an existing string segment, bumping its ref-count.
+   * This only requires lock_ to be held in shared mode.
+   *
+   * @param sv the individual string to be looked up.
+   * @return Symbol the symbol for sv, or 0 if sv is not in the table or is
+   *         about to be freed, in which case toSymbol() must be used instead.
+   */
+  Symbol lookupSymbol(absl::string_view sv) SHARED_LOCKS_REQUIRED(lock_);
+
   /**
    * Convenience function for decode(), decoding one symbol at a time.
    *
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const SHARED_LOCKS_REQUIRED(lock_);
 
   /**
    * Stages a new symbol for use. To be called after a successful insertion.
@@ -269,7 +291,7 @@ private:
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    absl::ReaderMutexLock lock(&lock_);
     return monotonic_counter_;
   }
 
@@ -292,7 +314,14 @@ private:
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
   std::stack<Symbol> pool_ GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ GUARDED_BY(lock_);
+
+  // Recent lookups have their own lock, as they are updated on every encode.
+  // They are only tracked once enabled via setRecentLookupCapacity(), so the
+  // capacity is mirrored in an atomic to keep this lock off the encode path in
+  // the common case.
+  mutable Thread::MutexBasicLockable recent_lookups_lock_;
+  RecentLookups recent_lookups_ GUARDED_BY(recent_lookups_lock_);
+  std::atomic<uint64_t> recent_lookup_capacity_{0};
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
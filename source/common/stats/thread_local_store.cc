@@ -754,6 +754,18 @@ const std::string ParentHistogramImpl::bucketSummary() const {
   }
 }
 
+void ParentHistogramImpl::forEachBin(bool cumulative, const BinFn& fn) const {
+  const histogram_t* histogram = cumulative ? cumulative_histogram_ : interval_histogram_;
+  const int num_bins = hist_bucket_count(histogram);
+  for (int i = 0; i < num_bins; ++i) {
+    hist_bucket_t bin;
+    uint64_t count;
+    if (hist_bucket_idx_bucket(histogram, i, &bin, &count) && count > 0) {
+      fn(hist_bucket_to_double(bin), hist_bucket_to_double_bin_width(bin), count);
+    }
+  }
+}
+
 void ParentHistogramImpl::addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr) {
   Thread::LockGuard lock(merge_lock_);
   tls_histograms_.emplace_back(hist_ptr);
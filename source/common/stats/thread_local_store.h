@@ -104,6 +104,7 @@ public:
   }
   const std::string quantileSummary() const override;
   const std::string bucketSummary() const override;
+  void forEachBin(bool cumulative, const BinFn& fn) const override;
 
   // Stats::Metric
   SymbolTable& symbolTable() override { return parent_.symbolTable(); }
@@ -0,0 +1,177 @@
+#include "common/tcp_proxy/splice_proxy.h"
+
+#include <cerrno>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+
+#include "common/api/os_sys_calls_impl_linux.h"
+#endif
+
+namespace Envoy {
+namespace TcpProxy {
+
+std::unique_ptr<SplicePipe> SplicePipe::create(os_fd_t source, os_fd_t destination) {
+#if defined(__linux__)
+  int pipe[2];
+  if (Api::LinuxOsSysCallsSingleton::get().pipe2(pipe, O_NONBLOCK | O_CLOEXEC).rc_ != 0) {
+    return nullptr;
+  }
+  return std::unique_ptr<SplicePipe>(new SplicePipe(source, destination, pipe));
+#else
+  UNREFERENCED_PARAMETER(source);
+  UNREFERENCED_PARAMETER(destination);
+  return nullptr;
+#endif
+}
+
+SplicePipe::SplicePipe(os_fd_t source, os_fd_t destination, const int pipe[2])
+    : source_(source), destination_(destination), pipe_read_(pipe[0]), pipe_write_(pipe[1]) {}
+
+SplicePipe::~SplicePipe() {
+  Api::OsSysCallsSingleton::get().close(pipe_read_);
+  Api::OsSysCallsSingleton::get().close(pipe_write_);
+}
+
+SplicePipe::Status SplicePipe::move(uint64_t max_length, uint64_t& moved_length) {
+  moved_length = 0;
+#if defined(__linux__)
+  auto& os_sys_calls = Api::LinuxOsSysCallsSingleton::get();
+  uint64_t read_length = 0;
+  bool progress = true;
+  // A splice() into the pipe may also block because the pipe is full, so keep moving data both ways
+  // as long as either way makes progress, rather than stopping at the first splice() which blocks.
+  while (progress) {
+    progress = false;
+    if (!end_stream_ && read_length < max_length) {
+      const Api::SysCallSizeResult result = os_sys_calls.splice(
+          source_, pipe_write_, ChunkLength, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (result.rc_ > 0) {
+        buffered_length_ += result.rc_;
+        read_length += result.rc_;
+        progress = true;
+      } else if (result.rc_ == 0) {
+        end_stream_ = true;
+      } else if (result.errno_ != EAGAIN) {
+        return Status::Error;
+      }
+    }
+    if (buffered_length_ > 0) {
+      const Api::SysCallSizeResult result = os_sys_calls.splice(
+          pipe_read_, destination_, buffered_length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (result.rc_ > 0) {
+        buffered_length_ -= result.rc_;
+        moved_length += result.rc_;
+        progress = true;
+      } else if (result.rc_ < 0 && result.errno_ != EAGAIN) {
+        return Status::Error;
+      }
+    }
+  }
+
+  if (end_stream_ && buffered_length_ == 0) {
+    return Status::EndStream;
+  }
+  return !end_stream_ && read_length >= max_length ? Status::Yielded : Status::Blocked;
+#else
+  UNREFERENCED_PARAMETER(max_length);
+  NOT_REACHED_GCOVR_EXCL_LINE;
+#endif
+}
+
+std::unique_ptr<SpliceProxy> SpliceProxy::create(Network::Connection& downstream,
+                                                 Network::Connection& upstream,
+                                                 Callbacks& callbacks) {
+  Network::IoHandle* downstream_io_handle = downstream.rawIoHandle();
+  Network::IoHandle* upstream_io_handle = upstream.rawIoHandle();
+  if (downstream_io_handle == nullptr || upstream_io_handle == nullptr) {
+    return nullptr;
+  }
+  SplicePipePtr downstream_to_upstream =
+      SplicePipe::create(downstream_io_handle->fd(), upstream_io_handle->fd());
+  SplicePipePtr upstream_to_downstream =
+      SplicePipe::create(upstream_io_handle->fd(), downstream_io_handle->fd());
+  if (downstream_to_upstream == nullptr || upstream_to_downstream == nullptr) {
+    return nullptr;
+  }
+  return std::unique_ptr<SpliceProxy>(new SpliceProxy(downstream, upstream,
+                                                      std::move(downstream_to_upstream),
+                                                      std::move(upstream_to_downstream),
+                                                      callbacks));
+}
+
+SpliceProxy::SpliceProxy(Network::Connection& downstream, Network::Connection& upstream,
+                         SplicePipePtr&& downstream_to_upstream,
+                         SplicePipePtr&& upstream_to_downstream, Callbacks& callbacks)
+    : downstream_(downstream), upstream_(upstream),
+      downstream_to_upstream_(std::move(downstream_to_upstream)),
+      upstream_to_downstream_(std::move(upstream_to_downstream)), callbacks_(callbacks),
+      yield_timer_(downstream.dispatcher().createTimer([this]() -> void { onRawIoReady(); })) {
+  downstream_.startRawIo(*this);
+  upstream_.startRawIo(*this);
+}
+
+SpliceProxy::~SpliceProxy() {
+  // The connections may outlive the proxy, so they must not call it anymore.
+  downstream_.stopRawIo();
+  upstream_.stopRawIo();
+}
+
+void SpliceProxy::endStream(Network::Connection& destination, bool& end_stream_written) {
+  if (!end_stream_written) {
+    end_stream_written = true;
+    Buffer::OwnedImpl empty;
+    destination.write(empty, true);
+  }
+}
+
+void SpliceProxy::onRawIoReady() {
+  if (ended_) {
+    return;
+  }
+
+  uint64_t downstream_length;
+  uint64_t upstream_length;
+  const SplicePipe::Status downstream_status =
+      downstream_to_upstream_->move(MaxLengthPerEvent, downstream_length);
+  const SplicePipe::Status upstream_status =
+      upstream_to_downstream_->move(MaxLengthPerEvent, upstream_length);
+  if (downstream_length > 0 || upstream_length > 0) {
+    callbacks_.onSpliced(downstream_length, upstream_length);
+  }
+
+  if (downstream_status == SplicePipe::Status::Error ||
+      upstream_status == SplicePipe::Status::Error) {
+    ENVOY_LOG(debug, "splice failed");
+    ended_ = true;
+    callbacks_.onSpliceEnd(true);
+    return;
+  }
+  if (downstream_status == SplicePipe::Status::EndStream) {
+    endStream(upstream_, downstream_end_stream_written_);
+  }
+  if (upstream_status == SplicePipe::Status::EndStream) {
+    endStream(downstream_, upstream_end_stream_written_);
+  }
+  if (downstream_status == SplicePipe::Status::EndStream &&
+      upstream_status == SplicePipe::Status::EndStream) {
+    ended_ = true;
+    callbacks_.onSpliceEnd(false);
+    return;
+  }
+
+  // Nothing may trigger the events of the sockets again while they still have data, so move it
+  // again once the dispatcher has run the other events.
+  if (downstream_status == SplicePipe::Status::Yielded ||
+      upstream_status == SplicePipe::Status::Yielded) {
+    yield_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+} // namespace TcpProxy
+} // namespace Envoy
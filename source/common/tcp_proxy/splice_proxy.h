@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/platform.h"
+#include "envoy/common/pure.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/connection.h"
+
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace TcpProxy {
+
+/**
+ * Moves the data of a source socket to a destination socket with splice(), through a pipe, so that
+ * it never leaves the kernel.
+ */
+class SplicePipe : NonCopyable {
+public:
+  enum class Status {
+    // Either socket would block, and the pipe waits for them to be ready again.
+    Blocked,
+    // Moving stopped after the maximum length, while the source socket may still have data.
+    Yielded,
+    // The source socket reached end of stream, and all of its data was moved.
+    EndStream,
+    // Either socket failed (i.e. it was reset).
+    Error,
+  };
+
+  // Length of the data asked of the source socket by each splice() into the pipe.
+  static constexpr uint64_t ChunkLength = 64 * 1024;
+
+  /**
+   * @return a pipe between the sockets, or nullptr if splice() isn't available or the pipe can't be
+   *         created.
+   */
+  static std::unique_ptr<SplicePipe> create(os_fd_t source, os_fd_t destination);
+  ~SplicePipe();
+
+  /**
+   * Moves data until either socket would block, the source socket reaches end of stream, or about
+   * max_length bytes were read from the source socket.
+   * @param max_length supplies the length of the data to read from the source socket after which to
+   *        yield.
+   * @param moved_length supplies where to return the length of the data written to the destination
+   *        socket.
+   * @return the status of the pipe.
+   */
+  Status move(uint64_t max_length, uint64_t& moved_length);
+
+private:
+  SplicePipe(os_fd_t source, os_fd_t destination, const int pipe[2]);
+
+  const os_fd_t source_;
+  const os_fd_t destination_;
+  const int pipe_read_;
+  const int pipe_write_;
+  // Length of the data in the pipe.
+  uint64_t buffered_length_{};
+  bool end_stream_{};
+};
+
+using SplicePipePtr = std::unique_ptr<SplicePipe>;
+
+/**
+ * Forwards the data of a downstream connection and an upstream connection to each other, with a
+ * SplicePipe for each direction, once the connections handed the reads of their sockets over (@see
+ * Network::Connection::startRawIo()). Both directions are moved whenever either socket becomes
+ * ready, up to MaxLengthPerEvent bytes each, so that a busy connection doesn't starve the others of
+ * its dispatcher. The end of stream of each direction is forwarded by half-closing the destination
+ * connection.
+ */
+class SpliceProxy : Network::RawIoCallbacks, NonCopyable, Logger::Loggable<Logger::Id::filter> {
+public:
+  class Callbacks {
+  public:
+    virtual ~Callbacks() = default;
+
+    /**
+     * Called when data was forwarded.
+     * @param downstream_length supplies the length of the data forwarded from the downstream socket
+     *        to the upstream socket.
+     * @param upstream_length supplies the length of the data forwarded from the upstream socket to
+     *        the downstream socket.
+     */
+    virtual void onSpliced(uint64_t downstream_length, uint64_t upstream_length) PURE;
+
+    /**
+     * Called once both sockets reached end of stream and all of their data was forwarded, or
+     * either socket failed. Nothing is forwarded anymore, and the proxy may be destroyed from the
+     * callback.
+     * @param error supplies whether a socket failed.
+     */
+    virtual void onSpliceEnd(bool error) PURE;
+  };
+
+  static constexpr uint64_t MaxLengthPerEvent = 1024 * 1024;
+
+  /**
+   * @return a proxy forwarding the data of the connections, or nullptr if either connection can't
+   *         be forwarded without going through it (@see Network::Connection::rawIoHandle()),
+   *         splice() isn't available, or the pipes can't be created.
+   */
+  static std::unique_ptr<SpliceProxy> create(Network::Connection& downstream,
+                                             Network::Connection& upstream, Callbacks& callbacks);
+
+  ~SpliceProxy() override;
+
+private:
+  SpliceProxy(Network::Connection& downstream, Network::Connection& upstream,
+              SplicePipePtr&& downstream_to_upstream, SplicePipePtr&& upstream_to_downstream,
+              Callbacks& callbacks);
+
+  // Network::RawIoCallbacks
+  void onRawIoReady() override;
+
+  // Half-closes the destination connection of a pipe which reached end of stream, once.
+  static void endStream(Network::Connection& destination, bool& end_stream_written);
+
+  Network::Connection& downstream_;
+  Network::Connection& upstream_;
+  const SplicePipePtr downstream_to_upstream_;
+  const SplicePipePtr upstream_to_downstream_;
+  Callbacks& callbacks_;
+  bool downstream_end_stream_written_{};
+  bool upstream_end_stream_written_{};
+  bool ended_{};
+  // Moves the data again after yielding, once the dispatcher has run the other events.
+  Event::TimerPtr yield_timer_;
+};
+
+using SpliceProxyPtr = std::unique_ptr<SpliceProxy>;
+
+} // namespace TcpProxy
+} // namespace Envoy
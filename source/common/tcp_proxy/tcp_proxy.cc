@@ -117,7 +117,7 @@ Config::Config(const envoy::extensions::filters::network::tcp_proxy::v3::TcpProx
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
       shared_config_(std::make_shared<SharedConfig>(config, context)),
-      random_generator_(context.random()) {
+      random_generator_(context.random()), splice_(config.splice()) {
 
   upstream_drain_manager_slot_->set([](Event::Dispatcher&) {
     ThreadLocal::ThreadLocalObjectSharedPtr drain_manager =
@@ -541,6 +541,9 @@ Network::FilterStatus Filter::onData(Buffer::Instance& data, bool end_stream) {
 }
 
 void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
+  if (event != Network::ConnectionEvent::Connected) {
+    splice_proxy_.reset();
+  }
   if (upstream_) {
     Tcp::ConnectionPool::ConnectionDataPtr conn_data(upstream_->onDownstreamEvent(event));
     if (conn_data != nullptr &&
@@ -580,6 +583,7 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
 
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
+    splice_proxy_.reset();
     upstream_.reset();
     disableIdleTimer();
 
@@ -598,8 +602,10 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
     }
   } else if (event == Network::ConnectionEvent::Connected) {
     // Re-enable downstream reads now that the upstream connection is established
-    // so we have a place to send downstream data to.
-    read_callbacks_->connection().readDisable(false);
+    // so we have a place to send downstream data to, unless the data is spliced instead.
+    if (!startSplicing()) {
+      read_callbacks_->connection().readDisable(false);
+    }
 
     read_callbacks_->upstreamHost()->outlierDetector().putResult(
         Upstream::Outlier::Result::LocalOriginConnectSuccessFinal);
@@ -625,6 +631,47 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
   }
 }
 
+bool Filter::startSplicing() {
+  if (!config_->splice() || upstream_ == nullptr) {
+    return false;
+  }
+  Network::Connection* upstream_connection = upstream_->connection();
+  if (upstream_connection == nullptr) {
+    return false;
+  }
+  // This fails, and the data is proxied as usual, if other network filters see the data of either
+  // connection, or either transport socket doesn't write plaintext to its socket.
+  splice_proxy_ = SpliceProxy::create(read_callbacks_->connection(), *upstream_connection, *this);
+  if (splice_proxy_ == nullptr) {
+    return false;
+  }
+
+  // Neither connection reads its socket from now on, and both are half-close enabled, so that the
+  // end of stream of either direction is forwarded by the splice proxy.
+  ENVOY_CONN_LOG(debug, "splicing the connections", read_callbacks_->connection());
+  config_->stats().downstream_cx_spliced_total_.inc();
+  return true;
+}
+
+void Filter::onSpliced(uint64_t downstream_length, uint64_t upstream_length) {
+  // The spliced data doesn't go through the connections, so account for it on their behalf.
+  getStreamInfo().addBytesReceived(downstream_length);
+  getStreamInfo().addBytesSent(upstream_length);
+  config_->stats().downstream_cx_rx_bytes_total_.add(downstream_length);
+  config_->stats().downstream_cx_tx_bytes_total_.add(upstream_length);
+  const Upstream::ClusterStats& cluster_stats = read_callbacks_->upstreamHost()->cluster().stats();
+  cluster_stats.upstream_cx_tx_bytes_total_.add(downstream_length);
+  cluster_stats.upstream_cx_rx_bytes_total_.add(upstream_length);
+  resetIdleTimer();
+}
+
+void Filter::onSpliceEnd(bool error) {
+  splice_proxy_.reset();
+  // This results in also closing the upstream connection.
+  read_callbacks_->connection().close(error ? Network::ConnectionCloseType::NoFlush
+                                            : Network::ConnectionCloseType::FlushWrite);
+}
+
 void Filter::onIdleTimeout() {
   ENVOY_CONN_LOG(debug, "Session timed out", read_callbacks_->connection());
   config_->stats().idle_timeout_.inc();
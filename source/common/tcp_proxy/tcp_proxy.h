@@ -26,6 +26,7 @@
 #include "common/network/hash_policy.h"
 #include "common/network/utility.h"
 #include "common/stream_info/stream_info_impl.h"
+#include "common/tcp_proxy/splice_proxy.h"
 #include "common/tcp_proxy/upstream.h"
 #include "common/upstream/load_balancer_impl.h"
 
@@ -38,6 +39,7 @@ namespace TcpProxy {
 #define ALL_TCP_PROXY_STATS(COUNTER, GAUGE)                                                        \
   COUNTER(downstream_cx_no_route)                                                                  \
   COUNTER(downstream_cx_rx_bytes_total)                                                            \
+  COUNTER(downstream_cx_spliced_total)                                                             \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_tx_bytes_total)                                                            \
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
@@ -149,6 +151,7 @@ public:
     return cluster_metadata_match_criteria_.get();
   }
   const Network::HashPolicy* hashPolicy() { return hash_policy_.get(); }
+  bool splice() const { return splice_; }
 
 private:
   struct RouteImpl : public Route {
@@ -208,6 +211,7 @@ private:
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
   Runtime::RandomGenerator& random_generator_;
   std::unique_ptr<const Network::HashPolicyImpl> hash_policy_;
+  const bool splice_;
 };
 
 using ConfigSharedPtr = std::shared_ptr<Config>;
@@ -234,6 +238,7 @@ class Filter : public Network::ReadFilter,
                public Upstream::LoadBalancerContextBase,
                Tcp::ConnectionPool::Callbacks,
                public Http::ConnectionPool::Callbacks,
+               SpliceProxy::Callbacks,
                protected Logger::Loggable<Logger::Id::filter> {
 public:
   Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager);
@@ -258,6 +263,10 @@ public:
                    Upstream::HostDescriptionConstSharedPtr host,
                    const StreamInfo::StreamInfo& info) override;
 
+  // SpliceProxy::Callbacks
+  void onSpliced(uint64_t downstream_length, uint64_t upstream_length) override;
+  void onSpliceEnd(bool error) override;
+
   void onPoolReadyBase(Upstream::HostDescriptionConstSharedPtr& host,
                        const Network::Address::InstanceConstSharedPtr& local_address,
                        Ssl::ConnectionInfoConstSharedPtr ssl_info);
@@ -357,6 +366,8 @@ protected:
   void onDownstreamEvent(Network::ConnectionEvent event);
   void onUpstreamData(Buffer::Instance& data, bool end_stream);
   void onUpstreamEvent(Network::ConnectionEvent event);
+  // Forwards the data of the connections with splice() from now on, if configured and possible.
+  bool startSplicing();
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
@@ -372,6 +383,7 @@ protected:
   std::shared_ptr<UpstreamCallbacks> upstream_callbacks_; // shared_ptr required for passing as a
                                                           // read filter.
   std::unique_ptr<GenericUpstream> upstream_;
+  SpliceProxyPtr splice_proxy_;
   RouteConstSharedPtr route_;
   Network::TransportSocketOptionsSharedPtr transport_socket_options_;
   uint32_t connect_attempts_{};
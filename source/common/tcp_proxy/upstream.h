@@ -51,6 +51,9 @@ public:
   virtual void encodeData(Buffer::Instance& data, bool end_stream) PURE;
   // Adds a callback to be called when the data is sent to the kernel.
   virtual void addBytesSentCallback(Network::Connection::BytesSentCb cb) PURE;
+  // Returns the upstream connection if the upstream is a plain connection, whose data may be
+  // forwarded without going through the upstream, or nullptr otherwise.
+  virtual Network::Connection* connection() PURE;
   // Called when a Network::ConnectionEvent is received on the downstream connection, to allow the
   // upstream to do any cleanup.
   virtual Tcp::ConnectionPool::ConnectionData*
@@ -66,6 +69,7 @@ public:
   bool readDisable(bool disable) override;
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
+  Network::Connection* connection() override;
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
 
 private:
@@ -86,6 +90,7 @@ public:
   bool readDisable(bool disable) override;
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
+  Network::Connection* connection() override { return nullptr; }
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
 
   // Http::StreamCallbacks
@@ -178,8 +178,12 @@ void InstanceImpl::runOnAllThreads(Event::PostCb cb) {
   ASSERT(std::this_thread::get_id() == main_thread_id_);
   ASSERT(!shutdown_);
 
-  for (Event::Dispatcher& dispatcher : registered_threads_) {
-    dispatcher.post(cb);
+  if (batch_depth_ > 0) {
+    batched_callbacks_.push_back([cb](Event::Dispatcher&) -> void { cb(); });
+  } else {
+    for (Event::Dispatcher& dispatcher : registered_threads_) {
+      dispatcher.post(cb);
+    }
   }
 
   // Handle main thread.
@@ -200,8 +204,14 @@ void InstanceImpl::runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_c
                                             delete cb;
                                           });
 
-  for (Event::Dispatcher& dispatcher : registered_threads_) {
-    dispatcher.post([cb_guard]() -> void { (*cb_guard)(); });
+  // A batched callback is shared by the worker threads, and released with the batch once all of
+  // them ran it.
+  if (batch_depth_ > 0) {
+    batched_callbacks_.push_back([cb_guard](Event::Dispatcher&) -> void { (*cb_guard)(); });
+  } else {
+    for (Event::Dispatcher& dispatcher : registered_threads_) {
+      dispatcher.post([cb_guard]() -> void { (*cb_guard)(); });
+    }
   }
 }
 
@@ -209,15 +219,48 @@ void InstanceImpl::SlotImpl::set(InitializeCb cb) {
   ASSERT(std::this_thread::get_id() == parent_.main_thread_id_);
   ASSERT(!parent_.shutdown_);
 
-  for (Event::Dispatcher& dispatcher : parent_.registered_threads_) {
-    const uint32_t index = index_;
-    dispatcher.post([index, cb, &dispatcher]() -> void { setThreadLocal(index, cb(dispatcher)); });
+  const uint32_t index = index_;
+  if (parent_.batch_depth_ > 0) {
+    parent_.batched_callbacks_.push_back([index, cb](Event::Dispatcher& dispatcher) -> void {
+      setThreadLocal(index, cb(dispatcher));
+    });
+  } else {
+    for (Event::Dispatcher& dispatcher : parent_.registered_threads_) {
+      dispatcher.post(
+          [index, cb, &dispatcher]() -> void { setThreadLocal(index, cb(dispatcher)); });
+    }
   }
 
   // Handle main thread.
   setThreadLocal(index_, cb(*parent_.main_thread_dispatcher_));
 }
 
+UpdateBatchPtr InstanceImpl::batchUpdates() {
+  ASSERT(std::this_thread::get_id() == main_thread_id_);
+  return std::make_unique<UpdateBatchImpl>(*this);
+}
+
+void InstanceImpl::endBatch() {
+  ASSERT(std::this_thread::get_id() == main_thread_id_);
+  ASSERT(batch_depth_ > 0);
+  if (--batch_depth_ > 0 || batched_callbacks_.empty()) {
+    return;
+  }
+  // The callbacks are shared by the worker threads rather than copied for each of them.
+  auto callbacks = std::make_shared<const std::vector<BatchedCb>>(std::move(batched_callbacks_));
+  batched_callbacks_.clear();
+  if (shutdown_) {
+    return;
+  }
+  for (Event::Dispatcher& dispatcher : registered_threads_) {
+    dispatcher.post([callbacks, &dispatcher]() -> void {
+      for (const BatchedCb& cb : *callbacks) {
+        cb(dispatcher);
+      }
+    });
+  }
+}
+
 void InstanceImpl::setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object) {
   if (thread_local_data_.data_.size() <= index) {
     thread_local_data_.data_.resize(index + 1);
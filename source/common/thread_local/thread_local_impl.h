@@ -29,6 +29,7 @@ public:
   void shutdownGlobalThreading() override;
   void shutdownThread() override;
   Event::Dispatcher& dispatcher() override;
+  UpdateBatchPtr batchUpdates() override;
 
 private:
   struct SlotImpl : public Slot {
@@ -75,6 +76,16 @@ private:
     std::vector<ThreadLocalObjectSharedPtr> data_;
   };
 
+  struct UpdateBatchImpl : public UpdateBatch {
+    UpdateBatchImpl(InstanceImpl& parent) : parent_(parent) { parent_.batch_depth_++; }
+    ~UpdateBatchImpl() override { parent_.endBatch(); }
+
+    InstanceImpl& parent_;
+  };
+
+  // A callback of a batch, which is run by each worker thread with its dispatcher.
+  using BatchedCb = std::function<void(Event::Dispatcher& dispatcher)>;
+
   void recycle(std::unique_ptr<SlotImpl>&& slot);
   // Cleanup the deferred deletes queue.
   void scheduleCleanup(SlotImpl* slot);
@@ -82,6 +93,8 @@ private:
   void removeSlot(SlotImpl& slot);
   void runOnAllThreads(Event::PostCb cb);
   void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback);
+  // Posts the callbacks of the batch to the worker threads when the outermost batch ends.
+  void endBatch();
   static void setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object);
 
   static thread_local ThreadLocalData thread_local_data_;
@@ -99,6 +112,9 @@ private:
   std::thread::id main_thread_id_;
   Event::Dispatcher* main_thread_dispatcher_{};
   std::atomic<bool> shutdown_{};
+  // The number of batches started and not ended yet, and the callbacks of the batch.
+  uint32_t batch_depth_{};
+  std::vector<BatchedCb> batched_callbacks_;
 
   // Test only.
   friend class ThreadLocalInstanceImplTest;
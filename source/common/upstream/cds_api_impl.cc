@@ -1,6 +1,8 @@
 #include "common/upstream/cds_api_impl.h"
 
+#include <algorithm>
 #include <string>
+#include <thread>
 
 #include "envoy/api/v2/cluster.pb.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -11,9 +13,11 @@
 
 #include "common/common/assert.h"
 #include "common/common/cleanup.h"
+#include "common/common/parallel.h"
 #include "common/common/utility.h"
 #include "common/config/api_version.h"
 #include "common/config/utility.h"
+#include "common/config/version_converter.h"
 #include "common/protobuf/utility.h"
 
 #include "absl/strings/str_join.h"
@@ -22,17 +26,20 @@ namespace Envoy {
 namespace Upstream {
 
 CdsApiPtr CdsApiImpl::create(const envoy::config::core::v3::ConfigSource& cds_config,
-                             ClusterManager& cm, Stats::Scope& scope,
-                             ProtobufMessage::ValidationVisitor& validation_visitor) {
-  return CdsApiPtr{new CdsApiImpl(cds_config, cm, scope, validation_visitor)};
+                             ClusterManager& cm, ThreadLocal::Instance& tls, Stats::Scope& scope,
+                             ProtobufMessage::ValidationVisitor& validation_visitor,
+                             Thread::ThreadFactory& thread_factory) {
+  return CdsApiPtr{new CdsApiImpl(cds_config, cm, tls, scope, validation_visitor, thread_factory)};
 }
 
 CdsApiImpl::CdsApiImpl(const envoy::config::core::v3::ConfigSource& cds_config, ClusterManager& cm,
-                       Stats::Scope& scope, ProtobufMessage::ValidationVisitor& validation_visitor)
+                       ThreadLocal::Instance& tls, Stats::Scope& scope,
+                       ProtobufMessage::ValidationVisitor& validation_visitor,
+                       Thread::ThreadFactory& thread_factory)
     : Envoy::Config::SubscriptionBase<envoy::config::cluster::v3::Cluster>(
           cds_config.resource_api_version()),
-      cm_(cm), scope_(scope.createScope("cluster_manager.cds.")),
-      validation_visitor_(validation_visitor) {
+      cm_(cm), tls_(tls), scope_(scope.createScope("cluster_manager.cds.")),
+      validation_visitor_(validation_visitor), thread_factory_(thread_factory) {
   const auto resource_name = getResourceName();
   subscription_ = cm_.subscriptionFactory().subscriptionFromConfigSource(
       cds_config, Grpc::Common::typeUrl(resource_name), *scope_, *this);
@@ -41,30 +48,60 @@ CdsApiImpl::CdsApiImpl(const envoy::config::core::v3::ConfigSource& cds_config,
 void CdsApiImpl::onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
                                 const std::string& version_info) {
   ClusterManager::ClusterInfoMap clusters_to_remove = cm_.clusters();
-  std::vector<envoy::config::cluster::v3::Cluster> clusters;
+  std::vector<DecodedCluster> clusters;
+  clusters.reserve(resources.size());
   for (const auto& cluster_blob : resources) {
-    // No validation needed here the overloaded call to onConfigUpdate validates.
-    clusters.push_back(MessageUtil::anyConvert<envoy::config::cluster::v3::Cluster>(cluster_blob));
-    clusters_to_remove.erase(clusters.back().name());
+    clusters.emplace_back(cluster_blob, version_info);
+  }
+  decodeClusters(clusters);
+  for (const DecodedCluster& cluster : clusters) {
+    // A resource which is not a cluster rejects the whole update, before any cluster is applied.
+    if (!cluster.unpack_error_.empty()) {
+      throw EnvoyException(cluster.unpack_error_);
+    }
+    clusters_to_remove.erase(cluster.cluster_.name());
   }
   Protobuf::RepeatedPtrField<std::string> to_remove_repeated;
   for (const auto& cluster : clusters_to_remove) {
     *to_remove_repeated.Add() = cluster.first;
   }
-  Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource> to_add_repeated;
-  for (const auto& cluster : clusters) {
-    envoy::service::discovery::v3::Resource* to_add = to_add_repeated.Add();
-    to_add->set_name(cluster.name());
-    to_add->set_version(version_info);
-    to_add->mutable_resource()->PackFrom(cluster);
-  }
-  onConfigUpdate(to_add_repeated, to_remove_repeated, version_info);
+  applyClusters(clusters, to_remove_repeated, version_info);
 }
 
 void CdsApiImpl::onConfigUpdate(
     const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
     const Protobuf::RepeatedPtrField<std::string>& removed_resources,
     const std::string& system_version_info) {
+  std::vector<DecodedCluster> clusters;
+  clusters.reserve(added_resources.size());
+  for (const auto& resource : added_resources) {
+    clusters.emplace_back(resource.resource(), resource.version());
+  }
+  decodeClusters(clusters);
+  applyClusters(clusters, removed_resources, system_version_info);
+}
+
+void CdsApiImpl::decodeClusters(std::vector<DecodedCluster>& clusters) {
+  Thread::parallelFor(
+      thread_factory_, clusters.size(), MinClustersPerDecodeThread,
+      std::min<uint32_t>(MaxDecodeThreads, std::thread::hardware_concurrency()),
+      [&clusters](size_t index) {
+        DecodedCluster& cluster = clusters[index];
+        try {
+          MessageUtil::unpackTo(cluster.resource_, cluster.cluster_);
+        } catch (const EnvoyException& e) {
+          cluster.unpack_error_ = e.what();
+          return;
+        }
+        // Unexpected fields are checked by applyClusters(), as the validation visitor may count
+        // stats and read runtime, which must be done on the main thread.
+        cluster.valid_ = Validate(cluster.cluster_, &cluster.validation_error_);
+      });
+}
+
+void CdsApiImpl::applyClusters(const std::vector<DecodedCluster>& clusters,
+                               const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                               const std::string& system_version_info) {
   std::unique_ptr<Cleanup> maybe_eds_resume;
   if (cm_.adsMux()) {
     const auto type_url = Config::getTypeUrl<envoy::config::endpoint::v3::ClusterLoadAssignment>(
@@ -74,29 +111,41 @@ void CdsApiImpl::onConfigUpdate(
         std::make_unique<Cleanup>([this, type_url] { cm_.adsMux()->resume(type_url); });
   }
 
-  ENVOY_LOG(info, "cds: add {} cluster(s), remove {} cluster(s)", added_resources.size(),
+  ENVOY_LOG(info, "cds: add {} cluster(s), remove {} cluster(s)", clusters.size(),
             removed_resources.size());
 
+  // The thread local cluster updates of the clusters applied here are posted to each worker as one
+  // batch, rather than one post per cluster and worker.
+  ThreadLocal::UpdateBatchPtr tls_batch = tls_.batchUpdates();
+
   std::vector<std::string> exception_msgs;
   std::unordered_set<std::string> cluster_names;
   bool any_applied = false;
-  for (const auto& resource : added_resources) {
-    envoy::config::cluster::v3::Cluster cluster;
+  for (const DecodedCluster& decoded : clusters) {
+    const envoy::config::cluster::v3::Cluster& cluster = decoded.cluster_;
+    // As when clusters were converted here, errors of clusters which fail to decode are not named.
+    std::string cluster_name;
     try {
-      cluster = MessageUtil::anyConvertAndValidate<envoy::config::cluster::v3::Cluster>(
-          resource.resource(), validation_visitor_);
-      if (!cluster_names.insert(cluster.name()).second) {
+      if (!decoded.unpack_error_.empty()) {
+        throw EnvoyException(decoded.unpack_error_);
+      }
+      MessageUtil::checkForUnexpectedFields(cluster, validation_visitor_);
+      if (!decoded.valid_) {
+        throw ProtoValidationException(decoded.validation_error_, API_RECOVER_ORIGINAL(cluster));
+      }
+      cluster_name = cluster.name();
+      if (!cluster_names.insert(cluster_name).second) {
         // NOTE: at this point, the first of these duplicates has already been successfully applied.
-        throw EnvoyException(fmt::format("duplicate cluster {} found", cluster.name()));
+        throw EnvoyException(fmt::format("duplicate cluster {} found", cluster_name));
       }
-      if (cm_.addOrUpdateCluster(cluster, resource.version())) {
+      if (cm_.addOrUpdateCluster(cluster, decoded.version_)) {
         any_applied = true;
-        ENVOY_LOG(info, "cds: add/update cluster '{}'", cluster.name());
+        ENVOY_LOG(info, "cds: add/update cluster '{}'", cluster_name);
       } else {
-        ENVOY_LOG(debug, "cds: add/update cluster '{}' skipped", cluster.name());
+        ENVOY_LOG(debug, "cds: add/update cluster '{}' skipped", cluster_name);
       }
     } catch (const EnvoyException& e) {
-      exception_msgs.push_back(fmt::format("{}: {}", cluster.name(), e.what()));
+      exception_msgs.push_back(fmt::format("{}: {}", cluster_name, e.what()));
     }
   }
   for (const auto& resource_name : removed_resources) {
@@ -106,6 +155,10 @@ void CdsApiImpl::onConfigUpdate(
     }
   }
 
+  // The batch ends before the initialize callback, which may go on with other updates which rely
+  // on the clusters being known to the workers.
+  tls_batch.reset();
+
   if (any_applied) {
     system_version_info_ = system_version_info;
   }
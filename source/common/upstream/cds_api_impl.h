@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <string>
+#include <vector>
 
 #include "envoy/api/api.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -10,6 +12,8 @@
 #include "envoy/local_info/local_info.h"
 #include "envoy/service/discovery/v3/discovery.pb.h"
 #include "envoy/stats/scope.h"
+#include "envoy/thread/thread.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/logger.h"
@@ -26,8 +30,14 @@ class CdsApiImpl : public CdsApi,
                    Logger::Loggable<Logger::Id::upstream> {
 public:
   static CdsApiPtr create(const envoy::config::core::v3::ConfigSource& cds_config,
-                          ClusterManager& cm, Stats::Scope& scope,
-                          ProtobufMessage::ValidationVisitor& validation_visitor);
+                          ClusterManager& cm, ThreadLocal::Instance& tls, Stats::Scope& scope,
+                          ProtobufMessage::ValidationVisitor& validation_visitor,
+                          Thread::ThreadFactory& thread_factory);
+
+  // Updates are decoded by up to MaxDecodeThreads threads, each decoding at least
+  // MinClustersPerDecodeThread clusters.
+  static constexpr size_t MinClustersPerDecodeThread = 128;
+  static constexpr uint32_t MaxDecodeThreads = 8;
 
   // Upstream::CdsApi
   void initialize() override { subscription_->start({}); }
@@ -49,16 +59,40 @@ private:
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::config::cluster::v3::Cluster>(resource).name();
   }
+  // A cluster of an update, unpacked and checked against its constraints by a decoding thread.
+  struct DecodedCluster {
+    DecodedCluster(const ProtobufWkt::Any& resource, const std::string& version)
+        : resource_(resource), version_(version) {}
+
+    const ProtobufWkt::Any& resource_;
+    const std::string& version_;
+    envoy::config::cluster::v3::Cluster cluster_;
+    // The errors unpacking the cluster and checking its constraints, if any.
+    std::string unpack_error_;
+    std::string validation_error_;
+    bool valid_{};
+  };
+
   CdsApiImpl(const envoy::config::core::v3::ConfigSource& cds_config, ClusterManager& cm,
-             Stats::Scope& scope, ProtobufMessage::ValidationVisitor& validation_visitor);
+             ThreadLocal::Instance& tls, Stats::Scope& scope,
+             ProtobufMessage::ValidationVisitor& validation_visitor,
+             Thread::ThreadFactory& thread_factory);
+  // Decoding a cluster only reads its resource and writes its DecodedCluster, so the clusters of
+  // large updates are decoded in parallel, and the main thread only applies them.
+  void decodeClusters(std::vector<DecodedCluster>& clusters);
+  void applyClusters(const std::vector<DecodedCluster>& clusters,
+                     const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                     const std::string& system_version_info);
   void runInitializeCallbackIfAny();
 
   ClusterManager& cm_;
+  ThreadLocal::Instance& tls_;
   std::unique_ptr<Config::Subscription> subscription_;
   std::string system_version_info_;
   std::function<void()> initialize_callback_;
   Stats::ScopePtr scope_;
   ProtobufMessage::ValidationVisitor& validation_visitor_;
+  Thread::ThreadFactory& thread_factory_;
 };
 
 } // namespace Upstream
@@ -22,6 +22,7 @@
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
 #include "common/config/new_grpc_mux_impl.h"
+#include "common/config/snapshot_cache.h"
 #include "common/config/utility.h"
 #include "common/config/version_converter.h"
 #include "common/grpc/async_client_manager_impl.h"
@@ -250,7 +251,7 @@ ClusterManagerImpl::ClusterManagerImpl(
         (cluster.type() == envoy::config::cluster::v3::Cluster::EDS &&
          cluster.eds_cluster_config().eds_config().config_source_specifier_case() ==
              envoy::config::core::v3::ConfigSource::ConfigSourceSpecifierCase::kPath)) {
-      loadCluster(cluster, "", false, active_clusters_);
+      loadCluster(cluster, MessageUtil::hash(cluster), "", false, active_clusters_);
     }
   }
 
@@ -294,7 +295,10 @@ ClusterManagerImpl::ClusterManagerImpl(
                     "StreamAggregatedResources"),
           dyn_resources.ads_config().transport_api_version(), random_, stats_,
           Envoy::Config::Utility::parseRateLimitSettings(dyn_resources.ads_config()),
-          bootstrap.dynamic_resources().ads_config().set_node_on_first_message_only());
+          bootstrap.dynamic_resources().ads_config().set_node_on_first_message_only(),
+          dyn_resources.ads_snapshot_path().empty()
+              ? nullptr
+              : std::make_unique<Config::SnapshotCache>(dyn_resources.ads_snapshot_path(), api));
     }
   } else {
     ads_mux_ = std::make_unique<Config::NullGrpcMuxImpl>();
@@ -306,7 +310,7 @@ ClusterManagerImpl::ClusterManagerImpl(
     if (cluster.type() == envoy::config::cluster::v3::Cluster::EDS &&
         cluster.eds_cluster_config().eds_config().config_source_specifier_case() !=
             envoy::config::core::v3::ConfigSource::ConfigSourceSpecifierCase::kPath) {
-      loadCluster(cluster, "", false, active_clusters_);
+      loadCluster(cluster, MessageUtil::hash(cluster), "", false, active_clusters_);
     }
   }
 
@@ -568,7 +572,8 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cl
   //       and easy to understand.
   const bool use_active_map =
       init_helper_.state() != ClusterManagerInitHelper::State::AllClustersInitialized;
-  loadCluster(cluster, version_info, true, use_active_map ? active_clusters_ : warming_clusters_);
+  loadCluster(cluster, new_hash, version_info, true,
+              use_active_map ? active_clusters_ : warming_clusters_);
 
   if (use_active_map) {
     ENVOY_LOG(debug, "add/update cluster {} during init", cluster_name);
@@ -618,6 +623,8 @@ void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster)
     for (auto& cb : cluster_manager.update_callbacks_) {
       cb->onClusterAddOrUpdate(*thread_local_cluster);
     }
+    cluster_manager.completeClusterDiscoveries(new_cluster->name(),
+                                               ClusterDiscoveryStatus::Available);
   });
 }
 
@@ -663,8 +670,8 @@ bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
 }
 
 void ClusterManagerImpl::loadCluster(const envoy::config::cluster::v3::Cluster& cluster,
-                                     const std::string& version_info, bool added_via_api,
-                                     ClusterMap& cluster_map) {
+                                     uint64_t cluster_hash, const std::string& version_info,
+                                     bool added_via_api, ClusterMap& cluster_map) {
   std::pair<ClusterSharedPtr, ThreadAwareLoadBalancerPtr> new_cluster_pair =
       factory_.clusterFromProto(cluster, *this, outlier_event_logger_, added_via_api);
   auto& new_cluster = new_cluster_pair.first;
@@ -711,7 +718,7 @@ void ClusterManagerImpl::loadCluster(const envoy::config::cluster::v3::Cluster&
   }
 
   cluster_map[cluster_reference.info()->name()] = std::make_unique<ClusterData>(
-      cluster, version_info, added_via_api, std::move(new_cluster), time_source_);
+      cluster, cluster_hash, version_info, added_via_api, std::move(new_cluster), time_source_);
   const auto cluster_entry_it = cluster_map.find(cluster_reference.info()->name());
 
   // If an LB is thread aware, create it here. The LB is not initialized until cluster pre-init
@@ -875,6 +882,53 @@ ClusterManagerImpl::addThreadLocalClusterUpdateCallbacks(ClusterUpdateCallbacks&
   return std::make_unique<ClusterUpdateCallbacksHandleImpl>(cb, cluster_manager.update_callbacks_);
 }
 
+OdCdsApiHandleSharedPtr
+ClusterManagerImpl::allocateOdCdsApi(const envoy::config::core::v3::ConfigSource& odcds_config,
+                                     absl::optional<std::chrono::milliseconds> idle_timeout,
+                                     ProtobufMessage::ValidationVisitor& validation_visitor) {
+  for (const OdCdsApiEntry& entry : odcds_apis_) {
+    if (entry.idle_timeout_ == idle_timeout && MessageUtil::equal(entry.config_, odcds_config)) {
+      return entry.handle_;
+    }
+  }
+  auto handle = std::make_shared<OdCdsApiHandleImpl>(
+      *this, OdCdsApiImpl::create(odcds_config, idle_timeout, *this, *this, dispatcher_, stats_,
+                                  validation_visitor));
+  odcds_apis_.push_back({odcds_config, idle_timeout, handle});
+  return handle;
+}
+
+void ClusterManagerImpl::notifyMissingCluster(const std::string& cluster_name) {
+  tls_->runOnAllThreads([this, cluster_name]() -> void {
+    ThreadLocalClusterManagerImpl& cluster_manager =
+        tls_->getTyped<ThreadLocalClusterManagerImpl>();
+    // The cluster may have been added by another subscription in the meantime.
+    if (!cluster_manager.thread_local_clusters_.contains(cluster_name)) {
+      cluster_manager.completeClusterDiscoveries(cluster_name, ClusterDiscoveryStatus::Missing);
+    }
+  });
+}
+
+ClusterDiscoveryCallbackHandlePtr ClusterManagerImpl::requestOnDemandClusterDiscovery(
+    const OdCdsApiSharedPtr& odcds, const std::string& name, ClusterDiscoveryCallbackPtr callback,
+    std::chrono::milliseconds timeout) {
+  ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
+  if (cluster_manager.thread_local_clusters_.contains(name)) {
+    return nullptr;
+  }
+
+  // Only the first pending request of a thread for a cluster is forwarded to the main thread, the
+  // others wait for the same cluster update.
+  const bool first_request = !cluster_manager.pending_cluster_discoveries_.contains(name);
+  auto handle = std::make_unique<ClusterDiscoveryCallbackHandleImpl>(
+      cluster_manager, name, std::move(callback), timeout);
+  if (first_request) {
+    ENVOY_LOG(debug, "requesting on-demand discovery of cluster {}", name);
+    dispatcher_.post([odcds, name]() -> void { odcds->updateOnDemand(name); });
+  }
+  return handle;
+}
+
 ProtobufTypes::MessagePtr ClusterManagerImpl::dumpClusterConfigs() {
   auto config_dump = std::make_unique<envoy::admin::v3::ClustersConfigDump>();
   config_dump->set_version_info(cds_api_ != nullptr ? cds_api_->versionInfo() : "");
@@ -942,6 +996,13 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
   // member update callback registered with the local cluster.
   ENVOY_LOG(debug, "shutting down thread local cluster manager");
   destroying_ = true;
+  for (auto& pending : pending_cluster_discoveries_) {
+    for (ClusterDiscoveryCallbackHandleImpl* request : pending.second) {
+      request->entry_.reset();
+      request->timeout_timer_->disableTimer();
+    }
+  }
+  pending_cluster_discoveries_.clear();
   host_http_conn_pool_map_.clear();
   host_tcp_conn_pool_map_.clear();
   ASSERT(host_tcp_conn_map_.empty());
@@ -1147,6 +1208,29 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
   }
 }
 
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeClusterDiscovery(
+    ClusterDiscoveryCallbackHandleImpl& request) {
+  ASSERT(request.entry_.has_value());
+  auto pending = pending_cluster_discoveries_.find(request.name_);
+  ASSERT(pending != pending_cluster_discoveries_.end());
+  pending->second.erase(request.entry_.value());
+  request.entry_.reset();
+  if (pending->second.empty()) {
+    pending_cluster_discoveries_.erase(pending);
+  }
+}
+
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::completeClusterDiscoveries(
+    const std::string& name, ClusterDiscoveryStatus status) {
+  // Each callback may delete other pending requests, or make new ones, so the pending requests are
+  // looked up again after each of them.
+  auto pending = pending_cluster_discoveries_.find(name);
+  while (pending != pending_cluster_discoveries_.end()) {
+    pending->second.front()->complete(status);
+    pending = pending_cluster_discoveries_.find(name);
+  }
+}
+
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ConnPoolsContainer*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::getHttpConnPoolsContainer(
     const HostConstSharedPtr& host, bool allocate) {
@@ -1162,6 +1246,32 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::getHttpConnPoolsContainer(
   return &container_iter->second;
 }
 
+ClusterManagerImpl::ClusterDiscoveryCallbackHandleImpl::ClusterDiscoveryCallbackHandleImpl(
+    ThreadLocalClusterManagerImpl& parent, const std::string& name,
+    ClusterDiscoveryCallbackPtr&& callback, std::chrono::milliseconds timeout)
+    : parent_(parent), name_(name), callback_(std::move(callback)),
+      timeout_timer_(parent.thread_local_dispatcher_.createTimer(
+          [this]() -> void { complete(ClusterDiscoveryStatus::Timeout); })) {
+  auto& pending = parent_.pending_cluster_discoveries_[name_];
+  entry_ = pending.insert(pending.end(), this);
+  timeout_timer_->enableTimer(timeout);
+}
+
+ClusterManagerImpl::ClusterDiscoveryCallbackHandleImpl::~ClusterDiscoveryCallbackHandleImpl() {
+  if (entry_.has_value()) {
+    parent_.removeClusterDiscovery(*this);
+  }
+}
+
+void ClusterManagerImpl::ClusterDiscoveryCallbackHandleImpl::complete(
+    ClusterDiscoveryStatus status) {
+  parent_.removeClusterDiscovery(*this);
+  timeout_timer_->disableTimer();
+  // The callback may delete this handle.
+  ClusterDiscoveryCallbackPtr callback = std::move(callback_);
+  (*callback)(status);
+}
+
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     ThreadLocalClusterManagerImpl& parent, ClusterInfoConstSharedPtr cluster,
     const LoadBalancerFactorySharedPtr& lb_factory)
@@ -1374,7 +1484,8 @@ CdsApiPtr
 ProdClusterManagerFactory::createCds(const envoy::config::core::v3::ConfigSource& cds_config,
                                      ClusterManager& cm) {
   // TODO(htuch): Differentiate static vs. dynamic validation visitors.
-  return CdsApiImpl::create(cds_config, cm, stats_, validation_context_.dynamicValidationVisitor());
+  return CdsApiImpl::create(cds_config, cm, tls_, stats_,
+                            validation_context_.dynamicValidationVisitor(), api_.threadFactory());
 }
 
 } // namespace Upstream
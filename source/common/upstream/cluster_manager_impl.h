@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
@@ -28,6 +29,7 @@
 #include "common/config/subscription_factory_impl.h"
 #include "common/http/async_client_impl.h"
 #include "common/upstream/load_stats_reporter.h"
+#include "common/upstream/od_cds_api_impl.h"
 #include "common/upstream/priority_conn_pool_map.h"
 #include "common/upstream/upstream_impl.h"
 
@@ -176,7 +178,9 @@ struct ClusterManagerStats {
  * Implementation of ClusterManager that reads from a proto configuration, maintains a central
  * cluster list, as well as thread local caches of each cluster and associated connection pools.
  */
-class ClusterManagerImpl : public ClusterManager, Logger::Loggable<Logger::Id::upstream> {
+class ClusterManagerImpl : public ClusterManager,
+                           public MissingClusterNotifier,
+                           Logger::Loggable<Logger::Id::upstream> {
 public:
   ClusterManagerImpl(const envoy::config::bootstrap::v3::Bootstrap& bootstrap,
                      ClusterManagerFactory& factory, Stats::Store& stats,
@@ -220,6 +224,7 @@ public:
   void shutdown() override {
     // Make sure we destroy all potential outgoing connections before this returns.
     cds_api_.reset();
+    odcds_apis_.clear();
     ads_mux_.reset();
     active_clusters_.clear();
     warming_clusters_.clear();
@@ -242,6 +247,14 @@ public:
 
   Config::SubscriptionFactory& subscriptionFactory() override { return subscription_factory_; }
 
+  OdCdsApiHandleSharedPtr
+  allocateOdCdsApi(const envoy::config::core::v3::ConfigSource& odcds_config,
+                   absl::optional<std::chrono::milliseconds> idle_timeout,
+                   ProtobufMessage::ValidationVisitor& validation_visitor) override;
+
+  // Upstream::MissingClusterNotifier
+  void notifyMissingCluster(const std::string& cluster_name) override;
+
 protected:
   virtual void postThreadLocalDrainConnections(const Cluster& cluster,
                                                const HostVector& hosts_removed);
@@ -250,6 +263,8 @@ protected:
                                             const HostVector& hosts_removed);
 
 private:
+  struct ClusterDiscoveryCallbackHandleImpl;
+
   /**
    * Thread local cached cluster data. Each thread local cluster gets updates from the parent
    * central dynamic cluster (if applicable). It maintains load balancer state and any created
@@ -349,6 +364,10 @@ private:
                                         const HostVector& hosts_removed, ThreadLocal::Slot& tls,
                                         uint64_t overprovisioning_factor);
     static void onHostHealthFailure(const HostSharedPtr& host, ThreadLocal::Slot& tls);
+    void removeClusterDiscovery(ClusterDiscoveryCallbackHandleImpl& request);
+    // Completes the pending discovery requests for a cluster which was added on this thread, or
+    // which is missing from the config source.
+    void completeClusterDiscoveries(const std::string& name, ClusterDiscoveryStatus status);
 
     ConnPoolsContainer* getHttpConnPoolsContainer(const HostConstSharedPtr& host,
                                                   bool allocate = false);
@@ -364,15 +383,18 @@ private:
     std::unordered_map<HostConstSharedPtr, TcpConnectionsMap> host_tcp_conn_map_;
 
     std::list<Envoy::Upstream::ClusterUpdateCallbacks*> update_callbacks_;
+    // The pending on-demand discovery requests made on this thread, by cluster name.
+    absl::flat_hash_map<std::string, std::list<ClusterDiscoveryCallbackHandleImpl*>>
+        pending_cluster_discoveries_;
     const PrioritySet* local_priority_set_{};
     bool destroying_{};
   };
 
   struct ClusterData {
-    ClusterData(const envoy::config::cluster::v3::Cluster& cluster_config,
+    ClusterData(const envoy::config::cluster::v3::Cluster& cluster_config, uint64_t config_hash,
                 const std::string& version_info, bool added_via_api, ClusterSharedPtr&& cluster,
                 TimeSource& time_source)
-        : cluster_config_(cluster_config), config_hash_(MessageUtil::hash(cluster_config)),
+        : cluster_config_(cluster_config), config_hash_(config_hash),
           version_info_(version_info), added_via_api_(added_via_api), cluster_(std::move(cluster)),
           last_updated_(time_source.systemTime()) {}
 
@@ -403,6 +425,44 @@ private:
         : RaiiListElement<ClusterUpdateCallbacks*>(parent, &cb) {}
   };
 
+  // An on-demand cluster discovery request made on a worker, pending until the cluster is added on
+  // that worker or the request times out.
+  struct ClusterDiscoveryCallbackHandleImpl : public ClusterDiscoveryCallbackHandle {
+    ClusterDiscoveryCallbackHandleImpl(ThreadLocalClusterManagerImpl& parent,
+                                       const std::string& name,
+                                       ClusterDiscoveryCallbackPtr&& callback,
+                                       std::chrono::milliseconds timeout);
+    ~ClusterDiscoveryCallbackHandleImpl() override;
+
+    // Removes the request from the pending ones and runs its callback, which may delete the
+    // handle.
+    void complete(ClusterDiscoveryStatus status);
+
+    ThreadLocalClusterManagerImpl& parent_;
+    const std::string name_;
+    ClusterDiscoveryCallbackPtr callback_;
+    Event::TimerPtr timeout_timer_;
+    // The position of the request among the pending ones for its cluster, while it is pending.
+    absl::optional<std::list<ClusterDiscoveryCallbackHandleImpl*>::iterator> entry_;
+  };
+
+  class OdCdsApiHandleImpl : public OdCdsApiHandle {
+  public:
+    OdCdsApiHandleImpl(ClusterManagerImpl& parent, OdCdsApiSharedPtr odcds)
+        : parent_(parent), odcds_(std::move(odcds)) {}
+
+    // Upstream::OdCdsApiHandle
+    ClusterDiscoveryCallbackHandlePtr
+    requestOnDemandClusterDiscovery(const std::string& name, ClusterDiscoveryCallbackPtr callback,
+                                    std::chrono::milliseconds timeout) override {
+      return parent_.requestOnDemandClusterDiscovery(odcds_, name, std::move(callback), timeout);
+    }
+
+  private:
+    ClusterManagerImpl& parent_;
+    OdCdsApiSharedPtr odcds_;
+  };
+
   using ClusterDataPtr = std::unique_ptr<ClusterData>;
   // This map is ordered so that config dumping is consistent.
   using ClusterMap = std::map<std::string, ClusterDataPtr>;
@@ -448,9 +508,13 @@ private:
   bool scheduleUpdate(const Cluster& cluster, uint32_t priority, bool mergeable,
                       const uint64_t timeout);
   void createOrUpdateThreadLocalCluster(ClusterData& cluster);
+  ClusterDiscoveryCallbackHandlePtr
+  requestOnDemandClusterDiscovery(const OdCdsApiSharedPtr& odcds, const std::string& name,
+                                  ClusterDiscoveryCallbackPtr callback,
+                                  std::chrono::milliseconds timeout);
   ProtobufTypes::MessagePtr dumpClusterConfigs();
   static ClusterManagerStats generateStats(Stats::Scope& scope);
-  void loadCluster(const envoy::config::cluster::v3::Cluster& cluster,
+  void loadCluster(const envoy::config::cluster::v3::Cluster& cluster, uint64_t cluster_hash,
                    const std::string& version_info, bool added_via_api, ClusterMap& cluster_map);
   void onClusterInit(Cluster& cluster);
   void postThreadLocalHealthFailure(const HostSharedPtr& host);
@@ -471,6 +535,15 @@ private:
   Outlier::EventLoggerSharedPtr outlier_event_logger_;
   const LocalInfo::LocalInfo& local_info_;
   CdsApiPtr cds_api_;
+  // An on-demand CDS subscription, shared by the callers of allocateOdCdsApi() with the same
+  // configuration source and idle timeout.
+  struct OdCdsApiEntry {
+    const envoy::config::core::v3::ConfigSource config_;
+    const absl::optional<std::chrono::milliseconds> idle_timeout_;
+    const OdCdsApiHandleSharedPtr handle_;
+  };
+  // Few distinct configuration sources are expected, so they are looked up linearly.
+  std::vector<OdCdsApiEntry> odcds_apis_;
   ClusterManagerStats cm_stats_;
   ClusterManagerInitHelper init_helper_;
   Config::GrpcMuxSharedPtr ads_mux_;
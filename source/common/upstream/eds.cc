@@ -1,5 +1,7 @@
 #include "common/upstream/eds.h"
 
+#include <tuple>
+
 #include "envoy/api/v2/endpoint.pb.h"
 #include "envoy/common/exception.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -9,9 +11,11 @@
 #include "envoy/service/discovery/v3/discovery.pb.h"
 
 #include "common/common/assert.h"
+#include "common/common/hash.h"
 #include "common/common/utility.h"
 #include "common/config/api_version.h"
 #include "common/config/version_converter.h"
+#include "common/stats/timespan_impl.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -28,7 +32,10 @@ EdsClusterImpl::EdsClusterImpl(
       cluster_name_(cluster.eds_cluster_config().service_name().empty()
                         ? cluster.name()
                         : cluster.eds_cluster_config().service_name()),
-      validation_visitor_(factory_context.messageValidationVisitor()) {
+      validation_visitor_(factory_context.messageValidationVisitor()),
+      eds_stats_scope_(info_->statsScope().createScope("eds.")),
+      eds_stats_(generateStats(*eds_stats_scope_)),
+      time_source_(factory_context.dispatcher().timeSource()) {
   Event::Dispatcher& dispatcher = factory_context.dispatcher();
   assignment_timeout_ = dispatcher.createTimer([this]() -> void { onAssignmentTimeout(); });
   const auto& eds_config = cluster.eds_cluster_config().eds_config();
@@ -47,18 +54,38 @@ EdsClusterImpl::EdsClusterImpl(
 void EdsClusterImpl::startPreInit() { subscription_->start({cluster_name_}); }
 
 void EdsClusterImpl::BatchUpdateHelper::batchUpdate(PrioritySet::HostUpdateCb& host_update_cb) {
+  Stats::HistogramCompletableTimespanImpl update_timespan(parent_.eds_stats_.update_duration_us_,
+                                                          parent_.time_source_);
   std::unordered_map<std::string, HostSharedPtr> updated_hosts;
+  // The endpoints of this update by the hash of their config, with the hosts registered for them.
+  std::vector<std::tuple<uint64_t, const envoy::config::endpoint::v3::LbEndpoint*, HostSharedPtr>>
+      endpoint_hosts;
   PriorityStateManager priority_state_manager(parent_, parent_.local_info_, &host_update_cb);
   for (const auto& locality_lb_endpoint : cluster_load_assignment_.endpoints()) {
     parent_.validateEndpointsForZoneAwareRouting(locality_lb_endpoint);
 
     priority_state_manager.initializePriorityFor(locality_lb_endpoint);
 
+    const uint64_t locality_hash = MessageUtil::hash(locality_lb_endpoint.locality());
     for (const auto& lb_endpoint : locality_lb_endpoint.lb_endpoints()) {
-      priority_state_manager.registerHostForPriority(
-          lb_endpoint.endpoint().hostname(),
-          parent_.resolveProtoAddress(lb_endpoint.endpoint().address()), locality_lb_endpoint,
-          lb_endpoint);
+      const uint64_t endpoint_hash = endpointHash(locality_lb_endpoint, locality_hash, lb_endpoint);
+      // A host built from the same config as the current host of the endpoint would only be matched
+      // with it and discarded, so the current host is registered as is.
+      const HostSharedPtr current_host =
+          parent_.currentHostForEndpoint(endpoint_hash, locality_lb_endpoint, lb_endpoint);
+      if (current_host != nullptr) {
+        parent_.eds_stats_.hosts_reused_.inc();
+        priority_state_manager.registerHostForPriority(current_host, locality_lb_endpoint);
+      } else {
+        parent_.eds_stats_.hosts_created_.inc();
+        priority_state_manager.registerHostForPriority(
+            lb_endpoint.endpoint().hostname(),
+            parent_.resolveProtoAddress(lb_endpoint.endpoint().address()), locality_lb_endpoint,
+            lb_endpoint);
+      }
+      endpoint_hosts.emplace_back(
+          endpoint_hash, &lb_endpoint,
+          priority_state_manager.priorityState()[locality_lb_endpoint.priority()].first->back());
     }
   }
 
@@ -103,15 +130,63 @@ void EdsClusterImpl::BatchUpdateHelper::batchUpdate(PrioritySet::HostUpdateCb& h
 
   parent_.all_hosts_ = std::move(updated_hosts);
 
+  // The hosts registered for the endpoints may have been matched with existing hosts, which are
+  // kept instead, so the endpoints are mapped to the hosts which are current after the update.
+  parent_.hosts_by_endpoint_hash_.clear();
+  for (const auto& endpoint_host : endpoint_hosts) {
+    const auto host = parent_.all_hosts_.find(std::get<2>(endpoint_host)->address()->asString());
+    if (host != parent_.all_hosts_.end()) {
+      parent_.hosts_by_endpoint_hash_.emplace(
+          std::get<0>(endpoint_host), EndpointHost{*std::get<1>(endpoint_host), host->second});
+    }
+  }
+
   if (!cluster_rebuilt) {
     parent_.info_->stats().update_no_rebuild_.inc();
   }
+  update_timespan.complete();
 
   // If we didn't setup to initialize when our first round of health checking is complete, just
   // do it now.
   parent_.onPreInitComplete();
 }
 
+uint64_t EdsClusterImpl::endpointHash(
+    const envoy::config::endpoint::v3::LocalityLbEndpoints& locality_lb_endpoint,
+    uint64_t locality_hash, const envoy::config::endpoint::v3::LbEndpoint& lb_endpoint) {
+  const uint64_t hashes[] = {MessageUtil::hash(lb_endpoint), locality_hash,
+                             locality_lb_endpoint.priority()};
+  return HashUtil::xxHash64(
+      absl::string_view(reinterpret_cast<const char*>(hashes), sizeof(hashes)));
+}
+
+HostSharedPtr EdsClusterImpl::currentHostForEndpoint(
+    uint64_t endpoint_hash,
+    const envoy::config::endpoint::v3::LocalityLbEndpoints& locality_lb_endpoint,
+    const envoy::config::endpoint::v3::LbEndpoint& lb_endpoint) const {
+  const auto endpoint_host = hosts_by_endpoint_hash_.find(endpoint_hash);
+  if (endpoint_host == hosts_by_endpoint_hash_.end()) {
+    return nullptr;
+  }
+  // Endpoints which hash the same aren't necessarily the same endpoint.
+  const HostSharedPtr& host = endpoint_host->second.host_;
+  if (!MessageUtil::equal(endpoint_host->second.lb_endpoint_, lb_endpoint) ||
+      !MessageUtil::equal(host->locality(), locality_lb_endpoint.locality()) ||
+      host->priority() != locality_lb_endpoint.priority()) {
+    return nullptr;
+  }
+  // The host may have been removed from the cluster since the last update.
+  const auto current_host = all_hosts_.find(host->address()->asString());
+  if (current_host == all_hosts_.end() || current_host->second != host) {
+    return nullptr;
+  }
+  return host;
+}
+
+EdsClusterStats EdsClusterImpl::generateStats(Stats::Scope& scope) {
+  return {ALL_EDS_CLUSTER_STATS(POOL_COUNTER(scope), POOL_HISTOGRAM(scope))};
+}
+
 void EdsClusterImpl::onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
                                     const std::string&) {
   if (!validateUpdateSize(resources.size())) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "envoy/common/time.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/config/core/v3/base.pb.h"
 #include "envoy/config/core/v3/config_source.pb.h"
@@ -10,17 +11,36 @@
 #include "envoy/secret/secret_manager.h"
 #include "envoy/service/discovery/v3/discovery.pb.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/upstream/locality.h"
 
 #include "common/config/subscription_base.h"
+#include "common/config/utility.h"
 #include "common/upstream/cluster_factory_impl.h"
 #include "common/upstream/upstream_impl.h"
 
 #include "extensions/clusters/well_known_names.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
+/**
+ * All EDS cluster stats. @see stats_macros.h
+ */
+#define ALL_EDS_CLUSTER_STATS(COUNTER, HISTOGRAM)                                                  \
+  COUNTER(hosts_created)                                                                           \
+  COUNTER(hosts_reused)                                                                            \
+  HISTOGRAM(update_duration_us, Microseconds)
+
+/**
+ * Struct definition for all EDS cluster stats. @see stats_macros.h
+ */
+struct EdsClusterStats {
+  ALL_EDS_CLUSTER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
 /**
  * Cluster implementation that reads host information from the Endpoint Discovery Service.
  */
@@ -44,8 +64,8 @@ private:
   void onConfigUpdateFailed(Envoy::Config::ConfigUpdateFailureReason reason,
                             const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
-    return MessageUtil::anyConvert<envoy::config::endpoint::v3::ClusterLoadAssignment>(resource)
-        .cluster_name();
+    return Config::Utility::resourceNameFromAny(
+        resource, envoy::config::endpoint::v3::ClusterLoadAssignment::kClusterNameFieldNumber);
   }
   using LocalityWeightsMap = std::unordered_map<envoy::config::core::v3::Locality, uint32_t,
                                                 LocalityHash, LocalityEqualTo>;
@@ -55,6 +75,18 @@ private:
                               PriorityStateManager& priority_state_manager,
                               std::unordered_map<std::string, HostSharedPtr>& updated_hosts);
   bool validateUpdateSize(int num_resources);
+  // Hashes the config a host is built from, i.e. the endpoint and the locality and priority of its
+  // group.
+  static uint64_t
+  endpointHash(const envoy::config::endpoint::v3::LocalityLbEndpoints& locality_lb_endpoint,
+               uint64_t locality_hash, const envoy::config::endpoint::v3::LbEndpoint& lb_endpoint);
+  // Returns the current host of the endpoint with the given hash in the last update, if it was
+  // built from the same config, i.e. the same endpoint in the same locality and priority.
+  HostSharedPtr currentHostForEndpoint(
+      uint64_t endpoint_hash,
+      const envoy::config::endpoint::v3::LocalityLbEndpoints& locality_lb_endpoint,
+      const envoy::config::endpoint::v3::LbEndpoint& lb_endpoint) const;
+  static EdsClusterStats generateStats(Stats::Scope& scope);
 
   // ClusterImplBase
   void reloadHealthyHostsHelper(const HostSharedPtr& host) override;
@@ -84,6 +116,16 @@ private:
   Event::TimerPtr assignment_timeout_;
   ProtobufMessage::ValidationVisitor& validation_visitor_;
   InitializePhase initialize_phase_;
+  Stats::ScopePtr eds_stats_scope_;
+  EdsClusterStats eds_stats_;
+  TimeSource& time_source_;
+  // A host of the last update, along with the endpoint it was built from.
+  struct EndpointHost {
+    const envoy::config::endpoint::v3::LbEndpoint lb_endpoint_;
+    const HostSharedPtr host_;
+  };
+  // The hosts of the endpoints of the last update, by the hash of the config they were built from.
+  absl::flat_hash_map<uint64_t, EndpointHost> hosts_by_endpoint_hash_;
 };
 
 class EdsClusterFactory : public ClusterFactoryImplBase {
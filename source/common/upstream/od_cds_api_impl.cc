@@ -0,0 +1,263 @@
+#include "common/upstream/od_cds_api_impl.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/config/cluster/v3/cluster.pb.validate.h"
+#include "envoy/config/core/v3/config_source.pb.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/grpc/common.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/container/flat_hash_set.h"
+
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// The activity of a cluster which has not been through an idle check yet, so that a cluster is
+// never removed before the request which caused its discovery had the time to use it.
+constexpr uint64_t UncheckedActivity = std::numeric_limits<uint64_t>::max();
+
+} // namespace
+
+OdCdsApiSharedPtr OdCdsApiImpl::create(const envoy::config::core::v3::ConfigSource& odcds_config,
+                                       absl::optional<std::chrono::milliseconds> idle_timeout,
+                                       ClusterManager& cm, MissingClusterNotifier& notifier,
+                                       Event::Dispatcher& dispatcher, Stats::Scope& scope,
+                                       ProtobufMessage::ValidationVisitor& validation_visitor) {
+  return OdCdsApiSharedPtr{new OdCdsApiImpl(odcds_config, idle_timeout, cm, notifier, dispatcher,
+                                            scope, validation_visitor)};
+}
+
+OdCdsApiImpl::OdCdsApiImpl(const envoy::config::core::v3::ConfigSource& odcds_config,
+                           absl::optional<std::chrono::milliseconds> idle_timeout,
+                           ClusterManager& cm, MissingClusterNotifier& notifier,
+                           Event::Dispatcher& dispatcher, Stats::Scope& scope,
+                           ProtobufMessage::ValidationVisitor& validation_visitor)
+    : Envoy::Config::SubscriptionBase<envoy::config::cluster::v3::Cluster>(
+          odcds_config.resource_api_version()),
+      odcds_config_(odcds_config), cm_(cm), notifier_(notifier),
+      scope_(scope.createScope("cluster_manager.odcds.")), validation_visitor_(validation_visitor),
+      idle_timeout_(idle_timeout) {
+  subscription_ = createSubscription();
+  if (idle_timeout_.has_value()) {
+    idle_timer_ = dispatcher.createTimer([this]() -> void {
+      removeIdleClusters();
+      idle_timer_->enableTimer(idle_timeout_.value());
+    });
+    idle_timer_->enableTimer(idle_timeout_.value());
+  }
+  cluster_update_callbacks_handle_ = cm_.addThreadLocalClusterUpdateCallbacks(*this);
+}
+
+std::unique_ptr<Config::Subscription> OdCdsApiImpl::createSubscription() {
+  const auto resource_name = getResourceName();
+  return cm_.subscriptionFactory().subscriptionFromConfigSource(
+      odcds_config_, Grpc::Common::typeUrl(resource_name), *scope_, *this);
+}
+
+void OdCdsApiImpl::updateOnDemand(const std::string& cluster_name) {
+  if (!cluster_names_.insert(cluster_name).second) {
+    return;
+  }
+  ENVOY_LOG(debug, "odcds: requesting cluster '{}'", cluster_name);
+  unconfirmed_cluster_names_.insert(cluster_name);
+  if (resubscribe_) {
+    // The previous subscription may still be interested in this cluster, in which case updating
+    // its interest would not have the cluster sent again.
+    subscription_ = createSubscription();
+    started_ = false;
+    resubscribe_ = false;
+  }
+  if (!started_) {
+    started_ = true;
+    subscription_->start(cluster_names_);
+  } else {
+    subscription_->updateResourceInterest(cluster_names_);
+  }
+}
+
+void OdCdsApiImpl::updateResourceInterest() {
+  // An empty interest would subscribe to all clusters, so the subscription stays interested in
+  // the last clusters, which are ignored if received again, until it is replaced.
+  if (cluster_names_.empty()) {
+    resubscribe_ = true;
+    return;
+  }
+  subscription_->updateResourceInterest(cluster_names_);
+}
+
+void OdCdsApiImpl::onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                                  const std::string& version_info) {
+  // The whole update is decoded before any cluster is applied, so that an invalid cluster rejects
+  // it as a whole.
+  std::vector<envoy::config::cluster::v3::Cluster> clusters;
+  clusters.reserve(resources.size());
+  absl::flat_hash_set<std::string> cluster_names;
+  for (const auto& resource : resources) {
+    clusters.push_back(MessageUtil::anyConvertAndValidate<envoy::config::cluster::v3::Cluster>(
+        resource, validation_visitor_));
+    if (!cluster_names.insert(clusters.back().name()).second) {
+      throw EnvoyException(fmt::format("duplicate cluster {} found", clusters.back().name()));
+    }
+  }
+  std::vector<std::string> clusters_to_remove;
+  for (const auto& cluster : added_clusters_) {
+    if (!cluster_names.contains(cluster.first)) {
+      clusters_to_remove.push_back(cluster.first);
+    }
+  }
+  for (const auto& cluster : clusters) {
+    addOrUpdateCluster(cluster, version_info);
+  }
+  for (const auto& cluster_name : clusters_to_remove) {
+    removeCluster(cluster_name);
+  }
+
+  // The config source does not have the clusters missing from an update, unless they were
+  // requested since the previous update, which this one may predate. The request acknowledging
+  // this update carries them, so they are checked by the next update.
+  std::vector<std::string> missing_clusters;
+  for (const auto& cluster_name : cluster_names_) {
+    if (!cluster_names.contains(cluster_name) &&
+        !unconfirmed_cluster_names_.contains(cluster_name)) {
+      missing_clusters.push_back(cluster_name);
+    }
+  }
+  unconfirmed_cluster_names_.clear();
+  for (const auto& cluster_name : missing_clusters) {
+    removeMissingCluster(cluster_name);
+  }
+  if (!missing_clusters.empty()) {
+    updateResourceInterest();
+  }
+}
+
+void OdCdsApiImpl::onConfigUpdate(
+    const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+    const Protobuf::RepeatedPtrField<std::string>& removed_resources, const std::string&) {
+  std::vector<envoy::config::cluster::v3::Cluster> clusters;
+  clusters.reserve(added_resources.size());
+  for (const auto& resource : added_resources) {
+    clusters.push_back(MessageUtil::anyConvertAndValidate<envoy::config::cluster::v3::Cluster>(
+        resource.resource(), validation_visitor_));
+  }
+  for (int i = 0; i < added_resources.size(); i++) {
+    addOrUpdateCluster(clusters[i], added_resources[i].version());
+  }
+  // The config source lists the clusters it does not have, or no longer has, as removed.
+  bool interest_changed = false;
+  for (const auto& cluster_name : removed_resources) {
+    removeCluster(cluster_name);
+    if (cluster_names_.count(cluster_name) > 0) {
+      removeMissingCluster(cluster_name);
+      interest_changed = true;
+    }
+  }
+  if (interest_changed) {
+    updateResourceInterest();
+  }
+}
+
+void OdCdsApiImpl::onConfigUpdateFailed(Envoy::Config::ConfigUpdateFailureReason reason,
+                                        const EnvoyException*) {
+  ASSERT(Envoy::Config::ConfigUpdateFailureReason::ConnectionFailure != reason);
+  // The requests for the clusters which are not added yet fail rather than time out, and their
+  // next request asks for them again.
+  std::vector<std::string> pending_clusters;
+  for (const auto& cluster_name : cluster_names_) {
+    if (!added_clusters_.contains(cluster_name)) {
+      pending_clusters.push_back(cluster_name);
+    }
+  }
+  for (const auto& cluster_name : pending_clusters) {
+    removeMissingCluster(cluster_name);
+  }
+  if (!pending_clusters.empty()) {
+    updateResourceInterest();
+  }
+}
+
+void OdCdsApiImpl::addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
+                                      const std::string& version_info) {
+  // Sources which do not filter by resource name, such as files, may carry clusters which were
+  // never requested.
+  if (cluster_names_.count(cluster.name()) == 0) {
+    ENVOY_LOG(debug, "odcds: ignoring unrequested cluster '{}'", cluster.name());
+    return;
+  }
+  if (cm_.addOrUpdateCluster(cluster, version_info)) {
+    ENVOY_LOG(info, "odcds: add/update cluster '{}'", cluster.name());
+    added_clusters_.emplace(cluster.name(), UncheckedActivity);
+  } else {
+    ENVOY_LOG(debug, "odcds: add/update cluster '{}' skipped", cluster.name());
+  }
+}
+
+void OdCdsApiImpl::removeCluster(const std::string& cluster_name) {
+  if (added_clusters_.erase(cluster_name) > 0 && cm_.removeCluster(cluster_name)) {
+    ENVOY_LOG(info, "odcds: remove cluster '{}'", cluster_name);
+  }
+}
+
+void OdCdsApiImpl::removeMissingCluster(const std::string& cluster_name) {
+  ENVOY_LOG(debug, "odcds: cluster '{}' is missing", cluster_name);
+  cluster_names_.erase(cluster_name);
+  unconfirmed_cluster_names_.erase(cluster_name);
+  notifier_.notifyMissingCluster(cluster_name);
+}
+
+void OdCdsApiImpl::onClusterRemoval(const std::string& cluster_name) {
+  // The clusters removed by this subscription are no longer in added_clusters_ by now. Others were
+  // removed behind its back, e.g. by a state of the world CDS update which did not carry them.
+  if (added_clusters_.erase(cluster_name) == 0) {
+    return;
+  }
+  ENVOY_LOG(debug, "odcds: cluster '{}' was removed from the cluster manager", cluster_name);
+  cluster_names_.erase(cluster_name);
+  unconfirmed_cluster_names_.erase(cluster_name);
+  updateResourceInterest();
+}
+
+void OdCdsApiImpl::removeIdleClusters() {
+  std::vector<std::string> idle_clusters;
+  for (auto& cluster : added_clusters_) {
+    ThreadLocalCluster* thread_local_cluster = cm_.get(cluster.first);
+    if (thread_local_cluster == nullptr) {
+      // The cluster is still warming.
+      continue;
+    }
+    const ClusterStats& stats = thread_local_cluster->info()->stats();
+    const uint64_t activity = clusterActivity(stats);
+    if (activity == cluster.second && stats.upstream_rq_active_.value() == 0 &&
+        stats.upstream_cx_active_.value() == 0) {
+      idle_clusters.push_back(cluster.first);
+    } else {
+      cluster.second = activity;
+    }
+  }
+  if (idle_clusters.empty()) {
+    return;
+  }
+  for (const auto& cluster_name : idle_clusters) {
+    ENVOY_LOG(debug, "odcds: cluster '{}' is idle", cluster_name);
+    removeCluster(cluster_name);
+    cluster_names_.erase(cluster_name);
+    unconfirmed_cluster_names_.erase(cluster_name);
+  }
+  updateResourceInterest();
+}
+
+uint64_t OdCdsApiImpl::clusterActivity(const ClusterStats& stats) {
+  return stats.upstream_rq_total_.value() + stats.upstream_cx_total_.value();
+}
+
+} // namespace Upstream
+} // namespace Envoy
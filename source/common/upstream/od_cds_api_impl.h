@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "envoy/common/pure.h"
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/config/core/v3/config_source.pb.h"
+#include "envoy/config/subscription.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/protobuf/message_validator.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "common/common/logger.h"
+#include "common/config/subscription_base.h"
+#include "common/config/utility.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Notified of the clusters requested on demand which the config source does not have, or whose
+ * update was rejected, so that the requests waiting for them fail without waiting for their
+ * timeout.
+ */
+class MissingClusterNotifier {
+public:
+  virtual ~MissingClusterNotifier() = default;
+
+  /**
+   * @param cluster_name is the name of the missing cluster.
+   */
+  virtual void notifyMissingCluster(const std::string& cluster_name) PURE;
+};
+
+class OdCdsApiImpl;
+using OdCdsApiSharedPtr = std::shared_ptr<OdCdsApiImpl>;
+
+/**
+ * On-demand CDS API implementation. Lives on the main thread, where it subscribes to the clusters
+ * requested by the workers as they are first requested, adds them to the cluster manager as they
+ * are received, and removes them again once they have been idle for the idle timeout, if any.
+ * Clusters removed from the cluster manager, by this subscription or by another one, are
+ * unsubscribed from, so that their next request discovers them again. So are the clusters which
+ * the config source does not have, or whose update was rejected, after the requests waiting for
+ * them were notified through the MissingClusterNotifier.
+ */
+class OdCdsApiImpl : Envoy::Config::SubscriptionBase<envoy::config::cluster::v3::Cluster>,
+                     ClusterUpdateCallbacks,
+                     Logger::Loggable<Logger::Id::upstream> {
+public:
+  static OdCdsApiSharedPtr create(const envoy::config::core::v3::ConfigSource& odcds_config,
+                                  absl::optional<std::chrono::milliseconds> idle_timeout,
+                                  ClusterManager& cm, MissingClusterNotifier& notifier,
+                                  Event::Dispatcher& dispatcher, Stats::Scope& scope,
+                                  ProtobufMessage::ValidationVisitor& validation_visitor);
+
+  /**
+   * Subscribe to a cluster, unless it is already subscribed to.
+   * @param cluster_name is the name of the cluster.
+   */
+  void updateOnDemand(const std::string& cluster_name);
+
+private:
+  OdCdsApiImpl(const envoy::config::core::v3::ConfigSource& odcds_config,
+               absl::optional<std::chrono::milliseconds> idle_timeout, ClusterManager& cm,
+               MissingClusterNotifier& notifier, Event::Dispatcher& dispatcher,
+               Stats::Scope& scope, ProtobufMessage::ValidationVisitor& validation_visitor);
+
+  // Config::SubscriptionCallbacks
+  void onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                      const std::string& version_info) override;
+  void onConfigUpdate(
+      const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+      const std::string& system_version_info) override;
+  void onConfigUpdateFailed(Envoy::Config::ConfigUpdateFailureReason reason,
+                            const EnvoyException* e) override;
+  std::string resourceName(const ProtobufWkt::Any& resource) override {
+    return Config::Utility::resourceNameFromAny(
+        resource, envoy::config::cluster::v3::Cluster::kNameFieldNumber);
+  }
+
+  // Upstream::ClusterUpdateCallbacks
+  void onClusterAddOrUpdate(ThreadLocalCluster&) override {}
+  void onClusterRemoval(const std::string& cluster_name) override;
+
+  std::unique_ptr<Config::Subscription> createSubscription();
+  // Updates the resource interest of the subscription to the clusters subscribed to.
+  void updateResourceInterest();
+  void addOrUpdateCluster(const envoy::config::cluster::v3::Cluster& cluster,
+                          const std::string& version_info);
+  void removeCluster(const std::string& cluster_name);
+  // Unsubscribes from a cluster the config source does not have, and notifies the requests
+  // waiting for it. The caller updates the resource interest afterwards.
+  void removeMissingCluster(const std::string& cluster_name);
+  // Removes the clusters which saw no requests nor connections since the previous check.
+  void removeIdleClusters();
+  static uint64_t clusterActivity(const ClusterStats& stats);
+
+  const envoy::config::core::v3::ConfigSource odcds_config_;
+  ClusterManager& cm_;
+  MissingClusterNotifier& notifier_;
+  Stats::ScopePtr scope_;
+  ProtobufMessage::ValidationVisitor& validation_visitor_;
+  std::unique_ptr<Config::Subscription> subscription_;
+  // The clusters subscribed to, ordered as the subscription expects them.
+  std::set<std::string> cluster_names_;
+  // The clusters subscribed to since the previous state of the world update, which may answer a
+  // request that did not carry them yet.
+  absl::flat_hash_set<std::string> unconfirmed_cluster_names_;
+  bool started_{};
+  // Set once no cluster is subscribed to anymore, in which case the subscription is replaced by a
+  // new one when a cluster is requested again.
+  bool resubscribe_{};
+  // The clusters added by this subscription, with the sum of their request and connection totals
+  // at the previous idle check.
+  absl::flat_hash_map<std::string, uint64_t> added_clusters_;
+  const absl::optional<std::chrono::milliseconds> idle_timeout_;
+  Event::TimerPtr idle_timer_;
+  ClusterUpdateCallbacksHandlePtr cluster_update_callbacks_handle_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -23,6 +23,8 @@
 #include "envoy/secret/secret_manager.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/server/transport_socket_config.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/singleton/manager.h"
 #include "envoy/ssl/context_manager.h"
 #include "envoy/stats/scope.h"
 #include "envoy/upstream/health_checker.h"
@@ -53,8 +55,33 @@
 
 namespace Envoy {
 namespace Upstream {
+
+SINGLETON_MANAGER_REGISTRATION(lazy_cluster_stat_names);
+
 namespace {
 
+// The names of the lazily created cluster stats relative to the scope of each cluster, shared by
+// all the clusters with lazy_stats.
+class LazyClusterStatNames : public Singleton::Instance {
+public:
+  explicit LazyClusterStatNames(Stats::SymbolTable& symbol_table) : names_(symbol_table) {}
+
+  Stats::LazyMetricNames& names() { return names_; }
+
+private:
+  Stats::LazyMetricNames names_;
+};
+
+std::shared_ptr<Stats::LazyMetricNames>
+lazyClusterStatNames(Singleton::Manager& singleton_manager, Stats::SymbolTable& symbol_table) {
+  std::shared_ptr<LazyClusterStatNames> names =
+      singleton_manager.getTyped<LazyClusterStatNames>(
+          SINGLETON_MANAGER_REGISTERED_NAME(lazy_cluster_stat_names),
+          [&symbol_table] { return std::make_shared<LazyClusterStatNames>(symbol_table); });
+  // Aliases the set, keeping the singleton alive along with it.
+  return std::shared_ptr<Stats::LazyMetricNames>(names, &names->names());
+}
+
 const Network::Address::InstanceConstSharedPtr
 getSourceAddress(const envoy::config::cluster::v3::Cluster& cluster,
                  const envoy::config::core::v3::BindConfig& bind_config) {
@@ -237,6 +264,20 @@ HostVector filterHosts(const std::unordered_set<HostSharedPtr>& hosts,
   return net_hosts;
 }
 
+// Shared by the eager (Stats::Scope) and lazy (Stats::LazyMetricPool) stat generation paths.
+template <class Pool>
+ClusterCircuitBreakersStats circuitBreakersStats(Pool& pool, const std::string& stat_prefix,
+                                                 bool track_remaining) {
+  std::string prefix(fmt::format("circuit_breakers.{}.", stat_prefix));
+  if (track_remaining) {
+    return {ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE_PREFIX(pool, prefix),
+                                               POOL_GAUGE_PREFIX(pool, prefix))};
+  } else {
+    return {ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE_PREFIX(pool, prefix),
+                                               NULL_POOL_GAUGE(pool))};
+  }
+}
+
 } // namespace
 
 HostDescriptionImpl::HostDescriptionImpl(
@@ -609,6 +650,10 @@ ClusterStats ClusterInfoImpl::generateStats(Stats::Scope& scope) {
   return {ALL_CLUSTER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
+ClusterStats ClusterInfoImpl::generateStats(Stats::LazyMetricPool& pool) {
+  return {ALL_CLUSTER_STATS(POOL_COUNTER(pool), POOL_GAUGE(pool), POOL_HISTOGRAM(pool))};
+}
+
 ClusterLoadReportStats ClusterInfoImpl::generateLoadReportStats(Stats::Scope& scope) {
   return {ALL_CLUSTER_LOAD_REPORT_STATS(POOL_COUNTER(scope))};
 }
@@ -617,6 +662,11 @@ ClusterTimeoutBudgetStats ClusterInfoImpl::generateTimeoutBudgetStats(Stats::Sco
   return {ALL_CLUSTER_TIMEOUT_BUDGET_STATS(POOL_HISTOGRAM(scope))};
 }
 
+ClusterTimeoutBudgetStats
+ClusterInfoImpl::generateTimeoutBudgetStats(Stats::LazyMetricPool& pool) {
+  return {ALL_CLUSTER_TIMEOUT_BUDGET_STATS(POOL_HISTOGRAM(pool))};
+}
+
 // Implements the FactoryContext interface required by network filters.
 class FactoryContextImpl : public Server::Configuration::CommonFactoryContext {
 public:
@@ -676,17 +726,34 @@ ClusterInfoImpl::ClusterInfoImpl(
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
       socket_matcher_(std::move(socket_matcher)), stats_scope_(std::move(stats_scope)),
-      stats_(generateStats(*stats_scope_)), load_report_stats_store_(stats_scope_->symbolTable()),
+      lazy_stat_names_(config.lazy_stats()
+                           ? lazyClusterStatNames(factory_context.singletonManager(),
+                                                  stats_scope_->symbolTable())
+                           : nullptr),
+      // The prefix matches the one the scope of the cluster is created with.
+      lazy_stats_pool_(config.lazy_stats()
+                           ? std::make_unique<Stats::LazyMetricPool>(
+                                 *stats_scope_,
+                                 fmt::format("cluster.{}.", config.alt_stat_name().empty()
+                                                                ? config.name()
+                                                                : config.alt_stat_name()),
+                                 *lazy_stat_names_)
+                           : nullptr),
+      stats_(lazy_stats_pool_ != nullptr ? generateStats(*lazy_stats_pool_)
+                                         : generateStats(*stats_scope_)),
+      load_report_stats_store_(stats_scope_->symbolTable()),
       load_report_stats_(generateLoadReportStats(load_report_stats_store_)),
-      timeout_budget_stats_(config.track_timeout_budgets()
-                                ? absl::make_optional<ClusterTimeoutBudgetStats>(
-                                      generateTimeoutBudgetStats(*stats_scope_))
-                                : absl::nullopt),
+      timeout_budget_stats_(
+          config.track_timeout_budgets()
+              ? absl::make_optional<ClusterTimeoutBudgetStats>(
+                    lazy_stats_pool_ != nullptr ? generateTimeoutBudgetStats(*lazy_stats_pool_)
+                                                : generateTimeoutBudgetStats(*stats_scope_))
+              : absl::nullopt),
       features_(parseFeatures(config)),
       http1_settings_(Http::Utility::parseHttp1Settings(config.http_protocol_options())),
       http2_options_(Http2::Utility::initializeAndValidateOptions(config.http2_protocol_options())),
       extension_protocol_options_(parseExtensionProtocolOptions(config, validation_visitor)),
-      resource_managers_(config, runtime, name_, *stats_scope_),
+      resource_managers_(config, runtime, name_, *stats_scope_, lazy_stats_pool_.get()),
       maintenance_mode_runtime_key_(absl::StrCat("upstream.maintenance_mode.", name_)),
       source_address_(getSourceAddress(config, bind_config)),
       lb_least_request_config_(config.least_request_lb_config()),
@@ -1082,30 +1149,34 @@ void ClusterImplBase::validateEndpointsForZoneAwareRouting(
 
 ClusterInfoImpl::ResourceManagers::ResourceManagers(
     const envoy::config::cluster::v3::Cluster& config, Runtime::Loader& runtime,
-    const std::string& cluster_name, Stats::Scope& stats_scope) {
-  managers_[enumToInt(ResourcePriority::Default)] =
-      load(config, runtime, cluster_name, stats_scope, envoy::config::core::v3::DEFAULT);
-  managers_[enumToInt(ResourcePriority::High)] =
-      load(config, runtime, cluster_name, stats_scope, envoy::config::core::v3::HIGH);
+    const std::string& cluster_name, Stats::Scope& stats_scope,
+    Stats::LazyMetricPool* lazy_stats_pool) {
+  managers_[enumToInt(ResourcePriority::Default)] = load(config, runtime, cluster_name, stats_scope,
+                                                        lazy_stats_pool,
+                                                        envoy::config::core::v3::DEFAULT);
+  managers_[enumToInt(ResourcePriority::High)] = load(config, runtime, cluster_name, stats_scope,
+                                                     lazy_stats_pool,
+                                                     envoy::config::core::v3::HIGH);
 }
 
 ClusterCircuitBreakersStats
 ClusterInfoImpl::generateCircuitBreakersStats(Stats::Scope& scope, const std::string& stat_prefix,
                                               bool track_remaining) {
-  std::string prefix(fmt::format("circuit_breakers.{}.", stat_prefix));
-  if (track_remaining) {
-    return {ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE_PREFIX(scope, prefix),
-                                               POOL_GAUGE_PREFIX(scope, prefix))};
-  } else {
-    return {ALL_CLUSTER_CIRCUIT_BREAKERS_STATS(POOL_GAUGE_PREFIX(scope, prefix),
-                                               NULL_POOL_GAUGE(scope))};
-  }
+  return circuitBreakersStats(scope, stat_prefix, track_remaining);
+}
+
+ClusterCircuitBreakersStats
+ClusterInfoImpl::generateCircuitBreakersStats(Stats::LazyMetricPool& pool,
+                                              const std::string& stat_prefix,
+                                              bool track_remaining) {
+  return circuitBreakersStats(pool, stat_prefix, track_remaining);
 }
 
 ResourceManagerImplPtr
 ClusterInfoImpl::ResourceManagers::load(const envoy::config::cluster::v3::Cluster& config,
                                         Runtime::Loader& runtime, const std::string& cluster_name,
                                         Stats::Scope& stats_scope,
+                                        Stats::LazyMetricPool* lazy_stats_pool,
                                         const envoy::config::core::v3::RoutingPriority& priority) {
   uint64_t max_connections = 1024;
   uint64_t max_pending_requests = 1024;
@@ -1165,7 +1236,11 @@ ClusterInfoImpl::ResourceManagers::load(const envoy::config::cluster::v3::Cluste
   return std::make_unique<ResourceManagerImpl>(
       runtime, runtime_prefix, max_connections, max_pending_requests, max_requests, max_retries,
       max_connection_pools,
-      ClusterInfoImpl::generateCircuitBreakersStats(stats_scope, priority_name, track_remaining),
+      lazy_stats_pool != nullptr
+          ? ClusterInfoImpl::generateCircuitBreakersStats(*lazy_stats_pool, priority_name,
+                                                          track_remaining)
+          : ClusterInfoImpl::generateCircuitBreakersStats(stats_scope, priority_name,
+                                                          track_remaining),
       budget_percent, min_retry_concurrency);
 }
 
@@ -1420,17 +1495,18 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const HostVector& new_hosts,
   }
 
   // Remove hosts from current_priority_hosts that were matched to an existing host in the previous
-  // loop.
-  for (auto itr = current_priority_hosts.begin(); itr != current_priority_hosts.end();) {
-    auto existing_itr = existing_hosts_for_current_priority.find((*itr)->address()->asString());
-
-    if (existing_itr != existing_hosts_for_current_priority.end()) {
-      existing_hosts_for_current_priority.erase(existing_itr);
-      itr = current_priority_hosts.erase(itr);
-    } else {
-      itr++;
+  // loop. The other hosts are moved up in a single pass, since erasing the matched hosts one by one
+  // would be quadratic in the number of hosts, most of which are matched in a typical update.
+  auto kept_end = current_priority_hosts.begin();
+  for (auto itr = current_priority_hosts.begin(); itr != current_priority_hosts.end(); ++itr) {
+    if (existing_hosts_for_current_priority.erase((*itr)->address()->asString()) == 0) {
+      if (kept_end != itr) {
+        *kept_end = std::move(*itr);
+      }
+      ++kept_end;
     }
   }
+  current_priority_hosts.erase(kept_end, current_priority_hosts.end());
 
   // If we saw existing hosts during this iteration from a different priority, then we've moved
   // a host from another priority into this one, so we should mark the priority as having changed.
@@ -44,6 +44,7 @@
 #include "common/network/utility.h"
 #include "common/shared_pool/shared_pool.h"
 #include "common/stats/isolated_store_impl.h"
+#include "common/stats/lazy_metric_impl.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/outlier_detection_impl.h"
 #include "common/upstream/resource_manager_impl.h"
@@ -516,11 +517,16 @@ public:
                   Server::Configuration::TransportSocketFactoryContext&);
 
   static ClusterStats generateStats(Stats::Scope& scope);
+  static ClusterStats generateStats(Stats::LazyMetricPool& pool);
   static ClusterLoadReportStats generateLoadReportStats(Stats::Scope& scope);
   static ClusterCircuitBreakersStats generateCircuitBreakersStats(Stats::Scope& scope,
                                                                   const std::string& stat_prefix,
                                                                   bool track_remaining);
+  static ClusterCircuitBreakersStats generateCircuitBreakersStats(Stats::LazyMetricPool& pool,
+                                                                  const std::string& stat_prefix,
+                                                                  bool track_remaining);
   static ClusterTimeoutBudgetStats generateTimeoutBudgetStats(Stats::Scope&);
+  static ClusterTimeoutBudgetStats generateTimeoutBudgetStats(Stats::LazyMetricPool&);
 
   // Upstream::ClusterInfo
   bool addedViaApi() const override { return added_via_api_; }
@@ -598,10 +604,11 @@ public:
 private:
   struct ResourceManagers {
     ResourceManagers(const envoy::config::cluster::v3::Cluster& config, Runtime::Loader& runtime,
-                     const std::string& cluster_name, Stats::Scope& stats_scope);
+                     const std::string& cluster_name, Stats::Scope& stats_scope,
+                     Stats::LazyMetricPool* lazy_stats_pool);
     ResourceManagerImplPtr load(const envoy::config::cluster::v3::Cluster& config,
                                 Runtime::Loader& runtime, const std::string& cluster_name,
-                                Stats::Scope& stats_scope,
+                                Stats::Scope& stats_scope, Stats::LazyMetricPool* lazy_stats_pool,
                                 const envoy::config::core::v3::RoutingPriority& priority);
 
     using Managers = std::array<ResourceManagerImplPtr, NumResourcePriorities>;
@@ -619,6 +626,11 @@ private:
   const uint32_t per_connection_buffer_limit_bytes_;
   TransportSocketMatcherPtr socket_matcher_;
   Stats::ScopePtr stats_scope_;
+  // Only set when lazy_stats is configured. The names of the stats are shared by all the clusters
+  // with lazy_stats. The pool must be declared after stats_scope_ and lazy_stat_names_, which it
+  // refers to, and before stats_, which refers to it.
+  std::shared_ptr<Stats::LazyMetricNames> lazy_stat_names_;
+  std::unique_ptr<Stats::LazyMetricPool> lazy_stats_pool_;
   mutable ClusterStats stats_;
   Stats::IsolatedStoreImpl load_report_stats_store_;
   mutable ClusterLoadReportStats load_report_stats_;
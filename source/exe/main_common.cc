@@ -58,9 +58,15 @@ MainCommonBase::MainCommonBase(const OptionsImpl& options, Event::TimeSystem& ti
   switch (options_.mode()) {
   case Server::Mode::InitOnly:
   case Server::Mode::Serve: {
+    if (!options_.statsRegionPath().empty()) {
+      // The first epoch starts from a clean region, later ones adopt the one left by the parent.
+      stats_region_ = Stats::MappedStatsRegion::create(
+          options_.statsRegionPath(), options_.statsRegionSlots(), options_.restartEpoch() == 0);
+      stats_allocator_.setMappedStatsRegion(stats_region_.get());
+    }
 #ifdef ENVOY_HOT_RESTART
     if (!options.hotRestartDisabled()) {
-      restarter_ = std::make_unique<Server::HotRestartImpl>(options_);
+      restarter_ = std::make_unique<Server::HotRestartImpl>(options_, stats_region_.get());
     }
 #endif
     if (restarter_ == nullptr) {
@@ -7,6 +7,7 @@
 #include "common/event/real_time_system.h"
 #include "common/grpc/google_grpc_context.h"
 #include "common/stats/fake_symbol_table_impl.h"
+#include "common/stats/mapped_stats_region.h"
 #include "common/stats/thread_local_store.h"
 #include "common/thread_local/thread_local_impl.h"
 
@@ -76,6 +77,8 @@ protected:
   Thread::ThreadFactory& thread_factory_;
   Filesystem::Instance& file_system_;
   Stats::SymbolTablePtr symbol_table_;
+  // Declared ahead of the allocator, as the stats it allocates may live in the region.
+  Stats::MappedStatsRegionPtr stats_region_;
   Stats::AllocatorImpl stats_allocator_;
 
   std::unique_ptr<ThreadLocal::InstanceImpl> tls_;
@@ -3,15 +3,37 @@
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
 #include "common/http/codes.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
 namespace OnDemand {
 
+OnDemandFilterConfig::OnDemandFilterConfig(
+    const envoy::extensions::filters::http::on_demand::v3::OnDemand& proto_config,
+    Upstream::ClusterManager& cm, ProtobufMessage::ValidationVisitor& validation_visitor)
+    : cm_(cm),
+      odcds_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(proto_config.odcds(), timeout, 5000)) {
+  if (proto_config.has_odcds()) {
+    const auto& odcds = proto_config.odcds();
+    odcds_ = cm_.allocateOdCdsApi(
+        odcds.source(),
+        odcds.has_idle_timeout()
+            ? absl::make_optional(std::chrono::milliseconds(
+                  DurationUtil::durationToMilliseconds(odcds.idle_timeout())))
+            : absl::nullopt,
+        validation_visitor);
+  }
+}
+
 Http::FilterHeadersStatus OnDemandRouteUpdate::decodeHeaders(Http::RequestHeaderMap&, bool) {
-  if (callbacks_->route() != nullptr ||
-      !(callbacks_->routeConfig().has_value() && callbacks_->routeConfig().value()->usesVhds())) {
+  if (callbacks_->route() != nullptr) {
+    filter_iteration_state_ = requestUnknownCluster() ? Http::FilterHeadersStatus::StopIteration
+                                                      : Http::FilterHeadersStatus::Continue;
+    return filter_iteration_state_;
+  }
+  if (!(callbacks_->routeConfig().has_value() && callbacks_->routeConfig().value()->usesVhds())) {
     filter_iteration_state_ = Http::FilterHeadersStatus::Continue;
     return filter_iteration_state_;
   }
@@ -37,6 +59,24 @@ void OnDemandRouteUpdate::setDecoderFilterCallbacks(Http::StreamDecoderFilterCal
   callbacks_ = &callbacks;
 }
 
+bool OnDemandRouteUpdate::requestUnknownCluster() {
+  Upstream::OdCdsApiHandle* odcds = config_->odcds();
+  const Router::RouteEntry* route_entry = callbacks_->route()->routeEntry();
+  if (odcds == nullptr || route_entry == nullptr ||
+      config_->clusterManager().get(route_entry->clusterName()) != nullptr) {
+    return false;
+  }
+  cluster_discovery_handle_ = odcds->requestOnDemandClusterDiscovery(
+      route_entry->clusterName(),
+      std::make_unique<Upstream::ClusterDiscoveryCallback>(
+          [this](Upstream::ClusterDiscoveryStatus cluster_status) -> void {
+            onClusterDiscoveryCompletion(cluster_status);
+          }),
+      config_->odcdsTimeout());
+  // The cluster may have been added since it was looked up.
+  return cluster_discovery_handle_ != nullptr;
+}
+
 // This is the callback which is called when an update requested in requestRouteConfigUpdate()
 // has been propagated to workers, at which point the request processing is restarted from the
 // beginning.
@@ -55,6 +95,16 @@ void OnDemandRouteUpdate::onRouteConfigUpdateCompletion(bool route_exists) {
   callbacks_->continueDecoding();
 }
 
+// This is the callback which is called when a cluster requested in requestUnknownCluster() has been
+// added on this worker, when the config source does not have it, or when the request timed out. In
+// all cases the router then looks the cluster up again, and fails the request if it is still
+// unknown.
+void OnDemandRouteUpdate::onClusterDiscoveryCompletion(Upstream::ClusterDiscoveryStatus) {
+  cluster_discovery_handle_.reset();
+  filter_iteration_state_ = Http::FilterHeadersStatus::Continue;
+  callbacks_->continueDecoding();
+}
+
 } // namespace OnDemand
 } // namespace HttpFilters
 } // namespace Extensions
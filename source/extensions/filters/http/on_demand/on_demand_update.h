@@ -1,18 +1,48 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
+
+#include "envoy/extensions/filters/http/on_demand/v3/on_demand.pb.h"
 #include "envoy/http/filter.h"
+#include "envoy/protobuf/message_validator.h"
+#include "envoy/upstream/cluster_manager.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
 namespace OnDemand {
 
+/**
+ * Configuration shared by the on-demand filters of a filter chain.
+ */
+class OnDemandFilterConfig {
+public:
+  OnDemandFilterConfig(
+      const envoy::extensions::filters::http::on_demand::v3::OnDemand& proto_config,
+      Upstream::ClusterManager& cm, ProtobufMessage::ValidationVisitor& validation_visitor);
+
+  Upstream::ClusterManager& clusterManager() const { return cm_; }
+  // The on-demand CDS subscription, or nullptr if clusters are not discovered on demand.
+  Upstream::OdCdsApiHandle* odcds() const { return odcds_.get(); }
+  std::chrono::milliseconds odcdsTimeout() const { return odcds_timeout_; }
+
+private:
+  Upstream::ClusterManager& cm_;
+  Upstream::OdCdsApiHandleSharedPtr odcds_;
+  std::chrono::milliseconds odcds_timeout_;
+};
+
+using OnDemandFilterConfigSharedPtr = std::shared_ptr<const OnDemandFilterConfig>;
+
 class OnDemandRouteUpdate : public Http::StreamDecoderFilter {
 public:
-  OnDemandRouteUpdate() = default;
+  OnDemandRouteUpdate(OnDemandFilterConfigSharedPtr config) : config_(std::move(config)) {}
 
   void onRouteConfigUpdateCompletion(bool route_exists);
 
+  void onClusterDiscoveryCompletion(Upstream::ClusterDiscoveryStatus cluster_status);
+
   void setFilterIterationState(Envoy::Http::FilterHeadersStatus status) {
     filter_iteration_state_ = status;
   }
@@ -27,11 +57,17 @@ public:
 
   void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override;
 
-  void onDestroy() override {}
+  void onDestroy() override { cluster_discovery_handle_.reset(); }
 
 private:
+  // Requests the discovery of the cluster of the route if it is not known yet, and returns whether
+  // the request has to wait for it.
+  bool requestUnknownCluster();
+
+  const OnDemandFilterConfigSharedPtr config_;
   Http::StreamDecoderFilterCallbacks* callbacks_{};
   Http::RouteConfigUpdatedCallbackSharedPtr route_config_updated_callback_;
+  Upstream::ClusterDiscoveryCallbackHandlePtr cluster_discovery_handle_;
   Envoy::Http::FilterHeadersStatus filter_iteration_state_{Http::FilterHeadersStatus::Continue};
 };
 
@@ -0,0 +1,74 @@
+#include "extensions/private_key_providers/thread_pool/config.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "envoy/extensions/private_key_providers/thread_pool/v3alpha/thread_pool.pb.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3alpha/thread_pool.pb.validate.h"
+#include "envoy/registry/registry.h"
+#include "envoy/server/transport_socket_config.h"
+
+#include "common/common/lock_guard.h"
+#include "common/config/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/private_key_providers/thread_pool/thread_pool_private_key_method_provider.h"
+#include "extensions/private_key_providers/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+namespace {
+
+constexpr uint32_t DefaultMaxQueuedOperations = 1024;
+
+} // namespace
+
+Ssl::PrivateKeyMethodProviderSharedPtr
+ThreadPoolPrivateKeyMethodFactory::createPrivateKeyMethodProviderInstance(
+    const envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context) {
+  envoy::extensions::private_key_providers::thread_pool::v3alpha::ThreadPoolPrivateKeyMethodConfig
+      thread_pool_config;
+  Config::Utility::translateOpaqueConfig(config.typed_config(), ProtobufWkt::Struct(),
+                                         factory_context.messageValidationVisitor(),
+                                         thread_pool_config);
+  MessageUtil::validate(thread_pool_config, factory_context.messageValidationVisitor());
+  const uint32_t thread_count = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      thread_pool_config, thread_count, std::max(1U, std::thread::hardware_concurrency()));
+  const uint32_t max_queued_operations = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      thread_pool_config, max_queued_operations, DefaultMaxQueuedOperations);
+  return std::make_shared<ThreadPoolPrivateKeyMethodProvider>(
+      thread_pool_config, factory_context,
+      getPool(factory_context.api().threadFactory(), thread_count, max_queued_operations));
+}
+
+OperationThreadPoolSharedPtr
+ThreadPoolPrivateKeyMethodFactory::getPool(Thread::ThreadFactory& thread_factory,
+                                           uint32_t thread_count, uint32_t max_queued_operations) {
+  Thread::LockGuard lock(mutex_);
+  std::weak_ptr<OperationThreadPool>& pool = pools_[{thread_count, max_queued_operations}];
+  OperationThreadPoolSharedPtr shared_pool = pool.lock();
+  if (shared_pool == nullptr) {
+    shared_pool =
+        std::make_shared<OperationThreadPool>(thread_factory, thread_count, max_queued_operations);
+    pool = shared_pool;
+  }
+  return shared_pool;
+}
+
+std::string ThreadPoolPrivateKeyMethodFactory::name() const {
+  return PrivateKeyMethodProviderNames::get().ThreadPool;
+}
+
+/**
+ * Static registration for the thread pool private key method provider. @see RegisterFactory.
+ */
+REGISTER_FACTORY(ThreadPoolPrivateKeyMethodFactory, Ssl::PrivateKeyMethodProviderInstanceFactory);
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_config.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+
+#include "extensions/private_key_providers/thread_pool/thread_pool_private_key_method_provider.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+/**
+ * Config registration for the thread pool private key method provider. The factory owns the pools
+ * of threads, so that the providers of the process share their threads rather than each starting
+ * its own. @see PrivateKeyMethodProviderInstanceFactory.
+ */
+class ThreadPoolPrivateKeyMethodFactory : public Ssl::PrivateKeyMethodProviderInstanceFactory {
+public:
+  // Ssl::PrivateKeyMethodProviderInstanceFactory
+  Ssl::PrivateKeyMethodProviderSharedPtr createPrivateKeyMethodProviderInstance(
+      const envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context) override;
+  std::string name() const override;
+
+private:
+  /**
+   * @return the pool shared by the providers with the given settings, which is created when no
+   *         provider uses such a pool yet.
+   */
+  OperationThreadPoolSharedPtr getPool(Thread::ThreadFactory& thread_factory,
+                                       uint32_t thread_count, uint32_t max_queued_operations);
+
+  Thread::MutexBasicLockable mutex_;
+  // The pools, by number of threads and queue size. A pool is destroyed with the last provider
+  // using it.
+  absl::flat_hash_map<std::pair<uint32_t, uint32_t>, std::weak_ptr<OperationThreadPool>>
+      pools_ ABSL_GUARDED_BY(mutex_);
+};
+
+DECLARE_FACTORY(ThreadPoolPrivateKeyMethodFactory);
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
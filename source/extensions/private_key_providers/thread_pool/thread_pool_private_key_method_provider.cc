@@ -0,0 +1,393 @@
+#include "extensions/private_key_providers/thread_pool/thread_pool_private_key_method_provider.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/config/datasource.h"
+#include "common/protobuf/utility.h"
+
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+namespace {
+
+constexpr char StatPrefix[] = "private_key_provider.thread_pool";
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = ThreadPoolPrivateKeyConnection::get(ssl);
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  ThreadPoolPrivateKeyMethodProvider* provider =
+      connection->provider(SSL_get_signature_algorithm_key_type(signature_algorithm));
+  if (provider == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return provider->startOperation(*connection, true, signature_algorithm, in, in_len, out, out_len,
+                                  max_out);
+}
+
+ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out, const uint8_t* in, size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = ThreadPoolPrivateKeyConnection::get(ssl);
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  // Only the RSA key exchange decrypts with the private key.
+  ThreadPoolPrivateKeyMethodProvider* provider = connection->provider(EVP_PKEY_RSA);
+  if (provider == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return provider->startOperation(*connection, false, 0, in, in_len, out, out_len, max_out);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  ThreadPoolPrivateKeyConnection* connection = ThreadPoolPrivateKeyConnection::get(ssl);
+  if (connection == nullptr || connection->operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!connection->operation_->completed_) {
+    // The handshake was resumed by socket activity before the operation was performed.
+    return ssl_private_key_retry;
+  }
+  PrivateKeyOperationSharedPtr operation = std::move(connection->operation_);
+  connection->operation_ = nullptr;
+  return operation->provider_->finishOperation(*operation, out, out_len, max_out);
+}
+
+// Frees the connection of an SSL object which is freed without being unregistered.
+void freeConnection(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) {
+  delete static_cast<ThreadPoolPrivateKeyConnection*>(ptr);
+}
+
+int createIndex() {
+  int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeConnection);
+  RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+  return index;
+}
+
+} // namespace
+
+OperationThreadPool::OperationThreadPool(Thread::ThreadFactory& thread_factory,
+                                         uint32_t thread_count, uint32_t max_queued_operations)
+    : max_queued_operations_(max_queued_operations) {
+  for (uint32_t i = 0; i < thread_count; i++) {
+    threads_.push_back(thread_factory.createThread([this]() { threadRoutine(); }));
+  }
+}
+
+OperationThreadPool::~OperationThreadPool() {
+  {
+    Thread::LockGuard lock(mutex_);
+    shutdown_ = true;
+    for (const QueuedOperation& queued : queue_) {
+      queued.queued_operations_->dec();
+    }
+    queue_.clear();
+  }
+  condvar_.notifyAll();
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+bool OperationThreadPool::post(const void* owner, Stats::Gauge& queued_operations,
+                               std::function<void()> operation) {
+  {
+    Thread::LockGuard lock(mutex_);
+    if (queue_.size() >= max_queued_operations_) {
+      return false;
+    }
+    queue_.push_back({owner, &queued_operations, std::move(operation)});
+    queued_operations.inc();
+  }
+  condvar_.notifyOne();
+  return true;
+}
+
+void OperationThreadPool::cancel(const void* owner) {
+  Thread::LockGuard lock(mutex_);
+  queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                              [owner](const QueuedOperation& queued) {
+                                if (queued.owner_ != owner) {
+                                  return false;
+                                }
+                                queued.queued_operations_->dec();
+                                return true;
+                              }),
+               queue_.end());
+}
+
+void OperationThreadPool::threadRoutine() {
+  while (true) {
+    std::function<void()> operation;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (!shutdown_ && queue_.empty()) {
+        condvar_.wait(mutex_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      operation = std::move(queue_.front().operation_);
+      queue_.front().queued_operations_->dec();
+      queue_.pop_front();
+    }
+    operation();
+  }
+}
+
+PrivateKeyOperation::PrivateKeyOperation(ThreadPoolPrivateKeyMethodProvider& provider,
+                                         ThreadPoolPrivateKeyConnection& connection,
+                                         bssl::UniquePtr<EVP_PKEY> pkey, bool sign,
+                                         uint16_t signature_algorithm, const uint8_t* in,
+                                         size_t in_len, size_t max_out, MonotonicTime queued_time)
+    : provider_(&provider), connection_(&connection), pkey_(std::move(pkey)), sign_(sign),
+      signature_algorithm_(signature_algorithm), input_(in, in + in_len), max_out_(max_out),
+      queued_time_(queued_time), dispatcher_(&connection.dispatcher_) {}
+
+bool PrivateKeyOperation::perform() {
+  std::vector<uint8_t> output(max_out_);
+  size_t out_len = max_out_;
+  if (sign_) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pkey_ctx;
+    if (!EVP_DigestSignInit(ctx.get(), &pkey_ctx,
+                            SSL_get_signature_algorithm_digest(signature_algorithm_), nullptr,
+                            pkey_.get())) {
+      return false;
+    }
+    // RSA-PSS signatures use a salt as long as the digest (RFC 8446 section 4.2.3).
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm_) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) {
+      return false;
+    }
+    if (!EVP_DigestSign(ctx.get(), output.data(), &out_len, input_.data(), input_.size())) {
+      return false;
+    }
+  } else {
+    // The padding of the premaster secret is checked by BoringSSL.
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    if (rsa == nullptr || !RSA_decrypt(rsa, &out_len, output.data(), max_out_, input_.data(),
+                                       input_.size(), RSA_NO_PADDING)) {
+      return false;
+    }
+  }
+  output.resize(out_len);
+  output_ = std::move(output);
+  return true;
+}
+
+ThreadPoolPrivateKeyConnection::ThreadPoolPrivateKeyConnection(
+    Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher)
+    : cb_(cb), dispatcher_(dispatcher) {}
+
+ThreadPoolPrivateKeyConnection::~ThreadPoolPrivateKeyConnection() { cancelOperation(); }
+
+ThreadPoolPrivateKeyConnection* ThreadPoolPrivateKeyConnection::get(SSL* ssl) {
+  return static_cast<ThreadPoolPrivateKeyConnection*>(
+      SSL_get_ex_data(ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex()));
+}
+
+ThreadPoolPrivateKeyMethodProvider* ThreadPoolPrivateKeyConnection::provider(int key_type) const {
+  for (ThreadPoolPrivateKeyMethodProvider* provider : providers_) {
+    if (provider->keyType() == key_type) {
+      return provider;
+    }
+  }
+  return nullptr;
+}
+
+void ThreadPoolPrivateKeyConnection::addProvider(ThreadPoolPrivateKeyMethodProvider& provider) {
+  providers_.push_back(&provider);
+}
+
+void ThreadPoolPrivateKeyConnection::removeProvider(ThreadPoolPrivateKeyMethodProvider& provider) {
+  if (operation_ != nullptr && operation_->provider_ == &provider) {
+    cancelOperation();
+  }
+  providers_.erase(std::remove(providers_.begin(), providers_.end(), &provider),
+                   providers_.end());
+}
+
+void ThreadPoolPrivateKeyConnection::cancelOperation() {
+  if (operation_ == nullptr) {
+    return;
+  }
+  {
+    Thread::LockGuard lock(operation_->mutex_);
+    operation_->dispatcher_ = nullptr;
+  }
+  operation_->provider_ = nullptr;
+  operation_->connection_ = nullptr;
+  operation_ = nullptr;
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::extensions::private_key_providers::thread_pool::v3alpha::
+        ThreadPoolPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context,
+    OperationThreadPoolSharedPtr pool)
+    : time_source_(factory_context.api().timeSource()),
+      stats_({ALL_THREAD_POOL_PRIVATE_KEY_STATS(
+          POOL_COUNTER_PREFIX(factory_context.scope(), StatPrefix),
+          POOL_GAUGE_PREFIX(factory_context.scope(), StatPrefix),
+          POOL_HISTOGRAM_PREFIX(factory_context.scope(), StatPrefix))}),
+      pool_(std::move(pool)) {
+  const std::string private_key =
+      Config::DataSource::read(config.private_key(), false, factory_context.api());
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey_ == nullptr) {
+    throw EnvoyException("Failed to load private key for the thread pool private key provider");
+  }
+  if (keyType() != EVP_PKEY_RSA && keyType() != EVP_PKEY_EC) {
+    throw EnvoyException(
+        "Only RSA and ECDSA private keys are supported by the thread pool private key provider");
+  }
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method_->sign = privateKeySign;
+  method_->decrypt = privateKeyDecrypt;
+  method_->complete = privateKeyComplete;
+}
+
+// The pool is shared with the other providers, so drop the operations of this one which are still
+// queued. The ones being performed only refer to their own state.
+ThreadPoolPrivateKeyMethodProvider::~ThreadPoolPrivateKeyMethodProvider() { pool_->cancel(this); }
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  ThreadPoolPrivateKeyConnection* connection = ThreadPoolPrivateKeyConnection::get(ssl);
+  if (connection == nullptr) {
+    connection = new ThreadPoolPrivateKeyConnection(cb, dispatcher);
+    SSL_set_ex_data(ssl, connectionIndex(), connection);
+  }
+  // The operations of a connection are dispatched to the provider with a key of the right type.
+  if (connection->provider(keyType()) != nullptr) {
+    throw EnvoyException("Can't distinguish between two thread pool private key providers with "
+                         "keys of the same type for the same SSL object.");
+  }
+  connection->addProvider(*this);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  ThreadPoolPrivateKeyConnection* connection = ThreadPoolPrivateKeyConnection::get(ssl);
+  if (connection == nullptr) {
+    return;
+  }
+  connection->removeProvider(*this);
+  if (!connection->hasProviders()) {
+    SSL_set_ex_data(ssl, connectionIndex(), nullptr);
+    delete connection;
+  }
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  if (keyType() == EVP_PKEY_RSA) {
+    RSA* rsa_private_key = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa_private_key != nullptr && RSA_check_fips(rsa_private_key);
+  }
+  const EC_KEY* ecdsa_private_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+  return ecdsa_private_key != nullptr && EC_KEY_check_fips(ecdsa_private_key);
+}
+
+Ssl::BoringSslPrivateKeyMethodSharedPtr
+ThreadPoolPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() {
+  return method_;
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::startOperation(
+    ThreadPoolPrivateKeyConnection& connection, bool sign, uint16_t signature_algorithm,
+    const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len, size_t max_out) {
+  ASSERT(connection.operation_ == nullptr);
+  (sign ? stats_.sign_ : stats_.decrypt_).inc();
+  auto operation = std::make_shared<PrivateKeyOperation>(
+      *this, connection, bssl::UpRef(pkey_), sign, signature_algorithm, in, in_len, max_out,
+      time_source_.monotonicTime());
+
+  // The operation may still be performed once the provider is gone, so it doesn't refer to it.
+  const bool queued =
+      pool_->post(this, stats_.queued_operations_, [&time_source = time_source_, operation]() {
+        operation->start_time_ = time_source.monotonicTime();
+        operation->success_ = operation->perform();
+        operation->end_time_ = time_source.monotonicTime();
+        Thread::LockGuard lock(operation->mutex_);
+        if (operation->dispatcher_ != nullptr) {
+          operation->dispatcher_->post([operation]() { onOperationPerformed(operation); });
+        }
+      });
+  if (queued) {
+    connection.operation_ = std::move(operation);
+    return ssl_private_key_retry;
+  }
+
+  // Rather than failing the handshake, the operation is performed on the worker thread.
+  stats_.queue_overflow_.inc();
+  ENVOY_LOG(debug, "private key operation queue is full, performing operation inline");
+  operation->success_ = operation->perform();
+  return finishOperation(*operation, out, out_len, max_out);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::onOperationPerformed(
+    const PrivateKeyOperationSharedPtr& operation) {
+  if (operation->connection_ == nullptr) {
+    // The connection was closed while the operation was in progress.
+    return;
+  }
+  operation->completed_ = true;
+
+  ThreadPoolPrivateKeyMethodProvider& provider = *operation->provider_;
+  const MonotonicTime now = provider.time_source_.monotonicTime();
+  provider.stats_.queue_time_.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                              operation->start_time_ - operation->queued_time_)
+                                              .count());
+  provider.stats_.operation_time_.recordValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(operation->end_time_ -
+                                                            operation->start_time_)
+          .count());
+  provider.stats_.total_time_.recordValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(now - operation->queued_time_)
+          .count());
+
+  // Resumes the handshake, which picks up the result from privateKeyComplete().
+  operation->connection_->cb_.onPrivateKeyMethodComplete();
+}
+
+ssl_private_key_result_t
+ThreadPoolPrivateKeyMethodProvider::finishOperation(const PrivateKeyOperation& operation,
+                                                    uint8_t* out, size_t* out_len,
+                                                    size_t max_out) {
+  if (!operation.success_ || operation.output_.size() > max_out) {
+    stats_.failure_.inc();
+    return ssl_private_key_failure;
+  }
+  std::copy(operation.output_.begin(), operation.output_.end(), out);
+  *out_len = operation.output_.size();
+  return ssl_private_key_success;
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3alpha/thread_pool.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+/**
+ * All thread pool private key provider stats. @see stats_macros.h
+ */
+#define ALL_THREAD_POOL_PRIVATE_KEY_STATS(COUNTER, GAUGE, HISTOGRAM)                               \
+  COUNTER(decrypt)                                                                                 \
+  COUNTER(failure)                                                                                 \
+  COUNTER(queue_overflow)                                                                          \
+  COUNTER(sign)                                                                                    \
+  GAUGE(queued_operations, Accumulate)                                                             \
+  HISTOGRAM(operation_time, Microseconds)                                                          \
+  HISTOGRAM(queue_time, Microseconds)                                                              \
+  HISTOGRAM(total_time, Microseconds)
+
+/**
+ * Struct definition for all thread pool private key provider stats. @see stats_macros.h
+ */
+struct ThreadPoolPrivateKeyStats {
+  ALL_THREAD_POOL_PRIVATE_KEY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                                    GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * A fixed set of threads running queued operations in order, shared by several owners. The queue
+ * is bounded, and the operations still queued when the pool is destroyed are dropped.
+ */
+class OperationThreadPool {
+public:
+  OperationThreadPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count,
+                      uint32_t max_queued_operations);
+  ~OperationThreadPool();
+
+  /**
+   * Queues an operation to be run on one of the threads.
+   * @param owner supplies the owner of the operation. @see cancel().
+   * @param queued_operations supplies the gauge of the queued operations of the owner.
+   * @param operation supplies the operation.
+   * @return false if the queue is full, in which case the operation is not queued.
+   */
+  bool post(const void* owner, Stats::Gauge& queued_operations, std::function<void()> operation);
+
+  /**
+   * Drops the queued operations of an owner, which is about to be destroyed. The operations
+   * already running are not waited for, so they must not refer to the owner.
+   * @param owner supplies the owner passed to post().
+   */
+  void cancel(const void* owner);
+
+private:
+  struct QueuedOperation {
+    const void* owner_;
+    Stats::Gauge* queued_operations_;
+    std::function<void()> operation_;
+  };
+
+  void threadRoutine();
+
+  const uint32_t max_queued_operations_;
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar condvar_;
+  std::deque<QueuedOperation> queue_ ABSL_GUARDED_BY(mutex_);
+  bool shutdown_ ABSL_GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+using OperationThreadPoolSharedPtr = std::shared_ptr<OperationThreadPool>;
+
+class ThreadPoolPrivateKeyMethodProvider;
+class ThreadPoolPrivateKeyConnection;
+
+/**
+ * A signing or decryption operation of a handshake. It is started on the worker thread, performed
+ * on a pool thread, and handed back to the worker thread, unless the connection went away in the
+ * meantime.
+ */
+struct PrivateKeyOperation {
+  PrivateKeyOperation(ThreadPoolPrivateKeyMethodProvider& provider,
+                      ThreadPoolPrivateKeyConnection& connection, bssl::UniquePtr<EVP_PKEY> pkey,
+                      bool sign, uint16_t signature_algorithm, const uint8_t* in, size_t in_len,
+                      size_t max_out, MonotonicTime queued_time);
+
+  /**
+   * Performs the operation, on any thread. Sets output_ on success.
+   * @return whether the operation succeeded.
+   */
+  bool perform();
+
+  // Only accessed on the worker thread. The provider and the connection are cleared when the
+  // connection is unregistered, and the provider outlives the connections registered to it.
+  ThreadPoolPrivateKeyMethodProvider* provider_;
+  ThreadPoolPrivateKeyConnection* connection_;
+  bool completed_{};
+
+  // Set before the operation is queued, and then only read by the thread performing it.
+  const bssl::UniquePtr<EVP_PKEY> pkey_;
+  const bool sign_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> input_;
+  const size_t max_out_;
+  const MonotonicTime queued_time_;
+
+  // Set by the thread performing the operation, and read by the worker thread once completed.
+  MonotonicTime start_time_;
+  MonotonicTime end_time_;
+  std::vector<uint8_t> output_;
+  bool success_{};
+
+  Thread::MutexBasicLockable mutex_;
+  // The dispatcher of the worker thread, cleared when the connection is unregistered.
+  Event::Dispatcher* dispatcher_ ABSL_GUARDED_BY(mutex_);
+};
+
+using PrivateKeyOperationSharedPtr = std::shared_ptr<PrivateKeyOperation>;
+
+/**
+ * The state of a TLS connection registered to one or more thread pool providers, stored in the
+ * ex_data of the SSL object. With multiple certificates, a provider is registered for each of them,
+ * and the provider of an operation is found from the type of its key.
+ */
+class ThreadPoolPrivateKeyConnection {
+public:
+  ThreadPoolPrivateKeyConnection(Ssl::PrivateKeyConnectionCallbacks& cb,
+                                 Event::Dispatcher& dispatcher);
+  ~ThreadPoolPrivateKeyConnection();
+
+  /**
+   * @return the connection registered to the SSL object, or nullptr.
+   */
+  static ThreadPoolPrivateKeyConnection* get(SSL* ssl);
+
+  /**
+   * @return the registered provider of keys of the given type, or nullptr.
+   */
+  ThreadPoolPrivateKeyMethodProvider* provider(int key_type) const;
+
+  void addProvider(ThreadPoolPrivateKeyMethodProvider& provider);
+  void removeProvider(ThreadPoolPrivateKeyMethodProvider& provider);
+  bool hasProviders() const { return !providers_.empty(); }
+
+  /**
+   * Drops the pending operation. Its result is not handed back to the worker thread.
+   */
+  void cancelOperation();
+
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  // The operation in progress, if any. A handshake performs at most one at a time.
+  PrivateKeyOperationSharedPtr operation_;
+
+private:
+  std::vector<ThreadPoolPrivateKeyMethodProvider*> providers_;
+};
+
+/**
+ * Private key method provider performing the signing and decryption operations of the handshakes
+ * on a pool of threads, shared with the other providers of the process, so that they do not block
+ * the worker threads.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider,
+                                           Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::extensions::private_key_providers::thread_pool::v3alpha::
+          ThreadPoolPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context,
+      OperationThreadPoolSharedPtr pool);
+  ~ThreadPoolPrivateKeyMethodProvider() override;
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override;
+
+  /**
+   * Starts an operation of a connection, on the worker thread. The operation is queued to the
+   * pool, or performed right away if the queue is full.
+   * @return ssl_private_key_retry if the operation was queued, or else its result.
+   */
+  ssl_private_key_result_t startOperation(ThreadPoolPrivateKeyConnection& connection, bool sign,
+                                          uint16_t signature_algorithm, const uint8_t* in,
+                                          size_t in_len, uint8_t* out, size_t* out_len,
+                                          size_t max_out);
+
+  /**
+   * Copies out the result of a performed operation, on the worker thread.
+   */
+  ssl_private_key_result_t finishOperation(const PrivateKeyOperation& operation, uint8_t* out,
+                                           size_t* out_len, size_t max_out);
+
+  int keyType() const { return EVP_PKEY_id(pkey_.get()); }
+  const ThreadPoolPrivateKeyStats& stats() const { return stats_; }
+
+  static int connectionIndex();
+
+private:
+  static void onOperationPerformed(const PrivateKeyOperationSharedPtr& operation);
+
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  TimeSource& time_source_;
+  ThreadPoolPrivateKeyStats stats_;
+  const OperationThreadPoolSharedPtr pool_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "common/singleton/const_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+
+/**
+ * Well-known private key method provider names.
+ * NOTE: New private key method providers should use the well known name:
+ * envoy.tls.key_providers.name.
+ */
+class PrivateKeyMethodProviderNameValues {
+public:
+  // Provider performing the operations on a pool of threads.
+  const std::string ThreadPool = "envoy.tls.key_providers.thread_pool";
+};
+
+using PrivateKeyMethodProviderNames = ConstSingleton<PrivateKeyMethodProviderNameValues>;
+
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -82,6 +82,9 @@ public:
   StreamInfo::StreamInfo& streamInfo() override { return stream_info_; }
   const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
   absl::string_view transportFailureReason() const override { return transport_failure_reason_; }
+  Network::IoHandle* rawIoHandle() override { return nullptr; }
+  void startRawIo(Network::RawIoCallbacks&) override { NOT_REACHED_GCOVR_EXCL_LINE; }
+  void stopRawIo() override { NOT_REACHED_GCOVR_EXCL_LINE; }
 
   // Network::FilterManagerConnection
   void rawWrite(Buffer::Instance& data, bool end_stream) override;
@@ -0,0 +1,48 @@
+#include "extensions/stat_sinks/open_telemetry/config.h"
+
+#include "envoy/extensions/stat_sinks/open_telemetry/v3alpha/open_telemetry.pb.h"
+#include "envoy/extensions/stat_sinks/open_telemetry/v3alpha/open_telemetry.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "common/grpc/async_client_impl.h"
+
+#include "extensions/stat_sinks/open_telemetry/open_telemetry_impl.h"
+#include "extensions/stat_sinks/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace OpenTelemetry {
+
+Stats::SinkPtr OpenTelemetrySinkFactory::createStatsSink(const Protobuf::Message& config,
+                                                         Server::Instance& server) {
+  const auto& sink_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::stat_sinks::open_telemetry::v3alpha::SinkConfig&>(
+      config, server.messageValidationContext().staticValidationVisitor());
+  const auto& grpc_service = sink_config.grpc_service();
+  ENVOY_LOG(debug, "OpenTelemetry stats sink gRPC service configuration: {}",
+            grpc_service.DebugString());
+
+  auto exporter = std::make_shared<OtlpMetricsExporterImpl>(
+      server.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
+          grpc_service, server.stats(), false));
+
+  return std::make_unique<OpenTelemetrySink>(exporter, std::make_shared<OtlpOptions>(sink_config),
+                                             server.localInfo(), server.timeSource());
+}
+
+ProtobufTypes::MessagePtr OpenTelemetrySinkFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::extensions::stat_sinks::open_telemetry::v3alpha::SinkConfig>();
+}
+
+std::string OpenTelemetrySinkFactory::name() const { return StatsSinkNames::get().OpenTelemetry; }
+
+/**
+ * Static registration for the OpenTelemetry sink factory. @see RegisterFactory.
+ */
+REGISTER_FACTORY(OpenTelemetrySinkFactory, Server::Configuration::StatsSinkFactory);
+
+} // namespace OpenTelemetry
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,331 @@
+#include "extensions/stat_sinks/open_telemetry/open_telemetry_impl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/protobuf/utility.h"
+#include "common/tracing/http_tracer_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace OpenTelemetry {
+
+namespace {
+
+constexpr uint32_t DefaultMaxMetricsPerRequest = 1000;
+
+// Exponential histograms start at a scale whose buckets grow by 2^(2^-3), i.e. about 9%, which
+// is close to the resolution of the log-linear bins of Envoy histograms. The scale is lowered
+// until the buckets between the smallest and the largest sample fit in MaxExponentialBuckets.
+constexpr int32_t MaxExponentialScale = 3;
+constexpr int64_t MaxExponentialBuckets = 160;
+
+void setStringAttribute(opentelemetry::proto::common::v1::KeyValue& attribute,
+                        absl::string_view key, absl::string_view value) {
+  attribute.set_key(key.data(), key.size());
+  attribute.mutable_value()->set_string_value(value.data(), value.size());
+}
+
+absl::string_view otlpUnit(Stats::Histogram::Unit unit) {
+  // Units follow the Unified Code for Units of Measure, as recommended by OpenTelemetry.
+  switch (unit) {
+  case Stats::Histogram::Unit::Bytes:
+    return "By";
+  case Stats::Histogram::Unit::Microseconds:
+    return "us";
+  case Stats::Histogram::Unit::Milliseconds:
+    return "ms";
+  case Stats::Histogram::Unit::Null:
+  case Stats::Histogram::Unit::Unspecified:
+    return "";
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+// @return the index of the bucket of an exponential histogram of scale MaxExponentialScale holding
+// a value, where bucket i holds the values in (2^(i / 2^scale), 2^((i + 1) / 2^scale)].
+int64_t exponentialBucketIndex(double value) {
+  return static_cast<int64_t>(std::ceil(std::ldexp(std::log2(value), MaxExponentialScale))) - 1;
+}
+
+// @return the index of the bucket holding the values of a bucket index once the scale of the
+// histogram is lowered by a shift, i.e. the index divided by 2^shift rounded down.
+int64_t downscaleBucketIndex(int64_t index, int32_t shift) {
+  return index >= 0 ? index >> shift : -((-index - 1) >> shift) - 1;
+}
+
+} // namespace
+
+OtlpOptions::OtlpOptions(
+    const envoy::extensions::stat_sinks::open_telemetry::v3alpha::SinkConfig& sink_config)
+    : report_counters_as_deltas_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(sink_config, report_counters_as_deltas, true)),
+      report_histograms_as_deltas_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(sink_config, report_histograms_as_deltas, true)),
+      report_histograms_as_explicit_buckets_(sink_config.report_histograms_as_explicit_buckets()),
+      emit_tags_as_attributes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(sink_config, emit_tags_as_attributes, true)),
+      max_metrics_per_request_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          sink_config, max_metrics_per_request, DefaultMaxMetricsPerRequest)) {}
+
+OtlpMetricsExporterImpl::OtlpMetricsExporterImpl(Grpc::AsyncClientFactoryPtr&& factory)
+    : client_(factory->create()),
+      service_method_(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+          "opentelemetry.proto.collector.metrics.v1.MetricsService.Export")) {}
+
+void OtlpMetricsExporterImpl::send(MetricsExportRequestPtr&& request) {
+  client_->send(service_method_, *request, *this, Tracing::NullSpan::instance(),
+                Http::AsyncClient::RequestOptions());
+}
+
+void OtlpMetricsExporterImpl::onSuccess(std::unique_ptr<MetricsExportResponse>&&,
+                                        Tracing::Span&) {
+  ENVOY_LOG(debug, "OTLP metrics export succeeded");
+}
+
+void OtlpMetricsExporterImpl::onFailure(Grpc::Status::GrpcStatus status,
+                                        const std::string& message, Tracing::Span&) {
+  ENVOY_LOG(debug, "OTLP metrics export failed with status {}: {}", status, message);
+}
+
+OtlpMetricsFlusher::OtlpMetricsFlusher(const OtlpOptionsSharedPtr& options,
+                                       const LocalInfo::LocalInfo& local_info)
+    : options_(options), local_info_(local_info) {}
+
+OtlpMetricsFlusher::Metric& OtlpMetricsFlusher::RequestBatcher::addMetric() {
+  const uint32_t max_metrics = parent_.options_->maxMetricsPerRequest();
+  if (metrics_ == nullptr ||
+      (max_metrics > 0 && static_cast<uint32_t>(metrics_->size()) >= max_metrics)) {
+    requests_.emplace_back(parent_.newRequest());
+    metrics_ = requests_.back()
+                   ->mutable_resource_metrics(0)
+                   ->mutable_instrumentation_library_metrics(0)
+                   ->mutable_metrics();
+  }
+  return *metrics_->Add();
+}
+
+MetricsExportRequestPtr OtlpMetricsFlusher::newRequest() const {
+  auto request = std::make_unique<MetricsExportRequest>();
+  auto* resource_metrics = request->add_resource_metrics();
+  auto* resource = resource_metrics->mutable_resource();
+  setStringAttribute(*resource->add_attributes(), "service.name", local_info_.clusterName());
+  setStringAttribute(*resource->add_attributes(), "service.instance.id", local_info_.nodeName());
+  auto* library_metrics = resource_metrics->add_instrumentation_library_metrics();
+  library_metrics->mutable_instrumentation_library()->set_name("envoy");
+  return request;
+}
+
+template <class DataPoint>
+void OtlpMetricsFlusher::setMetricIdentity(const Stats::Metric& stat, Metric& metric,
+                                           DataPoint& data_point) const {
+  if (!options_->emitTagsAsAttributes()) {
+    metric.set_name(stat.name());
+    return;
+  }
+  metric.set_name(stat.tagExtractedName());
+  for (const Stats::Tag& tag : stat.tags()) {
+    setStringAttribute(*data_point.add_attributes(), tag.name_, tag.value_);
+  }
+}
+
+void OtlpMetricsFlusher::flushCounter(
+    const Stats::MetricSnapshot::CounterSnapshot& counter_snapshot, RequestBatcher& batcher,
+    int64_t start_time_ns, int64_t time_ns) const {
+  const bool as_delta = options_->reportCountersAsDeltas();
+  // With delta temporality an unchanged counter carries no information, so it is not exported.
+  // This keeps the export cost proportional to the rate of change rather than the stat count.
+  if (as_delta && counter_snapshot.delta_ == 0) {
+    return;
+  }
+
+  const Stats::Counter& counter = counter_snapshot.counter_.get();
+  Metric& metric = batcher.addMetric();
+  auto* sum = metric.mutable_sum();
+  sum->set_is_monotonic(true);
+  sum->set_aggregation_temporality(
+      as_delta ? opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_DELTA
+               : opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_CUMULATIVE);
+  auto* data_point = sum->add_data_points();
+  data_point->set_start_time_unix_nano(start_time_ns);
+  data_point->set_time_unix_nano(time_ns);
+  data_point->set_as_int(as_delta ? counter_snapshot.delta_ : counter.value());
+  setMetricIdentity(counter, metric, *data_point);
+}
+
+void OtlpMetricsFlusher::flushGauge(const Stats::Gauge& gauge, RequestBatcher& batcher,
+                                    int64_t time_ns) const {
+  Metric& metric = batcher.addMetric();
+  auto* data_point = metric.mutable_gauge()->add_data_points();
+  data_point->set_time_unix_nano(time_ns);
+  data_point->set_as_int(gauge.value());
+  setMetricIdentity(gauge, metric, *data_point);
+}
+
+void OtlpMetricsFlusher::flushHistogram(const Stats::ParentHistogram& histogram,
+                                        RequestBatcher& batcher, int64_t start_time_ns,
+                                        int64_t time_ns) const {
+  const bool as_delta = options_->reportHistogramsAsDeltas();
+  const Stats::HistogramStatistics& stats =
+      as_delta ? histogram.intervalStatistics() : histogram.cumulativeStatistics();
+  if (as_delta && stats.sampleCount() == 0) {
+    return;
+  }
+
+  Metric& metric = batcher.addMetric();
+  const absl::string_view unit = otlpUnit(histogram.unit());
+  metric.set_unit(unit.data(), unit.size());
+  const auto temporality =
+      as_delta ? opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_DELTA
+               : opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_CUMULATIVE;
+  if (options_->reportHistogramsAsExplicitBuckets()) {
+    auto* otlp_histogram = metric.mutable_histogram();
+    otlp_histogram->set_aggregation_temporality(temporality);
+    auto* data_point = otlp_histogram->add_data_points();
+    data_point->set_start_time_unix_nano(start_time_ns);
+    data_point->set_time_unix_nano(time_ns);
+    data_point->set_count(stats.sampleCount());
+    data_point->set_sum(stats.sampleSum());
+    setExplicitBuckets(stats, *data_point);
+    setMetricIdentity(histogram, metric, *data_point);
+  } else {
+    auto* otlp_histogram = metric.mutable_exponential_histogram();
+    otlp_histogram->set_aggregation_temporality(temporality);
+    auto* data_point = otlp_histogram->add_data_points();
+    data_point->set_start_time_unix_nano(start_time_ns);
+    data_point->set_time_unix_nano(time_ns);
+    data_point->set_count(stats.sampleCount());
+    data_point->set_sum(stats.sampleSum());
+    setExponentialBuckets(histogram, !as_delta, *data_point);
+    setMetricIdentity(histogram, metric, *data_point);
+  }
+}
+
+void OtlpMetricsFlusher::setExplicitBuckets(const Stats::HistogramStatistics& stats,
+                                            HistogramDataPoint& data_point) const {
+  // Envoy computes cumulative counts per upper bound from the underlying circllhist, whereas OTLP
+  // expects the count of each bucket plus an overflow bucket for values above the last bound.
+  const std::vector<double>& bounds = stats.supportedBuckets();
+  const std::vector<uint64_t>& cumulative_counts = stats.computedBuckets();
+  ASSERT(bounds.size() == cumulative_counts.size());
+  data_point.mutable_explicit_bounds()->Reserve(bounds.size());
+  data_point.mutable_bucket_counts()->Reserve(bounds.size() + 1);
+  uint64_t previous_count = 0;
+  for (size_t i = 0; i < bounds.size(); ++i) {
+    data_point.add_explicit_bounds(bounds[i]);
+    // Guard against non-monotonic counts introduced by rounding in the bucket interpolation.
+    const uint64_t count = std::max(cumulative_counts[i], previous_count);
+    data_point.add_bucket_counts(count - previous_count);
+    previous_count = count;
+  }
+  data_point.add_bucket_counts(stats.sampleCount() > previous_count
+                                   ? stats.sampleCount() - previous_count
+                                   : 0);
+}
+
+void OtlpMetricsFlusher::setExponentialBuckets(const Stats::ParentHistogram& histogram,
+                                               bool cumulative,
+                                               ExponentialHistogramDataPoint& data_point) const {
+  // Each log-linear bin of the histogram goes to the exponential bucket holding its midpoint. The
+  // samples of Envoy histograms are never negative, so only the zero and positive buckets are set.
+  uint64_t zero_count = 0;
+  std::vector<std::pair<int64_t, uint64_t>> bins;
+  histogram.forEachBin(cumulative, [&zero_count, &bins](double lower_bound, double width,
+                                                        uint64_t count) {
+    const double midpoint = lower_bound + width / 2;
+    if (midpoint <= 0) {
+      zero_count += count;
+    } else {
+      bins.emplace_back(exponentialBucketIndex(midpoint), count);
+    }
+  });
+  data_point.set_zero_count(zero_count);
+
+  int32_t shift = 0;
+  if (!bins.empty()) {
+    while (downscaleBucketIndex(bins.back().first, shift) -
+               downscaleBucketIndex(bins.front().first, shift) >=
+           MaxExponentialBuckets) {
+      shift++;
+    }
+  }
+  data_point.set_scale(MaxExponentialScale - shift);
+  if (bins.empty()) {
+    return;
+  }
+
+  auto* positive = data_point.mutable_positive();
+  const int64_t offset = downscaleBucketIndex(bins.front().first, shift);
+  positive->set_offset(static_cast<int32_t>(offset));
+  for (const auto& bin : bins) {
+    const int64_t index = downscaleBucketIndex(bin.first, shift) - offset;
+    while (positive->bucket_counts_size() <= index) {
+      positive->add_bucket_counts(0);
+    }
+    positive->set_bucket_counts(index, positive->bucket_counts(index) + bin.second);
+  }
+}
+
+MetricsExportRequestPtrVector OtlpMetricsFlusher::flush(Stats::MetricSnapshot& snapshot,
+                                                        int64_t start_time_ns,
+                                                        int64_t cumulative_start_time_ns,
+                                                        int64_t time_ns) const {
+  MetricsExportRequestPtrVector requests;
+  RequestBatcher batcher(*this, requests);
+
+  const int64_t counter_start_time_ns =
+      options_->reportCountersAsDeltas() ? start_time_ns : cumulative_start_time_ns;
+  for (const auto& counter : snapshot.counters()) {
+    if (counter.counter_.get().used()) {
+      flushCounter(counter, batcher, counter_start_time_ns, time_ns);
+    }
+  }
+
+  for (const auto& gauge : snapshot.gauges()) {
+    if (gauge.get().used()) {
+      flushGauge(gauge.get(), batcher, time_ns);
+    }
+  }
+
+  const int64_t histogram_start_time_ns =
+      options_->reportHistogramsAsDeltas() ? start_time_ns : cumulative_start_time_ns;
+  for (const auto& histogram : snapshot.histograms()) {
+    if (histogram.get().used()) {
+      flushHistogram(histogram.get(), batcher, histogram_start_time_ns, time_ns);
+    }
+  }
+
+  return requests;
+}
+
+OpenTelemetrySink::OpenTelemetrySink(const OtlpMetricsExporterSharedPtr& exporter,
+                                     const OtlpOptionsSharedPtr& options,
+                                     const LocalInfo::LocalInfo& local_info,
+                                     TimeSource& time_source)
+    : exporter_(exporter), flusher_(options, local_info), time_source_(time_source),
+      start_time_ns_(nowNs()), last_flush_time_ns_(start_time_ns_) {}
+
+int64_t OpenTelemetrySink::nowNs() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             time_source_.systemTime().time_since_epoch())
+      .count();
+}
+
+void OpenTelemetrySink::flush(Stats::MetricSnapshot& snapshot) {
+  const int64_t now_ns = nowNs();
+  MetricsExportRequestPtrVector requests =
+      flusher_.flush(snapshot, last_flush_time_ns_, start_time_ns_, now_ns);
+  last_flush_time_ns_ = now_ns;
+  for (auto& request : requests) {
+    exporter_->send(std::move(request));
+  }
+}
+
+} // namespace OpenTelemetry
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
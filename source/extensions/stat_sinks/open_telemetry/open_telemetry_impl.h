@@ -0,0 +1,181 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/extensions/stat_sinks/open_telemetry/v3alpha/open_telemetry.pb.h"
+#include "envoy/grpc/async_client.h"
+#include "envoy/local_info/local_info.h"
+#include "envoy/stats/histogram.h"
+#include "envoy/stats/sink.h"
+#include "envoy/stats/stats.h"
+
+#include "common/common/logger.h"
+#include "common/grpc/typed_async_client.h"
+#include "common/protobuf/protobuf.h"
+
+#include "opentelemetry/proto/collector/metrics/v1/metrics_service.pb.h"
+#include "opentelemetry/proto/metrics/v1/metrics.pb.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace OpenTelemetry {
+
+using MetricsExportRequest =
+    opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest;
+using MetricsExportResponse =
+    opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse;
+using MetricsExportRequestPtr = std::unique_ptr<MetricsExportRequest>;
+using MetricsExportRequestPtrVector = std::vector<MetricsExportRequestPtr>;
+
+/**
+ * Options derived from the sink configuration, with defaults applied.
+ */
+class OtlpOptions {
+public:
+  explicit OtlpOptions(
+      const envoy::extensions::stat_sinks::open_telemetry::v3alpha::SinkConfig& sink_config);
+
+  bool reportCountersAsDeltas() const { return report_counters_as_deltas_; }
+  bool reportHistogramsAsDeltas() const { return report_histograms_as_deltas_; }
+  bool reportHistogramsAsExplicitBuckets() const { return report_histograms_as_explicit_buckets_; }
+  bool emitTagsAsAttributes() const { return emit_tags_as_attributes_; }
+  uint32_t maxMetricsPerRequest() const { return max_metrics_per_request_; }
+
+private:
+  const bool report_counters_as_deltas_;
+  const bool report_histograms_as_deltas_;
+  const bool report_histograms_as_explicit_buckets_;
+  const bool emit_tags_as_attributes_;
+  const uint32_t max_metrics_per_request_;
+};
+
+using OtlpOptionsSharedPtr = std::shared_ptr<OtlpOptions>;
+
+/**
+ * Interface for sending OTLP export requests.
+ */
+class OtlpMetricsExporter : public Grpc::AsyncRequestCallbacks<MetricsExportResponse> {
+public:
+  ~OtlpMetricsExporter() override = default;
+
+  /**
+   * Send an export request. Requests are fire and forget; failures are only logged.
+   * @param request supplies the metrics to export.
+   */
+  virtual void send(MetricsExportRequestPtr&& request) PURE;
+
+  // Grpc::AsyncRequestCallbacks
+  void onCreateInitialMetadata(Http::RequestHeaderMap&) override {}
+};
+
+using OtlpMetricsExporterSharedPtr = std::shared_ptr<OtlpMetricsExporter>;
+
+/**
+ * Production implementation of OtlpMetricsExporter.
+ */
+class OtlpMetricsExporterImpl : public OtlpMetricsExporter,
+                                public Logger::Loggable<Logger::Id::stats> {
+public:
+  explicit OtlpMetricsExporterImpl(Grpc::AsyncClientFactoryPtr&& factory);
+
+  // OtlpMetricsExporter
+  void send(MetricsExportRequestPtr&& request) override;
+
+  // Grpc::AsyncRequestCallbacks
+  void onSuccess(std::unique_ptr<MetricsExportResponse>&&, Tracing::Span&) override;
+  void onFailure(Grpc::Status::GrpcStatus status, const std::string& message,
+                 Tracing::Span&) override;
+
+private:
+  Grpc::AsyncClient<MetricsExportRequest, MetricsExportResponse> client_;
+  const Protobuf::MethodDescriptor& service_method_;
+};
+
+/**
+ * Converts a stats snapshot into batched OTLP export requests.
+ */
+class OtlpMetricsFlusher {
+public:
+  OtlpMetricsFlusher(const OtlpOptionsSharedPtr& options, const LocalInfo::LocalInfo& local_info);
+
+  /**
+   * Build the export requests for a snapshot.
+   * @param snapshot supplies the metrics to convert.
+   * @param start_time_ns supplies the start of the reporting interval for delta metrics, in
+   *        nanoseconds since the epoch.
+   * @param cumulative_start_time_ns supplies the start time for cumulative metrics.
+   * @param time_ns supplies the time the snapshot was taken.
+   * @return the export requests, each holding at most OtlpOptions::maxMetricsPerRequest() metrics.
+   */
+  MetricsExportRequestPtrVector flush(Stats::MetricSnapshot& snapshot, int64_t start_time_ns,
+                                      int64_t cumulative_start_time_ns, int64_t time_ns) const;
+
+private:
+  using Metric = opentelemetry::proto::metrics::v1::Metric;
+  using HistogramDataPoint = opentelemetry::proto::metrics::v1::HistogramDataPoint;
+  using ExponentialHistogramDataPoint =
+      opentelemetry::proto::metrics::v1::ExponentialHistogramDataPoint;
+
+  class RequestBatcher {
+  public:
+    RequestBatcher(const OtlpMetricsFlusher& parent, MetricsExportRequestPtrVector& requests)
+        : parent_(parent), requests_(requests) {}
+
+    Metric& addMetric();
+
+  private:
+    const OtlpMetricsFlusher& parent_;
+    MetricsExportRequestPtrVector& requests_;
+    Protobuf::RepeatedPtrField<Metric>* metrics_{};
+  };
+
+  template <class DataPoint>
+  void setMetricIdentity(const Stats::Metric& stat, Metric& metric, DataPoint& data_point) const;
+  void flushCounter(const Stats::MetricSnapshot::CounterSnapshot& counter_snapshot,
+                    RequestBatcher& batcher, int64_t start_time_ns, int64_t time_ns) const;
+  void flushGauge(const Stats::Gauge& gauge, RequestBatcher& batcher, int64_t time_ns) const;
+  void flushHistogram(const Stats::ParentHistogram& histogram, RequestBatcher& batcher,
+                      int64_t start_time_ns, int64_t time_ns) const;
+  void setExplicitBuckets(const Stats::HistogramStatistics& stats,
+                          HistogramDataPoint& data_point) const;
+  void setExponentialBuckets(const Stats::ParentHistogram& histogram, bool cumulative,
+                             ExponentialHistogramDataPoint& data_point) const;
+  MetricsExportRequestPtr newRequest() const;
+
+  const OtlpOptionsSharedPtr options_;
+  const LocalInfo::LocalInfo& local_info_;
+};
+
+/**
+ * Stats sink that exports metrics with the OTLP metrics service.
+ */
+class OpenTelemetrySink : public Stats::Sink {
+public:
+  OpenTelemetrySink(const OtlpMetricsExporterSharedPtr& exporter,
+                    const OtlpOptionsSharedPtr& options, const LocalInfo::LocalInfo& local_info,
+                    TimeSource& time_source);
+
+  // Stats::Sink
+  void flush(Stats::MetricSnapshot& snapshot) override;
+  void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
+
+private:
+  int64_t nowNs() const;
+
+  const OtlpMetricsExporterSharedPtr exporter_;
+  const OtlpMetricsFlusher flusher_;
+  TimeSource& time_source_;
+  const int64_t start_time_ns_;
+  int64_t last_flush_time_ns_;
+};
+
+} // namespace OpenTelemetry
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -22,6 +22,8 @@ public:
   const std::string MetricsService = "envoy.stat_sinks.metrics_service";
   // Hystrix sink
   const std::string Hystrix = "envoy.stat_sinks.hystrix";
+  // OpenTelemetry (OTLP) metrics sink
+  const std::string OpenTelemetry = "envoy.stat_sinks.open_telemetry";
 };
 
 using StatsSinkNames = ConstSingleton<StatsSinkNameValues>;
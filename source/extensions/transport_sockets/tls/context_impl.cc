@@ -23,6 +23,7 @@
 
 #include "extensions/transport_sockets/tls/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "openssl/evp.h"
 #include "openssl/hmac.h"
@@ -49,6 +50,55 @@ bool cbsContainsU16(CBS& cbs, uint16_t n) {
   return false;
 }
 
+// Hashes the parts of a client context configuration which decide whether an upstream host is
+// trusted, or which identify Envoy to the host. Each part is prefixed with its length, so that
+// different configurations can't hash the same.
+std::string clientConfigFingerprint(const Envoy::Ssl::ClientContextConfig& config) {
+  bssl::ScopedEVP_MD_CTX md;
+  int rc = EVP_DigestInit(md.get(), EVP_sha256());
+  RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  const auto update = [&md](absl::string_view data) {
+    const uint64_t size = data.size();
+    int rc = EVP_DigestUpdate(md.get(), &size, sizeof(size));
+    RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+    rc = EVP_DigestUpdate(md.get(), data.data(), data.size());
+    RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  };
+
+  update(config.alpnProtocols());
+  update(config.cipherSuites());
+  update(config.ecdhCurves());
+  update(absl::StrCat(config.minProtocolVersion(), ",", config.maxProtocolVersion(), ",",
+                      config.allowRenegotiation()));
+  for (const auto& tls_certificate : config.tlsCertificates()) {
+    update(tls_certificate.get().certificateChain());
+  }
+  const Envoy::Ssl::CertificateValidationContextConfig* validation_context =
+      config.certificateValidationContext();
+  if (validation_context != nullptr) {
+    update(validation_context->caCert());
+    update(validation_context->certificateRevocationList());
+    update(absl::StrJoin(validation_context->verifySubjectAltNameList(), ","));
+    for (const auto& matcher : validation_context->subjectAltNameMatchers()) {
+      update(matcher.SerializeAsString());
+    }
+    update(absl::StrJoin(validation_context->verifyCertificateHashList(), ","));
+    update(absl::StrJoin(validation_context->verifyCertificateSpkiList(), ","));
+    update(absl::StrCat(validation_context->allowExpiredCertificate(), ",",
+                        static_cast<int>(validation_context->trustChainVerification())));
+  }
+
+  uint8_t hash_buffer[SHA256_DIGEST_LENGTH];
+  unsigned hash_length = 0;
+  rc = EVP_DigestFinal(md.get(), hash_buffer, &hash_length);
+  RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  return Hex::encode(hash_buffer, hash_length);
+}
+
+void freeSessionKey(void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) {
+  delete static_cast<std::string*>(ptr);
+}
+
 } // namespace
 
 int ContextImpl::sslExtendedSocketInfoIndex() {
@@ -63,6 +113,7 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
                          TimeSource& time_source)
     : scope_(scope), stats_(generateStats(scope)), time_source_(time_source),
       tls_max_version_(config.maxProtocolVersion()),
+      kernel_tls_offload_(config.kernelTlsOffload()),
       stat_name_set_(scope.symbolTable().makeSet("TransportSockets::Tls")),
       unknown_ssl_cipher_(stat_name_set_->add("unknown_ssl_cipher")),
       unknown_ssl_curve_(stat_name_set_->add("unknown_ssl_curve")),
@@ -812,11 +863,14 @@ Envoy::Ssl::CertificateDetailsPtr ContextImpl::certificateDetails(X509* cert,
 
 ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ClientContextConfig& config,
-                                     TimeSource& time_source)
+                                     TimeSource& time_source,
+                                     SessionCacheSharedPtr session_cache)
     : ContextImpl(scope, config, time_source),
       server_name_indication_(config.serverNameIndication()),
       allow_renegotiation_(config.allowRenegotiation()),
-      max_session_keys_(config.maxSessionKeys()) {
+      max_session_keys_(config.maxSessionKeys()),
+      config_fingerprint_(clientConfigFingerprint(config)),
+      session_cache_(std::move(session_cache)) {
   // This should be guaranteed during configuration ingestion for client contexts.
   ASSERT(tls_contexts_.size() == 1);
   if (!parsed_alpn_protocols_.empty()) {
@@ -846,7 +900,7 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
               static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
           ClientContextImpl* client_context_impl = dynamic_cast<ClientContextImpl*>(context_impl);
           RELEASE_ASSERT(client_context_impl != nullptr, ""); // for Coverity
-          return client_context_impl->newSessionKey(session);
+          return client_context_impl->newSessionKey(ssl, session);
         });
   }
 }
@@ -883,47 +937,50 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl(const Network::TransportSocketOpt
   }
 
   if (max_session_keys_ > 0) {
-    if (session_keys_single_use_) {
-      // Stored single-use session keys, use write/write locks.
-      absl::WriterMutexLock l(&session_keys_mu_);
-      if (!session_keys_.empty()) {
-        // Use the most recently stored session key, since it has the highest
-        // probability of still being recognized/accepted by the server.
-        SSL_SESSION* session = session_keys_.front().get();
-        SSL_set_session(ssl_con.get(), session);
-        // Remove single-use session key (TLS 1.3) after first use.
-        if (SSL_SESSION_should_be_single_use(session)) {
-          session_keys_.pop_front();
-        }
-      }
-    } else {
-      // Never stored single-use session keys, use read/write locks.
-      absl::ReaderMutexLock l(&session_keys_mu_);
-      if (!session_keys_.empty()) {
-        // Use the most recently stored session key, since it has the highest
-        // probability of still being recognized/accepted by the server.
-        SSL_SESSION* session = session_keys_.front().get();
-        SSL_set_session(ssl_con.get(), session);
-      }
+    // Sessions are keyed by everything deciding whether the upstream host is trusted. The key is
+    // completed with the address of the host in resumeSession(), once the connection knows it.
+    std::string session_key = absl::StrCat(config_fingerprint_, "|", server_name_indication, "|");
+    if (options) {
+      absl::StrAppend(&session_key, absl::StrJoin(options->verifySubjectAltNameListOverride(), ","),
+                      "|", absl::StrJoin(options->applicationProtocolListOverride(), ","), "|");
     }
+    SSL_set_ex_data(ssl_con.get(), sessionKeyIndex(), new std::string(std::move(session_key)));
   }
 
   return ssl_con;
 }
 
-int ClientContextImpl::newSessionKey(SSL_SESSION* session) {
-  // In case we ever store single-use session key (TLS 1.3),
-  // we need to switch to using write/write locks.
-  if (SSL_SESSION_should_be_single_use(session)) {
-    session_keys_single_use_ = true;
+void ClientContextImpl::resumeSession(SSL* ssl, const Network::Address::Instance& remote_address) {
+  auto* session_key = static_cast<std::string*>(SSL_get_ex_data(ssl, sessionKeyIndex()));
+  if (session_key == nullptr) {
+    return;
+  }
+
+  session_key->append(remote_address.asString());
+  // Use the most recently stored session of the host, since it has the highest probability of
+  // still being recognized/accepted by the host. Single-use sessions (TLS 1.3) are removed.
+  bssl::UniquePtr<SSL_SESSION> session = session_cache_->get(*session_key);
+  if (session != nullptr) {
+    SSL_set_session(ssl, session.get());
   }
-  absl::WriterMutexLock l(&session_keys_mu_);
-  // Evict oldest entries.
-  while (session_keys_.size() >= max_session_keys_) {
-    session_keys_.pop_back();
+}
+
+int ClientContextImpl::sessionKeyIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int session_key_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeSessionKey);
+    RELEASE_ASSERT(session_key_index >= 0, "");
+    return session_key_index;
+  }());
+}
+
+int ClientContextImpl::newSessionKey(SSL* ssl, SSL_SESSION* session) {
+  const auto* session_key =
+      static_cast<const std::string*>(SSL_get_ex_data(ssl, sessionKeyIndex()));
+  if (session_key == nullptr) {
+    return 0; // Tell BoringSSL that we didn't take ownership of the session.
   }
-  // Add new session key at the front of the queue, so that it's used first.
-  session_keys_.push_front(bssl::UniquePtr<SSL_SESSION>(session));
+  // Evicts the oldest sessions of the host, and adds the new one so that it's used first.
+  session_cache_->add(*session_key, bssl::UniquePtr<SSL_SESSION>(session), max_session_keys_);
   return 1; // Tell BoringSSL that we took ownership of the session.
 }
 
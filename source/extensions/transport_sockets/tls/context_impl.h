@@ -1,11 +1,11 @@
 #pragma once
 
 #include <array>
-#include <deque>
 #include <functional>
 #include <string>
 #include <vector>
 
+#include "envoy/network/address.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
@@ -18,8 +18,8 @@
 #include "common/stats/symbol_table_impl.h"
 
 #include "extensions/transport_sockets/tls/context_manager_impl.h"
+#include "extensions/transport_sockets/tls/session_cache.h"
 
-#include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
 #include "openssl/x509v3.h"
 
@@ -40,7 +40,9 @@ namespace Tls {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  COUNTER(kernel_tls_offload)                                                                      \
+  COUNTER(kernel_tls_offload_unavailable)
 
 /**
  * Wrapper struct for SSL stats. @see stats_macros.h
@@ -53,6 +55,14 @@ class ContextImpl : public virtual Envoy::Ssl::Context {
 public:
   virtual bssl::UniquePtr<SSL> newSsl(const Network::TransportSocketOptions* options);
 
+  /**
+   * Offers a cached session to the peer of a connection, once the address of the peer is known.
+   * Only client contexts resume sessions.
+   * @param ssl the connection to resume a session for.
+   * @param remote_address the address of the peer.
+   */
+  virtual void resumeSession(SSL*, const Network::Address::Instance&) {}
+
   /**
    * Logs successful TLS handshake and updates stats.
    * @param ssl the connection to log
@@ -88,6 +98,11 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return whether connections should offload record protection to the kernel.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -192,6 +207,7 @@ protected:
   std::string cert_chain_file_path_;
   TimeSource& time_source_;
   const unsigned tls_max_version_;
+  const bool kernel_tls_offload_;
   mutable Stats::StatNameSetPtr stat_name_set_;
   const Stats::StatName unknown_ssl_cipher_;
   const Stats::StatName unknown_ssl_curve_;
@@ -208,20 +224,28 @@ using ContextImplSharedPtr = std::shared_ptr<ContextImpl>;
 class ClientContextImpl : public ContextImpl, public Envoy::Ssl::ClientContext {
 public:
   ClientContextImpl(Stats::Scope& scope, const Envoy::Ssl::ClientContextConfig& config,
-                    TimeSource& time_source);
+                    TimeSource& time_source, SessionCacheSharedPtr session_cache);
 
   bssl::UniquePtr<SSL> newSsl(const Network::TransportSocketOptions* options) override;
+  void resumeSession(SSL* ssl, const Network::Address::Instance& remote_address) override;
 
 private:
-  int newSessionKey(SSL_SESSION* session);
+  /**
+   * The global SSL-library index used for storing the session cache key of a connection in the SSL
+   * instance, for retrieval in callbacks.
+   */
+  static int sessionKeyIndex();
+
+  int newSessionKey(SSL* ssl, SSL_SESSION* session);
   uint16_t parseSigningAlgorithmsForTest(const std::string& sigalgs);
 
   const std::string server_name_indication_;
   const bool allow_renegotiation_;
   const size_t max_session_keys_;
-  absl::Mutex session_keys_mu_;
-  std::deque<bssl::UniquePtr<SSL_SESSION>> session_keys_ ABSL_GUARDED_BY(session_keys_mu_);
-  bool session_keys_single_use_{false};
+  // Identifies the configuration deciding whether an upstream host is trusted. Sessions are only
+  // shared with the contexts having the same one.
+  const std::string config_fingerprint_;
+  const SessionCacheSharedPtr session_cache_;
 };
 
 class ServerContextImpl : public ContextImpl, public Envoy::Ssl::ServerContext {
@@ -9,6 +9,7 @@
 #include "envoy/stats/scope.h"
 
 #include "extensions/transport_sockets/tls/private_key/private_key_manager_impl.h"
+#include "extensions/transport_sockets/tls/session_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -24,7 +25,13 @@ namespace Tls {
  */
 class ContextManagerImpl final : public Envoy::Ssl::ContextManager {
 public:
-  ContextManagerImpl(TimeSource& time_source) : time_source_(time_source) {}
+  // The maximum number of upstream hosts whose TLS sessions are cached, across all the client
+  // contexts.
+  static constexpr uint64_t MaxSessionCacheKeys = 16384;
+
+  ContextManagerImpl(TimeSource& time_source)
+      : time_source_(time_source),
+        session_cache_(std::make_shared<SessionCache>(MaxSessionCacheKeys)) {}
   ~ContextManagerImpl() override;
 
   // Ssl::ContextManager
@@ -39,12 +46,21 @@ public:
   Ssl::PrivateKeyMethodManager& privateKeyMethodManager() override {
     return private_key_method_manager_;
   };
+  void iterateSessions(
+      std::function<void(const std::string& key, absl::string_view session)> callback) override {
+    session_cache_->iterateSessions(callback);
+  }
+  void importSession(const std::string& key, absl::string_view session) override {
+    session_cache_->importSession(key, session);
+  }
 
 private:
   void removeEmptyContexts();
   TimeSource& time_source_;
   std::list<std::weak_ptr<Envoy::Ssl::Context>> contexts_;
   PrivateKeyMethodManagerImpl private_key_method_manager_{};
+  // Shared with the client contexts, which may outlive the manager.
+  const SessionCacheSharedPtr session_cache_;
 };
 
 } // namespace Tls
@@ -0,0 +1,203 @@
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include <cstring>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+
+#include "absl/container/fixed_array.h"
+#include "openssl/mem.h"
+#include "openssl/nid.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+namespace {
+
+// Kernel ABI, see include/uapi/linux/tls.h. These are defined here as the build headers may
+// predate kTLS.
+constexpr int TcpUlp = 31;
+constexpr int SolTls = 282;
+constexpr int TlsTx = 1;
+constexpr int TlsRx = 2;
+constexpr int TlsSetRecordType = 1;
+constexpr int TlsGetRecordType = 2;
+constexpr uint16_t TlsCipherAesGcm128 = 51;
+constexpr uint16_t TlsCipherAesGcm256 = 52;
+constexpr uint16_t TlsCipherChaCha20Poly1305 = 54;
+
+struct CipherParams {
+  uint16_t kernel_cipher_;
+  // Size of the key and of the fixed part of the nonce, as laid out in the key block.
+  size_t key_size_;
+  size_t fixed_iv_size_;
+  // Size of the iv passed to the kernel, which follows the key block layout for ChaCha20 and is the
+  // explicit part of the nonce for AES-GCM.
+  size_t iv_size_;
+};
+
+bool cipherParams(int cipher_nid, CipherParams& params) {
+  switch (cipher_nid) {
+  case NID_aes_128_gcm:
+    params = {TlsCipherAesGcm128, 16, 4, 8};
+    return true;
+  case NID_aes_256_gcm:
+    params = {TlsCipherAesGcm256, 32, 4, 8};
+    return true;
+  case NID_chacha20_poly1305:
+    params = {TlsCipherChaCha20Poly1305, 32, 12, 12};
+    return true;
+  default:
+    return false;
+  }
+}
+
+void appendBigEndian(std::vector<uint8_t>& out, uint64_t value, size_t size) {
+  for (size_t i = size; i > 0; --i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * (i - 1))));
+  }
+}
+
+void appendNative(std::vector<uint8_t>& out, uint16_t value) {
+  uint8_t bytes[sizeof(value)];
+  memcpy(bytes, &value, sizeof(value));
+  out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+} // namespace
+
+std::vector<uint8_t> cryptoInfo(uint16_t version, int cipher_nid,
+                                absl::Span<const uint8_t> key_block, bool is_server,
+                                Direction direction, uint64_t sequence) {
+  CipherParams params;
+  if (version != TLS1_2_VERSION || !cipherParams(cipher_nid, params) ||
+      key_block.size() != 2 * (params.key_size_ + params.fixed_iv_size_)) {
+    return {};
+  }
+
+  // The AEAD ciphers have no MAC key, so the key block is the client key, the server key, the
+  // client IV and the server IV.
+  const bool client_keys = is_server == (direction == Direction::Receive);
+  const uint8_t* key = key_block.data() + (client_keys ? 0 : params.key_size_);
+  const uint8_t* fixed_iv =
+      key_block.data() + 2 * params.key_size_ + (client_keys ? 0 : params.fixed_iv_size_);
+
+  // struct tls_crypto_info, followed by the cipher specific iv, key, salt and rec_seq arrays.
+  std::vector<uint8_t> info;
+  appendNative(info, version);
+  appendNative(info, params.kernel_cipher_);
+  if (params.kernel_cipher_ == TlsCipherChaCha20Poly1305) {
+    info.insert(info.end(), fixed_iv, fixed_iv + params.fixed_iv_size_);
+    info.insert(info.end(), key, key + params.key_size_);
+  } else {
+    // The kernel increments the explicit nonce with each record. BoringSSL uses the sequence
+    // number, which is unique per key.
+    appendBigEndian(info, sequence, params.iv_size_);
+    info.insert(info.end(), key, key + params.key_size_);
+    info.insert(info.end(), fixed_iv, fixed_iv + params.fixed_iv_size_);
+  }
+  appendBigEndian(info, sequence, sizeof(sequence));
+  return info;
+}
+
+#ifdef __linux__
+
+Offload enable(SSL* ssl, os_fd_t fd) {
+  Offload offload;
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return offload;
+  }
+
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (!SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return offload;
+  }
+  const uint16_t version = SSL_version(ssl);
+  const int cipher_nid = SSL_CIPHER_get_cipher_nid(cipher);
+  const bool is_server = SSL_is_server(ssl);
+  std::vector<uint8_t> transmit = cryptoInfo(version, cipher_nid, key_block, is_server,
+                                             Direction::Transmit, SSL_get_write_sequence(ssl));
+  std::vector<uint8_t> receive = cryptoInfo(version, cipher_nid, key_block, is_server,
+                                            Direction::Receive, SSL_get_read_sequence(ssl));
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+
+  Api::OsSysCalls& os_sys_calls = Api::OsSysCallsSingleton::get();
+  if (!transmit.empty() && os_sys_calls.setsockopt(fd, IPPROTO_TCP, TcpUlp, "tls", 4).rc_ == 0) {
+    offload.transmit_ =
+        os_sys_calls.setsockopt(fd, SolTls, TlsTx, transmit.data(), transmit.size()).rc_ == 0;
+    // Records already read from the socket by BoringSSL would never be seen by the kernel.
+    if (!SSL_has_pending(ssl)) {
+      offload.receive_ =
+          os_sys_calls.setsockopt(fd, SolTls, TlsRx, receive.data(), receive.size()).rc_ == 0;
+    }
+  }
+  OPENSSL_cleanse(transmit.data(), transmit.size());
+  OPENSSL_cleanse(receive.data(), receive.size());
+  return offload;
+}
+
+Api::SysCallSizeResult read(os_fd_t fd, Buffer::RawSlice* slices, uint64_t num_slices,
+                            uint8_t& record_type) {
+  absl::FixedArray<iovec> iov(num_slices);
+  for (uint64_t i = 0; i < num_slices; i++) {
+    iov[i].iov_base = slices[i].mem_;
+    iov[i].iov_len = slices[i].len_;
+  }
+  char control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr message{};
+  message.msg_iov = iov.begin();
+  message.msg_iovlen = num_slices;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  const Api::SysCallSizeResult result = Api::OsSysCallsSingleton::get().recvmsg(fd, &message, 0);
+  record_type = ContentTypeApplicationData;
+  if (result.rc_ >= 0 && message.msg_controllen > 0) {
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (cmsg->cmsg_level == SolTls && cmsg->cmsg_type == TlsGetRecordType) {
+        record_type = *CMSG_DATA(cmsg);
+      }
+    }
+  }
+  return result;
+}
+
+Api::SysCallSizeResult sendAlert(os_fd_t fd, uint8_t level, uint8_t description) {
+  uint8_t alert[2] = {level, description};
+  iovec iov{alert, sizeof(alert)};
+  char control[CMSG_SPACE(sizeof(uint8_t))] = {};
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SolTls;
+  cmsg->cmsg_type = TlsSetRecordType;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = ContentTypeAlert;
+  return Api::OsSysCallsSingleton::get().sendmsg(fd, &message, 0);
+}
+
+#else
+
+Offload enable(SSL*, os_fd_t) { return {}; }
+
+Api::SysCallSizeResult read(os_fd_t, Buffer::RawSlice*, uint64_t, uint8_t&) {
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+Api::SysCallSizeResult sendAlert(os_fd_t, uint8_t, uint8_t) { NOT_REACHED_GCOVR_EXCL_LINE; }
+
+#endif
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
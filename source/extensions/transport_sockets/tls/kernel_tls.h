@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "envoy/api/os_sys_calls_common.h"
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/platform.h"
+
+#include "absl/types/span.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Offload of TLS record protection to the Linux kernel (kTLS). Once the keys of a connection are
+ * handed to the kernel, plain application data is read from and written to the socket, and the
+ * kernel encrypts and decrypts the records.
+ *
+ * Only TLS 1.2 connections using AES-GCM or ChaCha20-Poly1305 are offloaded. BoringSSL does not
+ * expose the traffic secrets of TLS 1.3 connections, whose post-handshake messages would also have
+ * to be handled outside of BoringSSL.
+ */
+namespace KernelTls {
+
+// TLS record content types (RFC 5246 section 6.2.1).
+constexpr uint8_t ContentTypeAlert = 21;
+constexpr uint8_t ContentTypeHandshake = 22;
+constexpr uint8_t ContentTypeApplicationData = 23;
+
+enum class Direction { Transmit, Receive };
+
+/**
+ * Builds the argument of the TLS_TX or TLS_RX socket option for one direction of a connection.
+ * @param version supplies the negotiated protocol version.
+ * @param cipher_nid supplies the NID of the negotiated AEAD.
+ * @param key_block supplies the key block of the connection (RFC 5246 section 6.3).
+ * @param is_server supplies whether the local end is the server.
+ * @param direction supplies the direction to build the argument for.
+ * @param sequence supplies the sequence number of the next record in that direction.
+ * @return the argument, or an empty vector if the connection cannot be offloaded.
+ */
+std::vector<uint8_t> cryptoInfo(uint16_t version, int cipher_nid,
+                                absl::Span<const uint8_t> key_block, bool is_server,
+                                Direction direction, uint64_t sequence);
+
+struct Offload {
+  bool transmit_{};
+  bool receive_{};
+};
+
+/**
+ * Hands the keys of a connection to the kernel. This must be done as soon as the handshake
+ * completes, before any application data is read or written through the SSL object. The
+ * directions which are offloaded must no longer be used through the SSL object.
+ * @param ssl supplies the connection.
+ * @param fd supplies the socket of the connection.
+ * @return the directions which were offloaded, none if the kernel or the connection do not support
+ *         offload.
+ */
+Offload enable(SSL* ssl, os_fd_t fd);
+
+/**
+ * Reads decrypted data from a socket with receive offload. A record of another type than
+ * application data is always returned by itself.
+ * @param fd supplies the socket.
+ * @param slices supplies the slices to read into.
+ * @param num_slices supplies the number of slices.
+ * @param record_type receives the content type of the records read.
+ * @return the result of recvmsg().
+ */
+Api::SysCallSizeResult read(os_fd_t fd, Buffer::RawSlice* slices, uint64_t num_slices,
+                            uint8_t& record_type);
+
+/**
+ * Sends an alert on a socket with transmit offload.
+ * @param fd supplies the socket.
+ * @param level supplies the alert level.
+ * @param description supplies the alert description.
+ * @return the result of sendmsg().
+ */
+Api::SysCallSizeResult sendAlert(os_fd_t fd, uint8_t level, uint8_t description);
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
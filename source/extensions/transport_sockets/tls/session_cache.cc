@@ -0,0 +1,117 @@
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+SessionCache::SessionCache(uint64_t max_keys)
+    : max_keys_per_shard_(std::max<uint64_t>(1, (max_keys + NumShards - 1) / NumShards)),
+      ssl_ctx_(SSL_CTX_new(TLS_method())) {
+  RELEASE_ASSERT(ssl_ctx_ != nullptr, "");
+}
+
+SessionCache::Shard& SessionCache::shard(const std::string& key) {
+  return shards_[HashUtil::xxHash64(key) % NumShards];
+}
+
+SessionCache::Entry& SessionCache::entry(Shard& shard, const std::string& key) {
+  auto it = shard.index_.find(key);
+  if (it != shard.index_.end()) {
+    shard.entries_.splice(shard.entries_.begin(), shard.entries_, it->second);
+    return shard.entries_.front();
+  }
+
+  if (shard.entries_.size() >= max_keys_per_shard_) {
+    shard.index_.erase(shard.entries_.back().key_);
+    shard.entries_.pop_back();
+  }
+  shard.entries_.emplace_front(key);
+  shard.index_.emplace(shard.entries_.front().key_, shard.entries_.begin());
+  return shard.entries_.front();
+}
+
+bssl::UniquePtr<SSL_SESSION> SessionCache::get(const std::string& key) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.index_.find(key);
+  if (it == shard.index_.end()) {
+    return nullptr;
+  }
+
+  Entry& entry = *it->second;
+  shard.entries_.splice(shard.entries_.begin(), shard.entries_, it->second);
+  ASSERT(!entry.sessions_.empty());
+  bssl::UniquePtr<SSL_SESSION> session;
+  if (SSL_SESSION_should_be_single_use(entry.sessions_.front().get())) {
+    session = std::move(entry.sessions_.front());
+    entry.sessions_.pop_front();
+    if (entry.sessions_.empty()) {
+      shard.index_.erase(entry.key_);
+      shard.entries_.pop_front();
+    }
+  } else {
+    session = bssl::UpRef(entry.sessions_.front());
+  }
+  return session;
+}
+
+void SessionCache::add(const std::string& key, bssl::UniquePtr<SSL_SESSION> session,
+                       size_t max_sessions) {
+  ASSERT(max_sessions > 0);
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  Entry& entry = this->entry(shard, key);
+  while (entry.sessions_.size() >= max_sessions) {
+    entry.sessions_.pop_back();
+  }
+  entry.sessions_.push_front(std::move(session));
+}
+
+void SessionCache::iterateSessions(const SessionCallback& callback) {
+  for (Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex_);
+    for (auto entry = shard.entries_.rbegin(); entry != shard.entries_.rend(); ++entry) {
+      for (const auto& session : entry->sessions_) {
+        uint8_t* data;
+        size_t size;
+        if (!SSL_SESSION_to_bytes(session.get(), &data, &size)) {
+          continue;
+        }
+        bssl::UniquePtr<uint8_t> free_data(data);
+        callback(entry->key_, absl::string_view(reinterpret_cast<const char*>(data), size));
+      }
+    }
+  }
+}
+
+void SessionCache::importSession(const std::string& key, absl::string_view session) {
+  bssl::UniquePtr<SSL_SESSION> parsed(SSL_SESSION_from_bytes(
+      reinterpret_cast<const uint8_t*>(session.data()), session.size(), ssl_ctx_.get()));
+  if (parsed == nullptr) {
+    return;
+  }
+
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  entry(shard, key).sessions_.push_back(std::move(parsed));
+}
+
+uint64_t SessionCache::size() {
+  uint64_t size = 0;
+  for (Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex_);
+    size += shard.entries_.size();
+  }
+  return size;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
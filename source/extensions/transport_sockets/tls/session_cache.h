@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Cache of the TLS sessions of upstream connections, shared by all the client contexts of the
+ * process, and so by all the workers. The sessions are keyed by the server name and the address of
+ * the upstream host, along with a fingerprint of the client context configuration, so that a
+ * session is only offered to the host it was established with, and only by a context that would
+ * have verified that host the same way.
+ *
+ * The cache is split into shards, each with its own lock and least recently used list, so that
+ * workers connecting to different hosts rarely contend. The least recently used key of a shard is
+ * evicted, along with its sessions, once the shard is full.
+ */
+class SessionCache {
+public:
+  using SessionCallback = std::function<void(const std::string& key, absl::string_view session)>;
+
+  static constexpr uint32_t NumShards = 16;
+
+  /**
+   * @param max_keys supplies the maximum number of keys cached, split evenly across the shards.
+   */
+  explicit SessionCache(uint64_t max_keys);
+
+  /**
+   * @return the most recently added session of a key, or nullptr if there is none. A session which
+   *         should only be used once (TLS 1.3) is removed from the cache.
+   */
+  bssl::UniquePtr<SSL_SESSION> get(const std::string& key);
+
+  /**
+   * Adds a session to a key, to be returned first. The oldest sessions of the key are dropped past
+   * max_sessions.
+   */
+  void add(const std::string& key, bssl::UniquePtr<SSL_SESSION> session, size_t max_sessions);
+
+  /**
+   * Calls the callback with each key and one of its sessions, serialized, so that the cache can be
+   * handed to another process. The keys are iterated from the least recently used one, and the
+   * sessions of each key from the most recent one, which is the order importSession() expects.
+   */
+  void iterateSessions(const SessionCallback& callback);
+
+  /**
+   * Adds a serialized session to a key, to be returned after the sessions the key already has.
+   * Sessions which can't be parsed are ignored.
+   */
+  void importSession(const std::string& key, absl::string_view session);
+
+  /**
+   * @return the number of keys cached.
+   */
+  uint64_t size();
+
+private:
+  struct Entry {
+    Entry(const std::string& key) : key_(key) {}
+
+    const std::string key_;
+    std::deque<bssl::UniquePtr<SSL_SESSION>> sessions_;
+  };
+
+  struct Shard {
+    absl::Mutex mutex_;
+    // Most recently used first. The index refers to the keys of the entries, which are stable.
+    std::list<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator>
+        index_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  Shard& shard(const std::string& key);
+  // Finds or creates the entry of a key, and moves it to the front of the shard.
+  Entry& entry(Shard& shard, const std::string& key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  const uint64_t max_keys_per_shard_;
+  std::array<Shard, NumShards> shards_;
+  // Only used to parse imported sessions, which don't depend on the context they are used with.
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+};
+
+using SessionCacheSharedPtr = std::shared_ptr<SessionCache>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
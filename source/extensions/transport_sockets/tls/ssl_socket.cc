@@ -1,5 +1,7 @@
 #include "extensions/transport_sockets/tls/ssl_socket.h"
 
+#include <cstring>
+
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
@@ -7,6 +9,7 @@
 #include "common/common/hex.h"
 #include "common/http/headers.h"
 
+#include "extensions/transport_sockets/tls/kernel_tls.h"
 #include "extensions/transport_sockets/tls/utility.h"
 
 #include "absl/strings/str_replace.h"
@@ -68,6 +71,11 @@ void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& c
     provider->registerPrivateKeyMethod(ssl_, *this, callbacks_->connection().dispatcher());
   }
 
+  // The address of the peer selects the cached session that client connections offer.
+  if (callbacks_->connection().remoteAddress() != nullptr) {
+    ctx_->resumeSession(ssl_, *callbacks_->connection().remoteAddress());
+  }
+
   BIO* bio = BIO_new_socket(callbacks_->ioHandle().fd(), 0);
   SSL_set_bio(ssl_, bio, bio);
 }
@@ -105,6 +113,9 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
       return {action, 0, false};
     }
   }
+  if (kernel_tls_receive_) {
+    return doKernelTlsRead(read_buffer);
+  }
 
   bool keep_reading = true;
   bool end_stream = false;
@@ -157,6 +168,75 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
   return {action, bytes_read, end_stream};
 }
 
+Network::IoResult SslSocket::doKernelTlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  while (true) {
+    Buffer::RawSlice slices[2];
+    const uint64_t num_slices = read_buffer.reserve(16384, slices, 2);
+    uint8_t record_type;
+    const Api::SysCallSizeResult result =
+        KernelTls::read(callbacks_->ioHandle().fd(), slices, num_slices, record_type);
+    ENVOY_CONN_LOG(trace, "kernel tls read returns: {}", callbacks_->connection(), result.rc_);
+    if (result.rc_ < 0) {
+      if (result.errno_ != EAGAIN) {
+        // Includes records which fail to decrypt, reported as EBADMSG.
+        failure_reason_ =
+            absl::StrCat("TLS error: kernel read failed: ", ::strerror(result.errno_));
+        ctx_->stats().connection_error_.inc();
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+    if (result.rc_ == 0) {
+      // Like BoringSSL, treat a close without close_notify as an error, as it allows truncation.
+      action = PostIoAction::Close;
+      break;
+    }
+
+    if (record_type != KernelTls::ContentTypeApplicationData) {
+      // The alert, if any, is in the reserved slices, which are not committed.
+      uint8_t alert[2];
+      uint64_t alert_length = 0;
+      for (uint64_t i = 0; i < num_slices && alert_length < 2; i++) {
+        const uint64_t length = std::min<uint64_t>(
+            {slices[i].len_, 2 - alert_length, static_cast<uint64_t>(result.rc_) - alert_length});
+        memcpy(alert + alert_length, slices[i].mem_, length);
+        alert_length += length;
+      }
+      if (record_type == KernelTls::ContentTypeAlert && result.rc_ == 2 &&
+          alert[1] == SSL_AD_CLOSE_NOTIFY) {
+        end_stream = true;
+      } else {
+        // Renegotiation is not supported, so any other record is fatal.
+        failure_reason_ = absl::StrCat("TLS error: unexpected record of type ",
+                                       static_cast<int>(record_type));
+        ctx_->stats().connection_error_.inc();
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+
+    uint64_t remaining = result.rc_;
+    uint64_t slices_to_commit = 0;
+    for (uint64_t i = 0; i < num_slices && remaining > 0; i++) {
+      slices[i].len_ = std::min<uint64_t>(slices[i].len_, remaining);
+      remaining -= slices[i].len_;
+      slices_to_commit++;
+    }
+    read_buffer.commit(slices, slices_to_commit);
+    bytes_read += result.rc_;
+    if (callbacks_->shouldDrainReadBuffer()) {
+      callbacks_->setReadBufferReady();
+      break;
+    }
+  }
+
+  ENVOY_CONN_LOG(trace, "kernel tls read {} bytes", callbacks_->connection(), bytes_read);
+  return {action, bytes_read, end_stream};
+}
+
 void SslSocket::onPrivateKeyMethodComplete() {
   ASSERT(isThreadSafe());
   ASSERT(state_ == SocketState::HandshakeInProgress);
@@ -176,6 +256,9 @@ PostIoAction SslSocket::doHandshake() {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     state_ = SocketState::HandshakeComplete;
     ctx_->logHandshake(ssl_);
+    if (ctx_->kernelTlsOffload()) {
+      enableKernelTls();
+    }
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -202,6 +285,19 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+void SslSocket::enableKernelTls() {
+  const KernelTls::Offload offload = KernelTls::enable(ssl_, callbacks_->ioHandle().fd());
+  kernel_tls_transmit_ = offload.transmit_;
+  kernel_tls_receive_ = offload.receive_;
+  ENVOY_CONN_LOG(debug, "kernel tls offload: transmit={} receive={}", callbacks_->connection(),
+                 kernel_tls_transmit_, kernel_tls_receive_);
+  if (kernel_tls_transmit_ || kernel_tls_receive_) {
+    ctx_->stats().kernel_tls_offload_.inc();
+  } else {
+    ctx_->stats().kernel_tls_offload_unavailable_.inc();
+  }
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -237,15 +333,20 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
       return {action, 0, false};
     }
   }
+  if (kernel_tls_transmit_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
 
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
     bytes_to_retry_ = 0;
   } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+    bytes_to_write = nextWriteSize(write_buffer);
   }
 
+  // Only used when small slices are coalesced into a record.
+  uint8_t scratch[MaxWriteSize];
   uint64_t total_bytes_written = 0;
   while (bytes_to_write > 0) {
     // TODO(mattklein123): As it relates to our fairness efforts, we might want to limit the number
@@ -253,15 +354,15 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
 
     // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
     // it again with the same parameters. This is done by tracking last write size, but not write
-    // data, since linearize() will return the same undrained data anyway.
+    // data, since writeData() will return the same undrained data anyway.
     ASSERT(bytes_to_write <= write_buffer.length());
-    int rc = SSL_write(ssl_, write_buffer.linearize(bytes_to_write), bytes_to_write);
+    int rc = SSL_write(ssl_, writeData(write_buffer, bytes_to_write, scratch), bytes_to_write);
     ENVOY_CONN_LOG(trace, "ssl write returns: {}", callbacks_->connection(), rc);
     if (rc > 0) {
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+      bytes_to_write = nextWriteSize(write_buffer);
     } else {
       int err = SSL_get_error(ssl_, rc);
       switch (err) {
@@ -286,6 +387,53 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+uint64_t SslSocket::nextWriteSize(const Buffer::Instance& buffer) {
+  const uint64_t length = std::min(buffer.length(), MaxWriteSize);
+  if (length == 0) {
+    return 0;
+  }
+  // A large enough front slice is encrypted in place, even if it makes for a short record.
+  const uint64_t front_length = buffer.getRawSlices(1)[0].len_;
+  return front_length >= MinDirectWriteSize ? std::min(front_length, length) : length;
+}
+
+const void* SslSocket::writeData(const Buffer::Instance& buffer, uint64_t size, uint8_t* scratch) {
+  ASSERT(size <= MaxWriteSize);
+  const Buffer::RawSlice front = buffer.getRawSlices(1)[0];
+  if (front.len_ >= size) {
+    return front.mem_;
+  }
+  // Unlike linearize(), this only copies the bytes of the record, and leaves the buffer as is.
+  buffer.copyOut(0, size, scratch);
+  return scratch;
+}
+
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel splits the plain text into records, so the buffer is written as is.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = write_buffer.write(callbacks_->ioHandle());
+    ENVOY_CONN_LOG(trace, "kernel tls write returns: {}", callbacks_->connection(), result.rc_);
+    if (!result.ok()) {
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      failure_reason_ =
+          absl::StrCat("TLS error: kernel write failed: ", result.err_->getErrorDetails());
+      ENVOY_CONN_LOG(debug, "{}", callbacks_->connection(), failure_reason_);
+      ctx_->stats().connection_error_.inc();
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    total_bytes_written += result.rc_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(state_ == SocketState::PreHandshake); }
 
 Ssl::ConnectionInfoConstSharedPtr SslSocket::ssl() const { return info_; }
@@ -294,9 +442,16 @@ void SslSocket::shutdownSsl() {
   ASSERT(state_ != SocketState::PreHandshake);
   if (state_ != SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
-    int rc = SSL_shutdown(ssl_);
-    ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
-    drainErrorQueue();
+    if (kernel_tls_transmit_) {
+      // The write state of ssl_ is stale once the kernel seals the records.
+      const Api::SysCallSizeResult result = KernelTls::sendAlert(
+          callbacks_->ioHandle().fd(), SSL3_AL_WARNING, SSL_AD_CLOSE_NOTIFY);
+      ENVOY_CONN_LOG(debug, "kernel tls shutdown: rc={}", callbacks_->connection(), result.rc_);
+    } else {
+      int rc = SSL_shutdown(ssl_);
+      ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
+      drainErrorQueue();
+    }
     state_ = SocketState::ShutdownSent;
   }
 }
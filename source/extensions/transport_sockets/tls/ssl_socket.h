@@ -120,14 +120,39 @@ public:
 
   SSL* rawSslForTest() const { return ssl_; }
 
+  // Largest amount of data passed to a single SSL_write(), which is the maximum record size.
+  static constexpr uint64_t MaxWriteSize = 16384;
+  // Smallest front slice which is written as a record of its own rather than coalesced with the
+  // following slices, as each record has a fixed cost.
+  static constexpr uint64_t MinDirectWriteSize = 8192;
+
+  /**
+   * @param buffer supplies the data to write.
+   * @return the number of bytes to pass to the next SSL_write().
+   */
+  static uint64_t nextWriteSize(const Buffer::Instance& buffer);
+
+  /**
+   * Gets the data for an SSL_write() without linearizing the buffer.
+   * @param buffer supplies the data to write.
+   * @param size supplies the number of bytes to write, at most MaxWriteSize.
+   * @param scratch supplies MaxWriteSize bytes to coalesce slices into.
+   * @return the first size bytes of the buffer, pointing either into its front slice when it holds
+   *         them all, or into scratch.
+   */
+  static const void* writeData(const Buffer::Instance& buffer, uint64_t size, uint8_t* scratch);
+
 private:
   struct ReadResult {
     bool commit_slice_{};
     absl::optional<int> error_;
   };
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
+  Network::IoResult doKernelTlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
 
   Network::PostIoAction doHandshake();
+  void enableKernelTls();
   void drainErrorQueue();
   void shutdownSsl();
   bool isThreadSafe() const {
@@ -140,6 +165,10 @@ private:
   uint64_t bytes_to_retry_{};
   std::string failure_reason_;
   SocketState state_;
+  // Whether record protection in each direction has been offloaded to the kernel, in which case
+  // that direction bypasses ssl_.
+  bool kernel_tls_transmit_{};
+  bool kernel_tls_receive_{};
 
   SSL* ssl_;
   Ssl::ConnectionInfoConstSharedPtr info_;
@@ -132,6 +132,9 @@ protected:
       const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
       void setDelayedCloseTimeout(std::chrono::milliseconds) override {}
       absl::string_view transportFailureReason() const override { return EMPTY_STRING; }
+      Network::IoHandle* rawIoHandle() override { return nullptr; }
+      void startRawIo(Network::RawIoCallbacks&) override { NOT_REACHED_GCOVR_EXCL_LINE; }
+      void stopRawIo() override { NOT_REACHED_GCOVR_EXCL_LINE; }
 
       SyntheticReadCallbacks& parent_;
       StreamInfo::StreamInfoImpl stream_info_;
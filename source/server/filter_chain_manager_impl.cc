@@ -272,16 +272,9 @@ void FilterChainManagerImpl::addFilterChainForServerNames(
                                           source_ports, filter_chain);
   } else {
     for (const auto& server_name_ptr : server_names) {
-      if (isWildcardServerName(*server_name_ptr)) {
-        // Add mapping for the wildcard domain, i.e. ".example.com" for "*.example.com".
-        addFilterChainForApplicationProtocols(
-            server_names_map[server_name_ptr->substr(1)][transport_protocol], application_protocols,
-            source_type, source_ips, source_ports, filter_chain);
-      } else {
-        addFilterChainForApplicationProtocols(
-            server_names_map[*server_name_ptr][transport_protocol], application_protocols,
-            source_type, source_ips, source_ports, filter_chain);
-      }
+      addFilterChainForApplicationProtocols(server_names_map[*server_name_ptr][transport_protocol],
+                                            application_protocols, source_type, source_ips,
+                                            source_ports, filter_chain);
     }
   }
 }
@@ -416,29 +409,18 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDestinatio
 
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName(
     const ServerNamesMap& server_names_map, const Network::ConnectionSocket& socket) const {
-  const std::string server_name(socket.requestedServerName());
-
-  // Match on exact server name, i.e. "www.example.com" for "www.example.com".
-  const auto server_name_exact_match = server_names_map.find(server_name);
-  if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
-  }
-
-  // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
-  size_t pos = server_name.find('.', 1);
-  while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
-    const auto server_name_wildcard_match = server_names_map.find(wildcard);
-    if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
-    }
-    pos = server_name.find('.', pos + 1);
+  // Match on exact server name, i.e. "www.example.com" for "www.example.com", or else on the
+  // longest wildcard domain, i.e. "*.example.com" and then "*.com" for "www.example.com".
+  const TransportProtocolsMap* server_name_match =
+      server_names_map.find(socket.requestedServerName());
+  if (server_name_match != nullptr) {
+    return findFilterChainForTransportProtocol(*server_name_match, socket);
   }
 
   // Match on a filter chain without server name requirements.
-  const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
-  if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
+  const TransportProtocolsMap* server_name_catchall_match = server_names_map.find(EMPTY_STRING);
+  if (server_name_catchall_match != nullptr) {
+    return findFilterChainForTransportProtocol(*server_name_catchall_match, socket);
   }
 
   return nullptr;
@@ -567,8 +549,8 @@ void FilterChainManagerImpl::convertIPsToTries() {
       // This hugely nested for loop greatly pains me, but I'm not sure how to make it better.
       // We need to get access to all of the source IP strings so that we can convert them into
       // a trie like we did for the destination IPs above.
-      for (auto& server_names_entry : *entry.second) {
-        for (auto& transport_protocols_entry : server_names_entry.second) {
+      entry.second->iterate([](TransportProtocolsMap& transport_protocols_map) {
+        for (auto& transport_protocols_entry : transport_protocols_map) {
           for (auto& application_protocols_entry : transport_protocols_entry.second) {
             for (auto& source_array_entry : application_protocols_entry.second) {
               auto& source_ips_map = source_array_entry.first;
@@ -585,7 +567,7 @@ void FilterChainManagerImpl::convertIPsToTries() {
             }
           }
         }
-      }
+      });
     }
 
     destination_ips_pair.second = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
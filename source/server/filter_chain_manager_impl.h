@@ -17,6 +17,7 @@
 #include "common/network/lc_trie.h"
 
 #include "server/filter_chain_factory_context_callback.h"
+#include "server/server_name_index.h"
 
 #include "absl/container/flat_hash_map.h"
 
@@ -207,10 +208,9 @@ private:
   using SourceTypesArray = std::array<std::pair<SourceIPsMap, SourceIPsTriePtr>, 3>;
   using ApplicationProtocolsMap = absl::flat_hash_map<std::string, SourceTypesArray>;
   using TransportProtocolsMap = absl::flat_hash_map<std::string, ApplicationProtocolsMap>;
-  // Both exact server names and wildcard domains are part of the same map, in which wildcard
-  // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
-  // between exact and wildcard entries.
-  using ServerNamesMap = absl::flat_hash_map<std::string, TransportProtocolsMap>;
+  // Exact server names are hashed, and wildcard domains (i.e. "*.example.com") are held in a trie
+  // of their labels, so that the lookup cost doesn't grow with the number of server names.
+  using ServerNamesMap = ServerNameIndex<TransportProtocolsMap>;
   using ServerNamesMapSharedPtr = std::shared_ptr<ServerNamesMap>;
   using DestinationIPsMap = absl::flat_hash_map<std::string, ServerNamesMapSharedPtr>;
   using DestinationIPsTrie = Network::LcTrie::LcTrie<ServerNamesMapSharedPtr>;
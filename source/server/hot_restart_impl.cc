@@ -91,9 +91,10 @@ void initializeMutex(pthread_mutex_t& mutex) {
   pthread_mutex_init(&mutex, &attribute);
 }
 
-HotRestartImpl::HotRestartImpl(const Options& options)
+HotRestartImpl::HotRestartImpl(const Options& options,
+                               const Stats::MappedStatsRegion* stats_region)
     : as_child_(HotRestartingChild(options.baseId(), options.restartEpoch())),
-      as_parent_(HotRestartingParent(options.baseId(), options.restartEpoch())),
+      as_parent_(HotRestartingParent(options.baseId(), options.restartEpoch(), stats_region)),
       shmem_(attachSharedMemory(options)), log_lock_(shmem_->log_lock_),
       access_log_lock_(shmem_->access_log_lock_) {
   // If our parent ever goes away just terminate us so that we don't have to rely on ops/launching
@@ -135,6 +136,17 @@ HotRestartImpl::mergeParentStatsIfAny(Stats::StoreRoot& stats_store) {
   return response;
 }
 
+void HotRestartImpl::importParentTlsSessions(Ssl::ContextManager& context_manager) {
+  std::unique_ptr<envoy::HotRestartMessage> wrapper_msg = as_child_.getParentTlsSessions();
+  // getParentTlsSessions() returns nullptr if we have no parent, or if it didn't hand over its
+  // sessions.
+  if (wrapper_msg) {
+    for (const auto& session : wrapper_msg->reply().tls_sessions().sessions()) {
+      context_manager.importSession(session.key(), session.session());
+    }
+  }
+}
+
 void HotRestartImpl::shutdown() { as_parent_.shutdown(); }
 
 std::string HotRestartImpl::version() { return hotRestartVersion(); }
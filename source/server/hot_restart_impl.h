@@ -13,6 +13,7 @@
 
 #include "common/common/assert.h"
 #include "common/stats/allocator_impl.h"
+#include "common/stats/mapped_stats_region.h"
 
 #include "server/hot_restarting_child.h"
 #include "server/hot_restarting_parent.h"
@@ -95,7 +96,12 @@ private:
  */
 class HotRestartImpl : public HotRestart {
 public:
-  HotRestartImpl(const Options& options);
+  /**
+   * @param options supplies the server options.
+   * @param stats_region supplies the memory-mapped stats region shared with the parent and child,
+   *        if any. Stats held in it are not transferred to the child over the hot restart socket.
+   */
+  HotRestartImpl(const Options& options, const Stats::MappedStatsRegion* stats_region = nullptr);
 
   // Server::HotRestart
   void drainParentListeners() override;
@@ -104,6 +110,7 @@ public:
   void sendParentAdminShutdownRequest(time_t& original_start_time) override;
   void sendParentTerminateRequest() override;
   ServerStatsFromParent mergeParentStatsIfAny(Stats::StoreRoot& stats_store) override;
+  void importParentTlsSessions(Ssl::ContextManager& context_manager) override;
   void shutdown() override;
   std::string version() override;
   Thread::BasicLockable& logLock() override { return log_lock_; }
@@ -47,6 +47,25 @@ std::unique_ptr<HotRestartMessage> HotRestartingChild::getParentStats() {
   return wrapped_reply;
 }
 
+std::unique_ptr<HotRestartMessage> HotRestartingChild::getParentTlsSessions() {
+  if (restart_epoch_ == 0 || parent_terminated_) {
+    return nullptr;
+  }
+
+  HotRestartMessage wrapped_request;
+  wrapped_request.mutable_request()->mutable_tls_sessions();
+  sendHotRestartMessage(parent_address_, wrapped_request);
+
+  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveHotRestartMessage(Blocking::Yes);
+  // A parent predating the handover of TLS sessions replies that it didn't recognize the request,
+  // in which case upstream connections start over with full handshakes.
+  if (!replyIsExpectedType(wrapped_reply.get(), HotRestartMessage::Reply::kTlsSessions)) {
+    ENVOY_LOG(info, "hot restart parent did not hand over its upstream TLS sessions");
+    return nullptr;
+  }
+  return wrapped_reply;
+}
+
 void HotRestartingChild::drainParentListeners() {
   if (restart_epoch_ == 0 || parent_terminated_) {
     return;
@@ -14,8 +14,9 @@ namespace Server {
 
 using HotRestartMessage = envoy::HotRestartMessage;
 
-HotRestartingParent::HotRestartingParent(int base_id, int restart_epoch)
-    : HotRestartingBase(base_id), restart_epoch_(restart_epoch) {
+HotRestartingParent::HotRestartingParent(int base_id, int restart_epoch,
+                                         const Stats::MappedStatsRegion* stats_region)
+    : HotRestartingBase(base_id), restart_epoch_(restart_epoch), stats_region_(stats_region) {
   child_address_ = createDomainSocketAddress(restart_epoch_ + 1, "child");
   bindDomainSocket(restart_epoch_, "parent");
 }
@@ -28,7 +29,7 @@ void HotRestartingParent::initialize(Event::Dispatcher& dispatcher, Server::Inst
         onSocketEvent();
       },
       Event::FileTriggerType::Edge, Event::FileReadyType::Read);
-  internal_ = std::make_unique<Internal>(&server);
+  internal_ = std::make_unique<Internal>(&server, stats_region_);
 }
 
 void HotRestartingParent::onSocketEvent() {
@@ -60,6 +61,13 @@ void HotRestartingParent::onSocketEvent() {
       break;
     }
 
+    case HotRestartMessage::Request::kTlsSessions: {
+      HotRestartMessage wrapped_reply;
+      internal_->exportTlsSessionsToChild(wrapped_reply.mutable_reply()->mutable_tls_sessions());
+      sendHotRestartMessage(child_address_, wrapped_reply);
+      break;
+    }
+
     case HotRestartMessage::Request::kDrainListeners: {
       internal_->drainListeners();
       break;
@@ -84,7 +92,9 @@ void HotRestartingParent::onSocketEvent() {
 
 void HotRestartingParent::shutdown() { socket_event_.reset(); }
 
-HotRestartingParent::Internal::Internal(Server::Instance* server) : server_(server) {
+HotRestartingParent::Internal::Internal(Server::Instance* server,
+                                        const Stats::MappedStatsRegion* stats_region)
+    : server_(server), stats_region_(stats_region) {
   // Track the hot-restart generation. Using gauge's accumulate semantics,
   // the increments will be combined across hot-restart. This may be useful
   // at some point, though the main motivation for this stat is to enable
@@ -131,7 +141,7 @@ HotRestartingParent::Internal::getListenSocketsForChild(const HotRestartMessage:
 // names. The problem can be solved by splitting the export up over many chunks.
 void HotRestartingParent::Internal::exportStatsToChild(HotRestartMessage::Reply::Stats* stats) {
   for (const auto& gauge : server_->stats().gauges()) {
-    if (gauge->used()) {
+    if (gauge->used() && !sharedWithChild(*gauge)) {
       const std::string name = gauge->name();
       (*stats->mutable_gauges())[name] = gauge->value();
       recordDynamics(stats, name, gauge->statName());
@@ -139,7 +149,7 @@ void HotRestartingParent::Internal::exportStatsToChild(HotRestartMessage::Reply:
   }
 
   for (const auto& counter : server_->stats().counters()) {
-    if (counter->used()) {
+    if (counter->used() && !sharedWithChild(*counter)) {
       // The hot restart parent is expected to have stopped its normal stat exporting (and so
       // latching) by the time it begins exporting to the hot restart child.
       uint64_t latched_value = counter->latch();
@@ -154,6 +164,12 @@ void HotRestartingParent::Internal::exportStatsToChild(HotRestartMessage::Reply:
   stats->set_num_connections(server_->listenerManager().numConnections());
 }
 
+bool HotRestartingParent::Internal::sharedWithChild(const Stats::Metric& metric) const {
+  // The child maps the same stats region, so it already sees the values of the stats held there,
+  // and merging them again would double count.
+  return stats_region_ != nullptr && stats_region_->contains(metric.name());
+}
+
 void HotRestartingParent::Internal::recordDynamics(HotRestartMessage::Reply::Stats* stats,
                                                    const std::string& name,
                                                    Stats::StatName stat_name) {
@@ -180,5 +196,16 @@ void HotRestartingParent::Internal::recordDynamics(HotRestartMessage::Reply::Sta
 
 void HotRestartingParent::Internal::drainListeners() { server_->drainListeners(); }
 
+void HotRestartingParent::Internal::exportTlsSessionsToChild(
+    HotRestartMessage::Reply::TlsSessions* tls_sessions) {
+  server_->sslContextManager().iterateSessions(
+      [tls_sessions](const std::string& key, absl::string_view session) {
+        HotRestartMessage::Reply::TlsSessions::Session* session_proto =
+            tls_sessions->add_sessions();
+        session_proto->set_key(key);
+        session_proto->set_session(session.data(), session.size());
+      });
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/common/hash.h"
+#include "common/stats/mapped_stats_region.h"
 
 #include "server/hot_restarting_base.h"
 
@@ -14,7 +15,8 @@ namespace Server {
  */
 class HotRestartingParent : HotRestartingBase, Logger::Loggable<Logger::Id::main> {
 public:
-  HotRestartingParent(int base_id, int restart_epoch);
+  HotRestartingParent(int base_id, int restart_epoch,
+                      const Stats::MappedStatsRegion* stats_region = nullptr);
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server);
   void shutdown();
 
@@ -22,7 +24,10 @@ public:
   // request from the child for that action.
   class Internal {
   public:
-    explicit Internal(Server::Instance* server);
+    // Stats held in 'stats_region', if any, are shared with the child directly and so are not
+    // exported to it.
+    explicit Internal(Server::Instance* server,
+                      const Stats::MappedStatsRegion* stats_region = nullptr);
     // Return value is the response to return to the child.
     envoy::HotRestartMessage shutdownAdmin();
     // Return value is the response to return to the child.
@@ -33,15 +38,22 @@ public:
     void recordDynamics(envoy::HotRestartMessage::Reply::Stats* stats, const std::string& name,
                         Stats::StatName stat_name);
     void drainListeners();
+    // 'tls_sessions' is a field in the reply protobuf to be sent to the child, which we should
+    // populate.
+    void exportTlsSessionsToChild(envoy::HotRestartMessage::Reply::TlsSessions* tls_sessions);
 
   private:
+    bool sharedWithChild(const Stats::Metric& metric) const;
+
     Server::Instance* const server_{};
+    const Stats::MappedStatsRegion* const stats_region_{};
   };
 
 private:
   void onSocketEvent();
 
   const int restart_epoch_;
+  const Stats::MappedStatsRegion* const stats_region_;
   sockaddr_un child_address_;
   Event::FileEventPtr socket_event_;
   std::unique_ptr<Internal> internal_;
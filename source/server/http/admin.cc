@@ -45,6 +45,7 @@
 #include "common/network/listen_socket_impl.h"
 #include "common/network/utility.h"
 #include "common/profiler/profiler.h"
+#include "common/profiler/sampling_profiler.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
 #include "common/router/config_impl.h"
@@ -55,6 +56,7 @@
 
 #include "extensions/access_loggers/file/file_access_log_impl.h"
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
@@ -636,6 +638,11 @@ Http::Code AdminImpl::handlerCpuProfiler(absl::string_view url, Http::ResponseHe
 
   bool enable = query_params.begin()->second == "y";
   if (enable && !Profiler::Cpu::profilerEnabled()) {
+    // Both profilers are driven by SIGPROF.
+    if (Profiler::SamplingProfiler::isRunning()) {
+      response.add("the sampling profiler is running");
+      return Http::Code::BadRequest;
+    }
     if (!Profiler::Cpu::startProfiler(profile_path_)) {
       response.add("failure to start the profiler");
       return Http::Code::InternalServerError;
@@ -649,6 +656,66 @@ Http::Code AdminImpl::handlerCpuProfiler(absl::string_view url, Http::ResponseHe
   return Http::Code::OK;
 }
 
+Http::Code AdminImpl::handlerSamplingProfiler(absl::string_view url, Http::ResponseHeaderMap&,
+                                              Buffer::Instance& response, AdminStream&) {
+  if (!Profiler::SamplingProfiler::supported()) {
+    response.add("The current platform does not support the sampling profiler");
+    return Http::Code::NotImplemented;
+  }
+
+  Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  const auto enable_it = query_params.find("enable");
+  const auto hz_it = query_params.find("hz");
+  uint32_t frequency_hz = Profiler::SamplingProfiler::DefaultFrequencyHz;
+  if (enable_it == query_params.end() || (enable_it->second != "y" && enable_it->second != "n") ||
+      query_params.size() != (hz_it == query_params.end() ? 1 : 2) ||
+      (hz_it != query_params.end() &&
+       (!absl::SimpleAtoi(hz_it->second, &frequency_hz) || frequency_hz == 0 ||
+        frequency_hz > Profiler::SamplingProfiler::MaxFrequencyHz))) {
+    response.add(fmt::format("?enable=<y|n>[&hz=<1-{}>]\n",
+                             Profiler::SamplingProfiler::MaxFrequencyHz));
+    return Http::Code::BadRequest;
+  }
+
+  if (enable_it->second == "y") {
+    if (Profiler::Cpu::profilerEnabled()) {
+      response.add("the CPU profiler is running");
+      return Http::Code::BadRequest;
+    }
+    // Restarting discards the samples recorded so far, so that the new frequency applies to all.
+    Profiler::SamplingProfiler::stop();
+    if (!Profiler::SamplingProfiler::start(frequency_hz)) {
+      response.add("failure to start the sampling profiler");
+      return Http::Code::InternalServerError;
+    }
+  } else {
+    Profiler::SamplingProfiler::stop();
+  }
+
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerSamplingProfilerPprof(absl::string_view url,
+                                                   Http::ResponseHeaderMap& response_headers,
+                                                   Buffer::Instance& response, AdminStream&) {
+  Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  absl::optional<std::chrono::nanoseconds> max_age;
+  const auto seconds_it = query_params.find("seconds");
+  if (seconds_it != query_params.end()) {
+    uint64_t seconds;
+    if (!absl::SimpleAtoi(seconds_it->second, &seconds) || seconds == 0) {
+      response.add("?seconds=<number of seconds of samples to include>\n");
+      return Http::Code::BadRequest;
+    }
+    max_age = std::chrono::seconds(seconds);
+  }
+
+  response_headers.setContentType("application/octet-stream");
+  response.add(Profiler::SamplingProfiler::pprofProfile(max_age));
+  return Http::Code::OK;
+}
+
 Http::Code AdminImpl::handlerHeapProfiler(absl::string_view url, Http::ResponseHeaderMap&,
                                           Buffer::Instance& response, AdminStream&) {
   if (!Profiler::Heap::profilerEnabled()) {
@@ -1007,6 +1074,10 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server)
            MAKE_ADMIN_HANDLER(handlerCpuProfiler), false, true},
           {"/heapprofiler", "enable/disable the heap profiler",
            MAKE_ADMIN_HANDLER(handlerHeapProfiler), false, true},
+          {"/sampling_profiler", "enable/disable the low overhead sampling CPU profiler",
+           MAKE_ADMIN_HANDLER(handlerSamplingProfiler), false, true},
+          {"/sampling_profiler/pprof", "print recent CPU samples as a pprof profile",
+           MAKE_ADMIN_HANDLER(handlerSamplingProfilerPprof), false, false},
           {"/healthcheck/fail", "cause the server to fail health checks",
            MAKE_ADMIN_HANDLER(handlerHealthcheckFail), false, true},
           {"/healthcheck/ok", "cause the server to pass health checks",
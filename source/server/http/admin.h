@@ -315,6 +315,12 @@ private:
   Http::Code handlerHeapProfiler(absl::string_view path_and_query,
                                  Http::ResponseHeaderMap& response_headers,
                                  Buffer::Instance& response, AdminStream&);
+  Http::Code handlerSamplingProfiler(absl::string_view path_and_query,
+                                     Http::ResponseHeaderMap& response_headers,
+                                     Buffer::Instance& response, AdminStream&);
+  Http::Code handlerSamplingProfilerPprof(absl::string_view path_and_query,
+                                          Http::ResponseHeaderMap& response_headers,
+                                          Buffer::Instance& response, AdminStream&);
   Http::Code handlerHealthcheckFail(absl::string_view path_and_query,
                                     Http::ResponseHeaderMap& response_headers,
                                     Buffer::Instance& response, AdminStream&);
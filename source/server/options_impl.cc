@@ -145,6 +145,14 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
                                               "Use fake symbol table implementation", false, true,
                                               "bool", cmd);
 
+  TCLAP::ValueArg<std::string> stats_region_path(
+      "", "stats-region-path",
+      "File backing a memory-mapped stats region shared across hot restarts", false, "", "string",
+      cmd);
+  TCLAP::ValueArg<uint32_t> stats_region_slots(
+      "", "stats-region-slots", "Number of counters and gauges the stats region can hold", false,
+      65536, "uint32_t", cmd);
+
   TCLAP::ValueArg<std::string> disable_extensions("", "disable-extensions",
                                                   "Comma-separated list of extensions to disable",
                                                   false, "", "string", cmd);
@@ -171,6 +179,11 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
   mutex_tracing_enabled_ = enable_mutex_tracing.getValue();
   fake_symbol_table_enabled_ = use_fake_symbol_table.getValue();
   cpuset_threads_ = cpuset_threads.getValue();
+  stats_region_path_ = stats_region_path.getValue();
+  stats_region_slots_ = stats_region_slots.getValue();
+  if (!stats_region_path_.empty() && stats_region_slots_ == 0) {
+    throw MalformedArgvException("error: --stats-region-slots must be greater than zero");
+  }
 
   if (log_level.isSet()) {
     log_level_ = parseAndValidateLogLevel(log_level.getValue());
@@ -353,6 +366,8 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   command_line_options->set_enable_mutex_tracing(mutexTracingEnabled());
   command_line_options->set_cpuset_threads(cpusetThreadsEnabled());
   command_line_options->set_restart_epoch(restartEpoch());
+  command_line_options->set_stats_region_path(statsRegionPath());
+  command_line_options->set_stats_region_slots(statsRegionSlots());
   for (const auto& e : disabledExtensions()) {
     command_line_options->add_disabled_extensions(e);
   }
@@ -368,7 +383,7 @@ OptionsImpl::OptionsImpl(const std::string& service_cluster, const std::string&
       service_zone_(service_zone), file_flush_interval_msec_(10000), drain_time_(600),
       parent_shutdown_time_(900), mode_(Server::Mode::Serve), hot_restart_disabled_(false),
       signal_handling_enabled_(true), mutex_tracing_enabled_(false), cpuset_threads_(false),
-      fake_symbol_table_enabled_(false) {}
+      fake_symbol_table_enabled_(false), stats_region_slots_(65536) {}
 
 void OptionsImpl::disableExtensions(const std::vector<std::string>& names) {
   for (const auto& name : names) {
@@ -95,6 +95,12 @@ public:
   void setFakeSymbolTableEnabled(bool fake_symbol_table_enabled) {
     fake_symbol_table_enabled_ = fake_symbol_table_enabled;
   }
+  void setStatsRegionPath(const std::string& stats_region_path) {
+    stats_region_path_ = stats_region_path;
+  }
+  void setStatsRegionSlots(uint32_t stats_region_slots) {
+    stats_region_slots_ = stats_region_slots;
+  }
 
   // Server::Options
   uint64_t baseId() const override { return base_id_; }
@@ -133,6 +139,8 @@ public:
   bool signalHandlingEnabled() const override { return signal_handling_enabled_; }
   bool mutexTracingEnabled() const override { return mutex_tracing_enabled_; }
   bool fakeSymbolTableEnabled() const override { return fake_symbol_table_enabled_; }
+  const std::string& statsRegionPath() const override { return stats_region_path_; }
+  uint32_t statsRegionSlots() const override { return stats_region_slots_; }
   Server::CommandLineOptionsPtr toCommandLineOptions() const override;
   void parseComponentLogLevels(const std::string& component_log_levels);
   bool cpusetThreadsEnabled() const override { return cpuset_threads_; }
@@ -182,6 +190,8 @@ private:
   bool mutex_tracing_enabled_;
   bool cpuset_threads_;
   bool fake_symbol_table_enabled_;
+  std::string stats_region_path_;
+  uint32_t stats_region_slots_;
   std::vector<std::string> disabled_extensions_;
   uint32_t count_;
 };
@@ -23,6 +23,7 @@
 
 #include "common/api/api_impl.h"
 #include "common/api/os_sys_calls_impl.h"
+#include "common/buffer/slice_allocator.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/mutex_tracer_impl.h"
 #include "common/common/utility.h"
@@ -207,6 +208,13 @@ void InstanceImpl::updateServerStats() {
                                        parent_stats.parent_memory_allocated_);
   server_stats_->memory_heap_size_.set(Memory::Stats::totalCurrentlyReserved());
   server_stats_->memory_physical_size_.set(Memory::Stats::totalPhysicalBytes());
+  const Buffer::SliceAllocator::Stats slice_allocator_stats = Buffer::SliceAllocator::stats();
+  server_stats_->buffer_slices_allocated_.add(slice_allocator_stats.allocated_blocks_ -
+                                              slice_allocator_stats_.allocated_blocks_);
+  server_stats_->buffer_slices_reused_.add(slice_allocator_stats.reused_blocks_ -
+                                           slice_allocator_stats_.reused_blocks_);
+  server_stats_->buffer_slice_cache_size_.set(slice_allocator_stats.cached_bytes_);
+  slice_allocator_stats_ = slice_allocator_stats;
   server_stats_->parent_connections_.set(parent_stats.parent_connections_);
   server_stats_->total_connections_.set(listener_manager_->numConnections() +
                                         parent_stats.parent_connections_);
@@ -424,6 +432,8 @@ void InstanceImpl::initialize(const Options& options,
 
   // Once we have runtime we can initialize the SSL context manager.
   ssl_context_manager_ = createContextManager("ssl_context_manager", time_source_);
+  // Keep resuming the TLS sessions of our parent with upstream hosts, before the clusters connect.
+  restarter_.importParentTlsSessions(*ssl_context_manager_);
 
   const bool use_tcp_for_dns_lookups = bootstrap_.use_tcp_for_dns_lookups();
   dns_resolver_ = dispatcher_->createDnsResolver({}, use_tcp_for_dns_lookups);
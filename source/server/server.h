@@ -22,6 +22,7 @@
 #include "envoy/tracing/http_tracer.h"
 
 #include "common/access_log/access_log_manager_impl.h"
+#include "common/buffer/slice_allocator.h"
 #include "common/common/assert.h"
 #include "common/common/cleanup.h"
 #include "common/common/logger_delegates.h"
@@ -52,9 +53,12 @@ namespace Server {
  * All server wide stats. @see stats_macros.h
  */
 #define ALL_SERVER_STATS(COUNTER, GAUGE, HISTOGRAM)                                                \
+  COUNTER(buffer_slices_allocated)                                                                 \
+  COUNTER(buffer_slices_reused)                                                                    \
   COUNTER(debug_assertion_failures)                                                                \
   COUNTER(dynamic_unknown_fields)                                                                  \
   COUNTER(static_unknown_fields)                                                                   \
+  GAUGE(buffer_slice_cache_size, NeverImport)                                                      \
   GAUGE(concurrency, NeverImport)                                                                  \
   GAUGE(days_until_first_cert_expiring, Accumulate)                                                \
   GAUGE(hot_restart_epoch, NeverImport)                                                            \
@@ -310,6 +314,8 @@ private:
   time_t original_start_time_;
   Stats::StoreRoot& stats_store_;
   std::unique_ptr<ServerStats> server_stats_;
+  // Slice allocator counters as of the last update of the server stats.
+  Buffer::SliceAllocator::Stats slice_allocator_stats_;
   Assert::ActionRegistrationPtr assert_action_registration_;
   ThreadLocal::Instance& thread_local_;
   Api::ApiPtr api_;
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Index of values by TLS server name (SNI). Exact server names are kept in a hash map, and wildcard
+ * domains (i.e. "*.example.com") in a trie of their labels, starting from the last one, so that a
+ * lookup costs a hash lookup and a walk of the labels of the requested server name, no matter how
+ * many names are indexed, and never copies the requested server name.
+ */
+template <class Value> class ServerNameIndex {
+public:
+  /**
+   * @param server_name supplies an exact server name, a wildcard domain (i.e. "*.example.com"), or
+   *        an empty string for the entry without server name requirements.
+   * @return the value of the server name, default constructed if it wasn't indexed yet. The
+   *         reference is stable as long as the index exists.
+   */
+  Value& operator[](absl::string_view server_name) {
+    if (!absl::StartsWith(server_name, "*.")) {
+      auto& value = exact_[server_name];
+      if (value == nullptr) {
+        value = std::make_unique<Value>();
+      }
+      return *value;
+    }
+
+    // Walk down the labels of the domain from the last one, i.e. "com" then "example" for
+    // "*.example.com".
+    Node* node = &root_;
+    absl::string_view domain = server_name.substr(2);
+    while (true) {
+      const size_t pos = domain.rfind('.');
+      const absl::string_view label =
+          pos == absl::string_view::npos ? domain : domain.substr(pos + 1);
+      auto& child = node->children_[label];
+      if (child == nullptr) {
+        child = std::make_unique<Node>();
+      }
+      node = child.get();
+      if (pos == absl::string_view::npos) {
+        break;
+      }
+      domain = domain.substr(0, pos);
+    }
+    if (node->wildcard_ == nullptr) {
+      node->wildcard_ = std::make_unique<Value>();
+    }
+    return *node->wildcard_;
+  }
+
+  /**
+   * @return the value of the exact server name if indexed, or else the value of the longest
+   *         wildcard domain matching it (i.e. "*.example.com" before "*.com" for
+   *         "www.example.com"), or nullptr if there is neither.
+   */
+  const Value* find(absl::string_view server_name) const {
+    const auto exact = exact_.find(server_name);
+    if (exact != exact_.end()) {
+      return exact->second.get();
+    }
+
+    // A wildcard domain only matches when at least one label is left in front of it, i.e.
+    // "*.example.com" matches "www.example.com" but not "example.com".
+    const Value* longest = nullptr;
+    const Node* node = &root_;
+    absl::string_view remaining = server_name;
+    size_t pos;
+    while ((pos = remaining.rfind('.')) != absl::string_view::npos && pos > 0) {
+      const auto child = node->children_.find(remaining.substr(pos + 1));
+      if (child == node->children_.end()) {
+        break;
+      }
+      node = child->second.get();
+      if (node->wildcard_ != nullptr) {
+        longest = node->wildcard_.get();
+      }
+      remaining = remaining.substr(0, pos);
+    }
+    return longest;
+  }
+
+  /**
+   * Calls the callback with the value of each indexed server name and wildcard domain.
+   */
+  void iterate(const std::function<void(Value&)>& callback) {
+    for (auto& exact : exact_) {
+      callback(*exact.second);
+    }
+    iterate(root_, callback);
+  }
+
+private:
+  struct Node {
+    absl::flat_hash_map<std::string, std::unique_ptr<Node>> children_;
+    std::unique_ptr<Value> wildcard_;
+  };
+
+  static void iterate(Node& node, const std::function<void(Value&)>& callback) {
+    if (node.wildcard_ != nullptr) {
+      callback(*node.wildcard_);
+    }
+    for (auto& child : node.children_) {
+      iterate(*child.second, callback);
+    }
+  }
+
+  absl::flat_hash_map<std::string, std::unique_ptr<Value>> exact_;
+  Node root_;
+};
+
+} // namespace Server
+} // namespace Envoy
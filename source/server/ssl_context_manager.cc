@@ -31,6 +31,11 @@ class SslContextManagerNoTlsStub final : public Envoy::Ssl::ContextManager {
 
   Ssl::PrivateKeyMethodManager& privateKeyMethodManager() override { throwException(); }
 
+  void iterateSessions(
+      std::function<void(const std::string&, absl::string_view)> /* callback */) override {}
+
+  void importSession(const std::string& /* key */, absl::string_view /* session */) override {}
+
 private:
   [[noreturn]] void throwException() {
     throw EnvoyException("SSL is not supported in this configuration");
@@ -1,4 +1,7 @@
+#include <vector>
+
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_allocator.h"
 #include "common/common/assert.h"
 
 #include "absl/strings/string_view.h"
@@ -244,6 +247,48 @@ static void bufferReserveCommitPartial(benchmark::State& state) {
 }
 BENCHMARK(bufferReserveCommitPartial)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
 
+// Test the read cycle of a connection: the space of a read is reserved, filled, and then drained
+// all at once, so that every iteration allocates and frees the slices of the read.
+static void bufferReadDrainCycle(benchmark::State& state) {
+  const Buffer::SliceAllocator::Stats before = Buffer::SliceAllocator::threadStats();
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    constexpr uint64_t NumSlices = 2;
+    Buffer::RawSlice slices[NumSlices];
+    const uint64_t slices_used = buffer.reserve(state.range(0), slices, NumSlices);
+    buffer.commit(slices, slices_used);
+    buffer.drain(buffer.length());
+  }
+  benchmark::DoNotOptimize(buffer.length());
+
+  const Buffer::SliceAllocator::Stats after = Buffer::SliceAllocator::threadStats();
+  const uint64_t allocated = after.allocated_blocks_ - before.allocated_blocks_;
+  state.counters["reused_fraction"] =
+      allocated == 0 ? 0 : double(after.reused_blocks_ - before.reused_blocks_) / allocated;
+  state.counters["cached_bytes"] = after.cached_bytes_;
+}
+BENCHMARK(bufferReadDrainCycle)->Arg(4096)->Arg(16384)->Arg(65536);
+
+// Test moving the data of reads into a queue of buffers, and draining the buffers which fall out of
+// the queue, so that slices are freed in a different order than they were allocated in.
+static void bufferReadQueueCycle(benchmark::State& state) {
+  constexpr uint64_t QueueLength = 32;
+  std::vector<Buffer::OwnedImpl> queue(QueueLength);
+  uint64_t next = 0;
+  for (auto _ : state) {
+    Buffer::OwnedImpl buffer;
+    constexpr uint64_t NumSlices = 2;
+    Buffer::RawSlice slices[NumSlices];
+    const uint64_t slices_used = buffer.reserve(state.range(0), slices, NumSlices);
+    buffer.commit(slices, slices_used);
+    Buffer::OwnedImpl& queued = queue[next++ % QueueLength];
+    queued.drain(queued.length());
+    queued.move(buffer);
+  }
+  benchmark::DoNotOptimize(queue[0].length());
+}
+BENCHMARK(bufferReadQueueCycle)->Arg(4096)->Arg(16384);
+
 // Test the linearization of a buffer in the best case where the data is in one slice.
 static void bufferLinearizeSimple(benchmark::State& state) {
   const std::string data(state.range(0), 'a');
@@ -3,6 +3,7 @@
 #include "envoy/common/exception.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_allocator.h"
 
 #include "test/common/buffer/utility.h"
 #include "test/test_common/printers.h"
@@ -60,7 +61,8 @@ bool sliceMatches(const SlicePtr& slice, const std::string& expected) {
 }
 
 TEST_F(OwnedSliceTest, Create) {
-  static constexpr uint64_t Sizes[] = {0, 1, 64, 4096 - sizeof(OwnedSlice), 65535};
+  static constexpr uint64_t Sizes[] = {
+      0, 1, 64, 4096 - SliceAllocator::HeaderSize - sizeof(OwnedSlice), 65535};
   for (const auto size : Sizes) {
     auto slice = OwnedSlice::create(size);
     EXPECT_NE(nullptr, slice->data());
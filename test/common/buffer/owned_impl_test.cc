@@ -1,6 +1,7 @@
 #include "envoy/api/io_error.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_allocator.h"
 #include "common/network/io_socket_handle_impl.h"
 
 #include "test/common/buffer/utility.h"
@@ -19,6 +20,10 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
+// Largest amount of data which fits in a slice of a single page.
+constexpr uint64_t OnePageSliceSize =
+    SliceAllocator::PageSize - SliceAllocator::HeaderSize - sizeof(OwnedSlice);
+
 class OwnedImplTest : public testing::Test {
 public:
   bool release_callback_called_ = false;
@@ -360,7 +365,7 @@ TEST_F(OwnedImplTest, ReserveCommit) {
     // Request a reservation that is too large to fit in the remaining space at the end of
     // the last slice, and allow the buffer to use only one slice. This should result in the
     // creation of a new slice within the buffer.
-    num_reserved = buffer.reserve(4096 - sizeof(OwnedSlice), iovecs, 1);
+    num_reserved = buffer.reserve(OnePageSliceSize, iovecs, 1);
     EXPECT_EQ(1, num_reserved);
     EXPECT_NE(slice1, iovecs[0].mem_);
     clearReservation(iovecs, num_reserved, buffer);
@@ -368,19 +373,19 @@ TEST_F(OwnedImplTest, ReserveCommit) {
     // Request the same size reservation, but allow the buffer to use multiple slices. This
     // should result in the buffer creating a second slice and splitting the reservation between the
     // last two slices.
-    num_reserved = buffer.reserve(4096 - sizeof(OwnedSlice), iovecs, NumIovecs);
+    num_reserved = buffer.reserve(OnePageSliceSize, iovecs, NumIovecs);
     EXPECT_EQ(2, num_reserved);
     EXPECT_EQ(slice1, iovecs[0].mem_);
     clearReservation(iovecs, num_reserved, buffer);
 
     // Request a reservation that too big to fit in the existing slices. This should result
     // in the creation of a third slice.
-    expectSlices({{1, 4055, 4056}}, buffer);
-    buffer.reserve(4096 - sizeof(OwnedSlice), iovecs, NumIovecs);
-    expectSlices({{1, 4055, 4056}, {0, 4056, 4056}}, buffer);
+    expectSlices({{1, 4039, 4040}}, buffer);
+    buffer.reserve(OnePageSliceSize, iovecs, NumIovecs);
+    expectSlices({{1, 4039, 4040}, {0, 4040, 4040}}, buffer);
     const void* slice2 = iovecs[1].mem_;
     num_reserved = buffer.reserve(8192, iovecs, NumIovecs);
-    expectSlices({{1, 4055, 4056}, {0, 4056, 4056}, {0, 4056, 4056}}, buffer);
+    expectSlices({{1, 4039, 4040}, {0, 4040, 4040}, {0, 4040, 4040}}, buffer);
     EXPECT_EQ(3, num_reserved);
     EXPECT_EQ(slice1, iovecs[0].mem_);
     EXPECT_EQ(slice2, iovecs[1].mem_);
@@ -389,11 +394,11 @@ TEST_F(OwnedImplTest, ReserveCommit) {
     // Append a fragment to the buffer, and then request a small reservation. The buffer
     // should make a new slice to satisfy the reservation; it cannot safely use any of
     // the previously seen slices, because they are no longer at the end of the buffer.
-    expectSlices({{1, 4055, 4056}}, buffer);
+    expectSlices({{1, 4039, 4040}}, buffer);
     buffer.addBufferFragment(fragment);
     EXPECT_EQ(13, buffer.length());
     num_reserved = buffer.reserve(1, iovecs, NumIovecs);
-    expectSlices({{1, 4055, 4056}, {12, 0, 12}, {0, 4056, 4056}}, buffer);
+    expectSlices({{1, 4039, 4040}, {12, 0, 12}, {0, 4040, 4040}}, buffer);
     EXPECT_EQ(1, num_reserved);
     EXPECT_NE(slice1, iovecs[0].mem_);
     commitReservation(iovecs, num_reserved, buffer);
@@ -424,16 +429,16 @@ TEST_F(OwnedImplTest, ReserveCommitReuse) {
   EXPECT_EQ(2, num_reserved);
   const void* first_slice = iovecs[0].mem_;
   iovecs[0].len_ = 1;
-  expectSlices({{8000, 4248, 12248}, {0, 12248, 12248}}, buffer);
+  expectSlices({{8000, 4248, 12232}, {0, 12232, 12232}}, buffer);
   buffer.commit(iovecs, 1);
   EXPECT_EQ(8001, buffer.length());
   EXPECT_EQ(first_slice, iovecs[0].mem_);
   // The second slice is now released because there's nothing in the second slice.
-  expectSlices({{8001, 4247, 12248}}, buffer);
+  expectSlices({{8001, 4247, 12232}}, buffer);
 
   // Reserve 16KB again.
   num_reserved = buffer.reserve(16384, iovecs, NumIovecs);
-  expectSlices({{8001, 4247, 12248}, {0, 12248, 12248}}, buffer);
+  expectSlices({{8001, 4247, 12232}, {0, 12232, 12232}}, buffer);
   EXPECT_EQ(2, num_reserved);
   EXPECT_EQ(static_cast<const uint8_t*>(first_slice) + 1,
             static_cast<const uint8_t*>(iovecs[0].mem_));
@@ -460,7 +465,7 @@ TEST_F(OwnedImplTest, ReserveReuse) {
   EXPECT_EQ(2, num_reserved);
   EXPECT_EQ(first_slice, iovecs[0].mem_);
   EXPECT_EQ(second_slice, iovecs[1].mem_);
-  expectSlices({{0, 12248, 12248}, {0, 8152, 8152}}, buffer);
+  expectSlices({{0, 12232, 12232}, {0, 8136, 8136}}, buffer);
 
   // Request a larger reservation, verify that the second entry is replaced with a block with a
   // larger size.
@@ -468,51 +473,51 @@ TEST_F(OwnedImplTest, ReserveReuse) {
   const void* third_slice = iovecs[1].mem_;
   EXPECT_EQ(2, num_reserved);
   EXPECT_EQ(first_slice, iovecs[0].mem_);
-  EXPECT_EQ(12248, iovecs[0].len_);
+  EXPECT_EQ(12232, iovecs[0].len_);
   EXPECT_NE(second_slice, iovecs[1].mem_);
   EXPECT_EQ(30000 - iovecs[0].len_, iovecs[1].len_);
-  expectSlices({{0, 12248, 12248}, {0, 8152, 8152}, {0, 20440, 20440}}, buffer);
+  expectSlices({{0, 12232, 12232}, {0, 8136, 8136}, {0, 20424, 20424}}, buffer);
 
   // Repeating a the reservation request for a smaller block returns the previous entry.
   num_reserved = buffer.reserve(16384, iovecs, NumIovecs);
   EXPECT_EQ(2, num_reserved);
   EXPECT_EQ(first_slice, iovecs[0].mem_);
   EXPECT_EQ(second_slice, iovecs[1].mem_);
-  expectSlices({{0, 12248, 12248}, {0, 8152, 8152}, {0, 20440, 20440}}, buffer);
+  expectSlices({{0, 12232, 12232}, {0, 8136, 8136}, {0, 20424, 20424}}, buffer);
 
   // Repeat the larger reservation notice that it doesn't match the prior reservation for 30000
   // bytes.
   num_reserved = buffer.reserve(30000, iovecs, NumIovecs);
   EXPECT_EQ(2, num_reserved);
   EXPECT_EQ(first_slice, iovecs[0].mem_);
-  EXPECT_EQ(12248, iovecs[0].len_);
+  EXPECT_EQ(12232, iovecs[0].len_);
   EXPECT_NE(second_slice, iovecs[1].mem_);
   EXPECT_NE(third_slice, iovecs[1].mem_);
   EXPECT_EQ(30000 - iovecs[0].len_, iovecs[1].len_);
-  expectSlices({{0, 12248, 12248}, {0, 8152, 8152}, {0, 20440, 20440}, {0, 20440, 20440}}, buffer);
+  expectSlices({{0, 12232, 12232}, {0, 8136, 8136}, {0, 20424, 20424}, {0, 20424, 20424}}, buffer);
 
   // Commit the most recent reservation and verify the representation.
   buffer.commit(iovecs, num_reserved);
-  expectSlices({{12248, 0, 12248}, {0, 8152, 8152}, {0, 20440, 20440}, {17752, 2688, 20440}},
+  expectSlices({{12232, 0, 12232}, {0, 8136, 8136}, {0, 20424, 20424}, {17768, 2656, 20424}},
                buffer);
 
   // Do another reservation.
   num_reserved = buffer.reserve(16384, iovecs, NumIovecs);
   EXPECT_EQ(2, num_reserved);
-  expectSlices({{12248, 0, 12248},
-                {0, 8152, 8152},
-                {0, 20440, 20440},
-                {17752, 2688, 20440},
-                {0, 16344, 16344}},
+  expectSlices({{12232, 0, 12232},
+                {0, 8136, 8136},
+                {0, 20424, 20424},
+                {17768, 2656, 20424},
+                {0, 16328, 16328}},
                buffer);
 
   // And commit.
   buffer.commit(iovecs, num_reserved);
-  expectSlices({{12248, 0, 12248},
-                {0, 8152, 8152},
-                {0, 20440, 20440},
-                {20440, 0, 20440},
-                {13696, 2648, 16344}},
+  expectSlices({{12232, 0, 12232},
+                {0, 8136, 8136},
+                {0, 20424, 20424},
+                {20424, 0, 20424},
+                {13728, 2600, 16328}},
                buffer);
 }
 
@@ -669,7 +674,7 @@ TEST_F(OwnedImplTest, ReserveZeroCommit) {
   ASSERT_EQ(os_sys_calls.close(pipe_fds[1]).rc_, 0);
   ASSERT_EQ(previous_length, buf.search(data.data(), rc, previous_length));
   EXPECT_EQ("bbbbb", buf.toString().substr(0, 5));
-  expectSlices({{5, 0, 4056}, {1953, 2103, 4056}}, buf);
+  expectSlices({{5, 0, 4040}, {1953, 2087, 4040}}, buf);
 }
 
 TEST_F(OwnedImplTest, ReadReserveAndCommit) {
@@ -696,7 +701,7 @@ TEST_F(OwnedImplTest, ReadReserveAndCommit) {
   ASSERT_EQ(result.rc_, static_cast<uint64_t>(rc));
   ASSERT_EQ(os_sys_calls.close(pipe_fds[1]).rc_, 0);
   EXPECT_EQ("bbbbbe", buf.toString());
-  expectSlices({{6, 4050, 4056}}, buf);
+  expectSlices({{6, 4034, 4040}}, buf);
 }
 
 TEST(OverflowDetectingUInt64, Arithmetic) {
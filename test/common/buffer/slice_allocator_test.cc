@@ -0,0 +1,155 @@
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_allocator.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+// Usable sizes of the blocks of one and four pages.
+constexpr uint64_t OnePage = SliceAllocator::PageSize - SliceAllocator::HeaderSize;
+constexpr uint64_t FourPages = 4 * SliceAllocator::PageSize - SliceAllocator::HeaderSize;
+
+// Blocks of a cached size freed by a thread are reused by its next allocations of that size.
+TEST(SliceAllocatorTest, ReuseFreedBlocks) {
+  Thread::threadFactoryForTest()
+      .createThread([]() {
+        void* block = SliceAllocator::allocate(OnePage);
+        EXPECT_EQ(1, SliceAllocator::threadStats().allocated_blocks_);
+        EXPECT_EQ(0, SliceAllocator::threadStats().reused_blocks_);
+        SliceAllocator::deallocate(block);
+        EXPECT_EQ(4096, SliceAllocator::threadStats().cached_bytes_);
+
+        // Another size class doesn't reuse the block.
+        void* other = SliceAllocator::allocate(FourPages);
+        EXPECT_EQ(0, SliceAllocator::threadStats().reused_blocks_);
+        EXPECT_EQ(block, SliceAllocator::allocate(OnePage));
+        EXPECT_EQ(1, SliceAllocator::threadStats().reused_blocks_);
+        EXPECT_EQ(0, SliceAllocator::threadStats().cached_bytes_);
+
+        SliceAllocator::deallocate(block);
+        SliceAllocator::deallocate(other);
+        EXPECT_EQ(4096 + 16384, SliceAllocator::threadStats().cached_bytes_);
+      })
+      ->join();
+}
+
+// Blocks which aren't one to five whole pages are never cached.
+TEST(SliceAllocatorTest, UncachedSizes) {
+  Thread::threadFactoryForTest()
+      .createThread([]() {
+        const uint64_t six_pages = 6 * SliceAllocator::PageSize - SliceAllocator::HeaderSize;
+        for (const uint64_t size : {uint64_t(100), OnePage + 1, six_pages}) {
+          SliceAllocator::deallocate(SliceAllocator::allocate(size));
+        }
+        EXPECT_EQ(0, SliceAllocator::threadStats().allocated_blocks_);
+        EXPECT_EQ(0, SliceAllocator::threadStats().cached_bytes_);
+      })
+      ->join();
+}
+
+// Each free list of a thread is bounded.
+TEST(SliceAllocatorTest, BoundedFreeLists) {
+  Thread::threadFactoryForTest()
+      .createThread([]() {
+        std::vector<void*> blocks;
+        for (uint32_t i = 0; i < 2 * SliceAllocator::MaxFreeBlocksPerSizeClass; i++) {
+          blocks.push_back(SliceAllocator::allocate(2 * SliceAllocator::PageSize -
+                                                    SliceAllocator::HeaderSize));
+        }
+        for (void* block : blocks) {
+          SliceAllocator::deallocate(block);
+        }
+        EXPECT_EQ(SliceAllocator::MaxFreeBlocksPerSizeClass * 8192,
+                  SliceAllocator::threadStats().cached_bytes_);
+      })
+      ->join();
+}
+
+// A block freed by another thread than the one which allocated it goes to the free list of the
+// thread which frees it.
+TEST(SliceAllocatorTest, FreeOnAnotherThread) {
+  void* block = nullptr;
+  Thread::threadFactoryForTest()
+      .createThread([&block]() { block = SliceAllocator::allocate(OnePage); })
+      ->join();
+  Thread::threadFactoryForTest()
+      .createThread([block]() {
+        SliceAllocator::deallocate(block);
+        EXPECT_EQ(4096, SliceAllocator::threadStats().cached_bytes_);
+        EXPECT_EQ(block, SliceAllocator::allocate(OnePage));
+        SliceAllocator::deallocate(block);
+      })
+      ->join();
+}
+
+// The process-wide stats sum up the counters of the live threads and of the threads which exited.
+TEST(SliceAllocatorTest, Stats) {
+  const SliceAllocator::Stats before = SliceAllocator::stats();
+  Thread::threadFactoryForTest()
+      .createThread([&before]() {
+        SliceAllocator::deallocate(SliceAllocator::allocate(OnePage));
+        SliceAllocator::deallocate(SliceAllocator::allocate(OnePage));
+
+        const SliceAllocator::Stats stats = SliceAllocator::stats();
+        EXPECT_EQ(before.allocated_blocks_ + 2, stats.allocated_blocks_);
+        EXPECT_EQ(before.reused_blocks_ + 1, stats.reused_blocks_);
+        EXPECT_EQ(before.cached_bytes_ + 4096, stats.cached_bytes_);
+      })
+      ->join();
+
+  // The blocks cached by the thread were released when it exited.
+  const SliceAllocator::Stats after = SliceAllocator::stats();
+  EXPECT_EQ(before.allocated_blocks_ + 2, after.allocated_blocks_);
+  EXPECT_EQ(before.reused_blocks_ + 1, after.reused_blocks_);
+  EXPECT_EQ(before.cached_bytes_, after.cached_bytes_);
+}
+
+// The storage of the slices of buffers comes from the allocator.
+TEST(SliceAllocatorTest, OwnedSlices) {
+  Thread::threadFactoryForTest()
+      .createThread([]() {
+        {
+          OwnedImpl buffer(std::string(100, 'a'));
+          EXPECT_EQ(1, SliceAllocator::threadStats().allocated_blocks_);
+        }
+        EXPECT_EQ(4096, SliceAllocator::threadStats().cached_bytes_);
+
+        OwnedImpl buffer(std::string(100, 'a'));
+        EXPECT_EQ(1, SliceAllocator::threadStats().reused_blocks_);
+        EXPECT_EQ(0, SliceAllocator::threadStats().cached_bytes_);
+      })
+      ->join();
+}
+
+// The block of a 16KB read, as reserved by the sockets, is reused by the next read.
+TEST(SliceAllocatorTest, ReuseReadReservations) {
+  Thread::threadFactoryForTest()
+      .createThread([]() {
+        RawSlice iovecs[2];
+        void* block;
+        {
+          OwnedImpl buffer;
+          EXPECT_EQ(1, buffer.reserve(16384, iovecs, 2));
+          block = iovecs[0].mem_;
+          EXPECT_EQ(1, SliceAllocator::threadStats().allocated_blocks_);
+        }
+        EXPECT_EQ(5 * SliceAllocator::PageSize, SliceAllocator::threadStats().cached_bytes_);
+
+        OwnedImpl buffer;
+        EXPECT_EQ(1, buffer.reserve(16384, iovecs, 2));
+        EXPECT_EQ(block, iovecs[0].mem_);
+        EXPECT_EQ(1, SliceAllocator::threadStats().reused_blocks_);
+        EXPECT_EQ(0, SliceAllocator::threadStats().cached_bytes_);
+      })
+      ->join();
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
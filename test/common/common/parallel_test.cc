@@ -0,0 +1,49 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "common/common/parallel.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Thread {
+namespace {
+
+// Each index runs once, whatever the split in ranges.
+TEST(ParallelForTest, RunEachIndexOnce) {
+  for (const size_t count : {0, 1, 7, 100, 1001}) {
+    for (const uint32_t max_threads : {1, 2, 3, 8}) {
+      std::vector<std::atomic<uint32_t>> runs(count);
+      parallelFor(threadFactoryForTest(), count, 10, max_threads,
+                  [&runs](size_t i) { runs[i]++; });
+      for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(1, runs[i]) << "count " << count << " max_threads " << max_threads;
+      }
+    }
+  }
+}
+
+// Small batches are run by the calling thread alone.
+TEST(ParallelForTest, SmallBatch) {
+  const std::thread::id caller = std::this_thread::get_id();
+  parallelFor(threadFactoryForTest(), 19, 10, 8,
+              [caller](size_t) { EXPECT_EQ(caller, std::this_thread::get_id()); });
+}
+
+// Large batches are split among helper threads.
+TEST(ParallelForTest, LargeBatch) {
+  std::vector<std::thread::id> ids(100);
+  parallelFor(threadFactoryForTest(), ids.size(), 10, 4,
+              [&ids](size_t i) { ids[i] = std::this_thread::get_id(); });
+  EXPECT_EQ(std::this_thread::get_id(), ids[0]);
+  EXPECT_EQ(ids[0], ids[24]);
+  EXPECT_NE(ids[0], ids[25]);
+  EXPECT_NE(ids[25], ids[99]);
+}
+
+} // namespace
+} // namespace Thread
+} // namespace Envoy
@@ -8,6 +8,7 @@
 #include "common/config/api_version.h"
 #include "common/config/grpc_mux_impl.h"
 #include "common/config/protobuf_link_hacks.h"
+#include "common/config/snapshot_cache.h"
 #include "common/config/utility.h"
 #include "common/config/version_converter.h"
 #include "common/protobuf/protobuf.h"
@@ -20,6 +21,7 @@
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/test_common/environment.h"
 #include "test/test_common/logging.h"
 #include "test/test_common/resources.h"
 #include "test/test_common/simulated_time_system.h"
@@ -37,6 +39,7 @@ using testing::IsSubstring;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
+using testing::Throw;
 
 namespace Envoy {
 namespace Config {
@@ -56,7 +59,8 @@ public:
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
-        envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true);
+        envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true,
+        std::move(snapshot_cache_));
   }
 
   void setup(const RateLimitSettings& custom_rate_limit_settings) {
@@ -65,7 +69,7 @@ public:
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
         envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, custom_rate_limit_settings,
-        true);
+        true, nullptr);
   }
 
   void expectSendMessage(const std::string& type_url,
@@ -103,6 +107,8 @@ public:
   Stats::TestUtil::TestStore stats_;
   Envoy::Config::RateLimitSettings rate_limit_settings_;
   Stats::Gauge& control_plane_connected_state_;
+  // Handed over to the mux by setup().
+  SnapshotCachePtr snapshot_cache_;
 };
 
 class GrpcMuxImplTest : public GrpcMuxImplTestBase {
@@ -659,6 +665,139 @@ TEST_F(GrpcMuxImplTest, UnwatchedTypeRejectsResources) {
                       grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response)));
 }
 
+std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>
+loadAssignmentResponse(const std::string& version, const std::vector<std::string>& clusters) {
+  auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+  response->set_type_url(Config::TypeUrl::get().ClusterLoadAssignment);
+  response->set_version_info(version);
+  for (const auto& cluster : clusters) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+    load_assignment.set_cluster_name(cluster);
+    response->add_resources()->PackFrom(API_DOWNGRADE(load_assignment));
+  }
+  return response;
+}
+
+// The snapshot is replayed to the watches before the management server responds, and the accepted
+// responses replace it.
+TEST_F(GrpcMuxImplTest, SnapshotReplayAndStore) {
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  const std::string snapshot_path = TestEnvironment::temporaryPath("grpc_mux_snapshot_replay");
+  TestEnvironment::createPath(snapshot_path);
+  Api::ApiPtr api = Api::createApiForTest();
+  SnapshotCache(snapshot_path, *api).store(loadAssignmentResponse("1", {"x", "y"}));
+
+  snapshot_cache_ = std::make_unique<SnapshotCache>(snapshot_path, *api);
+  auto* snapshot_timer = new Event::MockTimer(&dispatcher_);
+  new Event::MockTimer(&dispatcher_); // The stream's retry timer.
+  setup();
+  NiceMock<MockSubscriptionCallbacks> foo_callbacks;
+  NiceMock<MockSubscriptionCallbacks> bar_callbacks;
+  EXPECT_CALL(*snapshot_timer, enableTimer(std::chrono::milliseconds(0), _)).Times(2);
+  auto foo_sub = grpc_mux_->addWatch(type_url, {"x"}, foo_callbacks);
+  auto bar_sub = grpc_mux_->addWatch(type_url, {"z"}, bar_callbacks);
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"z", "x"}, "", true);
+  grpc_mux_->start();
+
+  // Only the watches with snapshotted resources are updated, and only once.
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                          const std::string&) { EXPECT_EQ(1, resources.size()); }));
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, _)).Times(0);
+  snapshot_timer->invokeCallback();
+  snapshot_timer->invokeCallback();
+
+  // The snapshot's version is not acknowledged, so that the management server sends its own.
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "2"));
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, "2"));
+  expectSendMessage(type_url, {"z", "x"}, "2");
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(loadAssignmentResponse("2", {"x", "z"}));
+
+  // The management server's response superseded the snapshot.
+  NiceMock<MockSubscriptionCallbacks> baz_callbacks;
+  expectSendMessage(type_url, {"y", "z", "x"}, "2");
+  auto baz_sub = grpc_mux_->addWatch(type_url, {"y"}, baz_callbacks);
+  EXPECT_CALL(baz_callbacks, onConfigUpdate(_, _)).Times(0);
+  snapshot_timer->invokeCallback();
+
+  expectSendMessage(type_url, {"z", "x"}, "2");
+  expectSendMessage(type_url, {"x"}, "2");
+  expectSendMessage(type_url, {}, "2");
+  baz_sub.reset();
+  bar_sub.reset();
+  foo_sub.reset();
+  // Destroying the mux writes the accepted response.
+  grpc_mux_.reset();
+  auto snapshot = SnapshotCache(snapshot_path, *api).load(type_url);
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ("2", snapshot->version_info());
+  EXPECT_EQ(2, snapshot->resources().size());
+}
+
+// The responses of the resources requested by name are merged into the loaded snapshot, so that
+// the resources the management server didn't send again are kept.
+TEST_F(GrpcMuxImplTest, SnapshotMerge) {
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  const std::string snapshot_path = TestEnvironment::temporaryPath("grpc_mux_snapshot_merge");
+  TestEnvironment::createPath(snapshot_path);
+  Api::ApiPtr api = Api::createApiForTest();
+  SnapshotCache(snapshot_path, *api).store(loadAssignmentResponse("1", {"x", "y", "z"}));
+
+  snapshot_cache_ = std::make_unique<SnapshotCache>(snapshot_path, *api);
+  new NiceMock<Event::MockTimer>(&dispatcher_); // The snapshot timer.
+  new Event::MockTimer(&dispatcher_);           // The stream's retry timer.
+  setup();
+  NiceMock<MockSubscriptionCallbacks> foo_callbacks;
+  auto foo_sub = grpc_mux_->addWatch(type_url, {"x", "y"}, foo_callbacks);
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x", "y"}, "", true);
+  grpc_mux_->start();
+
+  // The resource which isn't subscribed to anymore is dropped from the snapshot.
+  expectSendMessage(type_url, {"x", "y"}, "2");
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(loadAssignmentResponse("2", {"x"}));
+
+  expectSendMessage(type_url, {}, "2");
+  foo_sub.reset();
+  grpc_mux_.reset();
+  auto snapshot = SnapshotCache(snapshot_path, *api).load(type_url);
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ("2", snapshot->version_info());
+  std::vector<std::string> clusters;
+  for (const auto& resource : snapshot->resources()) {
+    clusters.push_back(TestUtility::xdsResourceName(resource));
+  }
+  EXPECT_EQ(std::vector<std::string>({"x", "y"}), clusters);
+}
+
+// A snapshot which the watches reject is discarded.
+TEST_F(GrpcMuxImplTest, SnapshotRejected) {
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  const std::string snapshot_path = TestEnvironment::temporaryPath("grpc_mux_snapshot_rejected");
+  TestEnvironment::createPath(snapshot_path);
+  Api::ApiPtr api = Api::createApiForTest();
+  SnapshotCache(snapshot_path, *api).store(loadAssignmentResponse("1", {"x"}));
+
+  snapshot_cache_ = std::make_unique<SnapshotCache>(snapshot_path, *api);
+  auto* snapshot_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  new Event::MockTimer(&dispatcher_); // The stream's retry timer.
+  setup();
+  NiceMock<MockSubscriptionCallbacks> foo_callbacks;
+  auto foo_sub = grpc_mux_->addWatch(type_url, {"x"}, foo_callbacks);
+
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, "1")).WillOnce(Throw(EnvoyException("rejected")));
+  // A rejected snapshot does not fail the subscription, which waits for the management server.
+  EXPECT_CALL(foo_callbacks, onConfigUpdateFailed(_, _)).Times(0);
+  EXPECT_LOG_CONTAINS("warning", "Discarding the snapshot of " + type_url + ": rejected",
+                      snapshot_timer->invokeCallback());
+
+  NiceMock<MockSubscriptionCallbacks> bar_callbacks;
+  auto bar_sub = grpc_mux_->addWatch(type_url, {"x"}, bar_callbacks);
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, _)).Times(0);
+  snapshot_timer->invokeCallback();
+}
+
 TEST_F(GrpcMuxImplTest, BadLocalInfoEmptyClusterName) {
   EXPECT_CALL(local_info_, clusterName()).WillOnce(ReturnRef(EMPTY_STRING));
   EXPECT_THROW_WITH_MESSAGE(
@@ -666,7 +805,8 @@ TEST_F(GrpcMuxImplTest, BadLocalInfoEmptyClusterName) {
           local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
           *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
               "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
-          envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true),
+          envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true,
+          nullptr),
       EnvoyException,
       "ads: node 'id' and 'cluster' are required. Set it either in 'node' config or via "
       "--service-node and --service-cluster options.");
@@ -679,7 +819,8 @@ TEST_F(GrpcMuxImplTest, BadLocalInfoEmptyNodeName) {
           local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
           *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
               "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
-          envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true),
+          envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, rate_limit_settings_, true,
+          nullptr),
       EnvoyException,
       "ads: node 'id' and 'cluster' are required. Set it either in 'node' config or via "
       "--service-node and --service-cluster options.");
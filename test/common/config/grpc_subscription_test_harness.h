@@ -52,7 +52,7 @@ public:
     mux_ = std::make_shared<Config::GrpcMuxImpl>(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
         *method_descriptor_, envoy::config::core::v3::ApiVersion::AUTO, random_, stats_store_,
-        rate_limit_settings_, true);
+        rate_limit_settings_, true, nullptr);
     subscription_ = std::make_unique<GrpcSubscriptionImpl>(
         mux_, callbacks_, stats_, Config::TypeUrl::get().ClusterLoadAssignment, dispatcher_,
         init_fetch_timeout, false);
@@ -0,0 +1,102 @@
+// Usage: bazel run //test/common/config:snapshot_cache_speed_test
+//
+// Measures booting from an ADS snapshot of a large CDS response, that is reading it and decoding
+// its clusters, and writing such a snapshot.
+
+#include <memory>
+#include <string>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "common/common/assert.h"
+#include "common/config/snapshot_cache.h"
+#include "common/protobuf/utility.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/resources.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+const std::string ClusterYaml = R"EOF(
+type: EDS
+eds_cluster_config:
+  eds_config:
+    ads: {}
+connect_timeout: 0.25s
+lb_policy: LEAST_REQUEST
+circuit_breakers:
+  thresholds:
+  - priority: DEFAULT
+    max_connections: 1000
+    max_pending_requests: 1000
+    max_requests: 5000
+health_checks:
+- timeout: 1s
+  interval: 5s
+  unhealthy_threshold: 3
+  healthy_threshold: 2
+  http_health_check:
+    path: /healthz
+)EOF";
+
+std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse> clusters(int64_t count) {
+  envoy::config::cluster::v3::Cluster cluster;
+  TestUtility::loadFromYaml(ClusterYaml, cluster);
+  auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+  response->set_type_url(Config::TypeUrl::get().Cluster);
+  response->set_version_info("1");
+  for (int64_t i = 0; i < count; i++) {
+    cluster.set_name(absl::StrCat("cluster_", i));
+    response->add_resources()->PackFrom(cluster);
+  }
+  return response;
+}
+
+std::string snapshotPath(benchmark::State& state) {
+  const std::string path =
+      TestEnvironment::temporaryPath(absl::StrCat("snapshot_cache_speed_test_", state.range(0)));
+  TestEnvironment::createPath(path);
+  return path;
+}
+
+void bmSnapshotLoad(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  SnapshotCache snapshot_cache(snapshotPath(state), *api);
+  snapshot_cache.store(clusters(state.range(0)));
+  snapshot_cache.flush();
+  for (auto _ : state) {
+    auto response = snapshot_cache.load(Config::TypeUrl::get().Cluster);
+    RELEASE_ASSERT(response != nullptr, "");
+    for (const auto& resource : response->resources()) {
+      envoy::config::cluster::v3::Cluster cluster;
+      MessageUtil::unpackTo(resource, cluster);
+      benchmark::DoNotOptimize(cluster);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bmSnapshotLoad)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+void bmSnapshotStore(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  SnapshotCache snapshot_cache(snapshotPath(state), *api);
+  const auto response = clusters(state.range(0));
+  for (auto _ : state) {
+    snapshot_cache.store(
+        std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>(*response));
+    snapshot_cache.flush();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bmSnapshotStore)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,177 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "common/common/hash.h"
+#include "common/config/snapshot_cache.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/logging.h"
+#include "test/test_common/resources.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class SnapshotCacheTest : public testing::Test {
+protected:
+  SnapshotCacheTest()
+      : api_(Api::createApiForTest()),
+        path_(TestEnvironment::temporaryPath(
+            testing::UnitTest::GetInstance()->current_test_info()->name())) {
+    TestEnvironment::createPath(path_);
+  }
+
+  std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>
+  response(const std::string& version, const std::vector<std::string>& clusters = {"foo"}) {
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(Config::TypeUrl::get().ClusterLoadAssignment);
+    response->set_version_info(version);
+    for (const auto& cluster : clusters) {
+      envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+      load_assignment.set_cluster_name(cluster);
+      response->add_resources()->PackFrom(load_assignment);
+    }
+    return response;
+  }
+
+  // Returns the names of the clusters of the snapshot of the load assignments.
+  std::vector<std::string> loadClusters(SnapshotCache& snapshot_cache) {
+    std::vector<std::string> clusters;
+    const auto loaded = snapshot_cache.load(Config::TypeUrl::get().ClusterLoadAssignment);
+    if (loaded != nullptr) {
+      for (const auto& resource : loaded->resources()) {
+        envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+        resource.UnpackTo(&load_assignment);
+        clusters.push_back(load_assignment.cluster_name());
+      }
+    }
+    return clusters;
+  }
+
+  // Returns the contents of a snapshot file holding the serialized data.
+  static std::string fileContents(const std::string& serialized) {
+    const uint64_t length = serialized.size();
+    const uint64_t hash = HashUtil::xxHash64(serialized);
+    return absl::StrCat(SnapshotCache::FileHeader,
+                        absl::string_view(reinterpret_cast<const char*>(&length), sizeof(length)),
+                        absl::string_view(reinterpret_cast<const char*>(&hash), sizeof(hash)),
+                        serialized);
+  }
+
+  Api::ApiPtr api_;
+  const std::string path_;
+};
+
+TEST_F(SnapshotCacheTest, StoreAndLoad) {
+  auto stored = response("1");
+  const envoy::service::discovery::v3::DiscoveryResponse expected = *stored;
+  SnapshotCache(path_, *api_).store(std::move(stored));
+
+  SnapshotCache snapshot_cache(path_, *api_);
+  const auto loaded = snapshot_cache.load(Config::TypeUrl::get().ClusterLoadAssignment);
+  ASSERT_NE(nullptr, loaded);
+  EXPECT_TRUE(TestUtility::protoEqual(expected, *loaded));
+  EXPECT_EQ(nullptr, snapshot_cache.load(Config::TypeUrl::get().Cluster));
+}
+
+// Only the last response stored for a type URL is kept.
+TEST_F(SnapshotCacheTest, LastStoreWins) {
+  SnapshotCache snapshot_cache(path_, *api_);
+  snapshot_cache.store(response("1"));
+  snapshot_cache.store(response("2"));
+  snapshot_cache.flush();
+  snapshot_cache.store(response("3"));
+  snapshot_cache.flush();
+
+  const auto loaded = snapshot_cache.load(Config::TypeUrl::get().ClusterLoadAssignment);
+  ASSERT_NE(nullptr, loaded);
+  EXPECT_EQ("3", loaded->version_info());
+}
+
+// Files which are not snapshots, or not the snapshot of the type URL, are ignored.
+TEST_F(SnapshotCacheTest, InvalidSnapshot) {
+  const std::string type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  const std::string file_path =
+      absl::StrCat(path_, "/envoy.config.endpoint.v3.ClusterLoadAssignment.snapshot");
+  SnapshotCache snapshot_cache(path_, *api_);
+
+  TestEnvironment::writeStringToFileForTest(file_path, "garbage", true);
+  EXPECT_LOG_CONTAINS("warning", "Ignoring the invalid snapshot of " + type_url,
+                      EXPECT_EQ(nullptr, snapshot_cache.load(type_url)));
+
+  auto mismatched = response("1");
+  mismatched->set_type_url(Config::TypeUrl::get().Cluster);
+  TestEnvironment::writeStringToFileForTest(
+      file_path, fileContents(mismatched->SerializeAsString()), true);
+  EXPECT_LOG_CONTAINS("warning", "Ignoring the invalid snapshot of " + type_url,
+                      EXPECT_EQ(nullptr, snapshot_cache.load(type_url)));
+
+  // A truncated or corrupted snapshot doesn't match its length or its hash.
+  const std::string contents = fileContents(response("1")->SerializeAsString());
+  TestEnvironment::writeStringToFileForTest(file_path, contents.substr(0, contents.size() - 1),
+                                            true);
+  EXPECT_LOG_CONTAINS("warning", "Ignoring the invalid snapshot of " + type_url,
+                      EXPECT_EQ(nullptr, snapshot_cache.load(type_url)));
+  std::string corrupted = contents;
+  corrupted.back() ^= 1;
+  TestEnvironment::writeStringToFileForTest(file_path, corrupted, true);
+  EXPECT_LOG_CONTAINS("warning", "Ignoring the invalid snapshot of " + type_url,
+                      EXPECT_EQ(nullptr, snapshot_cache.load(type_url)));
+
+  TestEnvironment::writeStringToFileForTest(file_path, contents, true);
+  EXPECT_NE(nullptr, snapshot_cache.load(type_url));
+}
+
+// The responses of the type URLs whose resources are requested by name are merged per name, and
+// the resources which are not subscribed to anymore are dropped.
+TEST_F(SnapshotCacheTest, Merge) {
+  SnapshotCache snapshot_cache(path_, *api_);
+  snapshot_cache.merge(response("1", {"a", "b"}), {"a", "b"}, {"a", "b", "c"});
+  snapshot_cache.merge(response("2", {"c"}), {"c"}, {"a", "b", "c"});
+  snapshot_cache.flush();
+  EXPECT_EQ(std::vector<std::string>({"a", "b", "c"}), loadClusters(snapshot_cache));
+  EXPECT_EQ("2", snapshot_cache.load(Config::TypeUrl::get().ClusterLoadAssignment)->version_info());
+
+  snapshot_cache.merge(response("3", {}), {}, {"a", "c"});
+  snapshot_cache.flush();
+  EXPECT_EQ(std::vector<std::string>({"a", "c"}), loadClusters(snapshot_cache));
+
+  // A stored response replaces the merged ones.
+  snapshot_cache.store(response("4", {"d"}));
+  snapshot_cache.merge(response("5", {"e"}), {"e"}, {"d", "e"});
+  snapshot_cache.flush();
+  EXPECT_EQ(std::vector<std::string>({"e"}), loadClusters(snapshot_cache));
+}
+
+// The responses are merged into the loaded snapshot it was seeded with, unless one was merged
+// already.
+TEST_F(SnapshotCacheTest, Seed) {
+  SnapshotCache snapshot_cache(path_, *api_);
+  snapshot_cache.seed(response("1", {"a", "b"}), {"a", "b"});
+  snapshot_cache.flush();
+  // Seeding doesn't write the snapshot, which is on disk already.
+  EXPECT_EQ(nullptr, snapshot_cache.load(Config::TypeUrl::get().ClusterLoadAssignment));
+
+  snapshot_cache.merge(response("2", {"b"}), {"b"}, {"a", "b"});
+  snapshot_cache.seed(response("1", {"c"}), {"c"});
+  snapshot_cache.flush();
+  EXPECT_EQ(std::vector<std::string>({"a", "b"}), loadClusters(snapshot_cache));
+}
+
+TEST_F(SnapshotCacheTest, NotADirectory) {
+  EXPECT_THROW_WITH_MESSAGE(
+      SnapshotCache(path_ + "/missing", *api_), EnvoyException,
+      fmt::format("ADS snapshot path '{}/missing' is not a directory", path_));
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
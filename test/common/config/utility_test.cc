@@ -653,6 +653,32 @@ TEST(UtilityTest, CheckCluster) {
   EXPECT_NO_THROW(Utility::checkCluster("prefix", "foo", cm, false));
 }
 
+TEST(UtilityTest, ResourceNameFromAny) {
+  const int name_field = envoy::config::cluster::v3::Cluster::kNameFieldNumber;
+  envoy::config::cluster::v3::Cluster cluster;
+  ProtobufWkt::Any resource;
+  resource.PackFrom(cluster);
+  EXPECT_EQ("", Utility::resourceNameFromAny(resource, name_field));
+
+  // The name is found among the other fields.
+  cluster.mutable_connect_timeout()->set_seconds(1);
+  cluster.set_name("foo");
+  cluster.mutable_eds_cluster_config()->set_service_name("bar");
+  resource.PackFrom(cluster);
+  EXPECT_EQ("foo", Utility::resourceNameFromAny(resource, name_field));
+
+  // As when parsing, the last occurrence of the name wins.
+  envoy::config::cluster::v3::Cluster renamed;
+  renamed.set_name("baz");
+  resource.mutable_value()->append(renamed.SerializeAsString());
+  EXPECT_EQ("baz", Utility::resourceNameFromAny(resource, name_field));
+
+  resource.mutable_value()->resize(resource.value().size() - 1);
+  EXPECT_THROW_WITH_MESSAGE(
+      Utility::resourceNameFromAny(resource, name_field), EnvoyException,
+      "Unable to read the name of a type.googleapis.com/envoy.config.cluster.v3.Cluster resource");
+}
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
@@ -0,0 +1,145 @@
+// Measures the throughput of callbacks posted from several threads to a single consuming thread,
+// with PostQueue and with the list under a mutex which dispatchers used before, and end to end
+// through DispatcherImpl::post(). Each benchmark thread is a producer.
+
+#include <atomic>
+#include <list>
+#include <memory>
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/event/post_queue.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// The queue drained by a consumer thread until the benchmark ends.
+template <class Queue> class Consumer {
+public:
+  Consumer()
+      : thread_(Thread::threadFactoryForTest().createThread([this]() {
+          while (!stop_) {
+            queue_.drain();
+          }
+          queue_.drain();
+        })) {}
+  ~Consumer() {
+    stop_ = true;
+    thread_->join();
+  }
+
+  Queue queue_;
+
+private:
+  std::atomic<bool> stop_{};
+  Thread::ThreadPtr thread_;
+};
+
+class LockFreeQueue {
+public:
+  void push(PostCb callback) { queue_.push(std::move(callback)); }
+  void drain() {
+    queue_.rearm();
+    while (PostCb callback = queue_.pop()) {
+      callback();
+    }
+  }
+
+private:
+  PostQueue queue_;
+};
+
+class LockedListQueue {
+public:
+  void push(PostCb callback) {
+    Thread::LockGuard lock(lock_);
+    callbacks_.push_back(callback);
+  }
+  void drain() {
+    while (true) {
+      PostCb callback;
+      {
+        Thread::LockGuard lock(lock_);
+        if (callbacks_.empty()) {
+          return;
+        }
+        callback = callbacks_.front();
+        callbacks_.pop_front();
+      }
+      callback();
+    }
+  }
+
+private:
+  Thread::MutexBasicLockable lock_;
+  std::list<PostCb> callbacks_ ABSL_GUARDED_BY(lock_);
+};
+
+template <class Queue> void bmPush(benchmark::State& state) {
+  static Consumer<Queue>* consumer;
+  static std::atomic<uint64_t> run_count;
+  if (state.thread_index == 0) {
+    consumer = new Consumer<Queue>();
+    run_count = 0;
+  }
+  for (auto _ : state) {
+    consumer->queue_.push([]() { run_count++; });
+  }
+  if (state.thread_index == 0) {
+    delete consumer;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void lockFreePush(benchmark::State& state) { bmPush<LockFreeQueue>(state); }
+BENCHMARK(lockFreePush)->ThreadRange(1, 8)->UseRealTime();
+
+void lockedListPush(benchmark::State& state) { bmPush<LockedListQueue>(state); }
+BENCHMARK(lockedListPush)->ThreadRange(1, 8)->UseRealTime();
+
+// A dispatcher running on its own thread until the benchmark ends.
+class DispatcherThread {
+public:
+  DispatcherThread()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        thread_(Thread::threadFactoryForTest().createThread(
+            [this]() { dispatcher_->run(Dispatcher::RunType::RunUntilExit); })) {}
+  ~DispatcherThread() {
+    dispatcher_->post([this]() { dispatcher_->exit(); });
+    thread_->join();
+  }
+
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+
+private:
+  Thread::ThreadPtr thread_;
+};
+
+void dispatcherPost(benchmark::State& state) {
+  static DispatcherThread* dispatcher_thread;
+  static std::atomic<uint64_t> run_count;
+  if (state.thread_index == 0) {
+    dispatcher_thread = new DispatcherThread();
+    run_count = 0;
+  }
+  for (auto _ : state) {
+    dispatcher_thread->dispatcher_->post([]() { run_count++; });
+  }
+  if (state.thread_index == 0) {
+    delete dispatcher_thread;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(dispatcherPost)->ThreadRange(1, 8)->UseRealTime();
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,103 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "common/event/post_queue.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+TEST(PostQueueTest, PushPop) {
+  PostQueue queue;
+  EXPECT_FALSE(queue.pop());
+
+  std::vector<int> popped;
+  EXPECT_TRUE(queue.push([&popped]() { popped.push_back(1); }));
+  EXPECT_FALSE(queue.push([&popped]() { popped.push_back(2); }));
+  queue.pop()();
+  EXPECT_FALSE(queue.push([&popped]() { popped.push_back(3); }));
+  while (PostCb callback = queue.pop()) {
+    callback();
+  }
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), popped);
+
+  // The queue keeps working once emptied.
+  EXPECT_FALSE(queue.push([&popped]() { popped.push_back(4); }));
+  queue.pop()();
+  EXPECT_FALSE(queue.pop());
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), popped);
+}
+
+// Only the first push after each rearm asks for a wakeup.
+TEST(PostQueueTest, Rearm) {
+  PostQueue queue;
+  EXPECT_TRUE(queue.push([]() {}));
+  queue.rearm();
+  EXPECT_TRUE(queue.push([]() {}));
+  EXPECT_FALSE(queue.push([]() {}));
+  queue.rearm();
+  queue.rearm();
+  EXPECT_TRUE(queue.push([]() {}));
+}
+
+TEST(PostQueueTest, DestroyPendingCallbacks) {
+  auto data = std::make_shared<int>(0);
+  {
+    PostQueue queue;
+    queue.push([data]() {});
+    queue.push([data]() {});
+    EXPECT_EQ(3, data.use_count());
+  }
+  EXPECT_EQ(1, data.use_count());
+}
+
+// Callbacks pushed from several threads while they are popped are all popped once, in the order
+// each thread pushed them.
+TEST(PostQueueTest, ConcurrentPush) {
+  constexpr uint32_t Producers = 4;
+  constexpr uint32_t CallbacksPerProducer = 20000;
+  PostQueue queue;
+  std::vector<uint32_t> popped(Producers);
+  std::atomic<uint32_t> wakeups{};
+
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t producer = 0; producer < Producers; producer++) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([&, producer]() {
+      for (uint32_t i = 0; i < CallbacksPerProducer; i++) {
+        if (queue.push([&popped, producer, i]() {
+              EXPECT_EQ(i, popped[producer]);
+              popped[producer]++;
+            })) {
+          wakeups++;
+        }
+      }
+    }));
+  }
+
+  uint32_t total = 0;
+  while (total < Producers * CallbacksPerProducer) {
+    queue.rearm();
+    while (PostCb callback = queue.pop()) {
+      callback();
+      total++;
+    }
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+
+  EXPECT_FALSE(queue.pop());
+  for (uint32_t producer = 0; producer < Producers; producer++) {
+    EXPECT_EQ(CallbacksPerProducer, popped[producer]);
+  }
+  EXPECT_LE(1, wakeups);
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -351,5 +351,56 @@ TEST_F(FileSystemImplTest, ExistingReadOnlyFileAndWrite) {
   EXPECT_EQ("existing file", contents);
 }
 
+TEST_F(FileSystemImplTest, TruncateExistingFile) {
+  const std::string file_path =
+      TestEnvironment::writeStringToFileForTest("test_envoy", "existing file");
+
+  {
+    static constexpr FlagSet flag{1 << Filesystem::File::Operation::Write |
+                                  1 << Filesystem::File::Operation::Truncate};
+    FilePtr file = file_system_.createFile(file_path);
+    const Api::IoCallBoolResult open_result = file->open(flag);
+    EXPECT_TRUE(open_result.rc_);
+    const Api::IoCallSizeResult result = file->write("new");
+    EXPECT_EQ(3, result.rc_);
+  }
+
+  auto contents = TestEnvironment::readFileToStringForTest(file_path);
+  EXPECT_EQ("new", contents);
+}
+
+TEST_F(FileSystemImplTest, Sync) {
+  const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
+  ::unlink(new_file_path.c_str());
+
+  FilePtr file = file_system_.createFile(new_file_path);
+  const Api::IoCallBoolResult open_result = file->open(DefaultFlags);
+  EXPECT_TRUE(open_result.rc_);
+  const Api::IoCallSizeResult write_result = file->write("data");
+  EXPECT_EQ(4, write_result.rc_);
+  const Api::IoCallBoolResult sync_result = file->sync();
+  EXPECT_TRUE(sync_result.rc_);
+}
+
+TEST_F(FileSystemImplTest, RenameReplacesExistingFile) {
+  const std::string old_path = TestEnvironment::writeStringToFileForTest("test_envoy_old", "new");
+  const std::string new_path = TestEnvironment::writeStringToFileForTest("test_envoy_new", "old");
+
+  const Api::IoCallBoolResult result = file_system_.rename(old_path, new_path);
+  EXPECT_TRUE(result.rc_);
+  EXPECT_FALSE(file_system_.fileExists(old_path));
+  EXPECT_EQ("new", TestEnvironment::readFileToStringForTest(new_path));
+}
+
+TEST_F(FileSystemImplTest, RenameNonExistingFile) {
+  const std::string old_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
+  ::unlink(old_path.c_str());
+
+  const Api::IoCallBoolResult result =
+      file_system_.rename(old_path, TestEnvironment::temporaryPath("envoy_new_path"));
+  EXPECT_FALSE(result.rc_);
+  EXPECT_NE(nullptr, result.err_);
+}
+
 } // namespace Filesystem
 } // namespace Envoy
@@ -349,6 +349,32 @@ TEST(HeaderStringTest, All) {
     EXPECT_EQ(5U, string.size());
     EXPECT_FALSE(string.isReference());
   }
+
+  // Shared string, copied when modified and shared when moved
+  {
+    const SharedHeaderString shared = std::make_shared<const std::string>(std::string(200, 'a'));
+    HeaderString string;
+    string.setShared(shared);
+    EXPECT_FALSE(string.isReference());
+    EXPECT_EQ(200U, string.size());
+    EXPECT_EQ(shared->data(), string.getStringView().data());
+    EXPECT_EQ(2, shared.use_count());
+
+    HeaderString moved(std::move(string));
+    EXPECT_EQ(shared->data(), moved.getStringView().data());
+    EXPECT_EQ(2, shared.use_count());
+    EXPECT_EQ(0U, string.size()); // NOLINT(bugprone-use-after-move)
+
+    moved.append("b", 1);
+    EXPECT_EQ(std::string(200, 'a') + "b", moved.getStringView());
+    EXPECT_EQ(1, shared.use_count());
+    EXPECT_EQ(std::string(200, 'a'), *shared);
+
+    moved.setShared(shared);
+    moved.clear();
+    EXPECT_EQ(0U, moved.size());
+    EXPECT_EQ(1, shared.use_count());
+  }
 }
 
 #define TEST_INLINE_HEADER_FUNCS(name)                                                             \
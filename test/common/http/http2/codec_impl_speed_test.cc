@@ -0,0 +1,320 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/core/v3/protocol.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/http/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+// The response the server answers each request with.
+struct BenchmarkResponse {
+  ResponseHeaderMapPtr headers_{
+      createHeaderMap<ResponseHeaderMapImpl>({{Headers::get().Status, "200"}})};
+  std::string body_;
+  ResponseTrailerMapPtr trailers_;
+};
+
+// Drains the request, and answers it once it is complete.
+class BenchmarkRequestDecoder : public RequestDecoder {
+public:
+  BenchmarkRequestDecoder(ResponseEncoder& encoder, const BenchmarkResponse& response)
+      : encoder_(encoder), response_(response) {}
+
+  // Http::StreamDecoder
+  void decodeData(Buffer::Instance& data, bool end_stream) override {
+    data.drain(data.length());
+    if (end_stream) {
+      respond();
+    }
+  }
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+  // Http::RequestDecoder
+  void decodeHeaders(RequestHeaderMapPtr&&, bool end_stream) override {
+    if (end_stream) {
+      respond();
+    }
+  }
+  void decodeTrailers(RequestTrailerMapPtr&&) override { respond(); }
+
+private:
+  void respond() {
+    const bool headers_only = response_.body_.empty() && response_.trailers_ == nullptr;
+    encoder_.encodeHeaders(*response_.headers_, headers_only);
+    if (!response_.body_.empty()) {
+      Buffer::OwnedImpl body(response_.body_);
+      encoder_.encodeData(body, response_.trailers_ == nullptr);
+    }
+    if (response_.trailers_ != nullptr) {
+      encoder_.encodeTrailers(*response_.trailers_);
+    }
+  }
+
+  ResponseEncoder& encoder_;
+  const BenchmarkResponse& response_;
+};
+
+// Counts the complete responses.
+class BenchmarkResponseDecoder : public ResponseDecoder {
+public:
+  // Http::StreamDecoder
+  void decodeData(Buffer::Instance& data, bool end_stream) override {
+    data.drain(data.length());
+    responses_ += end_stream;
+  }
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+  // Http::ResponseDecoder
+  void decode100ContinueHeaders(ResponseHeaderMapPtr&&) override {}
+  void decodeHeaders(ResponseHeaderMapPtr&&, bool end_stream) override { responses_ += end_stream; }
+  void decodeTrailers(ResponseTrailerMapPtr&&) override { responses_++; }
+
+  uint64_t responses_{};
+};
+
+/**
+ * A client and a server codec connected through in-memory buffers, with the default HTTP/2
+ * options, so that requests and responses go through both codecs end to end. The pair serves as
+ * the connection callbacks of both codecs.
+ */
+class CodecPair : public ServerConnectionCallbacks {
+public:
+  explicit CodecPair(BenchmarkResponse response = {})
+      : options_(::Envoy::Http2::Utility::initializeAndValidateOptions(
+            envoy::config::core::v3::Http2ProtocolOptions())),
+        response_(std::move(response)) {
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) { to_server_.move(data); }));
+    ON_CALL(server_connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) { to_client_.move(data); }));
+    EXPECT_CALL(client_connection_.dispatcher_, deferredDelete_(_)).Times(AnyNumber());
+    EXPECT_CALL(server_connection_.dispatcher_, deferredDelete_(_)).Times(AnyNumber());
+    client_ = std::make_unique<ClientConnectionImpl>(
+        client_connection_, *this, stats_store_, options_,
+        DEFAULT_MAX_REQUEST_HEADERS_KB, DEFAULT_MAX_HEADERS_COUNT,
+        ProdNghttp2SessionFactory::get());
+    server_ = std::make_unique<ServerConnectionImpl>(
+        server_connection_, *this, stats_store_, options_, DEFAULT_MAX_REQUEST_HEADERS_KB,
+        DEFAULT_MAX_HEADERS_COUNT, envoy::config::core::v3::HttpProtocolOptions::ALLOW);
+  }
+
+  RequestEncoder& newStream() { return client_->newStream(response_decoder_); }
+
+  // Dispatches the bytes written by each codec to the other one, until neither has more to send.
+  // Every stream is complete by then, so the streams and their decoders are deleted.
+  void flush() {
+    while (to_server_.length() > 0 || to_client_.length() > 0) {
+      if (to_server_.length() > 0) {
+        server_->dispatch(to_server_);
+      }
+      if (to_client_.length() > 0) {
+        client_->dispatch(to_client_);
+      }
+    }
+    client_connection_.dispatcher_.to_delete_.clear();
+    server_connection_.dispatcher_.to_delete_.clear();
+    request_decoders_.clear();
+  }
+
+  uint64_t responses() const { return response_decoder_.responses_; }
+
+  // Http::ConnectionCallbacks
+  void onGoAway() override {}
+
+  // Http::ServerConnectionCallbacks
+  RequestDecoder& newStream(ResponseEncoder& response_encoder, bool) override {
+    request_decoders_.push_back(
+        std::make_unique<BenchmarkRequestDecoder>(response_encoder, response_));
+    return *request_decoders_.back();
+  }
+
+private:
+  const envoy::config::core::v3::Http2ProtocolOptions options_;
+  const BenchmarkResponse response_;
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<Network::MockConnection> client_connection_;
+  NiceMock<Network::MockConnection> server_connection_;
+  std::unique_ptr<ClientConnectionImpl> client_;
+  std::unique_ptr<ServerConnectionImpl> server_;
+  Buffer::OwnedImpl to_server_;
+  Buffer::OwnedImpl to_client_;
+  BenchmarkResponseDecoder response_decoder_;
+  std::vector<std::unique_ptr<BenchmarkRequestDecoder>> request_decoders_;
+};
+
+const RequestHeaderMapPtr& postHeaders() {
+  static const auto* headers = new RequestHeaderMapPtr(
+      createHeaderMap<RequestHeaderMapImpl>({{Headers::get().Method, "POST"},
+                                             {Headers::get().Path, "/upload"},
+                                             {Headers::get().Scheme, "https"},
+                                             {Headers::get().Host, "example.com"}}));
+  return *headers;
+}
+
+// Uploads a body made of slices of the given size, which don't line up with the DATA frames, as
+// with bodies read from a socket. The body bytes are referenced rather than copied into the body.
+static void Http2CodecUpload(benchmark::State& state) {
+  const uint64_t body_size = state.range(0);
+  const uint64_t slice_size = state.range(1);
+  const std::string data(slice_size, 'a');
+  std::vector<std::unique_ptr<Buffer::BufferFragmentImpl>> fragments;
+  for (uint64_t size = 0; size < body_size; size += slice_size) {
+    fragments.push_back(
+        std::make_unique<Buffer::BufferFragmentImpl>(data.data(), data.size(), nullptr));
+  }
+
+  CodecPair codecs;
+  for (auto _ : state) {
+    Buffer::OwnedImpl body;
+    for (const auto& fragment : fragments) {
+      body.addBufferFragment(*fragment);
+    }
+    RequestEncoder& encoder = codecs.newStream();
+    encoder.encodeHeaders(*postHeaders(), false);
+    encoder.encodeData(body, true);
+    codecs.flush();
+  }
+  benchmark::DoNotOptimize(codecs.responses());
+  state.SetBytesProcessed(state.iterations() * fragments.size() * slice_size);
+}
+BENCHMARK(Http2CodecUpload)
+    ->Args({64 * 1024, 10000})
+    ->Args({1024 * 1024, 10000})
+    ->Args({1024 * 1024, 16 * 1024})
+    ->Args({1024 * 1024, 64 * 1024});
+
+// A small gRPC unary call: a request message, and a response message followed by trailers.
+static void Http2CodecGrpcUnary(benchmark::State& state) {
+  BenchmarkResponse response;
+  response.headers_ = createHeaderMap<ResponseHeaderMapImpl>(
+      {{Headers::get().Status, "200"},
+       {Headers::get().ContentType, Headers::get().ContentTypeValues.Grpc}});
+  response.body_ = std::string(128, 'r');
+  response.trailers_ = createHeaderMap<ResponseTrailerMapImpl>(
+      {{Headers::get().GrpcStatus, "0"}, {Headers::get().GrpcMessage, "OK"}});
+  const RequestHeaderMapPtr request_headers = createHeaderMap<RequestHeaderMapImpl>(
+      {{Headers::get().Method, "POST"},
+       {Headers::get().Path, "/helloworld.Greeter/SayHello"},
+       {Headers::get().Scheme, "http"},
+       {Headers::get().Host, "greeter.example.com"},
+       {Headers::get().ContentType, Headers::get().ContentTypeValues.Grpc},
+       {Headers::get().TE, Headers::get().TEValues.Trailers},
+       {Headers::get().GrpcTimeout, "1S"},
+       {Headers::get().UserAgent, "grpc-c++/1.29.1 grpc-c/9.0.0 (linux; chttp2)"}});
+  const std::string message(64, 'q');
+
+  CodecPair codecs(std::move(response));
+  for (auto _ : state) {
+    RequestEncoder& encoder = codecs.newStream();
+    encoder.encodeHeaders(*request_headers, false);
+    Buffer::OwnedImpl body(message);
+    encoder.encodeData(body, true);
+    codecs.flush();
+  }
+  benchmark::DoNotOptimize(codecs.responses());
+}
+BENCHMARK(Http2CodecGrpcUnary);
+
+// Opens as many concurrent streams as the argument before dispatching any of them, so that each
+// dispatch carries the frames of many streams.
+static void Http2CodecConcurrentStreams(benchmark::State& state) {
+  const RequestHeaderMapPtr request_headers = createHeaderMap<RequestHeaderMapImpl>(
+      {{Headers::get().Method, "GET"},
+       {Headers::get().Path, "/"},
+       {Headers::get().Scheme, "https"},
+       {Headers::get().Host, "example.com"}});
+  BenchmarkResponse response;
+  response.body_ = std::string(1024, 'r');
+
+  CodecPair codecs(std::move(response));
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); i++) {
+      codecs.newStream().encodeHeaders(*request_headers, true);
+    }
+    codecs.flush();
+  }
+  benchmark::DoNotOptimize(codecs.responses());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Http2CodecConcurrentStreams)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+// A browser-like request and response, with many headers, most of which repeat across requests so
+// that they are encoded from the HPACK dynamic tables. The argument is the number of headers which
+// change with every request instead, as request IDs and tracing headers do.
+static void Http2CodecHpackHeaders(benchmark::State& state) {
+  BenchmarkResponse response;
+  response.headers_ = createHeaderMap<ResponseHeaderMapImpl>(
+      {{Headers::get().Status, "200"},
+       {Headers::get().ContentType, "text/html; charset=utf-8"},
+       {LowerCaseString("cache-control"), "private, max-age=0, must-revalidate"},
+       {LowerCaseString("date"), "Wed, 23 Jan 2019 04:00:00 GMT"},
+       {LowerCaseString("server"), "envoy"},
+       {LowerCaseString("strict-transport-security"), "max-age=31536000; includeSubDomains"},
+       {LowerCaseString("vary"), "accept-encoding"},
+       {LowerCaseString("x-frame-options"), "SAMEORIGIN"},
+       {Headers::get().XContentTypeOptions, "nosniff"},
+       {Headers::get().SetCookie, "session=0123456789abcdef0123456789abcdef; path=/; secure"},
+       {Headers::get().SetCookie, "preferences=dark-mode; path=/; max-age=31536000"}});
+  const RequestHeaderMapPtr request_headers = createHeaderMap<RequestHeaderMapImpl>(
+      {{Headers::get().Method, "GET"},
+       {Headers::get().Path, "/static/js/app.0123456789abcdef.js"},
+       {Headers::get().Scheme, "https"},
+       {Headers::get().Host, "www.example.com"},
+       {Headers::get().UserAgent, "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, "
+                                  "like Gecko) Chrome/83.0.4103.61 Safari/537.36"},
+       {Headers::get().Accept, "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,"
+                               "image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.9"},
+       {Headers::get().AcceptEncoding, "gzip, deflate, br"},
+       {LowerCaseString("accept-language"), "en-US,en;q=0.9"},
+       {LowerCaseString("referer"), "https://www.example.com/"},
+       {Headers::get().Cookie, "session=0123456789abcdef0123456789abcdef"},
+       {Headers::get().Cookie, "preferences=dark-mode"},
+       {Headers::get().Cookie, "_ga=GA1.2.1234567890.1234567890"},
+       {LowerCaseString("sec-fetch-site"), "same-origin"},
+       {LowerCaseString("sec-fetch-mode"), "no-cors"},
+       {LowerCaseString("sec-fetch-dest"), "script"}});
+  std::vector<LowerCaseString> changing_headers;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    changing_headers.emplace_back(absl::StrCat("x-changing-header-", i));
+  }
+
+  CodecPair codecs(std::move(response));
+  uint64_t request = 0;
+  for (auto _ : state) {
+    for (const LowerCaseString& header : changing_headers) {
+      request_headers->setCopy(header, absl::StrCat("0123456789abcdef-", request));
+    }
+    request++;
+    codecs.newStream().encodeHeaders(*request_headers, true);
+    codecs.flush();
+  }
+  benchmark::DoNotOptimize(codecs.responses());
+}
+BENCHMARK(Http2CodecHpackHeaders)->Arg(0)->Arg(1)->Arg(4);
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
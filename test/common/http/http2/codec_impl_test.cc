@@ -11,6 +11,7 @@
 #include "test/common/http/common.h"
 #include "test/common/http/http2/http2_frame.h"
 #include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/buffer/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/init/mocks.h"
 #include "test/mocks/local_info/mocks.h"
@@ -572,6 +573,27 @@ TEST_P(Http2CodecImplTest, TrailingHeadersLargeBody) {
   response_encoder_->encodeTrailers(TestResponseTrailerMapImpl{{"trailing", "header"}});
 }
 
+// DATA frames end on slice boundaries of the body, so that slices are moved rather than copied.
+TEST_P(Http2CodecImplTest, DataFramesEndOnSliceBoundaries) {
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  Buffer::OwnedImpl body;
+  for (int i = 0; i < 3; i++) {
+    Buffer::OwnedImpl slice(std::string(10000, 'a'));
+    body.move(slice);
+  }
+  ASSERT_EQ(3, body.getRawSlices().size());
+  EXPECT_CALL(request_decoder_, decodeData(BufferStringEqual(std::string(10000, 'a')), false))
+      .Times(2);
+  EXPECT_CALL(request_decoder_, decodeData(BufferStringEqual(std::string(10000, 'a')), true));
+  request_encoder_->encodeData(body, true);
+}
+
 TEST_P(Http2CodecImplTest, SmallMetadataVecTest) {
   allow_metadata_ = true;
   initialize();
@@ -0,0 +1,74 @@
+#include <string>
+
+#include "common/http/http2/header_value_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+// Short values are copied inline rather than cached.
+TEST(HeaderValueCacheTest, ShortValue) {
+  HeaderValueCache cache;
+  HeaderString string;
+  cache.setValue(string, "application/grpc");
+  EXPECT_EQ("application/grpc", string.getStringView());
+  EXPECT_EQ(0, cache.size());
+}
+
+// Long values are shared by the header strings set to them.
+TEST(HeaderValueCacheTest, SharedValue) {
+  HeaderValueCache cache;
+  const std::string value(200, 'a');
+  HeaderString first;
+  HeaderString second;
+  cache.setValue(first, value);
+  cache.setValue(second, value);
+  EXPECT_EQ(value, first.getStringView());
+  EXPECT_NE(value.data(), first.getStringView().data());
+  EXPECT_EQ(first.getStringView().data(), second.getStringView().data());
+  EXPECT_EQ(1, cache.size());
+
+  // The value outlives the cache.
+  HeaderString copied;
+  {
+    HeaderValueCache other;
+    other.setValue(copied, value);
+  }
+  EXPECT_EQ(value, copied.getStringView());
+}
+
+// Values longer than the maximum are copied.
+TEST(HeaderValueCacheTest, LargeValue) {
+  HeaderValueCache cache;
+  HeaderString string;
+  const std::string value(HeaderValueCache::MaxValueSize + 1, 'a');
+  cache.setValue(string, value);
+  EXPECT_EQ(value, string.getStringView());
+  EXPECT_EQ(0, cache.size());
+}
+
+// The cache is emptied once full, without affecting the header strings set from it.
+TEST(HeaderValueCacheTest, Full) {
+  HeaderValueCache cache;
+  HeaderString first;
+  cache.setValue(first, std::string(HeaderValueCache::MaxValueSize, 'a'));
+  for (char c = 'b'; c < 'e'; c++) {
+    HeaderString string;
+    cache.setValue(string, std::string(HeaderValueCache::MaxValueSize, c));
+  }
+  EXPECT_EQ(HeaderValueCache::MaxCacheSize / HeaderValueCache::MaxValueSize, cache.size());
+
+  HeaderString last;
+  cache.setValue(last, std::string(HeaderValueCache::MaxValueSize, 'e'));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(std::string(HeaderValueCache::MaxValueSize, 'a'), first.getStringView());
+  EXPECT_EQ(std::string(HeaderValueCache::MaxValueSize, 'e'), last.getStringView());
+}
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -502,6 +502,38 @@ TEST_P(ConnectionImplTest, ReadDisable) {
   disconnect(false);
 }
 
+class MockRawIoCallbacks : public RawIoCallbacks {
+public:
+  MOCK_METHOD(void, onRawIoReady, ());
+};
+
+// Tests that the connection reads its socket again once the raw I/O callbacks give it back.
+TEST_P(ConnectionImplTest, StopRawIo) {
+  setUpBasicConnection();
+  connect();
+
+  ASSERT_NE(nullptr, server_connection_->rawIoHandle());
+  MockRawIoCallbacks raw_io_callbacks;
+  EXPECT_CALL(raw_io_callbacks, onRawIoReady()).WillRepeatedly(Invoke([&]() -> void {
+    dispatcher_->exit();
+  }));
+  server_connection_->startRawIo(raw_io_callbacks);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  server_connection_->stopRawIo();
+  EXPECT_CALL(raw_io_callbacks, onRawIoReady()).Times(0);
+  EXPECT_CALL(*read_filter_, onData(BufferStringEqual("data"), false))
+      .WillOnce(Invoke([&](Buffer::Instance&, bool) -> FilterStatus {
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl buffer("data");
+  client_connection_->write(buffer, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  disconnect(true);
+}
+
 // The HTTP/1 codec handles pipelined connections by relying on readDisable(false) resulting in the
 // subsequent request being dispatched. Regression test this behavior.
 TEST_P(ConnectionImplTest, ReadEnableDispatches) {
@@ -0,0 +1,237 @@
+#include <chrono>
+#include <csignal>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/profiler/sampling_profiler.h"
+#include "common/protobuf/protobuf.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Profiler {
+namespace {
+
+// The fields of a perftools.profiles.Profile message, decoded without its generated code.
+class DecodedProfile {
+public:
+  explicit DecodedProfile(const std::string& serialized) {
+    EXPECT_TRUE(profile_.ParseFromString(serialized));
+  }
+
+  // UnknownFieldSet cannot be moved, so the messages are held in a deque.
+  std::deque<Protobuf::UnknownFieldSet> messages(int field) const {
+    std::deque<Protobuf::UnknownFieldSet> result;
+    for (int i = 0; i < profile_.field_count(); ++i) {
+      if (profile_.field(i).number() == field) {
+        result.emplace_back();
+        EXPECT_TRUE(result.back().ParseFromString(profile_.field(i).length_delimited()));
+      }
+    }
+    return result;
+  }
+
+  std::vector<std::string> strings() const {
+    std::vector<std::string> result;
+    for (int i = 0; i < profile_.field_count(); ++i) {
+      if (profile_.field(i).number() == 6) {
+        result.push_back(profile_.field(i).length_delimited());
+      }
+    }
+    return result;
+  }
+
+  uint64_t varint(int field) const { return varintOf(profile_, field); }
+
+  static uint64_t varintOf(const Protobuf::UnknownFieldSet& message, int field) {
+    for (int i = 0; i < message.field_count(); ++i) {
+      if (message.field(i).number() == field) {
+        return message.field(i).varint();
+      }
+    }
+    return 0;
+  }
+
+  static std::vector<uint64_t> packedOf(const Protobuf::UnknownFieldSet& message, int field) {
+    std::vector<uint64_t> result;
+    for (int i = 0; i < message.field_count(); ++i) {
+      if (message.field(i).number() == field) {
+        Protobuf::io::CodedInputStream input(
+            reinterpret_cast<const uint8_t*>(message.field(i).length_delimited().data()),
+            message.field(i).length_delimited().size());
+        uint64_t value;
+        while (input.ReadVarint64(&value)) {
+          result.push_back(value);
+        }
+      }
+    }
+    return result;
+  }
+
+  // Label values of a sample, keyed by label name.
+  std::map<std::string, std::string> labels(const Protobuf::UnknownFieldSet& sample) const {
+    const std::vector<std::string> table = strings();
+    std::map<std::string, std::string> result;
+    for (int i = 0; i < sample.field_count(); ++i) {
+      if (sample.field(i).number() == 3) {
+        Protobuf::UnknownFieldSet label;
+        EXPECT_TRUE(label.ParseFromString(sample.field(i).length_delimited()));
+        result[table[varintOf(label, 1)]] = table[varintOf(label, 2)];
+      }
+    }
+    return result;
+  }
+
+  // Function name of each frame of a sample, innermost first.
+  std::vector<std::string> stack(const Protobuf::UnknownFieldSet& sample) const {
+    const std::vector<std::string> table = strings();
+    const std::deque<Protobuf::UnknownFieldSet> locations = messages(4);
+    const std::deque<Protobuf::UnknownFieldSet> functions = messages(5);
+    std::vector<std::string> result;
+    for (const uint64_t location_id : packedOf(sample, 1)) {
+      const Protobuf::UnknownFieldSet& location = locations.at(location_id - 1);
+      EXPECT_EQ(location_id, varintOf(location, 1));
+      Protobuf::UnknownFieldSet line;
+      EXPECT_TRUE(line.ParseFromString(location.field(location.field_count() - 1)
+                                           .length_delimited()));
+      const Protobuf::UnknownFieldSet& function = functions.at(varintOf(line, 1) - 1);
+      result.push_back(table[varintOf(function, 2)]);
+    }
+    return result;
+  }
+
+private:
+  Protobuf::UnknownFieldSet profile_;
+};
+
+const void* address(uintptr_t value) { return reinterpret_cast<const void*>(value); }
+
+TEST(PprofProfileBuilderTest, Empty) {
+  PprofProfileBuilder builder(1000);
+  DecodedProfile profile(builder.serialize(5, 6));
+  EXPECT_EQ(0, profile.messages(2).size());
+  EXPECT_EQ("", profile.strings()[0]);
+  EXPECT_EQ(5, profile.varint(9));
+  EXPECT_EQ(6, profile.varint(10));
+  EXPECT_EQ(1000, profile.varint(12));
+  EXPECT_EQ(2, profile.messages(1).size());
+}
+
+TEST(PprofProfileBuilderTest, AggregatesIdenticalSamples) {
+  std::vector<uintptr_t> symbolized;
+  PprofProfileBuilder builder(1000, [&symbolized](const void* address) {
+    symbolized.push_back(reinterpret_cast<uintptr_t>(address));
+    return reinterpret_cast<uintptr_t>(address) < 0x200 ? "low" : "high";
+  });
+  builder.addSample({address(0x100), address(0x201)}, "worker_0", "Envoy::ActiveStream");
+  builder.addSample({address(0x100), address(0x201)}, "worker_0", "Envoy::ActiveStream");
+  builder.addSample({address(0x100), address(0x201)}, "worker_1", "");
+  builder.addSample({address(0x101)}, "worker_0", "");
+
+  // Addresses are symbolized once, and return addresses before the call returns to.
+  EXPECT_EQ((std::vector<uintptr_t>{0x100, 0x200, 0x101}), symbolized);
+
+  DecodedProfile profile(builder.serialize(0, 0));
+  const std::deque<Protobuf::UnknownFieldSet> samples = profile.messages(2);
+  ASSERT_EQ(3, samples.size());
+
+  EXPECT_EQ((std::vector<uint64_t>{2, 2000}), DecodedProfile::packedOf(samples[0], 2));
+  EXPECT_EQ((std::vector<std::string>{"low", "high"}), profile.stack(samples[0]));
+  EXPECT_EQ((std::map<std::string, std::string>{{"thread", "worker_0"},
+                                                {"scope", "Envoy::ActiveStream"}}),
+            profile.labels(samples[0]));
+
+  EXPECT_EQ((std::vector<uint64_t>{1, 1000}), DecodedProfile::packedOf(samples[1], 2));
+  EXPECT_EQ((std::map<std::string, std::string>{{"thread", "worker_1"}}),
+            profile.labels(samples[1]));
+
+  // Functions are shared by locations with the same name.
+  EXPECT_EQ((std::vector<std::string>{"low"}), profile.stack(samples[2]));
+  EXPECT_EQ(3, profile.messages(4).size());
+  EXPECT_EQ(2, profile.messages(5).size());
+}
+
+class TrackedObject : public ScopeTrackedObject {
+public:
+  void dumpState(std::ostream&, int) const override {}
+};
+
+uint64_t threadCpuTimeNs() {
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+TEST(SamplingProfilerTest, SamplesRegisteredThread) {
+  if (!SamplingProfiler::supported()) {
+    EXPECT_FALSE(SamplingProfiler::start(SamplingProfiler::DefaultFrequencyHz));
+    return;
+  }
+
+  TrackedObject object;
+  const ScopeTrackedObject* current_object = &object;
+  SamplingProfiler::ThreadRegistration registration("test_thread", current_object);
+
+  EXPECT_FALSE(SamplingProfiler::isRunning());
+  ASSERT_TRUE(SamplingProfiler::start(SamplingProfiler::MaxFrequencyHz));
+  EXPECT_TRUE(SamplingProfiler::isRunning());
+  EXPECT_FALSE(SamplingProfiler::start(SamplingProfiler::MaxFrequencyHz));
+
+  // Burn enough CPU time for a few dozen samples.
+  const uint64_t start_ns = threadCpuTimeNs();
+  volatile uint64_t sink = 0;
+  while (threadCpuTimeNs() - start_ns < 50000000) {
+    for (int i = 0; i < 10000; ++i) {
+      sink = sink + i;
+    }
+  }
+  SamplingProfiler::stop();
+  EXPECT_FALSE(SamplingProfiler::isRunning());
+
+  // Samples survive stopping the profiler.
+  DecodedProfile profile(SamplingProfiler::pprofProfile(absl::nullopt));
+  EXPECT_EQ(1000000, profile.varint(12));
+  uint64_t count = 0;
+  for (const Protobuf::UnknownFieldSet& sample : profile.messages(2)) {
+    const std::map<std::string, std::string> labels = profile.labels(sample);
+    if (labels.at("thread") == "test_thread") {
+      EXPECT_EQ("Envoy::Profiler::(anonymous namespace)::TrackedObject", labels.at("scope"));
+      EXPECT_FALSE(profile.stack(sample).empty());
+      count += DecodedProfile::packedOf(sample, 2)[0];
+    }
+  }
+  EXPECT_GT(count, 0);
+
+  // A tiny window excludes the samples taken before it.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  DecodedProfile recent(SamplingProfiler::pprofProfile(std::chrono::milliseconds(1)));
+  EXPECT_EQ(0, recent.messages(2).size());
+}
+
+// Another user of SIGPROF replacing the handler between runs does not silence the next run.
+TEST(SamplingProfilerTest, ReinstallsSignalHandler) {
+  if (!SamplingProfiler::supported()) {
+    return;
+  }
+
+  ASSERT_TRUE(SamplingProfiler::start(SamplingProfiler::DefaultFrequencyHz));
+  SamplingProfiler::stop();
+  struct sigaction action {};
+  action.sa_handler = SIG_IGN;
+  sigemptyset(&action.sa_mask);
+  ASSERT_EQ(0, sigaction(SIGPROF, &action, nullptr));
+
+  ASSERT_TRUE(SamplingProfiler::start(SamplingProfiler::DefaultFrequencyHz));
+  SamplingProfiler::stop();
+  struct sigaction current {};
+  ASSERT_EQ(0, sigaction(SIGPROF, nullptr, &current));
+  EXPECT_NE(0, current.sa_flags & SA_SIGINFO);
+}
+
+} // namespace
+} // namespace Profiler
+} // namespace Envoy
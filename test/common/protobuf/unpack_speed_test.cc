@@ -0,0 +1,109 @@
+// Measures unpacking the v2 clusters of an xDS update as v3 clusters, against unpacking v3 clusters
+// and against unpacking each v2 cluster as a dynamic message which is then upgraded, as
+// MessageUtil::unpackTo() used to.
+
+#include <string>
+
+#include "envoy/api/v2/cluster.pb.h"
+#include "envoy/config/cluster/v3/cluster.pb.h"
+
+#include "common/common/assert.h"
+#include "common/config/api_version.h"
+#include "common/config/version_converter.h"
+#include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
+
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace {
+
+const std::string ClusterYaml = R"EOF(
+type: EDS
+eds_cluster_config:
+  eds_config:
+    ads: {}
+connect_timeout: 0.25s
+lb_policy: LEAST_REQUEST
+http2_protocol_options:
+  max_concurrent_streams: 100
+circuit_breakers:
+  thresholds:
+  - priority: DEFAULT
+    max_connections: 1000
+    max_pending_requests: 1000
+    max_requests: 5000
+health_checks:
+- timeout: 1s
+  interval: 5s
+  unhealthy_threshold: 3
+  healthy_threshold: 2
+  http_health_check:
+    path: /healthz
+outlier_detection:
+  consecutive_5xx: 5
+  interval: 10s
+  base_ejection_time: 30s
+)EOF";
+
+template <class Cluster> Protobuf::RepeatedPtrField<ProtobufWkt::Any> clusters(int64_t count) {
+  Cluster cluster;
+  TestUtility::loadFromYaml(ClusterYaml, cluster);
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> clusters;
+  for (int64_t i = 0; i < count; i++) {
+    cluster.set_name(absl::StrCat("cluster_", i));
+    clusters.Add()->PackFrom(cluster);
+  }
+  return clusters;
+}
+
+void bmUnpackToSameVersion(benchmark::State& state) {
+  const auto resources = clusters<envoy::config::cluster::v3::Cluster>(state.range(0));
+  for (auto _ : state) {
+    for (const auto& resource : resources) {
+      envoy::config::cluster::v3::Cluster cluster;
+      MessageUtil::unpackTo(resource, cluster);
+      benchmark::DoNotOptimize(cluster);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bmUnpackToSameVersion)->Arg(1000);
+
+void bmUnpackToNextVersion(benchmark::State& state) {
+  const auto resources = clusters<API_NO_BOOST(envoy::api::v2::Cluster)>(state.range(0));
+  for (auto _ : state) {
+    for (const auto& resource : resources) {
+      envoy::config::cluster::v3::Cluster cluster;
+      MessageUtil::unpackTo(resource, cluster);
+      benchmark::DoNotOptimize(cluster);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bmUnpackToNextVersion)->Arg(1000);
+
+void bmUnpackDynamicAndUpgrade(benchmark::State& state) {
+  const auto resources = clusters<API_NO_BOOST(envoy::api::v2::Cluster)>(state.range(0));
+  const Protobuf::Descriptor* earlier_version_desc =
+      Protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName("envoy.api.v2.Cluster");
+  for (auto _ : state) {
+    for (const auto& resource : resources) {
+      Protobuf::DynamicMessageFactory dmf;
+      auto earlier_message =
+          ProtobufTypes::MessagePtr(dmf.GetPrototype(earlier_version_desc)->New());
+      RELEASE_ASSERT(resource.UnpackTo(earlier_message.get()), "");
+      envoy::config::cluster::v3::Cluster cluster;
+      Config::VersionConverter::upgrade(*earlier_message, cluster);
+      benchmark::DoNotOptimize(cluster);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bmUnpackDynamicAndUpgrade)->Arg(1000);
+
+} // namespace
+} // namespace Envoy
@@ -0,0 +1,256 @@
+// Measures hashing and comparing the protos which xDS updates diff, against hashing their
+// TextFormat rendering and MessageDifferencer::Equivalent(). Each update hashes every cluster and
+// listener it carries, so the time per message is multiplied by up to tens of thousands of
+// resources per update.
+
+#include <string>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/config/listener/v3/listener.pb.h"
+#include "envoy/extensions/filters/network/http_connection_manager/v3/http_connection_manager.pb.h"
+#include "envoy/extensions/filters/network/tcp_proxy/v3/tcp_proxy.pb.h"
+#include "envoy/extensions/transport_sockets/tls/v3/cert.pb.h"
+
+#include "common/common/hash.h"
+#include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace {
+
+const std::string ClusterYaml = R"EOF(
+name: backend
+type: EDS
+eds_cluster_config:
+  eds_config:
+    ads: {}
+connect_timeout: 0.25s
+lb_policy: LEAST_REQUEST
+http2_protocol_options:
+  max_concurrent_streams: 100
+circuit_breakers:
+  thresholds:
+  - priority: DEFAULT
+    max_connections: 1000
+    max_pending_requests: 1000
+    max_requests: 5000
+  - priority: HIGH
+    max_connections: 2000
+    max_requests: 10000
+health_checks:
+- timeout: 1s
+  interval: 5s
+  unhealthy_threshold: 3
+  healthy_threshold: 2
+  http_health_check:
+    path: /healthz
+    request_headers_to_add:
+    - header:
+        key: x-health-check
+        value: envoy
+outlier_detection:
+  consecutive_5xx: 5
+  interval: 10s
+  base_ejection_time: 30s
+  max_ejection_percent: 50
+common_lb_config:
+  healthy_panic_threshold:
+    value: 40
+metadata:
+  filter_metadata:
+    envoy.lb:
+      canary: false
+      version: v1.2.3
+      region: us-east-1
+      zone: us-east-1a
+transport_socket:
+  name: envoy.transport_sockets.tls
+  typed_config:
+    "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.v3.UpstreamTlsContext
+    sni: backend.example.com
+    common_tls_context:
+      alpn_protocols: [h2, http/1.1]
+      tls_params:
+        tls_minimum_protocol_version: TLSv1_2
+      validation_context:
+        trusted_ca:
+          filename: /etc/ssl/certs/ca-certificates.crt
+        match_subject_alt_names:
+        - exact: backend.example.com
+)EOF";
+
+const std::string ListenerYaml = R"EOF(
+name: ingress
+address:
+  socket_address:
+    address: 0.0.0.0
+    port_value: 443
+listener_filters:
+- name: envoy.filters.listener.tls_inspector
+filter_chains:
+- filter_chain_match:
+    server_names: [www.example.com, api.example.com]
+  transport_socket:
+    name: envoy.transport_sockets.tls
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.v3.DownstreamTlsContext
+      common_tls_context:
+        alpn_protocols: [h2, http/1.1]
+        tls_certificates:
+        - certificate_chain:
+            filename: /etc/envoy/example.com.crt
+          private_key:
+            filename: /etc/envoy/example.com.key
+  filters:
+  - name: envoy.filters.network.http_connection_manager
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.filters.network.http_connection_manager.v3.HttpConnectionManager
+      stat_prefix: ingress_https
+      codec_type: AUTO
+      use_remote_address: true
+      common_http_protocol_options:
+        idle_timeout: 300s
+      route_config:
+        name: local_route
+        virtual_hosts:
+        - name: www
+          domains: [www.example.com]
+          routes:
+          - match:
+              prefix: /static/
+            route:
+              cluster: static
+              timeout: 5s
+          - match:
+              prefix: /
+              headers:
+              - name: x-canary
+                exact_match: "true"
+            route:
+              cluster: www_canary
+          - match:
+              prefix: /
+            route:
+              cluster: www
+              retry_policy:
+                retry_on: 5xx,reset
+                num_retries: 2
+        - name: api
+          domains: [api.example.com]
+          routes:
+          - match:
+              safe_regex:
+                google_re2: {}
+                regex: /v[0-9]+/users/.*
+            route:
+              cluster: users
+          - match:
+              prefix: /
+            route:
+              cluster: api
+      http_filters:
+      - name: envoy.filters.http.router
+- filter_chain_match:
+    transport_protocol: raw_buffer
+  filters:
+  - name: envoy.filters.network.tcp_proxy
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.filters.network.tcp_proxy.v3.TcpProxy
+      stat_prefix: passthrough
+      cluster: passthrough
+)EOF";
+
+// MessageUtil::hash() before it walked messages with reflection.
+uint64_t textFormatHash(const Protobuf::Message& message) {
+  std::string text_format;
+  Protobuf::TextFormat::Printer printer;
+  printer.SetExpandAny(true);
+  printer.SetUseFieldNumber(true);
+  printer.SetSingleLineMode(true);
+  printer.PrintToString(message, &text_format);
+  return HashUtil::xxHash64(text_format);
+}
+
+template <class MessageType> MessageType load(const std::string& yaml) {
+  MessageType message;
+  TestUtility::loadFromYaml(yaml, message);
+  return message;
+}
+
+template <class MessageType> void bmHash(benchmark::State& state, const std::string& yaml) {
+  const MessageType message = load<MessageType>(yaml);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MessageUtil::hash(message));
+  }
+}
+
+template <class MessageType>
+void bmTextFormatHash(benchmark::State& state, const std::string& yaml) {
+  const MessageType message = load<MessageType>(yaml);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(textFormatHash(message));
+  }
+}
+
+template <class MessageType> void bmEqual(benchmark::State& state, const std::string& yaml) {
+  const MessageType lhs = load<MessageType>(yaml);
+  const MessageType rhs = load<MessageType>(yaml);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MessageUtil::equal(lhs, rhs));
+  }
+}
+
+template <class MessageType> void bmEquivalent(benchmark::State& state, const std::string& yaml) {
+  const MessageType lhs = load<MessageType>(yaml);
+  const MessageType rhs = load<MessageType>(yaml);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Protobuf::util::MessageDifferencer::Equivalent(lhs, rhs));
+  }
+}
+
+void BM_ClusterHash(benchmark::State& state) {
+  bmHash<envoy::config::cluster::v3::Cluster>(state, ClusterYaml);
+}
+BENCHMARK(BM_ClusterHash);
+
+void BM_ClusterTextFormatHash(benchmark::State& state) {
+  bmTextFormatHash<envoy::config::cluster::v3::Cluster>(state, ClusterYaml);
+}
+BENCHMARK(BM_ClusterTextFormatHash);
+
+void BM_ClusterEqual(benchmark::State& state) {
+  bmEqual<envoy::config::cluster::v3::Cluster>(state, ClusterYaml);
+}
+BENCHMARK(BM_ClusterEqual);
+
+void BM_ClusterEquivalent(benchmark::State& state) {
+  bmEquivalent<envoy::config::cluster::v3::Cluster>(state, ClusterYaml);
+}
+BENCHMARK(BM_ClusterEquivalent);
+
+void BM_ListenerHash(benchmark::State& state) {
+  bmHash<envoy::config::listener::v3::Listener>(state, ListenerYaml);
+}
+BENCHMARK(BM_ListenerHash);
+
+void BM_ListenerTextFormatHash(benchmark::State& state) {
+  bmTextFormatHash<envoy::config::listener::v3::Listener>(state, ListenerYaml);
+}
+BENCHMARK(BM_ListenerTextFormatHash);
+
+void BM_ListenerEqual(benchmark::State& state) {
+  bmEqual<envoy::config::listener::v3::Listener>(state, ListenerYaml);
+}
+BENCHMARK(BM_ListenerEqual);
+
+void BM_ListenerEquivalent(benchmark::State& state) {
+  bmEquivalent<envoy::config::listener::v3::Listener>(state, ListenerYaml);
+}
+BENCHMARK(BM_ListenerEquivalent);
+
+} // namespace
+} // namespace Envoy
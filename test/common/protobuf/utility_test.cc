@@ -12,6 +12,7 @@
 
 #include "common/common/base64.h"
 #include "common/config/api_version.h"
+#include "common/config/version_converter.h"
 #include "common/protobuf/message_validator_impl.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
@@ -154,6 +155,83 @@ TEST_F(ProtobufUtilityTest, MessageUtilHash) {
   EXPECT_NE(MessageUtil::hash(s), MessageUtil::hash(a1));
 }
 
+// The hash depends on the structure of messages, and not only on their values.
+TEST_F(ProtobufUtilityTest, MessageUtilHashStructure) {
+  ProtobufWkt::ListValue l1;
+  l1.add_values()->set_string_value("a");
+  l1.add_values()->set_string_value("b");
+  ProtobufWkt::ListValue l2;
+  l2.add_values()->set_string_value("b");
+  l2.add_values()->set_string_value("a");
+  ProtobufWkt::ListValue l3;
+  l3.add_values()->set_string_value("ab");
+  EXPECT_NE(MessageUtil::hash(l1), MessageUtil::hash(l2));
+  EXPECT_NE(MessageUtil::hash(l1), MessageUtil::hash(l3));
+
+  // A set empty message differs from an unset one.
+  ProtobufWkt::Value v1;
+  ProtobufWkt::Value v2;
+  v2.mutable_struct_value();
+  EXPECT_NE(MessageUtil::hash(v1), MessageUtil::hash(v2));
+
+  // Unknown fields are hashed too.
+  ProtobufWkt::Value v3;
+  v3.GetReflection()->MutableUnknownFields(&v3)->AddVarint(1000, 1);
+  EXPECT_NE(MessageUtil::hash(v1), MessageUtil::hash(v3));
+}
+
+// An Any of an unknown type is hashed with its serialized value.
+TEST_F(ProtobufUtilityTest, MessageUtilHashUnknownAny) {
+  ProtobufWkt::Any a1;
+  a1.set_type_url("type.googleapis.com/unknown.Type");
+  a1.set_value("a");
+  ProtobufWkt::Any a2 = a1;
+  EXPECT_EQ(MessageUtil::hash(a1), MessageUtil::hash(a2));
+  a2.set_value("b");
+  EXPECT_NE(MessageUtil::hash(a1), MessageUtil::hash(a2));
+}
+
+TEST_F(ProtobufUtilityTest, MessageUtilEqual) {
+  ProtobufWkt::Struct s1;
+  ProtobufWkt::Struct s2;
+  for (int i = 0; i < 10; i++) {
+    (*s1.mutable_fields())[absl::StrCat("key", i)].set_number_value(i);
+    (*s2.mutable_fields())[absl::StrCat("key", 9 - i)].set_number_value(9 - i);
+  }
+  EXPECT_TRUE(MessageUtil::equal(s1, s2));
+  EXPECT_TRUE(MessageUtil()(s1, s2));
+
+  // Equal messages packed with different map orders.
+  ProtobufWkt::Any a1;
+  a1.PackFrom(s1);
+  ProtobufWkt::Any a2 = a1;
+  a2.set_value(Base64::decode("CgsKA2NkZRIEGgJpagoLCgJhYhIFGgNmZ2g="));
+  ProtobufWkt::Any a3 = a1;
+  a3.set_value(Base64::decode("CgsKAmFiEgUaA2ZnaAoLCgNjZGUSBBoCaWo="));
+  EXPECT_FALSE(MessageUtil::equal(a1, a2));
+  EXPECT_TRUE(MessageUtil::equal(a2, a3));
+  EXPECT_EQ(MessageUtil::hash(a2), MessageUtil::hash(a3));
+
+  (*s2.mutable_fields())["key3"].set_string_value("3");
+  EXPECT_FALSE(MessageUtil::equal(s1, s2));
+  (*s2.mutable_fields())["key3"].set_number_value(3);
+  EXPECT_TRUE(MessageUtil::equal(s1, s2));
+  (*s2.mutable_fields())["key10"].set_number_value(10);
+  EXPECT_FALSE(MessageUtil::equal(s1, s2));
+
+  ProtobufWkt::Value v1;
+  ProtobufWkt::Value v2;
+  v2.mutable_struct_value();
+  EXPECT_FALSE(MessageUtil::equal(v1, v2));
+  EXPECT_FALSE(MessageUtil::equal(v1, s1));
+
+  // NaN equals itself, so that messages holding it can be looked up in hash containers.
+  ProtobufWkt::DoubleValue d1;
+  d1.set_value(std::numeric_limits<double>::quiet_NaN());
+  ProtobufWkt::DoubleValue d2 = d1;
+  EXPECT_TRUE(MessageUtil::equal(d1, d2));
+}
+
 TEST_F(ProtobufUtilityTest, RepeatedPtrUtilDebugString) {
   Protobuf::RepeatedPtrField<ProtobufWkt::UInt32Value> repeated;
   EXPECT_EQ("[]", RepeatedPtrUtil::debugString(repeated));
@@ -1181,6 +1259,39 @@ TEST_F(ProtobufUtilityTest, UnpackToNextVersion) {
   EXPECT_TRUE(dst.ignore_health_on_host_removal());
 }
 
+// MessageUtility::unpackTo() across version parses the earlier version as the next one, tracking
+// the original types as VersionConverter::upgrade() does.
+TEST_F(ProtobufUtilityTest, UnpackToNextVersionRecoverOriginal) {
+  API_NO_BOOST(envoy::api::v2::Cluster) source;
+  source.add_hosts();
+  source.mutable_load_assignment()->set_cluster_name("bar");
+  source.mutable_eds_cluster_config()->set_service_name("foo");
+  source.set_drain_connections_on_host_removal(true);
+  ProtobufWkt::Any source_any;
+  source_any.PackFrom(source);
+  API_NO_BOOST(envoy::config::cluster::v3::Cluster) dst;
+  MessageUtil::unpackTo(source_any, dst);
+
+  API_NO_BOOST(envoy::config::cluster::v3::Cluster) upgraded;
+  Config::VersionConverter::upgrade(source, upgraded);
+  EXPECT_EQ(upgraded.SerializeAsString(), dst.SerializeAsString());
+  EXPECT_THAT(*Config::VersionConverter::recoverOriginal(dst)->msg_, ProtoEq(source));
+  EXPECT_THAT(*Config::VersionConverter::recoverOriginal(dst.eds_cluster_config())->msg_,
+              ProtoEq(source.eds_cluster_config()));
+}
+
+// MessageUtility::unpackTo() across version throws when the earlier version can't be parsed.
+TEST_F(ProtobufUtilityTest, UnpackToNextVersionMalformed) {
+  API_NO_BOOST(envoy::api::v2::Cluster) source;
+  source.mutable_eds_cluster_config()->set_service_name("foo");
+  ProtobufWkt::Any source_any;
+  source_any.PackFrom(source);
+  source_any.mutable_value()->pop_back();
+  API_NO_BOOST(envoy::config::cluster::v3::Cluster) dst;
+  EXPECT_THROW_WITH_REGEX(MessageUtil::unpackTo(source_any, dst), EnvoyException,
+                          "Unable to unpack as envoy.api.v2.Cluster: .*");
+}
+
 // MessageUtility::loadFromJson() throws on garbage JSON.
 TEST_F(ProtobufUtilityTest, LoadFromJsonGarbage) {
   envoy::config::cluster::v3::Cluster dst;
@@ -6568,6 +6568,81 @@ virtual_hosts:
   }
 }
 
+class ReuseVirtualHostsTest : public RouteMatcherTest {
+protected:
+  ReuseVirtualHostsTest() {
+    route_config_ = parseRouteConfigurationFromV2Yaml(R"EOF(
+name: foo
+virtual_hosts:
+  - name: www
+    domains: ["www.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: www }
+  - name: api
+    domains: ["api.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: api }
+)EOF");
+  }
+
+  std::unique_ptr<ConfigImpl> build(bool validate_clusters, const ConfigImpl* previous) {
+    return std::make_unique<ConfigImpl>(route_config_, factory_context_,
+                                        ProtobufMessage::getNullValidationVisitor(),
+                                        validate_clusters, previous);
+  }
+
+  const VirtualHost& virtualHost(const ConfigImpl& config, const std::string& host) {
+    return config.route(genHeaders(host, "/", "GET"), stream_info_, 0)
+        ->routeEntry()
+        ->virtualHost();
+  }
+
+  envoy::config::route::v3::RouteConfiguration route_config_;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info_;
+};
+
+// Successive versions of a route configuration share the virtual hosts which did not change.
+TEST_F(ReuseVirtualHostsTest, ReuseUnchangedVirtualHosts) {
+  std::unique_ptr<ConfigImpl> first = build(false, nullptr);
+  route_config_.mutable_virtual_hosts(1)->mutable_routes(0)->mutable_route()->set_cluster("api2");
+  std::unique_ptr<ConfigImpl> second = build(false, first.get());
+
+  EXPECT_EQ(&virtualHost(*first, "www.lyft.com"), &virtualHost(*second, "www.lyft.com"));
+  EXPECT_NE(&virtualHost(*first, "api.lyft.com"), &virtualHost(*second, "api.lyft.com"));
+  EXPECT_EQ("api2", second->route(genHeaders("api.lyft.com", "/", "GET"), stream_info_, 0)
+                        ->routeEntry()
+                        ->clusterName());
+
+  // The shared virtual hosts outlive the version which built them.
+  first.reset();
+  const RouteConstSharedPtr route =
+      second->route(genHeaders("www.lyft.com", "/", "GET"), stream_info_, 0);
+  EXPECT_EQ("www", route->routeEntry()->clusterName());
+  EXPECT_EQ("foo", route->routeEntry()->virtualHost().routeConfig().name());
+}
+
+// No virtual host is shared when the configuration common to all of them changed.
+TEST_F(ReuseVirtualHostsTest, RebuildOnCommonConfigChange) {
+  std::unique_ptr<ConfigImpl> first = build(false, nullptr);
+  route_config_.add_internal_only_headers("x-internal");
+  std::unique_ptr<ConfigImpl> second = build(false, first.get());
+
+  EXPECT_NE(&virtualHost(*first, "www.lyft.com"), &virtualHost(*second, "www.lyft.com"));
+  EXPECT_NE(&virtualHost(*first, "api.lyft.com"), &virtualHost(*second, "api.lyft.com"));
+  EXPECT_EQ(1, virtualHost(*second, "www.lyft.com").routeConfig().internalOnlyHeaders().size());
+}
+
+// The clusters of shared virtual hosts are validated again.
+TEST_F(ReuseVirtualHostsTest, ValidateClustersOfReusedVirtualHosts) {
+  std::unique_ptr<ConfigImpl> first = build(true, nullptr);
+
+  EXPECT_CALL(factory_context_.cluster_manager_, get(Eq("www"))).WillRepeatedly(Return(nullptr));
+  EXPECT_THROW_WITH_MESSAGE(build(true, first.get()), EnvoyException,
+                            "route: unknown cluster 'www'");
+}
+
 TEST_F(RouteConfigurationV2, RegexPrefixWithNoRewriteWorksWhenPathChanged) {
 
   // Setup regex route entry. the regex is trivial, that's ok as we only want to test that
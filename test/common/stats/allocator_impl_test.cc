@@ -1,8 +1,12 @@
+#include <unistd.h>
+
 #include <string>
 
 #include "common/stats/allocator_impl.h"
+#include "common/stats/mapped_stats_region.h"
 #include "common/stats/symbol_table_creator.h"
 
+#include "test/test_common/environment.h"
 #include "test/test_common/logging.h"
 #include "test/test_common/thread_factory_for_test.h"
 
@@ -128,6 +132,60 @@ TEST_F(AllocatorImplTest, RefCountDecAllocRaceSynchronized) {
   EXPECT_FALSE(alloc_.isMutexLockedForTest());
 }
 
+// Counters and accumulating gauges allocated from a mapped region are shared with another
+// allocator mapping the same file, as happens across a hot restart.
+TEST_F(AllocatorImplTest, MappedStatsRegion) {
+  const std::string path = TestEnvironment::temporaryPath("allocator_mapped_stats_region");
+  MappedStatsRegionPtr parent_region = MappedStatsRegion::create(path, 16, true);
+  alloc_.setMappedStatsRegion(parent_region.get());
+  CounterSharedPtr parent_counter = alloc_.makeCounter(makeStat("counter"), StatName(), {});
+  GaugeSharedPtr parent_gauge =
+      alloc_.makeGauge(makeStat("gauge"), StatName(), {}, Gauge::ImportMode::Accumulate);
+  GaugeSharedPtr never_import =
+      alloc_.makeGauge(makeStat("never_import"), StatName(), {}, Gauge::ImportMode::NeverImport);
+  parent_counter->add(5);
+  parent_gauge->set(3);
+  never_import->set(7);
+  EXPECT_EQ(2, parent_region->numUsedSlots());
+  EXPECT_FALSE(parent_region->contains("never_import"));
+
+  SymbolTablePtr child_symbol_table = SymbolTableCreator::makeSymbolTable();
+  MappedStatsRegionPtr child_region = MappedStatsRegion::create(path, 16, false);
+  {
+    AllocatorImpl child_alloc(*child_symbol_table);
+    child_alloc.setMappedStatsRegion(child_region.get());
+    StatNamePool child_pool(*child_symbol_table);
+    CounterSharedPtr child_counter =
+        child_alloc.makeCounter(child_pool.add("counter"), StatName(), {});
+    GaugeSharedPtr child_gauge = child_alloc.makeGauge(child_pool.add("gauge"), StatName(), {},
+                                                       Gauge::ImportMode::Accumulate);
+
+    // The child starts from the parent's values, and sees them as used without having written.
+    EXPECT_EQ(5, child_counter->value());
+    EXPECT_TRUE(child_counter->used());
+    EXPECT_EQ(3, child_gauge->value());
+    EXPECT_TRUE(child_gauge->used());
+    EXPECT_EQ(Gauge::ImportMode::Accumulate, child_gauge->importMode());
+
+    // Updates from either process accrue into the same value, but each only latches its own.
+    child_counter->inc();
+    parent_counter->inc();
+    EXPECT_EQ(7, child_counter->value());
+    EXPECT_EQ(7, parent_counter->value());
+    EXPECT_EQ(6, parent_counter->latch());
+    EXPECT_EQ(1, child_counter->latch());
+    child_gauge->add(2);
+    parent_gauge->dec();
+    EXPECT_EQ(4, child_gauge->value());
+    EXPECT_EQ(4, parent_gauge->value());
+  }
+  parent_counter.reset();
+  parent_gauge.reset();
+  never_import.reset();
+  alloc_.setMappedStatsRegion(nullptr);
+  ::unlink(path.c_str());
+}
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
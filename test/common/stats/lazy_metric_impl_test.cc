@@ -0,0 +1,132 @@
+#include <string>
+
+#include "envoy/stats/stats_macros.h"
+
+#include "common/stats/isolated_store_impl.h"
+#include "common/stats/lazy_metric_impl.h"
+#include "common/stats/symbol_table_creator.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+#define LAZY_TEST_STATS(COUNTER, GAUGE, HISTOGRAM)                                                 \
+  COUNTER(requests)                                                                                \
+  GAUGE(active, Accumulate)                                                                        \
+  HISTOGRAM(latency, Milliseconds)
+
+struct LazyTestStats {
+  LAZY_TEST_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
+class LazyMetricImplTest : public testing::Test {
+protected:
+  LazyMetricImplTest()
+      : symbol_table_(SymbolTableCreator::makeSymbolTable()),
+        store_(std::make_unique<IsolatedStoreImpl>(*symbol_table_)),
+        names_(std::make_unique<LazyMetricNames>(*symbol_table_)),
+        scope_(store_->createScope("cluster.foo.")),
+        pool_(std::make_unique<LazyMetricPool>(*scope_, "cluster.foo.", *names_)),
+        stats_{LAZY_TEST_STATS(POOL_COUNTER(*pool_), POOL_GAUGE(*pool_), POOL_HISTOGRAM(*pool_))} {}
+  ~LazyMetricImplTest() override {
+    pool_.reset();
+    scope_.reset();
+    names_.reset();
+    store_.reset();
+    EXPECT_EQ(0, symbol_table_->numSymbols());
+  }
+
+  SymbolTablePtr symbol_table_;
+  std::unique_ptr<IsolatedStoreImpl> store_;
+  std::unique_ptr<LazyMetricNames> names_;
+  ScopePtr scope_;
+  std::unique_ptr<LazyMetricPool> pool_;
+  LazyTestStats stats_;
+};
+
+TEST_F(LazyMetricImplTest, NothingCreatedUntilWritten) {
+  EXPECT_EQ(0, stats_.requests_.value());
+  EXPECT_FALSE(stats_.requests_.used());
+  EXPECT_EQ(0, stats_.requests_.latch());
+  stats_.requests_.reset();
+  EXPECT_EQ(0, stats_.active_.value());
+  EXPECT_EQ(Gauge::ImportMode::Accumulate, stats_.active_.importMode());
+  EXPECT_EQ(Histogram::Unit::Milliseconds, stats_.latency_.unit());
+
+  // Setting an uncreated gauge to zero does not create it.
+  stats_.active_.set(0);
+
+  EXPECT_TRUE(store_->counters().empty());
+  EXPECT_TRUE(store_->gauges().empty());
+}
+
+TEST_F(LazyMetricImplTest, NameWithoutCreating) {
+  EXPECT_EQ("cluster.foo.requests", stats_.requests_.name());
+  EXPECT_EQ("cluster.foo.requests", symbol_table_->toString(stats_.requests_.statName()));
+  EXPECT_EQ("cluster.foo.active", stats_.active_.name());
+  EXPECT_EQ("cluster.foo.latency", stats_.latency_.name());
+  // Tags are only extracted once the metric is created.
+  EXPECT_TRUE(stats_.requests_.tags().empty());
+  EXPECT_EQ("cluster.foo.requests", stats_.requests_.tagExtractedName());
+
+  EXPECT_TRUE(store_->counters().empty());
+  EXPECT_TRUE(store_->gauges().empty());
+}
+
+TEST_F(LazyMetricImplTest, NamesSharedAcrossPools) {
+  ScopePtr scope = store_->createScope("cluster.bar.");
+  LazyMetricPool pool(*scope, "cluster.bar.", *names_);
+  LazyTestStats stats{LAZY_TEST_STATS(POOL_COUNTER(pool), POOL_GAUGE(pool), POOL_HISTOGRAM(pool))};
+  EXPECT_EQ("cluster.bar.requests", stats.requests_.name());
+  // The name is held once for both pools.
+  EXPECT_EQ(names_->add("requests").dataIncludingSize(),
+            names_->add("requests").dataIncludingSize());
+
+  stats.requests_.inc();
+  ASSERT_EQ(1, store_->counters().size());
+  EXPECT_EQ("cluster.bar.requests", store_->counters().front()->name());
+  EXPECT_EQ(0, stats_.requests_.value());
+}
+
+TEST_F(LazyMetricImplTest, CounterCreatedOnFirstWrite) {
+  stats_.requests_.inc();
+  stats_.requests_.add(2);
+  ASSERT_EQ(1, store_->counters().size());
+  Counter& counter = *store_->counters().front();
+  EXPECT_EQ("cluster.foo.requests", counter.name());
+  EXPECT_EQ(3, counter.value());
+  EXPECT_EQ(3, stats_.requests_.value());
+  EXPECT_TRUE(stats_.requests_.used());
+  EXPECT_EQ("cluster.foo.requests", stats_.requests_.name());
+  EXPECT_EQ(3, stats_.requests_.latch());
+  stats_.requests_.reset();
+  EXPECT_EQ(0, counter.value());
+  EXPECT_TRUE(store_->gauges().empty());
+}
+
+TEST_F(LazyMetricImplTest, GaugeCreatedOnFirstWrite) {
+  stats_.active_.inc();
+  ASSERT_EQ(1, store_->gauges().size());
+  Gauge& gauge = *store_->gauges().front();
+  EXPECT_EQ("cluster.foo.active", gauge.name());
+  EXPECT_EQ(1, gauge.value());
+  stats_.active_.add(4);
+  stats_.active_.sub(2);
+  stats_.active_.dec();
+  EXPECT_EQ(2, stats_.active_.value());
+
+  // Once created, setting to zero is forwarded.
+  stats_.active_.set(0);
+  EXPECT_EQ(0, gauge.value());
+}
+
+TEST_F(LazyMetricImplTest, HistogramCreatedOnFirstWrite) {
+  stats_.latency_.recordValue(10);
+  EXPECT_EQ("cluster.foo.latency", stats_.latency_.name());
+  EXPECT_EQ(Histogram::Unit::Milliseconds, stats_.latency_.unit());
+  EXPECT_TRUE(store_->counters().empty());
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,191 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include "common/stats/mapped_stats_region.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+class MappedStatsRegionTest : public testing::Test {
+protected:
+  MappedStatsRegionTest() : path_(TestEnvironment::temporaryPath("mapped_stats_region")) {
+    ::unlink(path_.c_str());
+  }
+  ~MappedStatsRegionTest() override { ::unlink(path_.c_str()); }
+
+  MappedStatsRegionPtr create(uint32_t num_slots, bool reset) {
+    return MappedStatsRegion::create(path_, num_slots, reset);
+  }
+
+  const std::string path_;
+};
+
+TEST_F(MappedStatsRegionTest, AllocateSameNameReturnsSameSlot) {
+  MappedStatsRegionPtr region = create(16, true);
+  EXPECT_EQ(16, region->numSlots());
+  EXPECT_EQ(0, region->numUsedSlots());
+  EXPECT_FALSE(region->contains("a.b"));
+
+  std::atomic<uint64_t>* a = region->allocate("a.b", MappedStatsRegion::Type::Counter);
+  ASSERT_NE(nullptr, a);
+  EXPECT_EQ(0, *a);
+  EXPECT_EQ(a, region->allocate("a.b", MappedStatsRegion::Type::Counter));
+  std::atomic<uint64_t>* c = region->allocate("c", MappedStatsRegion::Type::Gauge);
+  ASSERT_NE(nullptr, c);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(2, region->numUsedSlots());
+  EXPECT_TRUE(region->contains("a.b"));
+  EXPECT_TRUE(region->contains("c"));
+  EXPECT_FALSE(region->contains("a"));
+
+  region->release(a);
+  region->release(a);
+  region->release(c);
+}
+
+TEST_F(MappedStatsRegionTest, AdoptedBySecondMapping) {
+  MappedStatsRegionPtr parent = create(16, true);
+  std::atomic<uint64_t>* parent_value = parent->allocate("c", MappedStatsRegion::Type::Counter);
+  ASSERT_NE(nullptr, parent_value);
+  *parent_value += 42;
+
+  // The number of slots is taken from the existing region.
+  MappedStatsRegionPtr child = create(1024, false);
+  EXPECT_EQ(16, child->numSlots());
+  EXPECT_TRUE(child->contains("c"));
+  std::atomic<uint64_t>* child_value = child->allocate("c", MappedStatsRegion::Type::Counter);
+  ASSERT_NE(nullptr, child_value);
+  EXPECT_EQ(42, *child_value);
+
+  // Both mappings update the same value.
+  *child_value += 1;
+  EXPECT_EQ(43, *parent_value);
+  parent->release(parent_value);
+  parent.reset();
+  *child_value += 1;
+  EXPECT_EQ(44, *child_value);
+
+  // A slot keeps its value when no process references it.
+  child->release(child_value);
+  child_value = child->allocate("c", MappedStatsRegion::Type::Counter);
+  EXPECT_EQ(44, *child_value);
+  child->release(child_value);
+}
+
+TEST_F(MappedStatsRegionTest, ResetDiscardsContents) {
+  {
+    MappedStatsRegionPtr region = create(16, true);
+    *region->allocate("c", MappedStatsRegion::Type::Counter) = 5;
+  }
+  MappedStatsRegionPtr region = create(8, true);
+  EXPECT_EQ(8, region->numSlots());
+  EXPECT_EQ(0, region->numUsedSlots());
+  EXPECT_FALSE(region->contains("c"));
+}
+
+// Resetting the region leaves the one that earlier processes still have mapped untouched.
+TEST_F(MappedStatsRegionTest, ResetLeavesMappedRegion) {
+  MappedStatsRegionPtr parent = create(16, true);
+  std::atomic<uint64_t>* parent_value = parent->allocate("c", MappedStatsRegion::Type::Counter);
+  ASSERT_NE(nullptr, parent_value);
+  *parent_value = 5;
+
+  MappedStatsRegionPtr region = create(16, true);
+  EXPECT_FALSE(region->contains("c"));
+  EXPECT_EQ(5, *parent_value);
+  EXPECT_TRUE(parent->contains("c"));
+  EXPECT_EQ(1, parent->numUsedSlots());
+}
+
+TEST_F(MappedStatsRegionTest, CreatedWhenMissing) {
+  MappedStatsRegionPtr region = create(4, false);
+  EXPECT_EQ(4, region->numSlots());
+  EXPECT_NE(nullptr, region->allocate("c", MappedStatsRegion::Type::Counter));
+}
+
+TEST_F(MappedStatsRegionTest, TypeMismatch) {
+  MappedStatsRegionPtr region = create(16, true);
+  ASSERT_NE(nullptr, region->allocate("stat", MappedStatsRegion::Type::Counter));
+  EXPECT_EQ(nullptr, region->allocate("stat", MappedStatsRegion::Type::Gauge));
+}
+
+TEST_F(MappedStatsRegionTest, NameTooLong) {
+  MappedStatsRegionPtr region = create(16, true);
+  const std::string longest(MappedStatsRegion::maxNameLength(), 'x');
+  EXPECT_NE(nullptr, region->allocate(longest, MappedStatsRegion::Type::Counter));
+  EXPECT_TRUE(region->contains(longest));
+  const std::string too_long = longest + "x";
+  EXPECT_EQ(nullptr, region->allocate(too_long, MappedStatsRegion::Type::Counter));
+  EXPECT_FALSE(region->contains(too_long));
+}
+
+TEST_F(MappedStatsRegionTest, Full) {
+  MappedStatsRegionPtr region = create(2, true);
+  EXPECT_NE(nullptr, region->allocate("a", MappedStatsRegion::Type::Counter));
+  EXPECT_NE(nullptr, region->allocate("b", MappedStatsRegion::Type::Counter));
+  EXPECT_EQ(nullptr, region->allocate("c", MappedStatsRegion::Type::Counter));
+  EXPECT_FALSE(region->contains("c"));
+  // Existing stats can still be found.
+  EXPECT_NE(nullptr, region->allocate("a", MappedStatsRegion::Type::Counter));
+  EXPECT_NE(nullptr, region->allocate("b", MappedStatsRegion::Type::Counter));
+  EXPECT_TRUE(region->contains("a"));
+  EXPECT_TRUE(region->contains("b"));
+
+  // So can they by a process adopting the full region.
+  MappedStatsRegionPtr child = create(2, false);
+  EXPECT_EQ(nullptr, child->allocate("c", MappedStatsRegion::Type::Counter));
+  EXPECT_NE(nullptr, child->allocate("a", MappedStatsRegion::Type::Counter));
+  EXPECT_NE(nullptr, child->allocate("b", MappedStatsRegion::Type::Counter));
+}
+
+TEST_F(MappedStatsRegionTest, StaleClaim) {
+  MappedStatsRegionPtr region = create(1, true);
+  // Leave the only slot being claimed, as a process which died part way through its claim would.
+  {
+    const uint32_t claiming = 1;
+    const int fd = ::open(path_.c_str(), O_WRONLY);
+    ASSERT_NE(-1, fd);
+    EXPECT_EQ(sizeof(claiming),
+              ::pwrite(fd, &claiming, sizeof(claiming), MappedStatsRegion::HeaderSize + 8));
+    ::close(fd);
+  }
+  EXPECT_EQ(nullptr, region->allocate("a", MappedStatsRegion::Type::Counter));
+  // The claim was given up on, so this falls back without waiting for it again.
+  EXPECT_EQ(nullptr, region->allocate("b", MappedStatsRegion::Type::Counter));
+  EXPECT_FALSE(region->contains("a"));
+  EXPECT_FALSE(region->contains("b"));
+}
+
+TEST_F(MappedStatsRegionTest, IncompatibleLayout) {
+  {
+    std::ofstream file(path_);
+    file << std::string(MappedStatsRegion::HeaderSize + MappedStatsRegion::SlotSize, 'x');
+  }
+  EXPECT_THROW_WITH_REGEX(create(16, false), EnvoyException, "incompatible layout");
+}
+
+TEST_F(MappedStatsRegionTest, Truncated) {
+  {
+    std::ofstream file(path_);
+    file << "ENVSTATS";
+  }
+  EXPECT_THROW_WITH_REGEX(create(16, false), EnvoyException, "is truncated");
+}
+
+TEST_F(MappedStatsRegionTest, CannotOpen) {
+  EXPECT_THROW_WITH_REGEX(MappedStatsRegion::create("/nonexistent/dir/region", 16, true),
+                          EnvoyException, "cannot open stats region");
+}
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
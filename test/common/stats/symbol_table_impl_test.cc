@@ -626,28 +626,17 @@ TEST_P(StatNameTest, MutexContentionOnExistingSymbols) {
   int64_t create_contentions = mutex_tracer.numContentions();
   ENVOY_LOG_MISC(info, "Number of contentions: {}", create_contentions);
 
-  // But when we access the already-existing symbols, we guarantee that no
-  // further mutex contentions occur.
-  access.setReady();
-  accesses.Wait();
-
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
-  //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
-  // construction, as composition does not require a lock.
-  //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
+  // When we access the already-existing symbols, the SymbolTable only takes
+  // its lock in shared mode, so the accesses do not serialize on each other.
+  // We cannot assert that no further contentions are recorded, as the tracer
+  // also observes the mutexes in the ConditionalInitializers used to line up
+  // the threads. BM_EncodeContention in symbol_table_speed_test.cc measures
+  // the effect.
   //
   // Note also that we cannot guarantee there *will* be contentions
   // as a machine or OS is free to run all threads serially.
+  access.setReady();
+  accesses.Wait();
 
   wait.setReady();
   for (auto& thread : threads) {
@@ -655,6 +644,34 @@ TEST_P(StatNameTest, MutexContentionOnExistingSymbols) {
   }
 }
 
+// Races threads which repeatedly encode and free names sharing tokens, without
+// holding any other references, so that symbols keep dropping to a zero
+// ref-count while other threads are re-encoding them.
+TEST_P(StatNameTest, RacingEncodeAndFree) {
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  constexpr int num_threads = 8;
+  constexpr int num_iters = 2000;
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  ConditionalInitializer start;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([this, i, &start]() {
+      start.wait();
+      for (int j = 0; j < num_iters; ++j) {
+        const std::string name = absl::StrCat("shared.thread", i % 2, ".iter", j % 5);
+        StatNameStorage storage(name, *table_);
+        EXPECT_EQ(name, table_->toString(storage.statName()));
+        storage.free(*table_);
+      }
+    }));
+  }
+  start.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, table_->numSymbols());
+}
+
 TEST_P(StatNameTest, SharedStatNameStorageSetInsertAndFind) {
   StatNameStorageSet set;
   const int iters = 10;
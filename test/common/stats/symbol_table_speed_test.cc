@@ -12,6 +12,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -58,6 +59,56 @@ static void BM_CreateRace(benchmark::State& state) {
 }
 BENCHMARK(BM_CreateRace);
 
+// Measures throughput when many threads concurrently encode, decode and free
+// stat names whose tokens are already in the table, as happens when every
+// worker creates stat names for existing clusters. The "cluster" and
+// "upstream_rq" tokens are shared by all threads. The argument is the number
+// of threads.
+//
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_EncodeContention(benchmark::State& state) {
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+  const int num_threads = state.range(0);
+  constexpr int names_per_thread = 10000;
+  Envoy::Stats::SymbolTableImpl table;
+
+  // Keep one reference to each distinct name, so that the symbols outlive the
+  // per-iteration encodes.
+  Envoy::Stats::StatNamePool initial(table);
+  std::vector<std::vector<std::string>> names(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    names[i].reserve(names_per_thread);
+    for (int j = 0; j < names_per_thread; ++j) {
+      names[i].push_back(absl::StrCat("cluster.worker_", i, ".upstream_rq.", j % 100, ".count"));
+      if (j < 100) {
+        initial.add(names[i].back());
+      }
+    }
+  }
+
+  for (auto _ : state) {
+    std::vector<Envoy::Thread::ThreadPtr> threads;
+    threads.reserve(num_threads);
+    Envoy::ConditionalInitializer start;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.push_back(thread_factory.createThread([&start, &table, &names, i]() {
+        start.wait();
+        for (const std::string& name : names[i]) {
+          Envoy::Stats::StatNameStorage storage(name, table);
+          benchmark::DoNotOptimize(table.toString(storage.statName()));
+          storage.free(table);
+        }
+      }));
+    }
+    start.setReady();
+    for (auto& thread : threads) {
+      thread->join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * names_per_thread);
+}
+BENCHMARK(BM_EncodeContention)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_JoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
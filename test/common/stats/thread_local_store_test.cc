@@ -1,6 +1,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 
 #include "envoy/config/metrics/v3/stats.pb.h"
@@ -1363,6 +1364,33 @@ TEST_F(HistogramTest, ParentHistogramBucketSummary) {
             parent_histogram->bucketSummary());
 }
 
+TEST_F(HistogramTest, ParentHistogramBins) {
+  Histogram& histogram =
+      store_->histogramFromString("histogram", Stats::Histogram::Unit::Unspecified);
+  for (const uint64_t value : {10, 10, 250}) {
+    EXPECT_CALL(sink_, onHistogramComplete(Ref(histogram), value));
+    histogram.recordValue(value);
+  }
+  store_->mergeHistograms([]() -> void {});
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(histogram), 12));
+  histogram.recordValue(12);
+  store_->mergeHistograms([]() -> void {});
+  ASSERT_EQ(1, store_->histograms().size());
+  ParentHistogramSharedPtr parent_histogram = store_->histograms()[0];
+
+  using Bins = std::vector<std::tuple<double, double, uint64_t>>;
+  const auto bins = [&parent_histogram](bool cumulative) {
+    Bins bins;
+    parent_histogram->forEachBin(cumulative,
+                                 [&bins](double lower_bound, double width, uint64_t count) {
+                                   bins.emplace_back(lower_bound, width, count);
+                                 });
+    return bins;
+  };
+  EXPECT_EQ((Bins{{12, 1, 1}}), bins(false));
+  EXPECT_EQ((Bins{{10, 1, 2}, {12, 1, 1}, {250, 10, 1}}), bins(true));
+}
+
 class ClusterShutdownCleanupStarvationTest : public ThreadLocalStoreNoMocksTestBase {
 public:
   static constexpr uint32_t NumThreads = 2;
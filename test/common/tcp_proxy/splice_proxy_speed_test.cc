@@ -0,0 +1,102 @@
+// Compares forwarding the data of a socket to another one with splice() and through a buffer, the
+// way connections of raw buffer sockets read and write it. Each iteration writes a chunk into the
+// source socket, forwards it, and reads it from the destination socket. The sockets are Unix domain
+// socket pairs, so that the numbers don't depend on the network stack.
+
+#include <sys/socket.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/tcp_proxy/splice_proxy.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace TcpProxy {
+namespace {
+
+#if defined(__linux__)
+
+// Read length of raw buffer sockets.
+constexpr uint64_t ReadLength = 16384;
+
+class SocketPairs {
+public:
+  SocketPairs() {
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, source_) == 0, "");
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, destination_) == 0, "");
+    source_handle_ = std::make_unique<Network::IoSocketHandleImpl>(source_[0]);
+    destination_handle_ = std::make_unique<Network::IoSocketHandleImpl>(destination_[0]);
+  }
+  ~SocketPairs() {
+    ::close(source_[1]);
+    ::close(destination_[1]);
+  }
+
+  void write(const std::string& chunk) {
+    RELEASE_ASSERT(::write(source_[1], chunk.data(), chunk.size()) == ssize_t(chunk.size()), "");
+  }
+
+  // Reads the data of the destination socket, which should all have been forwarded.
+  void read(uint64_t length) {
+    while (length > 0) {
+      const ssize_t rc = ::read(destination_[1], read_buffer_.data(), read_buffer_.size());
+      RELEASE_ASSERT(rc > 0, "");
+      length -= rc;
+    }
+  }
+
+  int source_[2];
+  int destination_[2];
+  // Own, and close, the forwarded sockets.
+  std::unique_ptr<Network::IoSocketHandleImpl> source_handle_;
+  std::unique_ptr<Network::IoSocketHandleImpl> destination_handle_;
+  std::vector<char> read_buffer_ = std::vector<char>(1024 * 1024);
+};
+
+void spliceForward(benchmark::State& state) {
+  SocketPairs sockets;
+  SplicePipePtr pipe = SplicePipe::create(sockets.source_[0], sockets.destination_[0]);
+  const std::string chunk(state.range(0), 'a');
+  for (auto _ : state) {
+    sockets.write(chunk);
+    uint64_t forwarded = 0;
+    while (forwarded < chunk.size()) {
+      uint64_t moved_length;
+      pipe->move(SpliceProxy::MaxLengthPerEvent, moved_length);
+      forwarded += moved_length;
+    }
+    sockets.read(chunk.size());
+  }
+  state.SetBytesProcessed(state.iterations() * chunk.size());
+}
+BENCHMARK(spliceForward)->Arg(1024)->Arg(16384)->Arg(65536);
+
+void bufferForward(benchmark::State& state) {
+  SocketPairs sockets;
+  const std::string chunk(state.range(0), 'a');
+  for (auto _ : state) {
+    sockets.write(chunk);
+    Buffer::OwnedImpl buffer;
+    while (buffer.length() < chunk.size()) {
+      buffer.read(*sockets.source_handle_, ReadLength);
+    }
+    while (buffer.length() > 0) {
+      buffer.write(*sockets.destination_handle_);
+    }
+    sockets.read(chunk.size());
+  }
+  state.SetBytesProcessed(state.iterations() * chunk.size());
+}
+BENCHMARK(bufferForward)->Arg(1024)->Arg(16384)->Arg(65536);
+
+#endif
+
+} // namespace
+} // namespace TcpProxy
+} // namespace Envoy
@@ -0,0 +1,130 @@
+#include <sys/socket.h>
+
+#include <string>
+
+#include "common/tcp_proxy/splice_proxy.h"
+
+#include "test/mocks/api/mocks.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Return;
+
+namespace Envoy {
+namespace TcpProxy {
+namespace {
+
+#if defined(__linux__)
+
+// Pipes between two socket pairs, with the proxied sockets at index 0 and their peers at index 1.
+class SplicePipeTest : public testing::Test {
+protected:
+  SplicePipeTest() {
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, source_) == 0, "");
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, destination_) == 0, "");
+  }
+
+  ~SplicePipeTest() override {
+    for (const int fd : {source_[0], source_[1], destination_[0], destination_[1]}) {
+      ::close(fd);
+    }
+  }
+
+  SplicePipePtr createPipe() {
+    SplicePipePtr pipe = SplicePipe::create(source_[0], destination_[0]);
+    RELEASE_ASSERT(pipe != nullptr, "");
+    return pipe;
+  }
+
+  void writeSource(const std::string& data) {
+    RELEASE_ASSERT(::write(source_[1], data.data(), data.size()) == ssize_t(data.size()), "");
+  }
+
+  std::string readDestination() {
+    std::string data;
+    char buffer[16384];
+    ssize_t length;
+    while ((length = ::read(destination_[1], buffer, sizeof(buffer))) > 0) {
+      data.append(buffer, length);
+    }
+    return data;
+  }
+
+  int source_[2];
+  int destination_[2];
+};
+
+TEST_F(SplicePipeTest, Move) {
+  SplicePipePtr pipe = createPipe();
+  uint64_t moved_length;
+  EXPECT_EQ(SplicePipe::Status::Blocked, pipe->move(1024, moved_length));
+  EXPECT_EQ(0, moved_length);
+
+  writeSource("hello");
+  EXPECT_EQ(SplicePipe::Status::Blocked, pipe->move(1024, moved_length));
+  EXPECT_EQ(5, moved_length);
+  EXPECT_EQ("hello", readDestination());
+}
+
+// Moving yields once the maximum length was read, while the source socket still has data.
+TEST_F(SplicePipeTest, Yield) {
+  SplicePipePtr pipe = createPipe();
+  const std::string data(3 * 1024, 'a');
+  writeSource(data);
+
+  uint64_t moved_length;
+  EXPECT_EQ(SplicePipe::Status::Yielded, pipe->move(1, moved_length));
+  EXPECT_LT(0, moved_length);
+  EXPECT_EQ(SplicePipe::Status::Blocked, pipe->move(1024 * 1024, moved_length));
+  EXPECT_EQ(data, readDestination());
+}
+
+// The end of stream of the source socket is reported once its data is moved, and the destination
+// socket is left for its owner to shut down.
+TEST_F(SplicePipeTest, EndStream) {
+  SplicePipePtr pipe = createPipe();
+  writeSource("hello");
+  ::shutdown(source_[1], SHUT_WR);
+
+  uint64_t moved_length;
+  EXPECT_EQ(SplicePipe::Status::EndStream, pipe->move(1024, moved_length));
+  EXPECT_EQ(5, moved_length);
+  EXPECT_EQ("hello", readDestination());
+  char byte;
+  EXPECT_EQ(-1, ::read(destination_[1], &byte, 1));
+  EXPECT_EQ(EAGAIN, errno);
+
+  EXPECT_EQ(SplicePipe::Status::EndStream, pipe->move(1024, moved_length));
+  EXPECT_EQ(0, moved_length);
+}
+
+TEST(SplicePipeErrorTest, CreateFailure) {
+  Api::MockLinuxOsSysCalls linux_os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> linux_os_calls(&linux_os_sys_calls);
+  EXPECT_CALL(linux_os_sys_calls, pipe2(_, _)).WillOnce(Return(Api::SysCallIntResult{-1, EMFILE}));
+  EXPECT_EQ(nullptr, SplicePipe::create(1, 2));
+}
+
+TEST(SplicePipeErrorTest, MoveFailure) {
+  Api::MockLinuxOsSysCalls linux_os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> linux_os_calls(&linux_os_sys_calls);
+  EXPECT_CALL(linux_os_sys_calls, pipe2(_, _)).WillOnce([](int pipe[2], int) {
+    return Api::SysCallIntResult{::pipe(pipe), 0};
+  });
+  SplicePipePtr pipe = SplicePipe::create(1, 2);
+  ASSERT_NE(nullptr, pipe);
+
+  EXPECT_CALL(linux_os_sys_calls, splice(1, _, SplicePipe::ChunkLength, _))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, ECONNRESET}));
+  uint64_t moved_length;
+  EXPECT_EQ(SplicePipe::Status::Error, pipe->move(1024, moved_length));
+}
+
+#endif
+
+} // namespace
+} // namespace TcpProxy
+} // namespace Envoy
@@ -13,6 +13,7 @@
 #include "common/buffer/buffer_impl.h"
 #include "common/network/address_impl.h"
 #include "common/network/application_protocol.h"
+#include "common/network/io_socket_handle_impl.h"
 #include "common/network/transport_socket_options_impl.h"
 #include "common/network/upstream_server_name.h"
 #include "common/router/metadatamatchcriteria_impl.h"
@@ -23,6 +24,8 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
@@ -1015,6 +1018,86 @@ TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(HalfCloseProxy)) {
   upstream_callbacks_->onEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+// Tests that connections are proxied as usual when splicing is configured but the connections
+// can't be spliced, e.g. because other network filters see their data.
+TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(SpliceUnavailable)) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.set_splice(true);
+  setup(1, config);
+
+  EXPECT_CALL(filter_callbacks_.connection_, startRawIo(_)).Times(0);
+  EXPECT_CALL(*upstream_connections_.at(0), startRawIo(_)).Times(0);
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0, config_->stats().downstream_cx_spliced_total_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
+  filter_->onData(buffer, false);
+}
+
+#if defined(__linux__)
+// Tests that the data of plaintext connections is spliced when configured, along with their
+// half-closes, and that the connections are closed once both are half-closed.
+TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(SpliceConnections)) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.set_splice(true);
+  setup(1, config);
+
+  // The socket of each connection is one end of a socket pair, and its peer is the other end.
+  os_fd_t downstream_fds[2];
+  os_fd_t upstream_fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, downstream_fds));
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, upstream_fds));
+  Network::IoSocketHandleImpl downstream_io_handle(downstream_fds[0]);
+  Network::IoSocketHandleImpl downstream_peer_io_handle(downstream_fds[1]);
+  Network::IoSocketHandleImpl upstream_io_handle(upstream_fds[0]);
+  Network::IoSocketHandleImpl upstream_peer_io_handle(upstream_fds[1]);
+  ON_CALL(filter_callbacks_.connection_, rawIoHandle())
+      .WillByDefault(Return(&downstream_io_handle));
+  ON_CALL(*upstream_connections_.at(0), rawIoHandle()).WillByDefault(Return(&upstream_io_handle));
+
+  // Neither connection reads its socket anymore.
+  Network::RawIoCallbacks* downstream_callbacks{};
+  Network::RawIoCallbacks* upstream_callbacks{};
+  EXPECT_CALL(filter_callbacks_.connection_, startRawIo(_))
+      .WillOnce(SaveArgAddress(&downstream_callbacks));
+  EXPECT_CALL(*upstream_connections_.at(0), startRawIo(_))
+      .WillOnce(SaveArgAddress(&upstream_callbacks));
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(false)).Times(0);
+  conn_pool_callbacks_.at(0)->onPoolReady(std::move(upstream_connection_data_.at(0)),
+                                          upstream_hosts_.at(0));
+  EXPECT_EQ(1, config_->stats().downstream_cx_spliced_total_.value());
+  ASSERT_NE(nullptr, downstream_callbacks);
+  EXPECT_EQ(downstream_callbacks, upstream_callbacks);
+
+  EXPECT_EQ(5, ::write(downstream_fds[1], "hello", 5));
+  EXPECT_EQ(6, ::write(upstream_fds[1], "world!", 6));
+  downstream_callbacks->onRawIoReady();
+  char data[16];
+  EXPECT_EQ(5, ::read(upstream_fds[1], data, sizeof(data)));
+  EXPECT_EQ("hello", std::string(data, 5));
+  EXPECT_EQ(6, ::read(downstream_fds[1], data, sizeof(data)));
+  EXPECT_EQ("world!", std::string(data, 6));
+  EXPECT_EQ(5, config_->stats().downstream_cx_rx_bytes_total_.value());
+  EXPECT_EQ(6, config_->stats().downstream_cx_tx_bytes_total_.value());
+
+  // The end of stream of each direction is forwarded through the destination connection.
+  EXPECT_CALL(filter_callbacks_.connection_, close(_)).Times(0);
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferStringEqual(""), true));
+  ::shutdown(downstream_fds[1], SHUT_WR);
+  upstream_callbacks->onRawIoReady();
+  upstream_callbacks->onRawIoReady();
+
+  // The connections stop calling the proxy once it is destroyed.
+  EXPECT_CALL(filter_callbacks_.connection_, write(BufferStringEqual(""), true));
+  EXPECT_CALL(filter_callbacks_.connection_, stopRawIo());
+  EXPECT_CALL(*upstream_connections_.at(0), stopRawIo());
+  EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
+  ::shutdown(upstream_fds[1], SHUT_WR);
+  upstream_callbacks->onRawIoReady();
+}
+#endif
+
 // Test that downstream is closed after an upstream LocalClose.
 TEST_F(TcpProxyTest, DEPRECATED_FEATURE_TEST(UpstreamLocalDisconnect)) {
   setup(1);
@@ -11,6 +11,7 @@ using testing::_;
 using testing::InSequence;
 using testing::Ref;
 using testing::ReturnPointee;
+using testing::SaveArg;
 
 namespace Envoy {
 namespace ThreadLocal {
@@ -194,6 +195,49 @@ TEST_F(ThreadLocalInstanceImplTest, RunOnAllThreads) {
   tls_.shutdownThread();
 }
 
+// Validate that the updates of a batch run on the main thread right away, and are posted to the
+// worker threads as a single callback once the outermost batch ends.
+TEST_F(ThreadLocalInstanceImplTest, BatchUpdates) {
+  SlotPtr slot1 = tls_.allocateSlot();
+  SlotPtr slot2 = tls_.allocateSlot();
+  uint32_t calls = 0;
+  bool all_threads_complete = false;
+  Event::PostCb worker_cb;
+
+  {
+    UpdateBatchPtr batch = tls_.batchUpdates();
+    {
+      UpdateBatchPtr nested_batch = tls_.batchUpdates();
+      EXPECT_CALL(thread_dispatcher_, post(_)).Times(0);
+      slot1->set([&calls](Event::Dispatcher&) -> ThreadLocalObjectSharedPtr {
+        ++calls;
+        return nullptr;
+      });
+      slot2->runOnAllThreads([&calls]() -> void { ++calls; });
+      slot1->runOnAllThreads([&calls](ThreadLocalObjectSharedPtr previous) {
+        ++calls;
+        return previous;
+      });
+      slot2->runOnAllThreads([&calls]() -> void { ++calls; },
+                             [&all_threads_complete]() -> void { all_threads_complete = true; });
+      EXPECT_EQ(4, calls);
+    }
+    testing::Mock::VerifyAndClearExpectations(&thread_dispatcher_);
+    EXPECT_CALL(thread_dispatcher_, post(_)).WillOnce(SaveArg<0>(&worker_cb));
+  }
+
+  worker_cb();
+  EXPECT_EQ(8, calls);
+  EXPECT_FALSE(all_threads_complete);
+  // The all threads complete callback is posted once the workers released the batch.
+  EXPECT_CALL(main_dispatcher_, post(_));
+  worker_cb = nullptr;
+  EXPECT_TRUE(all_threads_complete);
+
+  tls_.shutdownGlobalThreading();
+  tls_.shutdownThread();
+}
+
 // Validate ThreadLocal::InstanceImpl's dispatcher() behavior.
 TEST(ThreadLocalInstanceImplDispatcherTest, Dispatcher) {
   InstanceImpl tls;
@@ -0,0 +1,95 @@
+// Usage: bazel run //test/common/thread_local:thread_local_speed_test
+//
+// Measures updating a thousand slots on 64 worker threads, as a large CDS update does, with and
+// without batching the updates, and counts the posts made to the workers per update.
+
+#include <memory>
+#include <vector>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/event/real_time_system.h"
+#include "common/thread_local/thread_local_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace ThreadLocal {
+namespace {
+
+constexpr uint32_t Workers = 64;
+constexpr uint32_t Slots = 1000;
+
+class CountingDispatcher : public Event::DispatcherImpl {
+public:
+  CountingDispatcher(Api::Api& api, Event::TimeSystem& time_system)
+      : DispatcherImpl("worker", api, time_system) {}
+
+  void post(std::function<void()> callback) override {
+    posts_++;
+    DispatcherImpl::post(std::move(callback));
+  }
+
+  uint64_t posts_{};
+};
+
+class TestObject : public ThreadLocalObject {};
+
+void bmUpdateSlots(benchmark::State& state) {
+  const bool batched = state.range(0) != 0;
+  Event::RealTimeSystem time_system;
+  Api::ApiPtr api = Api::createApiForTest(time_system);
+  Event::DispatcherPtr main_dispatcher = api->allocateDispatcher("main");
+  std::vector<std::unique_ptr<CountingDispatcher>> workers;
+  InstanceImpl tls;
+  tls.registerThread(*main_dispatcher, true);
+  for (uint32_t i = 0; i < Workers; i++) {
+    workers.push_back(std::make_unique<CountingDispatcher>(*api, time_system));
+    tls.registerThread(*workers.back(), false);
+  }
+  std::vector<SlotPtr> slots;
+  for (uint32_t i = 0; i < Slots; i++) {
+    slots.push_back(tls.allocateSlot());
+    slots.back()->set([](Event::Dispatcher&) -> ThreadLocalObjectSharedPtr {
+      return std::make_shared<TestObject>();
+    });
+  }
+  // The workers' callbacks run on this thread, as the worker dispatchers are run here.
+  for (auto& worker : workers) {
+    worker->run(Event::Dispatcher::RunType::NonBlock);
+    worker->posts_ = 0;
+  }
+
+  for (auto _ : state) {
+    {
+      UpdateBatchPtr batch = batched ? tls.batchUpdates() : nullptr;
+      for (auto& slot : slots) {
+        slot->runOnAllThreads(
+            [](ThreadLocalObjectSharedPtr previous) -> ThreadLocalObjectSharedPtr {
+              return previous;
+            });
+      }
+    }
+    for (auto& worker : workers) {
+      worker->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  uint64_t posts = 0;
+  for (const auto& worker : workers) {
+    posts += worker->posts_;
+  }
+  state.counters["posts_per_update"] =
+      static_cast<double>(posts) / (static_cast<double>(state.iterations()) * Slots);
+  state.SetItemsProcessed(state.iterations() * Slots);
+
+  tls.shutdownGlobalThreading();
+  slots.clear();
+  tls.shutdownThread();
+}
+BENCHMARK(bmUpdateSlots)->ArgName("batched")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace ThreadLocal
+} // namespace Envoy
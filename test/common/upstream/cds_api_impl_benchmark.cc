@@ -0,0 +1,92 @@
+// Usage: bazel run //test/common/upstream:cds_api_impl_benchmark
+//
+// Measures the time CdsApiImpl spends on the main thread decoding and validating the clusters of
+// large state of the world updates. Adding the clusters is left to a mock cluster manager.
+
+#include <string>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/config/core/v3/config_source.pb.h"
+#include "envoy/extensions/transport_sockets/tls/v3/cert.pb.h"
+
+#include "common/common/thread.h"
+#include "common/protobuf/protobuf.h"
+#include "common/stats/isolated_store_impl.h"
+#include "common/upstream/cds_api_impl.h"
+
+#include "test/mocks/protobuf/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+const std::string ClusterYaml = R"EOF(
+type: EDS
+eds_cluster_config:
+  eds_config:
+    ads: {}
+connect_timeout: 0.25s
+lb_policy: LEAST_REQUEST
+http2_protocol_options:
+  max_concurrent_streams: 100
+circuit_breakers:
+  thresholds:
+  - priority: DEFAULT
+    max_connections: 1000
+    max_pending_requests: 1000
+    max_requests: 5000
+health_checks:
+- timeout: 1s
+  interval: 5s
+  unhealthy_threshold: 3
+  healthy_threshold: 2
+  http_health_check:
+    path: /healthz
+outlier_detection:
+  consecutive_5xx: 5
+  interval: 10s
+  base_ejection_time: 30s
+transport_socket:
+  name: envoy.transport_sockets.tls
+  typed_config:
+    "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.v3.UpstreamTlsContext
+    sni: backend.example.com
+)EOF";
+
+void BM_CdsConfigUpdate(benchmark::State& state) {
+  Thread::MutexBasicLockable lock;
+  // CDS logs every update.
+  Logger::Context logging_context{spdlog::level::warn, Logger::Logger::DEFAULT_LOG_FORMAT, lock,
+                                  false};
+  NiceMock<MockClusterManager> cm;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  Stats::IsolatedStoreImpl store;
+  NiceMock<ProtobufMessage::MockValidationVisitor> validation_visitor;
+  CdsApiPtr cds = CdsApiImpl::create(envoy::config::core::v3::ConfigSource(), cm, tls, store,
+                                     validation_visitor, Thread::threadFactoryForTest());
+
+  envoy::config::cluster::v3::Cluster cluster;
+  TestUtility::loadFromYaml(ClusterYaml, cluster);
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> clusters;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    cluster.set_name(absl::StrCat("cluster_", i));
+    clusters.Add()->PackFrom(cluster);
+  }
+
+  for (auto _ : state) {
+    cm.subscription_factory_.callbacks_->onConfigUpdate(clusters, "v1");
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CdsConfigUpdate)->Arg(100)->Arg(1000)->Arg(10000)->UseRealTime();
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
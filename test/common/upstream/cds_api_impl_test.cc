@@ -13,14 +13,18 @@
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/protobuf/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 using testing::_;
+using testing::ByMove;
 using testing::InSequence;
 using testing::Return;
 using testing::StrEq;
@@ -36,7 +40,8 @@ class CdsApiImplTest : public testing::Test {
 protected:
   void setup() {
     envoy::config::core::v3::ConfigSource cds_config;
-    cds_ = CdsApiImpl::create(cds_config, cm_, store_, validation_visitor_);
+    cds_ = CdsApiImpl::create(cds_config, cm_, tls_, store_, validation_visitor_,
+                              Thread::threadFactoryForTest());
     cds_->setInitializedCb([this]() -> void { initialized_.ready(); });
 
     EXPECT_CALL(*cm_.subscription_factory_.subscription_, start(_));
@@ -62,6 +67,7 @@ protected:
   }
 
   NiceMock<MockClusterManager> cm_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
   Upstream::ClusterManager::ClusterInfoMap cluster_map_;
   Upstream::MockClusterMockPrioritySet mock_cluster_;
   Stats::IsolatedStoreImpl store_;
@@ -229,6 +235,68 @@ TEST_F(CdsApiImplTest, DeltaConfigUpdate) {
   }
 }
 
+// Updates large enough to be decoded by several threads add every valid cluster, in order, and
+// report the invalid ones.
+TEST_F(CdsApiImplTest, LargeConfigUpdate) {
+  {
+    InSequence s;
+    setup();
+  }
+
+  const size_t cluster_count = 4 * CdsApiImpl::MinClustersPerDecodeThread + 1;
+  const size_t invalid_index = 2 * CdsApiImpl::MinClustersPerDecodeThread;
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(makeClusterMap({"stale_cluster"})));
+  EXPECT_CALL(initialized_, ready());
+
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> clusters;
+  {
+    InSequence s;
+    for (size_t i = 0; i < cluster_count; i++) {
+      envoy::config::cluster::v3::Cluster cluster;
+      if (i != invalid_index) {
+        cluster.set_name(absl::StrCat("cluster_", i));
+        expectAdd(cluster.name(), "v1");
+      }
+      clusters.Add()->PackFrom(cluster);
+    }
+  }
+  EXPECT_CALL(cm_, removeCluster("stale_cluster")).WillOnce(Return(true));
+
+  EXPECT_THROW_WITH_REGEX(cds_callbacks_->onConfigUpdate(clusters, "v1"), EnvoyException,
+                          "^Error adding/updating cluster\\(s\\) : Proto constraint validation "
+                          "failed \\(ClusterValidationError.Name: ");
+  EXPECT_EQ("v1", cds_->versionInfo());
+}
+
+// The thread local updates of all the clusters of an update are batched, and the batch ends before
+// the initialize callback runs.
+TEST_F(CdsApiImplTest, ConfigUpdateBatchesThreadLocalUpdates) {
+  InSequence s;
+
+  setup();
+
+  auto* batch_ptr = new ThreadLocal::MockUpdateBatch();
+  ThreadLocal::UpdateBatchPtr batch(batch_ptr);
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(makeClusterMap({"stale_cluster"})));
+  EXPECT_CALL(tls_, batchUpdates()).WillOnce(Return(ByMove(std::move(batch))));
+  expectAdd("cluster_1", "v1");
+  expectAdd("cluster_2", "v1");
+  EXPECT_CALL(cm_, removeCluster("stale_cluster")).WillOnce(Return(true));
+  EXPECT_CALL(*batch_ptr, destroy_());
+  EXPECT_CALL(initialized_, ready());
+
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> clusters;
+  envoy::config::cluster::v3::Cluster cluster_1;
+  cluster_1.set_name("cluster_1");
+  clusters.Add()->PackFrom(cluster_1);
+  envoy::config::cluster::v3::Cluster cluster_2;
+  cluster_2.set_name("cluster_2");
+  clusters.Add()->PackFrom(cluster_2);
+
+  cds_callbacks_->onConfigUpdate(clusters, "v1");
+  EXPECT_EQ("v1", cds_->versionInfo());
+}
+
 TEST_F(CdsApiImplTest, ConfigUpdateAddsSecondClusterEvenIfFirstThrows) {
   {
     InSequence s;
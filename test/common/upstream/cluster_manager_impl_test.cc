@@ -1356,6 +1356,154 @@ TEST_F(ClusterManagerImplTest, AddOrUpdateClusterStaticExists) {
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
 }
 
+// Verifies that on-demand discovery requests wait for their cluster to warm, and that only the
+// first request of a thread for a cluster is forwarded to the main thread.
+TEST_F(ClusterManagerImplTest, OnDemandClusterDiscovery) {
+  create(defaultConfig());
+  envoy::config::core::v3::ConfigSource odcds_config;
+  odcds_config.mutable_ads();
+  OdCdsApiHandleSharedPtr odcds = cluster_manager_->allocateOdCdsApi(
+      odcds_config, absl::nullopt, validation_context_.dynamicValidationVisitor());
+
+  testing::MockFunction<void(ClusterDiscoveryStatus)> callback;
+  // The forwarded request is not run, as there is no ADS to subscribe through.
+  EXPECT_CALL(factory_.dispatcher_, post(_)).WillOnce(Return());
+  new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  ClusterDiscoveryCallbackHandlePtr handle1 = odcds->requestOnDemandClusterDiscovery(
+      "fake_cluster", std::make_unique<ClusterDiscoveryCallback>(callback.AsStdFunction()),
+      std::chrono::milliseconds(5000));
+  EXPECT_NE(nullptr, handle1);
+  new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  ClusterDiscoveryCallbackHandlePtr handle2 = odcds->requestOnDemandClusterDiscovery(
+      "fake_cluster", std::make_unique<ClusterDiscoveryCallback>(callback.AsStdFunction()),
+      std::chrono::milliseconds(5000));
+  EXPECT_NE(nullptr, handle2);
+
+  std::shared_ptr<MockClusterMockPrioritySet> cluster1(new NiceMock<MockClusterMockPrioritySet>());
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _))
+      .WillOnce(Return(std::make_pair(cluster1, nullptr)));
+  EXPECT_CALL(*cluster1, initialize(_));
+  EXPECT_CALL(callback, Call(_)).Times(0);
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(defaultStaticCluster("fake_cluster"), ""));
+
+  EXPECT_CALL(callback, Call(ClusterDiscoveryStatus::Available)).Times(2);
+  cluster1->initialize_callback_();
+  handle1.reset();
+  handle2.reset();
+
+  // Known clusters are not requested.
+  EXPECT_EQ(nullptr, odcds->requestOnDemandClusterDiscovery(
+                         "fake_cluster",
+                         std::make_unique<ClusterDiscoveryCallback>(callback.AsStdFunction()),
+                         std::chrono::milliseconds(5000)));
+
+  // The cluster manager releases the subscription, which unregisters from the thread local
+  // cluster manager.
+  odcds.reset();
+  cluster_manager_->shutdown();
+  factory_.tls_.shutdownThread();
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
+// Verifies that the callers with the same configuration source and idle timeout share an on-demand
+// subscription.
+TEST_F(ClusterManagerImplTest, OnDemandClusterDiscoverySharedSubscription) {
+  create(defaultConfig());
+  envoy::config::core::v3::ConfigSource odcds_config;
+  odcds_config.mutable_ads();
+  OdCdsApiHandleSharedPtr odcds = cluster_manager_->allocateOdCdsApi(
+      odcds_config, absl::nullopt, validation_context_.dynamicValidationVisitor());
+  ProtobufMessage::ValidationVisitor& validation_visitor =
+      validation_context_.dynamicValidationVisitor();
+  EXPECT_EQ(odcds, cluster_manager_->allocateOdCdsApi(odcds_config, absl::nullopt,
+                                                      validation_visitor));
+
+  new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  EXPECT_NE(odcds, cluster_manager_->allocateOdCdsApi(
+                       odcds_config, std::chrono::milliseconds(30000), validation_visitor));
+  envoy::config::core::v3::ConfigSource other_config;
+  other_config.mutable_ads();
+  other_config.mutable_initial_fetch_timeout()->set_seconds(1);
+  EXPECT_NE(odcds, cluster_manager_->allocateOdCdsApi(other_config, absl::nullopt,
+                                                      validation_visitor));
+
+  odcds.reset();
+  cluster_manager_->shutdown();
+  factory_.tls_.shutdownThread();
+}
+
+// Verifies that on-demand discovery requests for a cluster missing from the config source fail
+// without waiting for their timeout.
+TEST_F(ClusterManagerImplTest, OnDemandClusterDiscoveryMissing) {
+  create(defaultConfig());
+  envoy::config::core::v3::ConfigSource odcds_config;
+  odcds_config.mutable_ads();
+  OdCdsApiHandleSharedPtr odcds = cluster_manager_->allocateOdCdsApi(
+      odcds_config, absl::nullopt, validation_context_.dynamicValidationVisitor());
+
+  testing::MockFunction<void(ClusterDiscoveryStatus)> callback;
+  EXPECT_CALL(factory_.dispatcher_, post(_)).WillOnce(Return());
+  new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  ClusterDiscoveryCallbackHandlePtr handle = odcds->requestOnDemandClusterDiscovery(
+      "fake_cluster", std::make_unique<ClusterDiscoveryCallback>(callback.AsStdFunction()),
+      std::chrono::milliseconds(5000));
+
+  // Other clusters are left pending.
+  EXPECT_CALL(callback, Call(_)).Times(0);
+  cluster_manager_->notifyMissingCluster("other_cluster");
+  EXPECT_CALL(callback, Call(ClusterDiscoveryStatus::Missing));
+  cluster_manager_->notifyMissingCluster("fake_cluster");
+  handle.reset();
+
+  // The cluster manager releases the subscription, which unregisters from the thread local
+  // cluster manager.
+  odcds.reset();
+  cluster_manager_->shutdown();
+  factory_.tls_.shutdownThread();
+}
+
+// Verifies that on-demand discovery requests time out, and that deleting a request cancels it.
+TEST_F(ClusterManagerImplTest, OnDemandClusterDiscoveryTimeout) {
+  create(defaultConfig());
+  envoy::config::core::v3::ConfigSource odcds_config;
+  odcds_config.mutable_ads();
+  OdCdsApiHandleSharedPtr odcds = cluster_manager_->allocateOdCdsApi(
+      odcds_config, absl::nullopt, validation_context_.dynamicValidationVisitor());
+
+  testing::MockFunction<void(ClusterDiscoveryStatus)> callback;
+  EXPECT_CALL(factory_.dispatcher_, post(_)).Times(2).WillRepeatedly(Return());
+  auto* timer = new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(5000), _));
+  ClusterDiscoveryCallbackHandlePtr handle = odcds->requestOnDemandClusterDiscovery(
+      "fake_cluster", std::make_unique<ClusterDiscoveryCallback>(callback.AsStdFunction()),
+      std::chrono::milliseconds(5000));
+  EXPECT_CALL(callback, Call(ClusterDiscoveryStatus::Timeout));
+  timer->invokeCallback();
+  handle.reset();
+
+  // As no request is pending anymore, the next one is forwarded to the main thread again.
+  new NiceMock<Event::MockTimer>(&factory_.tls_.dispatcher_);
+  handle = odcds->requestOnDemandClusterDiscovery(
+      "fake_cluster", std::make_unique<ClusterDiscoveryCallback>(callback.AsStdFunction()),
+      std::chrono::milliseconds(5000));
+  handle.reset();
+
+  std::shared_ptr<MockClusterMockPrioritySet> cluster1(new NiceMock<MockClusterMockPrioritySet>());
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _))
+      .WillOnce(Return(std::make_pair(cluster1, nullptr)));
+  EXPECT_CALL(*cluster1, initialize(_));
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(defaultStaticCluster("fake_cluster"), ""));
+  EXPECT_CALL(callback, Call(_)).Times(0);
+  cluster1->initialize_callback_();
+
+  // The cluster manager releases the subscription, which unregisters from the thread local
+  // cluster manager.
+  odcds.reset();
+  cluster_manager_->shutdown();
+  factory_.tls_.shutdownThread();
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
 // Verifies that we correctly propagate the host_set state to the TLS clusters.
 TEST_F(ClusterManagerImplTest, HostsPostedToTlsCluster) {
   const std::string json = fmt::sprintf("{\"static_resources\":{%s}}",
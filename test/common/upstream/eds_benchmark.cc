@@ -0,0 +1,115 @@
+// Usage: bazel run //test/common/upstream:eds_benchmark
+//
+// Measures the time EdsClusterImpl spends applying updates to large clusters, in which only one
+// endpoint changes from one update to the next.
+
+#include <memory>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/config/endpoint/v3/endpoint_components.pb.h"
+
+#include "common/common/fmt.h"
+#include "common/common/thread.h"
+#include "common/singleton/manager_impl.h"
+#include "common/upstream/eds.h"
+
+#include "server/transport_socket_config_impl.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/common/upstream/utility.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/protobuf/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+class EdsSpeedTest {
+public:
+  EdsSpeedTest() : api_(Api::createApiForTest(stats_)) {
+    eds_cluster_ = parseClusterFromV2Yaml(R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: EDS
+      lb_policy: ROUND_ROBIN
+      eds_cluster_config:
+        service_name: fare
+        eds_config:
+          api_config_source:
+            api_type: REST
+            cluster_names:
+            - eds
+            refresh_delay: 1s
+    )EOF");
+    Stats::ScopePtr scope = stats_.createScope("cluster.name.");
+    Server::Configuration::TransportSocketFactoryContextImpl factory_context(
+        admin_, ssl_context_manager_, *scope, cm_, local_info_, dispatcher_, random_, stats_,
+        singleton_manager_, tls_, validation_visitor_, *api_);
+    cluster_ = std::make_shared<EdsClusterImpl>(eds_cluster_, runtime_, factory_context,
+                                                std::move(scope), false);
+    eds_callbacks_ = cm_.subscription_factory_.callbacks_;
+  }
+
+  void update(const envoy::config::endpoint::v3::ClusterLoadAssignment& cluster_load_assignment) {
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+    resources.Add()->PackFrom(cluster_load_assignment);
+    eds_callbacks_->onConfigUpdate(resources, "");
+  }
+
+  Stats::TestUtil::TestStore stats_;
+  Ssl::MockContextManager ssl_context_manager_;
+  envoy::config::cluster::v3::Cluster eds_cluster_;
+  NiceMock<MockClusterManager> cm_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  std::shared_ptr<EdsClusterImpl> cluster_;
+  Config::SubscriptionCallbacks* eds_callbacks_{};
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<Server::MockAdmin> admin_;
+  Singleton::ManagerImpl singleton_manager_{Thread::threadFactoryForTest()};
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<ProtobufMessage::MockValidationVisitor> validation_visitor_;
+  Api::ApiPtr api_;
+};
+
+void BM_EdsUpdateOneEndpoint(benchmark::State& state) {
+  Thread::MutexBasicLockable lock;
+  // EDS logs every update.
+  Logger::Context logging_context{spdlog::level::warn, Logger::Logger::DEFAULT_LOG_FORMAT, lock,
+                                  false};
+  EdsSpeedTest speed_test;
+  envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+  cluster_load_assignment.set_cluster_name("fare");
+  auto* endpoints = cluster_load_assignment.add_endpoints();
+  for (int64_t i = 0; i < state.range(0); i++) {
+    auto* socket_address = endpoints->add_lb_endpoints()
+                               ->mutable_endpoint()
+                               ->mutable_address()
+                               ->mutable_socket_address();
+    socket_address->set_address(fmt::format("10.0.{}.{}", i / 256, i % 256));
+    socket_address->set_port_value(80);
+  }
+  speed_test.update(cluster_load_assignment);
+
+  uint32_t weight = 1;
+  for (auto _ : state) {
+    weight = 3 - weight;
+    endpoints->mutable_lb_endpoints(0)->mutable_load_balancing_weight()->set_value(weight);
+    speed_test.update(cluster_load_assignment);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EdsUpdateOneEndpoint)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
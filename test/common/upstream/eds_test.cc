@@ -675,6 +675,71 @@ TEST_F(EdsTest, EndpointRemovalAfterHcFail) {
   }
 }
 
+// Validate that the hosts of unchanged endpoints are reused rather than built again.
+TEST_F(EdsTest, ReuseUnchangedHosts) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+  cluster_load_assignment.set_cluster_name("fare");
+  auto* endpoints = cluster_load_assignment.add_endpoints();
+  auto add_endpoint = [&endpoints](int port) {
+    auto* socket_address = endpoints->add_lb_endpoints()
+                               ->mutable_endpoint()
+                               ->mutable_address()
+                               ->mutable_socket_address();
+    socket_address->set_address("1.2.3.4");
+    socket_address->set_port_value(port);
+  };
+  add_endpoint(80);
+  add_endpoint(81);
+
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(2UL, stats_.counter("cluster.name.eds.hosts_created").value());
+  EXPECT_EQ(0UL, stats_.counter("cluster.name.eds.hosts_reused").value());
+  const HostVector hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
+  EXPECT_EQ(2, hosts.size());
+
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(2UL, stats_.counter("cluster.name.eds.hosts_created").value());
+  EXPECT_EQ(2UL, stats_.counter("cluster.name.eds.hosts_reused").value());
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_no_rebuild").value());
+  EXPECT_EQ(hosts, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts());
+
+  // A changed endpoint is built again, and still updates its existing host in place.
+  endpoints->mutable_lb_endpoints(1)->mutable_load_balancing_weight()->set_value(10);
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(3UL, stats_.counter("cluster.name.eds.hosts_created").value());
+  EXPECT_EQ(3UL, stats_.counter("cluster.name.eds.hosts_reused").value());
+  EXPECT_EQ(hosts, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts());
+  EXPECT_EQ(10, hosts[1]->weight());
+
+  // Its existing host is then reused for the new config.
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(3UL, stats_.counter("cluster.name.eds.hosts_created").value());
+  EXPECT_EQ(5UL, stats_.counter("cluster.name.eds.hosts_reused").value());
+  EXPECT_EQ(hosts, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts());
+
+  // Moving an endpoint to another priority builds its host again.
+  auto* high_priority_endpoints = cluster_load_assignment.add_endpoints();
+  high_priority_endpoints->set_priority(1);
+  *high_priority_endpoints->add_lb_endpoints() = endpoints->lb_endpoints(1);
+  endpoints->mutable_lb_endpoints()->RemoveLast();
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(4UL, stats_.counter("cluster.name.eds.hosts_created").value());
+  EXPECT_EQ(6UL, stats_.counter("cluster.name.eds.hosts_reused").value());
+  EXPECT_EQ(HostVector{hosts[0]}, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts());
+  EXPECT_EQ(HostVector{hosts[1]}, cluster_->prioritySet().hostSetsPerPriority()[1]->hosts());
+  EXPECT_EQ(1, hosts[1]->priority());
+
+  // Endpoints are no longer reused once they have been removed.
+  cluster_load_assignment.clear_endpoints();
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  endpoints = cluster_load_assignment.add_endpoints();
+  add_endpoint(80);
+  doOnConfigUpdateVerifyNoThrow(cluster_load_assignment);
+  EXPECT_EQ(5UL, stats_.counter("cluster.name.eds.hosts_created").value());
+  EXPECT_EQ(6UL, stats_.counter("cluster.name.eds.hosts_reused").value());
+  EXPECT_NE(hosts[0], cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
+}
+
 // Verify that a host is removed when it is still passing active HC, but has been previously
 // told by the EDS server to fail health check.
 TEST_F(EdsTest, EndpointRemovalEdsFailButActiveHcSuccess) {
@@ -0,0 +1,274 @@
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/config/core/v3/config_source.pb.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "common/stats/isolated_store_impl.h"
+#include "common/upstream/od_cds_api_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/protobuf/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Eq;
+using testing::DoAll;
+using testing::Return;
+using testing::ReturnNew;
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+MATCHER_P(WithName, expectedName, "") { return arg.name() == expectedName; }
+
+class MockMissingClusterNotifier : public MissingClusterNotifier {
+public:
+  MOCK_METHOD(void, notifyMissingCluster, (const std::string& cluster_name));
+};
+
+class OdCdsApiImplTest : public testing::Test {
+protected:
+  void setup(absl::optional<std::chrono::milliseconds> idle_timeout = absl::nullopt) {
+    if (idle_timeout.has_value()) {
+      idle_timer_ = new Event::MockTimer(&dispatcher_);
+      EXPECT_CALL(*idle_timer_, enableTimer(idle_timeout.value(), _));
+    }
+    EXPECT_CALL(cm_, addThreadLocalClusterUpdateCallbacks_(_))
+        .WillOnce(DoAll(SaveArgAddress(&cluster_update_callbacks_),
+                        ReturnNew<MockClusterUpdateCallbacksHandle>()));
+    envoy::config::core::v3::ConfigSource odcds_config;
+    odcds_ = OdCdsApiImpl::create(odcds_config, idle_timeout, cm_, notifier_, dispatcher_, store_,
+                                  validation_visitor_);
+    odcds_callbacks_ = cm_.subscription_factory_.callbacks_;
+  }
+
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any>
+  clusters(const std::vector<std::string>& cluster_names) {
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+    for (const auto& cluster_name : cluster_names) {
+      resources.Add()->PackFrom(defaultStaticCluster(cluster_name));
+    }
+    return resources;
+  }
+
+  NiceMock<MockClusterManager> cm_;
+  MockMissingClusterNotifier notifier_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Event::MockTimer* idle_timer_{};
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<ProtobufMessage::MockValidationVisitor> validation_visitor_;
+  OdCdsApiSharedPtr odcds_;
+  Config::SubscriptionCallbacks* odcds_callbacks_{};
+  ClusterUpdateCallbacks* cluster_update_callbacks_{};
+};
+
+// The subscription starts with the first requested cluster, and its interest grows with the
+// clusters requested after that.
+TEST_F(OdCdsApiImplTest, UpdateOnDemand) {
+  setup();
+
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_, start(std::set<std::string>{"cluster1"}));
+  odcds_->updateOnDemand("cluster1");
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1", "cluster2"}));
+  odcds_->updateOnDemand("cluster2");
+  // Clusters already subscribed to are not requested again.
+  odcds_->updateOnDemand("cluster1");
+}
+
+// Requested clusters are added, unrequested ones ignored, and the clusters missing from a state of
+// the world update removed.
+TEST_F(OdCdsApiImplTest, StateOfTheWorldUpdate) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+  odcds_->updateOnDemand("cluster2");
+
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster1"), "v1")).WillOnce(Return(true));
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster2"), "v1")).WillOnce(Return(true));
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster3"), _)).Times(0);
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1", "cluster2", "cluster3"}), "v1");
+
+  // The removed cluster is also unsubscribed from, so that its next request asks for it again.
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster1"), "v2")).WillOnce(Return(false));
+  EXPECT_CALL(cm_, removeCluster("cluster2")).WillOnce(Return(true));
+  EXPECT_CALL(notifier_, notifyMissingCluster("cluster2"));
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1"}));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1"}), "v2");
+}
+
+// The clusters missing from a state of the world update are notified and unsubscribed from, unless
+// they were requested since the previous update.
+TEST_F(OdCdsApiImplTest, StateOfTheWorldMissingCluster) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster1"), _)).WillRepeatedly(Return(true));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1"}), "v1");
+
+  odcds_->updateOnDemand("cluster2");
+  EXPECT_CALL(notifier_, notifyMissingCluster(_)).Times(0);
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1"}), "v2");
+
+  EXPECT_CALL(notifier_, notifyMissingCluster("cluster2"));
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1"}));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1"}), "v3");
+
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1", "cluster2"}));
+  odcds_->updateOnDemand("cluster2");
+}
+
+// An invalid cluster rejects the whole update.
+TEST_F(OdCdsApiImplTest, ValidateFail) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+
+  auto resources = clusters({"cluster1"});
+  resources.Add()->PackFrom(envoy::config::cluster::v3::Cluster());
+  EXPECT_CALL(cm_, addOrUpdateCluster(_, _)).Times(0);
+  EXPECT_THROW(odcds_callbacks_->onConfigUpdate(resources, "v1"), EnvoyException);
+}
+
+TEST_F(OdCdsApiImplTest, DeltaUpdate) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+
+  Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource> added_resources;
+  auto* resource = added_resources.Add();
+  resource->mutable_resource()->PackFrom(defaultStaticCluster("cluster1"));
+  resource->set_version("v1");
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster1"), "v1")).WillOnce(Return(true));
+  odcds_callbacks_->onConfigUpdate(added_resources, {}, "system_v1");
+
+  Protobuf::RepeatedPtrField<std::string> removed_resources;
+  *removed_resources.Add() = "cluster1";
+  EXPECT_CALL(cm_, removeCluster("cluster1")).WillOnce(Return(true));
+  EXPECT_CALL(notifier_, notifyMissingCluster("cluster1"));
+  odcds_callbacks_->onConfigUpdate({}, removed_resources, "system_v2");
+  // Clusters not added nor subscribed to by the subscription are left alone.
+  EXPECT_CALL(cm_, removeCluster(_)).Times(0);
+  EXPECT_CALL(notifier_, notifyMissingCluster(_)).Times(0);
+  odcds_callbacks_->onConfigUpdate({}, removed_resources, "system_v3");
+}
+
+// The requested clusters a delta update lists as removed are missing from the config source.
+TEST_F(OdCdsApiImplTest, DeltaMissingCluster) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+  odcds_->updateOnDemand("cluster2");
+
+  Protobuf::RepeatedPtrField<std::string> removed_resources;
+  *removed_resources.Add() = "cluster2";
+  EXPECT_CALL(cm_, removeCluster(_)).Times(0);
+  EXPECT_CALL(notifier_, notifyMissingCluster("cluster2"));
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1"}));
+  odcds_callbacks_->onConfigUpdate({}, removed_resources, "system_v1");
+}
+
+// The requested clusters which are not added yet are missing once an update is rejected.
+TEST_F(OdCdsApiImplTest, RejectedUpdate) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+  odcds_->updateOnDemand("cluster2");
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster1"), "v1")).WillOnce(Return(true));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1"}), "v1");
+
+  EXPECT_CALL(notifier_, notifyMissingCluster("cluster2"));
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1"}));
+  odcds_callbacks_->onConfigUpdateFailed(Config::ConfigUpdateFailureReason::UpdateRejected,
+                                         nullptr);
+}
+
+// Clusters are removed and unsubscribed from once they saw no requests nor connections between
+// two idle checks.
+TEST_F(OdCdsApiImplTest, RemoveIdleClusters) {
+  setup(std::chrono::milliseconds(30000));
+  odcds_->updateOnDemand("cluster1");
+  odcds_->updateOnDemand("cluster2");
+  EXPECT_CALL(cm_, addOrUpdateCluster(_, _)).WillRepeatedly(Return(true));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1", "cluster2"}), "v1");
+
+  NiceMock<MockThreadLocalCluster> cluster1;
+  NiceMock<MockThreadLocalCluster> cluster2;
+  ON_CALL(cm_, get(Eq("cluster1"))).WillByDefault(Return(&cluster1));
+  ON_CALL(cm_, get(Eq("cluster2"))).WillByDefault(Return(&cluster2));
+
+  // Clusters are never removed by their first check.
+  EXPECT_CALL(cm_, removeCluster(_)).Times(0);
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(30000), _));
+  idle_timer_->invokeCallback();
+
+  cluster2.cluster_.info_->stats_.upstream_rq_total_.inc();
+  EXPECT_CALL(cm_, removeCluster("cluster1")).WillOnce(Return(true));
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster2"}));
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(30000), _));
+  idle_timer_->invokeCallback();
+
+  // Clusters with active requests are not idle.
+  cluster2.cluster_.info_->stats_.upstream_rq_active_.inc();
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(30000), _));
+  idle_timer_->invokeCallback();
+}
+
+// Clusters removed by a state of the world CDS update are unsubscribed from, and discovered again
+// by their next request.
+TEST_F(OdCdsApiImplTest, ClusterRemovedByCds) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+  odcds_->updateOnDemand("cluster2");
+  EXPECT_CALL(cm_, addOrUpdateCluster(_, _)).WillRepeatedly(Return(true));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1", "cluster2"}), "v1");
+
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster2"}));
+  cluster_update_callbacks_->onClusterRemoval("cluster1");
+  // Clusters not added by the subscription are left alone.
+  cluster_update_callbacks_->onClusterRemoval("cluster3");
+
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1", "cluster2"}));
+  odcds_->updateOnDemand("cluster1");
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster1"), "v2")).WillOnce(Return(true));
+  EXPECT_CALL(cm_, addOrUpdateCluster(WithName("cluster2"), "v2")).WillOnce(Return(false));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1", "cluster2"}), "v2");
+}
+
+// Once no cluster is subscribed to anymore, the subscription is replaced when a cluster is
+// requested again, as the previous one may still be interested in that cluster.
+TEST_F(OdCdsApiImplTest, LastClusterRemoved) {
+  setup();
+  odcds_->updateOnDemand("cluster1");
+  EXPECT_CALL(cm_, addOrUpdateCluster(_, _)).WillOnce(Return(true));
+  odcds_callbacks_->onConfigUpdate(clusters({"cluster1"}), "v1");
+
+  Config::MockSubscription* previous_subscription = cm_.subscription_factory_.subscription_;
+  EXPECT_CALL(*previous_subscription, updateResourceInterest(_)).Times(0);
+  cluster_update_callbacks_->onClusterRemoval("cluster1");
+
+  EXPECT_CALL(cm_.subscription_factory_, subscriptionFromConfigSource(_, _, _, _));
+  odcds_->updateOnDemand("cluster1");
+  EXPECT_NE(previous_subscription, cm_.subscription_factory_.subscription_);
+  EXPECT_CALL(*cm_.subscription_factory_.subscription_,
+              updateResourceInterest(std::set<std::string>{"cluster1", "cluster2"}));
+  odcds_->updateOnDemand("cluster2");
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
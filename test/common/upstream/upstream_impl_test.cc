@@ -2348,6 +2348,38 @@ TEST_F(ClusterInfoImplTest, TestTrackTimeoutBudgets) {
             cluster->info()->timeoutBudgetStats()->upstream_rq_timeout_budget_percent_used_.unit());
 }
 
+TEST_F(ClusterInfoImplTest, TestLazyStats) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    lazy_stats: true
+    track_timeout_budgets: true
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+
+  // None of the cluster stats exist in the store until they are written to.
+  EXPECT_EQ(nullptr, TestUtility::findCounter(stats_, "cluster.name.upstream_rq_total"));
+  EXPECT_EQ(nullptr, TestUtility::findGauge(stats_, "cluster.name.upstream_rq_active"));
+  EXPECT_EQ(nullptr, TestUtility::findGauge(stats_, "cluster.name.membership_total"));
+  EXPECT_EQ(nullptr,
+            TestUtility::findGauge(stats_, "cluster.name.circuit_breakers.default.rq_open"));
+  EXPECT_EQ(0, cluster->info()->stats().upstream_rq_total_.value());
+
+  cluster->info()->stats().upstream_rq_total_.inc();
+  Stats::CounterSharedPtr counter =
+      TestUtility::findCounter(stats_, "cluster.name.upstream_rq_total");
+  ASSERT_NE(nullptr, counter);
+  EXPECT_EQ(1, counter->value());
+  EXPECT_EQ(1, cluster->info()->stats().upstream_rq_total_.value());
+  EXPECT_EQ(nullptr, TestUtility::findCounter(stats_, "cluster.name.upstream_rq_retry"));
+
+  EXPECT_EQ(Stats::Histogram::Unit::Unspecified,
+            cluster->info()->timeoutBudgetStats()->upstream_rq_timeout_budget_percent_used_.unit());
+}
+
 // Validates HTTP2 SETTINGS config.
 TEST_F(ClusterInfoImplTest, Http2ProtocolOptions) {
   const std::string yaml = R"EOF(
@@ -1,16 +1,24 @@
+#include <chrono>
 #include <memory>
 
+#include "envoy/extensions/filters/http/on_demand/v3/on_demand.pb.h"
+
 #include "common/http/header_map_impl.h"
 
 #include "extensions/filters/http/on_demand/on_demand_update.h"
 
 #include "test/mocks/http/mocks.h"
+#include "test/mocks/protobuf/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
+using testing::Eq;
+using testing::Invoke;
 using testing::Return;
 
 namespace Envoy {
@@ -21,10 +29,36 @@ namespace OnDemand {
 class OnDemandFilterTest : public testing::Test {
 public:
   void SetUp() override {
-    filter_ = std::make_unique<OnDemandRouteUpdate>();
+    setUpFilter(envoy::extensions::filters::http::on_demand::v3::OnDemand());
+  }
+
+  void setUpFilter(const envoy::extensions::filters::http::on_demand::v3::OnDemand& proto_config) {
+    config_ = std::make_shared<OnDemandFilterConfig>(proto_config, cm_, validation_visitor_);
+    filter_ = std::make_unique<OnDemandRouteUpdate>(config_);
     filter_->setDecoderFilterCallbacks(decoder_callbacks_);
   }
 
+  // Sets up a filter which discovers the clusters of routes on demand.
+  void setUpOdCdsFilter() {
+    const std::string yaml = R"EOF(
+odcds:
+  source:
+    ads: {}
+  timeout: 2s
+  idle_timeout: 30s
+)EOF";
+    envoy::extensions::filters::http::on_demand::v3::OnDemand proto_config;
+    TestUtility::loadFromYaml(yaml, proto_config);
+    EXPECT_CALL(cm_, allocateOdCdsApi(_, Eq(std::chrono::milliseconds(30000)), _))
+        .WillOnce(Return(odcds_));
+    setUpFilter(proto_config);
+  }
+
+  NiceMock<Upstream::MockClusterManager> cm_;
+  NiceMock<ProtobufMessage::MockValidationVisitor> validation_visitor_;
+  std::shared_ptr<Upstream::MockOdCdsApiHandle> odcds_{
+      std::make_shared<Upstream::MockOdCdsApiHandle>()};
+  OnDemandFilterConfigSharedPtr config_;
   std::unique_ptr<OnDemandRouteUpdate> filter_;
   NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
 };
@@ -104,6 +138,70 @@ TEST_F(OnDemandFilterTest, OnRouteConfigUpdateCompletionRestartsActiveStream) {
   filter_->onRouteConfigUpdateCompletion(true);
 }
 
+// tests decodeHeaders() when the cluster of the route is unknown and on-demand CDS is configured
+TEST_F(OnDemandFilterTest, TestDecodeHeadersRequestsUnknownCluster) {
+  setUpOdCdsFilter();
+  Http::RequestHeaderMapImpl headers;
+  Upstream::ClusterDiscoveryCallbackPtr callback;
+  EXPECT_CALL(cm_, get(Eq("fake_cluster"))).WillOnce(Return(nullptr));
+  EXPECT_CALL(*odcds_, requestOnDemandClusterDiscovery_("fake_cluster", _,
+                                                        std::chrono::milliseconds(2000)))
+      .WillOnce(Invoke([&callback](const std::string&, Upstream::ClusterDiscoveryCallbackPtr& cb,
+                                   std::chrono::milliseconds) {
+        callback = std::move(cb);
+        return new Upstream::MockClusterDiscoveryCallbackHandle();
+      }));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->decodeHeaders(headers, false));
+  Buffer::OwnedImpl buffer;
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndWatermark, filter_->decodeData(buffer, true));
+
+  EXPECT_CALL(decoder_callbacks_, continueDecoding());
+  (*callback)(Upstream::ClusterDiscoveryStatus::Available);
+}
+
+// tests that a request whose cluster was not discovered in time continues to the router
+TEST_F(OnDemandFilterTest, TestClusterDiscoveryTimeoutContinuesDecoding) {
+  setUpOdCdsFilter();
+  Http::RequestHeaderMapImpl headers;
+  Upstream::ClusterDiscoveryCallbackPtr callback;
+  EXPECT_CALL(cm_, get(Eq("fake_cluster"))).WillOnce(Return(nullptr));
+  EXPECT_CALL(*odcds_, requestOnDemandClusterDiscovery_(_, _, _))
+      .WillOnce(Invoke([&callback](const std::string&, Upstream::ClusterDiscoveryCallbackPtr& cb,
+                                   std::chrono::milliseconds) {
+        callback = std::move(cb);
+        return new Upstream::MockClusterDiscoveryCallbackHandle();
+      }));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->decodeHeaders(headers, true));
+
+  EXPECT_CALL(decoder_callbacks_, continueDecoding());
+  (*callback)(Upstream::ClusterDiscoveryStatus::Timeout);
+}
+
+// tests decodeHeaders() when the cluster of the route is known
+TEST_F(OnDemandFilterTest, TestDecodeHeadersWhenClusterIsKnown) {
+  setUpOdCdsFilter();
+  Http::RequestHeaderMapImpl headers;
+  EXPECT_CALL(*odcds_, requestOnDemandClusterDiscovery_(_, _, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, true));
+}
+
+// tests decodeHeaders() when the cluster of the route was added on the worker in the meantime
+TEST_F(OnDemandFilterTest, TestDecodeHeadersWhenClusterBecameKnown) {
+  setUpOdCdsFilter();
+  Http::RequestHeaderMapImpl headers;
+  EXPECT_CALL(cm_, get(Eq("fake_cluster"))).WillOnce(Return(nullptr));
+  EXPECT_CALL(*odcds_, requestOnDemandClusterDiscovery_(_, _, _)).WillOnce(Return(nullptr));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, true));
+}
+
+// tests decodeHeaders() when the cluster of the route is unknown but on-demand CDS is not
+// configured
+TEST_F(OnDemandFilterTest, TestDecodeHeadersWithoutOdCds) {
+  Http::RequestHeaderMapImpl headers;
+  EXPECT_CALL(cm_, get(_)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, true));
+}
+
 } // namespace OnDemand
 } // namespace HttpFilters
 } // namespace Extensions
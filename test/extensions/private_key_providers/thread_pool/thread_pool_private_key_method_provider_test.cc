@@ -0,0 +1,300 @@
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/private_key_providers/thread_pool/v3alpha/thread_pool.pb.h"
+#include "envoy/extensions/transport_sockets/tls/v3/common.pb.h"
+#include "envoy/registry/registry.h"
+#include "envoy/ssl/private_key/private_key_config.h"
+
+#include "extensions/private_key_providers/thread_pool/thread_pool_private_key_method_provider.h"
+#include "extensions/private_key_providers/well_known_names.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/mocks/stats/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+
+using testing::_;
+using testing::NiceMock;
+using testing::Property;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+const std::string TestDataPath =
+    "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/";
+
+class ThreadPoolPrivateKeyMethodProviderTest : public testing::Test,
+                                               public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  ThreadPoolPrivateKeyMethodProviderTest()
+      : api_(Api::createApiForTest(store_)), dispatcher_(api_->allocateDispatcher("test_thread")) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_, scope()).WillByDefault(ReturnRef(store_));
+  }
+
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override {
+    completions_++;
+    dispatcher_->exit();
+  }
+
+  Ssl::PrivateKeyMethodProviderSharedPtr createProvider(const std::string& key_file) {
+    envoy::extensions::private_key_providers::thread_pool::v3alpha::
+        ThreadPoolPrivateKeyMethodConfig config;
+    config.mutable_private_key()->set_filename(
+        TestEnvironment::substitute(TestDataPath + key_file));
+    config.mutable_thread_count()->set_value(2);
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider provider_config;
+    provider_config.set_provider_name(PrivateKeyMethodProviderNames::get().ThreadPool);
+    provider_config.mutable_typed_config()->PackFrom(config);
+
+    auto* factory =
+        Registry::FactoryRegistry<Ssl::PrivateKeyMethodProviderInstanceFactory>::getFactory(
+            PrivateKeyMethodProviderNames::get().ThreadPool);
+    EXPECT_NE(nullptr, factory);
+    return factory->createPrivateKeyMethodProviderInstance(provider_config, factory_context_);
+  }
+
+  bssl::UniquePtr<SSL_CTX> serverContext(const std::string& cert_file,
+                                         Ssl::PrivateKeyMethodProvider& provider) {
+    const std::string cert_pem = TestEnvironment::readFileToStringForTest(
+        TestEnvironment::substitute(TestDataPath + cert_file));
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(cert_pem.data(), cert_pem.size()));
+    bssl::UniquePtr<X509> cert(PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr));
+    bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+    EXPECT_TRUE(SSL_CTX_use_certificate(ctx.get(), cert.get()));
+    SSL_CTX_set_private_key_method(ctx.get(), provider.getBoringSslPrivateKeyMethod().get());
+    return ctx;
+  }
+
+  // Runs a handshake between a client and a server using the provider, and returns whether it
+  // succeeded. The dispatcher runs whenever the server waits for a private key operation.
+  bool handshake(Ssl::PrivateKeyMethodProvider& provider, const std::string& cert_file,
+                 uint16_t max_version = TLS1_3_VERSION, const char* cipher_list = nullptr) {
+    bssl::UniquePtr<SSL_CTX> server_ctx = serverContext(cert_file, provider);
+    bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+    SSL_CTX_set_max_proto_version(client_ctx.get(), max_version);
+    if (cipher_list != nullptr) {
+      SSL_CTX_set_strict_cipher_list(client_ctx.get(), cipher_list);
+    }
+    bssl::UniquePtr<SSL> client(SSL_new(client_ctx.get()));
+    bssl::UniquePtr<SSL> server(SSL_new(server_ctx.get()));
+    SSL_set_connect_state(client.get());
+    SSL_set_accept_state(server.get());
+    BIO* client_bio;
+    BIO* server_bio;
+    EXPECT_TRUE(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0));
+    SSL_set_bio(client.get(), client_bio, client_bio);
+    SSL_set_bio(server.get(), server_bio, server_bio);
+
+    provider.registerPrivateKeyMethod(server.get(), *this, *dispatcher_);
+    bool success = false;
+    while (true) {
+      const int client_rc = SSL_do_handshake(client.get());
+      const int server_rc = SSL_do_handshake(server.get());
+      if (client_rc == 1 && server_rc == 1) {
+        success = true;
+        break;
+      }
+      const int server_error = SSL_get_error(server.get(), server_rc);
+      if (server_error == SSL_ERROR_WANT_PRIVATE_KEY_OPERATION) {
+        dispatcher_->run(Event::Dispatcher::RunType::Block);
+      } else if (server_rc != 1 && server_error != SSL_ERROR_WANT_READ) {
+        break;
+      } else if (client_rc != 1 &&
+                 SSL_get_error(client.get(), client_rc) != SSL_ERROR_WANT_READ) {
+        break;
+      }
+    }
+    provider.unregisterPrivateKeyMethod(server.get());
+    return success;
+  }
+
+  NiceMock<Stats::MockIsolatedStatsStore> store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  uint32_t completions_{};
+};
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, RsaSign) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider("selfsigned_key.pem");
+  EXPECT_CALL(store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "private_key_provider.thread_pool.queue_time"),
+                  _));
+  EXPECT_CALL(store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "private_key_provider.thread_pool.operation_time"),
+                  _));
+  EXPECT_CALL(store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "private_key_provider.thread_pool.total_time"),
+                  _));
+  EXPECT_TRUE(handshake(*provider, "selfsigned_cert.pem"));
+  EXPECT_EQ(1, completions_);
+  EXPECT_EQ(1, store_.counter("private_key_provider.thread_pool.sign").value());
+  EXPECT_EQ(0, store_.counter("private_key_provider.thread_pool.failure").value());
+  EXPECT_EQ(0, store_.gauge("private_key_provider.thread_pool.queued_operations",
+                            Stats::Gauge::ImportMode::Accumulate)
+                   .value());
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, EcdsaSign) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider =
+      createProvider("selfsigned_ecdsa_p256_key.pem");
+  EXPECT_TRUE(handshake(*provider, "selfsigned_ecdsa_p256_cert.pem"));
+  EXPECT_EQ(1, completions_);
+  EXPECT_EQ(1, store_.counter("private_key_provider.thread_pool.sign").value());
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, RsaDecrypt) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider("selfsigned_key.pem");
+  EXPECT_TRUE(handshake(*provider, "selfsigned_cert.pem", TLS1_2_VERSION, "AES128-GCM-SHA256"));
+  EXPECT_EQ(1, completions_);
+  EXPECT_EQ(1, store_.counter("private_key_provider.thread_pool.decrypt").value());
+  EXPECT_EQ(0, store_.counter("private_key_provider.thread_pool.sign").value());
+}
+
+// The key does not match the certificate, so the client rejects the signature.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, WrongKey) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider =
+      createProvider("selfsigned_rsa_3072_key.pem");
+  EXPECT_FALSE(handshake(*provider, "selfsigned_cert.pem"));
+  EXPECT_EQ(1, completions_);
+}
+
+// Operations on connections which are gone are dropped.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, Unregister) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider("selfsigned_key.pem");
+  bssl::UniquePtr<SSL_CTX> server_ctx = serverContext("selfsigned_cert.pem", *provider);
+  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL> client(SSL_new(client_ctx.get()));
+  bssl::UniquePtr<SSL> server(SSL_new(server_ctx.get()));
+  SSL_set_connect_state(client.get());
+  SSL_set_accept_state(server.get());
+  BIO* client_bio;
+  BIO* server_bio;
+  ASSERT_TRUE(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0));
+  SSL_set_bio(client.get(), client_bio, client_bio);
+  SSL_set_bio(server.get(), server_bio, server_bio);
+
+  provider->registerPrivateKeyMethod(server.get(), *this, *dispatcher_);
+  EXPECT_EQ(-1, SSL_do_handshake(client.get()));
+  const int rc = SSL_do_handshake(server.get());
+  EXPECT_EQ(SSL_ERROR_WANT_PRIVATE_KEY_OPERATION, SSL_get_error(server.get(), rc));
+  provider->unregisterPrivateKeyMethod(server.get());
+
+  // The operation may still be performed once the provider is gone, but its result is dropped.
+  provider.reset();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0, completions_);
+}
+
+// The providers keep working while another provider sharing their threads goes away.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, SharedPool) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider1 = createProvider("selfsigned_key.pem");
+  Ssl::PrivateKeyMethodProviderSharedPtr provider2 = createProvider("selfsigned_key.pem");
+  EXPECT_TRUE(handshake(*provider1, "selfsigned_cert.pem"));
+  provider1.reset();
+  EXPECT_TRUE(handshake(*provider2, "selfsigned_cert.pem"));
+  EXPECT_EQ(2, completions_);
+  EXPECT_EQ(2, store_.counter("private_key_provider.thread_pool.sign").value());
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, SameKeyTypeTwice) {
+  Ssl::PrivateKeyMethodProviderSharedPtr provider1 = createProvider("selfsigned_key.pem");
+  Ssl::PrivateKeyMethodProviderSharedPtr provider2 =
+      createProvider("selfsigned_rsa_3072_key.pem");
+  Ssl::PrivateKeyMethodProviderSharedPtr provider3 =
+      createProvider("selfsigned_ecdsa_p256_key.pem");
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL> ssl(SSL_new(ctx.get()));
+
+  provider1->registerPrivateKeyMethod(ssl.get(), *this, *dispatcher_);
+  provider3->registerPrivateKeyMethod(ssl.get(), *this, *dispatcher_);
+  EXPECT_THROW_WITH_MESSAGE(
+      provider2->registerPrivateKeyMethod(ssl.get(), *this, *dispatcher_), EnvoyException,
+      "Can't distinguish between two thread pool private key providers with keys of the same "
+      "type for the same SSL object.");
+  provider1->unregisterPrivateKeyMethod(ssl.get());
+  provider3->unregisterPrivateKeyMethod(ssl.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, InvalidKey) {
+  EXPECT_THROW_WITH_MESSAGE(createProvider("selfsigned_cert.pem"), EnvoyException,
+                            "Failed to load private key for the thread pool private key provider");
+}
+
+TEST(OperationThreadPoolTest, BoundedQueue) {
+  Stats::TestUtil::TestStore store;
+  Stats::Gauge& queued = store.gauge("queued", Stats::Gauge::ImportMode::Accumulate);
+  const int owner = 0;
+  absl::Notification started;
+  absl::Notification release;
+  absl::Notification done;
+  OperationThreadPool pool(Thread::threadFactoryForTest(), 1, 1);
+  EXPECT_TRUE(pool.post(&owner, queued, [&]() {
+    started.Notify();
+    release.WaitForNotification();
+  }));
+  started.WaitForNotification();
+  EXPECT_EQ(0, queued.value());
+
+  // The only thread is busy, so one operation can be queued.
+  EXPECT_TRUE(pool.post(&owner, queued, [&]() { done.Notify(); }));
+  EXPECT_FALSE(pool.post(&owner, queued, []() {}));
+  EXPECT_EQ(1, queued.value());
+
+  release.Notify();
+  done.WaitForNotification();
+  EXPECT_EQ(0, queued.value());
+}
+
+// Cancelling drops the queued operations of an owner only.
+TEST(OperationThreadPoolTest, Cancel) {
+  Stats::TestUtil::TestStore store;
+  Stats::Gauge& queued1 = store.gauge("queued1", Stats::Gauge::ImportMode::Accumulate);
+  Stats::Gauge& queued2 = store.gauge("queued2", Stats::Gauge::ImportMode::Accumulate);
+  const int owner1 = 0;
+  const int owner2 = 0;
+  absl::Notification started;
+  absl::Notification release;
+  absl::Notification done;
+  bool cancelled_run = false;
+  OperationThreadPool pool(Thread::threadFactoryForTest(), 1, 2);
+  EXPECT_TRUE(pool.post(&owner1, queued1, [&]() {
+    started.Notify();
+    release.WaitForNotification();
+  }));
+  started.WaitForNotification();
+
+  EXPECT_TRUE(pool.post(&owner1, queued1, [&]() { cancelled_run = true; }));
+  EXPECT_TRUE(pool.post(&owner2, queued2, [&]() { done.Notify(); }));
+  pool.cancel(&owner1);
+  EXPECT_EQ(0, queued1.value());
+  EXPECT_EQ(1, queued2.value());
+
+  release.Notify();
+  done.WaitForNotification();
+  EXPECT_EQ(0, queued2.value());
+  EXPECT_FALSE(cancelled_run);
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
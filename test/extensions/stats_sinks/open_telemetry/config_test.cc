@@ -0,0 +1,56 @@
+#include "envoy/extensions/stat_sinks/open_telemetry/v3alpha/open_telemetry.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/stat_sinks/open_telemetry/config.h"
+#include "extensions/stat_sinks/open_telemetry/open_telemetry_impl.h"
+#include "extensions/stat_sinks/well_known_names.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace OpenTelemetry {
+namespace {
+
+TEST(OpenTelemetryConfigTest, CreateSink) {
+  const std::string name = StatsSinkNames::get().OpenTelemetry;
+
+  envoy::extensions::stat_sinks::open_telemetry::v3alpha::SinkConfig sink_config;
+  sink_config.mutable_grpc_service()->mutable_envoy_grpc()->set_cluster_name("otlp_collector");
+
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(name);
+  ASSERT_NE(factory, nullptr);
+
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  TestUtility::jsonConvert(sink_config, *message);
+
+  NiceMock<Server::MockInstance> server;
+  Stats::SinkPtr sink = factory->createStatsSink(*message, server);
+  EXPECT_NE(sink, nullptr);
+  EXPECT_NE(dynamic_cast<OpenTelemetrySink*>(sink.get()), nullptr);
+}
+
+TEST(OpenTelemetryConfigTest, MissingGrpcService) {
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(
+          StatsSinkNames::get().OpenTelemetry);
+  ASSERT_NE(factory, nullptr);
+
+  envoy::extensions::stat_sinks::open_telemetry::v3alpha::SinkConfig sink_config;
+  NiceMock<Server::MockInstance> server;
+  EXPECT_THROW(factory->createStatsSink(sink_config, server), ProtoValidationException);
+}
+
+} // namespace
+} // namespace OpenTelemetry
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
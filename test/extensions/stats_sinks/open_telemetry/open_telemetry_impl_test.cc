@@ -0,0 +1,315 @@
+#include "envoy/extensions/stat_sinks/open_telemetry/v3alpha/open_telemetry.pb.h"
+
+#include "common/stats/histogram_impl.h"
+
+#include "extensions/stat_sinks/open_telemetry/open_telemetry_impl.h"
+
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/stats/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "absl/strings/str_cat.h"
+#include "circllhist.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace OpenTelemetry {
+namespace {
+
+class MockOtlpMetricsExporter : public OtlpMetricsExporter {
+public:
+  MOCK_METHOD(void, send, (MetricsExportRequestPtr && request));
+  MOCK_METHOD(void, onSuccess, (std::unique_ptr<MetricsExportResponse>&&, Tracing::Span&));
+  MOCK_METHOD(void, onFailure, (Grpc::Status::GrpcStatus, const std::string&, Tracing::Span&));
+};
+
+class OpenTelemetrySinkTest : public testing::Test {
+public:
+  OpenTelemetrySinkTest() {
+    ON_CALL(local_info_, clusterName()).WillByDefault(ReturnRef(cluster_name_));
+    ON_CALL(local_info_, nodeName()).WillByDefault(ReturnRef(node_name_));
+  }
+
+  std::unique_ptr<OpenTelemetrySink> makeSink() {
+    return std::make_unique<OpenTelemetrySink>(
+        exporter_, std::make_shared<OtlpOptions>(sink_config_), local_info_, time_system_);
+  }
+
+  void addCounter(const std::string& name, uint64_t delta, uint64_t value) {
+    auto counter = std::make_unique<NiceMock<Stats::MockCounter>>();
+    counter->name_ = name;
+    counter->value_ = value;
+    counter->used_ = true;
+    snapshot_.counters_.push_back({delta, *counter});
+    counters_.push_back(std::move(counter));
+  }
+
+  void addGauge(const std::string& name, uint64_t value) {
+    auto gauge = std::make_unique<NiceMock<Stats::MockGauge>>();
+    gauge->name_ = name;
+    gauge->value_ = value;
+    gauge->used_ = true;
+    snapshot_.gauges_.push_back(*gauge);
+    gauges_.push_back(std::move(gauge));
+  }
+
+  // Captures the requests sent by a flush.
+  std::vector<MetricsExportRequest> flush(OpenTelemetrySink& sink) {
+    std::vector<MetricsExportRequest> requests;
+    EXPECT_CALL(*exporter_, send(_))
+        .WillRepeatedly(Invoke([&requests](MetricsExportRequestPtr&& request) {
+          requests.push_back(*request);
+        }));
+    sink.flush(snapshot_);
+    return requests;
+  }
+
+  static const opentelemetry::proto::metrics::v1::Metric&
+  metricAt(const MetricsExportRequest& request, int index) {
+    return request.resource_metrics(0).instrumentation_library_metrics(0).metrics(index);
+  }
+
+  static int metricCount(const MetricsExportRequest& request) {
+    return request.resource_metrics(0).instrumentation_library_metrics(0).metrics_size();
+  }
+
+  std::string cluster_name_{"service-cluster"};
+  std::string node_name_{"node-1"};
+  envoy::extensions::stat_sinks::open_telemetry::v3alpha::SinkConfig sink_config_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  Event::SimulatedTimeSystem time_system_;
+  std::shared_ptr<MockOtlpMetricsExporter> exporter_{std::make_shared<MockOtlpMetricsExporter>()};
+  NiceMock<Stats::MockMetricSnapshot> snapshot_;
+  std::vector<std::unique_ptr<NiceMock<Stats::MockCounter>>> counters_;
+  std::vector<std::unique_ptr<NiceMock<Stats::MockGauge>>> gauges_;
+};
+
+TEST_F(OpenTelemetrySinkTest, EmptySnapshotSendsNothing) {
+  auto sink = makeSink();
+  EXPECT_TRUE(flush(*sink).empty());
+}
+
+TEST_F(OpenTelemetrySinkTest, CountersAndGauges) {
+  auto sink = makeSink();
+  addCounter("cluster.foo.upstream_rq", 3, 10);
+  addCounter("cluster.foo.upstream_cx", 0, 5);
+  addGauge("cluster.foo.membership_total", 7);
+
+  time_system_.advanceTimeWait(std::chrono::seconds(5));
+  const auto requests = flush(*sink);
+  ASSERT_EQ(1, requests.size());
+  const auto& resource = requests[0].resource_metrics(0).resource();
+  ASSERT_EQ(2, resource.attributes_size());
+  EXPECT_EQ("service.name", resource.attributes(0).key());
+  EXPECT_EQ("service-cluster", resource.attributes(0).value().string_value());
+  EXPECT_EQ("service.instance.id", resource.attributes(1).key());
+  EXPECT_EQ("node-1", resource.attributes(1).value().string_value());
+
+  // The unchanged counter is not exported with delta temporality.
+  ASSERT_EQ(2, metricCount(requests[0]));
+  const auto& counter = metricAt(requests[0], 0);
+  EXPECT_EQ("cluster.foo.upstream_rq", counter.name());
+  EXPECT_TRUE(counter.sum().is_monotonic());
+  EXPECT_EQ(opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_DELTA,
+            counter.sum().aggregation_temporality());
+  EXPECT_EQ(3, counter.sum().data_points(0).as_int());
+  EXPECT_EQ(5000000000, counter.sum().data_points(0).time_unix_nano() -
+                            counter.sum().data_points(0).start_time_unix_nano());
+
+  const auto& gauge = metricAt(requests[0], 1);
+  EXPECT_EQ("cluster.foo.membership_total", gauge.name());
+  EXPECT_EQ(7, gauge.gauge().data_points(0).as_int());
+}
+
+TEST_F(OpenTelemetrySinkTest, CumulativeCounters) {
+  sink_config_.mutable_report_counters_as_deltas()->set_value(false);
+  auto sink = makeSink();
+  addCounter("cluster.foo.upstream_cx", 0, 5);
+
+  const auto requests = flush(*sink);
+  ASSERT_EQ(1, requests.size());
+  ASSERT_EQ(1, metricCount(requests[0]));
+  const auto& counter = metricAt(requests[0], 0);
+  EXPECT_EQ(opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_CUMULATIVE,
+            counter.sum().aggregation_temporality());
+  EXPECT_EQ(5, counter.sum().data_points(0).as_int());
+}
+
+TEST_F(OpenTelemetrySinkTest, TagsAsAttributes) {
+  auto sink = makeSink();
+  addGauge("cluster.foo.membership_total", 1);
+  gauges_.back()->setTagExtractedName("cluster.membership_total");
+  gauges_.back()->setTags(Stats::TagVector{{"envoy.cluster_name", "foo"}});
+
+  auto requests = flush(*sink);
+  ASSERT_EQ(1, requests.size());
+  const auto& gauge = metricAt(requests[0], 0);
+  EXPECT_EQ("cluster.membership_total", gauge.name());
+  ASSERT_EQ(1, gauge.gauge().data_points(0).attributes_size());
+  EXPECT_EQ("envoy.cluster_name", gauge.gauge().data_points(0).attributes(0).key());
+  EXPECT_EQ("foo", gauge.gauge().data_points(0).attributes(0).value().string_value());
+
+  sink_config_.mutable_emit_tags_as_attributes()->set_value(false);
+  sink = makeSink();
+  requests = flush(*sink);
+  ASSERT_EQ(1, requests.size());
+  EXPECT_EQ("cluster.foo.membership_total", metricAt(requests[0], 0).name());
+  EXPECT_EQ(0, metricAt(requests[0], 0).gauge().data_points(0).attributes_size());
+}
+
+TEST_F(OpenTelemetrySinkTest, BatchesRequests) {
+  sink_config_.mutable_max_metrics_per_request()->set_value(2);
+  auto sink = makeSink();
+  for (int i = 0; i < 5; ++i) {
+    addGauge(absl::StrCat("gauge", i), i);
+  }
+
+  const auto requests = flush(*sink);
+  ASSERT_EQ(3, requests.size());
+  EXPECT_EQ(2, metricCount(requests[0]));
+  EXPECT_EQ(2, metricCount(requests[1]));
+  EXPECT_EQ(1, metricCount(requests[2]));
+  EXPECT_EQ("gauge4", metricAt(requests[2], 0).name());
+  EXPECT_EQ("node-1",
+            requests[2].resource_metrics(0).resource().attributes(1).value().string_value());
+}
+
+TEST_F(OpenTelemetrySinkTest, Histograms) {
+  auto sink = makeSink();
+  NiceMock<Stats::MockParentHistogram> histogram;
+  histogram.name_ = "cluster.foo.upstream_rq_time";
+  histogram.used_ = true;
+  histogram.unit_ = Stats::Histogram::Unit::Milliseconds;
+  snapshot_.histograms_.push_back(histogram);
+
+  // An empty interval is not exported.
+  EXPECT_TRUE(flush(*sink).empty());
+
+  histogram_t* hist = hist_alloc();
+  hist_insert_intscale(hist, 0, 0, 1);
+  hist_insert_intscale(hist, 3, 0, 2);
+  hist_insert_intscale(hist, 20, 0, 1);
+  Stats::HistogramStatisticsImpl statistics(hist);
+  hist_free(hist);
+  EXPECT_CALL(histogram, intervalStatistics()).WillRepeatedly(ReturnRef(statistics));
+  EXPECT_CALL(histogram, forEachBin(false, _))
+      .WillOnce(Invoke([](bool, const Stats::ParentHistogram::BinFn& fn) {
+        fn(0, 0, 1);
+        fn(3, 0.1, 2);
+        fn(20, 1, 1);
+      }));
+
+  const auto requests = flush(*sink);
+  ASSERT_EQ(1, requests.size());
+  const auto& metric = metricAt(requests[0], 0);
+  EXPECT_EQ("ms", metric.unit());
+  EXPECT_EQ(opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_DELTA,
+            metric.exponential_histogram().aggregation_temporality());
+  const auto& data_point = metric.exponential_histogram().data_points(0);
+  EXPECT_EQ(4, data_point.count());
+  EXPECT_EQ(3, data_point.scale());
+  EXPECT_EQ(1, data_point.zero_count());
+
+  // With a scale of 3, bucket i holds the values in (2^(i/8), 2^((i+1)/8)]: 3 goes to bucket 12,
+  // and 20 to bucket 34.
+  EXPECT_EQ(12, data_point.positive().offset());
+  ASSERT_EQ(23, data_point.positive().bucket_counts_size());
+  for (int i = 0; i < data_point.positive().bucket_counts_size(); ++i) {
+    const uint64_t expected = i == 0 ? 2 : (i == 22 ? 1 : 0);
+    EXPECT_EQ(expected, data_point.positive().bucket_counts(i)) << "bucket " << i;
+  }
+  EXPECT_EQ(0, data_point.negative().bucket_counts_size());
+}
+
+// The scale of exponential histograms is lowered until their buckets fit.
+TEST_F(OpenTelemetrySinkTest, ExponentialHistogramDownscale) {
+  sink_config_.mutable_report_histograms_as_deltas()->set_value(false);
+  auto sink = makeSink();
+  NiceMock<Stats::MockParentHistogram> histogram;
+  histogram.name_ = "cluster.foo.upstream_rq_time";
+  histogram.used_ = true;
+  snapshot_.histograms_.push_back(histogram);
+
+  histogram_t* hist = hist_alloc();
+  hist_insert_intscale(hist, 1, 0, 1);
+  hist_insert_intscale(hist, 1, 9, 1);
+  Stats::HistogramStatisticsImpl statistics(hist);
+  hist_free(hist);
+  EXPECT_CALL(histogram, cumulativeStatistics()).WillRepeatedly(ReturnRef(statistics));
+  EXPECT_CALL(histogram, forEachBin(true, _))
+      .WillOnce(Invoke([](bool, const Stats::ParentHistogram::BinFn& fn) {
+        fn(1, 0.1, 1);
+        fn(1e9, 1e8, 1);
+      }));
+
+  const auto requests = flush(*sink);
+  ASSERT_EQ(1, requests.size());
+  const auto& exponential_histogram = metricAt(requests[0], 0).exponential_histogram();
+  EXPECT_EQ(opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_CUMULATIVE,
+            exponential_histogram.aggregation_temporality());
+  const auto& data_point = exponential_histogram.data_points(0);
+  EXPECT_EQ(2, data_point.count());
+  EXPECT_EQ(0, data_point.zero_count());
+
+  // At a scale of 3, the samples are in buckets 0 and 239, more than 160 buckets apart.
+  EXPECT_EQ(2, data_point.scale());
+  EXPECT_EQ(0, data_point.positive().offset());
+  ASSERT_EQ(120, data_point.positive().bucket_counts_size());
+  EXPECT_EQ(1, data_point.positive().bucket_counts(0));
+  EXPECT_EQ(1, data_point.positive().bucket_counts(119));
+}
+
+TEST_F(OpenTelemetrySinkTest, ExplicitBucketHistograms) {
+  sink_config_.set_report_histograms_as_explicit_buckets(true);
+  auto sink = makeSink();
+  NiceMock<Stats::MockParentHistogram> histogram;
+  histogram.name_ = "cluster.foo.upstream_rq_time";
+  histogram.used_ = true;
+  histogram.unit_ = Stats::Histogram::Unit::Milliseconds;
+  snapshot_.histograms_.push_back(histogram);
+
+  histogram_t* hist = hist_alloc();
+  hist_insert_intscale(hist, 3, 0, 2);
+  hist_insert_intscale(hist, 20, 0, 1);
+  Stats::HistogramStatisticsImpl statistics(hist);
+  hist_free(hist);
+  EXPECT_CALL(histogram, intervalStatistics()).WillRepeatedly(ReturnRef(statistics));
+  EXPECT_CALL(histogram, forEachBin(_, _)).Times(0);
+
+  const auto requests = flush(*sink);
+  ASSERT_EQ(1, requests.size());
+  const auto& metric = metricAt(requests[0], 0);
+  EXPECT_EQ("ms", metric.unit());
+  EXPECT_EQ(opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_DELTA,
+            metric.histogram().aggregation_temporality());
+  const auto& data_point = metric.histogram().data_points(0);
+  EXPECT_EQ(3, data_point.count());
+
+  const std::vector<double>& bounds = statistics.supportedBuckets();
+  ASSERT_EQ(bounds.size(), data_point.explicit_bounds_size());
+  ASSERT_EQ(bounds.size() + 1, data_point.bucket_counts_size());
+  uint64_t total = 0;
+  for (size_t i = 0; i < bounds.size(); ++i) {
+    EXPECT_EQ(bounds[i], data_point.explicit_bounds(i));
+    const uint64_t expected = bounds[i] == 5 ? 2 : (bounds[i] == 25 ? 1 : 0);
+    EXPECT_EQ(expected, data_point.bucket_counts(i)) << "bound " << bounds[i];
+    total += data_point.bucket_counts(i);
+  }
+  EXPECT_EQ(0, data_point.bucket_counts(bounds.size()));
+  EXPECT_EQ(3, total);
+}
+
+} // namespace
+} // namespace OpenTelemetry
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
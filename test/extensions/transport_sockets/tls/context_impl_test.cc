@@ -791,6 +791,18 @@ TEST_F(ClientContextConfigImplTest, EmptyServerNameIndication) {
       "SNI names containing NULL-byte are not allowed");
 }
 
+// Validate that kernel TLS offload is rejected when renegotiation is allowed.
+TEST_F(ClientContextConfigImplTest, KernelTlsOffloadWithRenegotiation) {
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+
+  tls_context.mutable_common_tls_context()->set_kernel_tls_offload(true);
+  tls_context.set_allow_renegotiation(true);
+  EXPECT_THROW_WITH_MESSAGE(
+      ClientContextConfigImpl client_context_config(tls_context, factory_context), EnvoyException,
+      "Kernel TLS offload is not supported with renegotiation allowed");
+}
+
 // Validate that values other than a hex-encoded SHA-256 fail config validation.
 TEST_F(ClientContextConfigImplTest, InvalidCertificateHash) {
   envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
@@ -0,0 +1,99 @@
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include "gtest/gtest.h"
+#include "openssl/nid.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+namespace {
+
+// A key block whose bytes are their own offsets, so the origin of each copied byte is visible.
+std::vector<uint8_t> keyBlock(size_t size) {
+  std::vector<uint8_t> key_block(size);
+  std::iota(key_block.begin(), key_block.end(), 0);
+  return key_block;
+}
+
+std::vector<uint8_t> range(uint8_t first, size_t size) {
+  std::vector<uint8_t> bytes(size);
+  std::iota(bytes.begin(), bytes.end(), first);
+  return bytes;
+}
+
+std::vector<uint8_t> header(uint16_t version, uint16_t cipher) {
+  std::vector<uint8_t> bytes(4);
+  memcpy(bytes.data(), &version, sizeof(version));
+  memcpy(bytes.data() + 2, &cipher, sizeof(cipher));
+  return bytes;
+}
+
+std::vector<uint8_t> concat(std::initializer_list<std::vector<uint8_t>> parts) {
+  std::vector<uint8_t> result;
+  for (const auto& part : parts) {
+    result.insert(result.end(), part.begin(), part.end());
+  }
+  return result;
+}
+
+const std::vector<uint8_t> Sequence{0, 0, 0, 0, 0, 0, 0x01, 0x02};
+
+TEST(KernelTlsTest, AesGcm128) {
+  // client key (16), server key (16), client iv (4), server iv (4).
+  const std::vector<uint8_t> key_block = keyBlock(40);
+
+  // The server transmits with the server keys, and the explicit nonce starts at the sequence.
+  EXPECT_EQ(concat({header(TLS1_2_VERSION, 51), Sequence, range(16, 16), range(36, 4), Sequence}),
+            cryptoInfo(TLS1_2_VERSION, NID_aes_128_gcm, key_block, true, Direction::Transmit,
+                       0x0102));
+  EXPECT_EQ(concat({header(TLS1_2_VERSION, 51), Sequence, range(0, 16), range(32, 4), Sequence}),
+            cryptoInfo(TLS1_2_VERSION, NID_aes_128_gcm, key_block, true, Direction::Receive,
+                       0x0102));
+  // And the other way around for the client.
+  EXPECT_EQ(concat({header(TLS1_2_VERSION, 51), Sequence, range(0, 16), range(32, 4), Sequence}),
+            cryptoInfo(TLS1_2_VERSION, NID_aes_128_gcm, key_block, false, Direction::Transmit,
+                       0x0102));
+}
+
+TEST(KernelTlsTest, AesGcm256) {
+  const std::vector<uint8_t> key_block = keyBlock(72);
+  EXPECT_EQ(concat({header(TLS1_2_VERSION, 52), Sequence, range(32, 32), range(68, 4), Sequence}),
+            cryptoInfo(TLS1_2_VERSION, NID_aes_256_gcm, key_block, true, Direction::Transmit,
+                       0x0102));
+}
+
+TEST(KernelTlsTest, ChaCha20Poly1305) {
+  // client key (32), server key (32), client iv (12), server iv (12).
+  const std::vector<uint8_t> key_block = keyBlock(88);
+  EXPECT_EQ(concat({header(TLS1_2_VERSION, 54), range(64, 12), range(0, 32), Sequence}),
+            cryptoInfo(TLS1_2_VERSION, NID_chacha20_poly1305, key_block, false,
+                       Direction::Transmit, 0x0102));
+}
+
+TEST(KernelTlsTest, Unsupported) {
+  // TLS 1.3 traffic secrets are not available.
+  EXPECT_TRUE(cryptoInfo(TLS1_3_VERSION, NID_aes_128_gcm, keyBlock(40), true, Direction::Transmit,
+                         0)
+                  .empty());
+  // Only AEAD ciphers are supported.
+  EXPECT_TRUE(cryptoInfo(TLS1_2_VERSION, NID_aes_128_cbc, keyBlock(104), true,
+                         Direction::Transmit, 0)
+                  .empty());
+  // The key block must match the cipher.
+  EXPECT_TRUE(cryptoInfo(TLS1_2_VERSION, NID_aes_128_gcm, keyBlock(72), true, Direction::Transmit,
+                         0)
+                  .empty());
+}
+
+} // namespace
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
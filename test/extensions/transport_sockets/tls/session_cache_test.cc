@@ -0,0 +1,201 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+#include "openssl/x509.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+// Returns a TLS 1.2 session established by an in-memory handshake, serialized.
+std::string handshakeSession() {
+  bssl::UniquePtr<EVP_PKEY> key(EVP_PKEY_new());
+  EC_KEY* ec_key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+  RELEASE_ASSERT(EC_KEY_generate_key(ec_key) && EVP_PKEY_assign_EC_KEY(key.get(), ec_key), "");
+  bssl::UniquePtr<X509> cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert.get()), 3600);
+  X509_set_pubkey(cert.get(), key.get());
+  RELEASE_ASSERT(X509_sign(cert.get(), key.get(), EVP_sha256()), "");
+
+  bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
+  RELEASE_ASSERT(SSL_CTX_use_certificate(server_ctx.get(), cert.get()) &&
+                     SSL_CTX_use_PrivateKey(server_ctx.get(), key.get()),
+                 "");
+  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+  SSL_CTX_set_max_proto_version(client_ctx.get(), TLS1_2_VERSION);
+
+  bssl::UniquePtr<SSL> client(SSL_new(client_ctx.get()));
+  bssl::UniquePtr<SSL> server(SSL_new(server_ctx.get()));
+  SSL_set_connect_state(client.get());
+  SSL_set_accept_state(server.get());
+  BIO* client_bio;
+  BIO* server_bio;
+  RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0), "");
+  SSL_set_bio(client.get(), client_bio, client_bio);
+  SSL_set_bio(server.get(), server_bio, server_bio);
+  int client_result = 0;
+  int server_result = 0;
+  while (client_result != 1 || server_result != 1) {
+    client_result = SSL_do_handshake(client.get());
+    server_result = SSL_do_handshake(server.get());
+  }
+
+  uint8_t* data;
+  size_t size;
+  RELEASE_ASSERT(SSL_SESSION_to_bytes(SSL_get_session(client.get()), &data, &size), "");
+  bssl::UniquePtr<uint8_t> free_data(data);
+  return std::string(reinterpret_cast<const char*>(data), size);
+}
+
+class SessionCacheTest : public testing::Test {
+protected:
+  // Returns a new session, told apart from the others by its ID.
+  bssl::UniquePtr<SSL_SESSION> newSession(uint8_t id, uint16_t version = TLS1_2_VERSION) {
+    static const std::string* serialized = new std::string(handshakeSession());
+    bssl::UniquePtr<SSL_SESSION> session(
+        SSL_SESSION_from_bytes(reinterpret_cast<const uint8_t*>(serialized->data()),
+                               serialized->size(), ssl_ctx_.get()));
+    RELEASE_ASSERT(session != nullptr, "");
+    RELEASE_ASSERT(SSL_SESSION_set1_id(session.get(), &id, 1), "");
+    RELEASE_ASSERT(SSL_SESSION_set_protocol_version(session.get(), version), "");
+    return session;
+  }
+
+  static uint8_t id(const bssl::UniquePtr<SSL_SESSION>& session) {
+    unsigned length;
+    const uint8_t* id = SSL_SESSION_get_id(session.get(), &length);
+    RELEASE_ASSERT(length == 1, "");
+    return *id;
+  }
+
+  // Returns keys which are all held in the same shard.
+  static std::vector<std::string> keysInOneShard(size_t count) {
+    std::vector<std::string> keys;
+    for (uint32_t i = 0; keys.size() < count; i++) {
+      const std::string key = absl::StrCat("host", i);
+      if (HashUtil::xxHash64(key) % SessionCache::NumShards == 0) {
+        keys.push_back(key);
+      }
+    }
+    return keys;
+  }
+
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_{SSL_CTX_new(TLS_method())};
+};
+
+TEST_F(SessionCacheTest, Empty) {
+  SessionCache cache(16);
+  EXPECT_EQ(nullptr, cache.get("key"));
+  EXPECT_EQ(0, cache.size());
+}
+
+// The most recent session of a key is returned, and kept.
+TEST_F(SessionCacheTest, MostRecentSession) {
+  SessionCache cache(16);
+  cache.add("key", newSession(1), 2);
+  cache.add("key", newSession(2), 2);
+  cache.add("other", newSession(3), 2);
+  EXPECT_EQ(2, id(cache.get("key")));
+  EXPECT_EQ(2, id(cache.get("key")));
+  EXPECT_EQ(3, id(cache.get("other")));
+  EXPECT_EQ(2, cache.size());
+}
+
+// Single-use sessions (TLS 1.3) are removed once returned, and so is a key without sessions.
+TEST_F(SessionCacheTest, SingleUseSession) {
+  SessionCache cache(16);
+  cache.add("key", newSession(1), 2);
+  cache.add("key", newSession(2, TLS1_3_VERSION), 2);
+  EXPECT_EQ(2, id(cache.get("key")));
+  EXPECT_EQ(1, id(cache.get("key")));
+  EXPECT_EQ(1, id(cache.get("key")));
+
+  cache.add("other", newSession(3, TLS1_3_VERSION), 2);
+  EXPECT_EQ(3, id(cache.get("other")));
+  EXPECT_EQ(nullptr, cache.get("other"));
+  EXPECT_EQ(1, cache.size());
+}
+
+// The oldest sessions of a key are dropped past the maximum.
+TEST_F(SessionCacheTest, MaxSessions) {
+  SessionCache cache(16);
+  cache.add("key", newSession(1, TLS1_3_VERSION), 2);
+  cache.add("key", newSession(2, TLS1_3_VERSION), 2);
+  cache.add("key", newSession(3, TLS1_3_VERSION), 2);
+  EXPECT_EQ(3, id(cache.get("key")));
+  EXPECT_EQ(2, id(cache.get("key")));
+  EXPECT_EQ(nullptr, cache.get("key"));
+}
+
+// The least recently used key of a full shard is evicted.
+TEST_F(SessionCacheTest, EvictLeastRecentlyUsed) {
+  SessionCache cache(2 * SessionCache::NumShards);
+  const std::vector<std::string> keys = keysInOneShard(3);
+  cache.add(keys[0], newSession(1), 1);
+  cache.add(keys[1], newSession(2), 1);
+  EXPECT_EQ(1, id(cache.get(keys[0])));
+
+  cache.add(keys[2], newSession(3), 1);
+  EXPECT_EQ(1, id(cache.get(keys[0])));
+  EXPECT_EQ(nullptr, cache.get(keys[1]));
+  EXPECT_EQ(3, id(cache.get(keys[2])));
+  EXPECT_EQ(2, cache.size());
+}
+
+// However many keys are added, each shard keeps its share of the maximum.
+TEST_F(SessionCacheTest, MaxKeys) {
+  SessionCache cache(SessionCache::NumShards);
+  for (uint8_t i = 0; i < 100; i++) {
+    cache.add(absl::StrCat("host", i), newSession(i), 1);
+  }
+  EXPECT_GE(SessionCache::NumShards, cache.size());
+  EXPECT_EQ(99, id(cache.get("host99")));
+}
+
+// A cache handed over to another process offers the same sessions, in the same order.
+TEST_F(SessionCacheTest, IterateAndImport) {
+  SessionCache cache(16);
+  cache.add("key", newSession(1), 2);
+  cache.add("key", newSession(2), 2);
+  cache.add("other", newSession(3), 2);
+
+  std::vector<std::pair<std::string, std::string>> sessions;
+  cache.iterateSessions([&sessions](const std::string& key, absl::string_view session) {
+    sessions.emplace_back(key, std::string(session));
+  });
+  EXPECT_EQ(3, sessions.size());
+
+  SessionCache imported(16);
+  imported.importSession("invalid", "not a session");
+  for (const auto& session : sessions) {
+    imported.importSession(session.first, session.second);
+  }
+  EXPECT_EQ(2, imported.size());
+  EXPECT_EQ(nullptr, imported.get("invalid"));
+  EXPECT_EQ(3, id(imported.get("other")));
+
+  // The sessions of a key keep their order.
+  imported.add("key", newSession(4, TLS1_3_VERSION), 3);
+  EXPECT_EQ(4, id(imported.get("key")));
+  EXPECT_EQ(2, id(imported.get("key")));
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
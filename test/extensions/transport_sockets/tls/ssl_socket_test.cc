@@ -779,7 +779,8 @@ protected:
 
   void testClientSessionResumption(const std::string& server_ctx_yaml,
                                    const std::string& client_ctx_yaml, bool expect_reuse,
-                                   const Network::Address::IpVersion version);
+                                   const Network::Address::IpVersion version,
+                                   bool new_client_context = false);
 
   Event::DispatcherPtr dispatcher_;
   StreamInfo::StreamInfoImpl stream_info_;
@@ -2462,6 +2463,101 @@ TEST_P(SslSocketTest, HalfClose) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Exchanges data in both directions with kernel offload requested. The test passes whether or not
+// the kernel supports it, as connections fall back to encrypting in user space.
+TEST_P(SslSocketTest, KernelTlsOffloadHalfClose) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+    validation_context:
+      trusted_ca:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ca_certificates.pem"
+    kernel_tls_offload: true
+)EOF";
+
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext server_tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context_);
+  ContextManagerImpl manager(time_system_);
+  Stats::TestUtil::TestStore server_stats_store;
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, std::vector<std::string>{});
+
+  auto socket = std::make_shared<Network::TcpListenSocket>(
+      Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener = dispatcher_->createListener(socket, listener_callbacks, true);
+  std::shared_ptr<Network::MockReadFilter> server_read_filter(new Network::MockReadFilter());
+  std::shared_ptr<Network::MockReadFilter> client_read_filter(new Network::MockReadFilter());
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_maximum_protocol_version: TLSv1_2
+        cipher_suites:
+        - ECDHE-RSA-AES128-GCM-SHA256
+      kernel_tls_offload: true
+  )EOF";
+
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml), tls_context);
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(tls_context, factory_context_);
+  Stats::TestUtil::TestStore client_stats_store;
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager,
+                                                   client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket->localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(nullptr), nullptr);
+  client_connection->enableHalfClose(true);
+  client_connection->addReadFilter(client_read_filter);
+  client_connection->connect();
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket(nullptr),
+            stream_info_);
+        server_connection->enableHalfClose(true);
+        server_connection->addReadFilter(server_read_filter);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+        Buffer::OwnedImpl data("hello");
+        server_connection->write(data, true);
+      }));
+
+  EXPECT_CALL(*server_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(*client_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(*client_read_filter, onData(BufferStringEqual("hello"), true))
+      .WillOnce(Invoke([&](Buffer::Instance&, bool) -> Network::FilterStatus {
+        Buffer::OwnedImpl buffer("world");
+        client_connection->write(buffer, true);
+        return Network::FilterStatus::Continue;
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(*server_read_filter, onData(BufferStringEqual("world"), true));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.kernel_tls_offload").value() +
+                     server_stats_store.counter("ssl.kernel_tls_offload_unavailable").value());
+  EXPECT_EQ(1UL, client_stats_store.counter("ssl.kernel_tls_offload").value() +
+                     client_stats_store.counter("ssl.kernel_tls_offload_unavailable").value());
+}
+
 TEST_P(SslSocketTest, ClientAuthMultipleCAs) {
   const std::string server_ctx_yaml = R"EOF(
   common_tls_context:
@@ -3254,7 +3350,8 @@ TEST_P(SslSocketTest, ClientAuthCrossListenerSessionResumption) {
 void SslSocketTest::testClientSessionResumption(const std::string& server_ctx_yaml,
                                                 const std::string& client_ctx_yaml,
                                                 bool expect_reuse,
-                                                const Network::Address::IpVersion version) {
+                                                const Network::Address::IpVersion version,
+                                                bool new_client_context) {
   InSequence s;
 
   ContextManagerImpl manager(time_system_);
@@ -3358,9 +3455,19 @@ void SslSocketTest::testClientSessionResumption(const std::string& server_ctx_ya
   connect_count = 0;
   close_count = 0;
 
+  // A new context with the same configuration, as after a cluster update, shares the sessions of
+  // the first one.
+  std::unique_ptr<ClientSslSocketFactory> new_client_ssl_socket_factory;
+  if (new_client_context) {
+    new_client_ssl_socket_factory = std::make_unique<ClientSslSocketFactory>(
+        std::make_unique<ClientContextConfigImpl>(client_ctx_proto, client_factory_context),
+        manager, client_stats_store);
+  }
   client_connection = dispatcher->createClientConnection(
       socket->localAddress(), Network::Address::InstanceConstSharedPtr(),
-      client_ssl_socket_factory.createTransportSocket(nullptr), nullptr);
+      new_client_context ? new_client_ssl_socket_factory->createTransportSocket(nullptr)
+                         : client_ssl_socket_factory.createTransportSocket(nullptr),
+      nullptr);
   client_connection->addConnectionCallbacks(client_connection_callbacks);
   client_connection->connect();
 
@@ -3415,6 +3522,30 @@ TEST_P(SslSocketTest, ClientSessionResumptionDefault) {
   testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, GetParam());
 }
 
+// Test client session resumption by a new context with the same configuration.
+TEST_P(SslSocketTest, ClientSessionResumptionNewContext) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+)EOF";
+
+  testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, GetParam(), true);
+}
+
 // Make sure client session resumption is not happening with TLS 1.0-1.2 when it's disabled.
 TEST_P(SslSocketTest, ClientSessionResumptionDisabledTls12) {
   const std::string server_ctx_yaml = R"EOF(
@@ -5135,6 +5266,42 @@ TEST_P(SslSocketTest, RsaAndEcdsaPrivateKeyProviderMultiCertFail) {
                .setExpectedServerStats("ssl.connection_error"));
 }
 
+// Large slices are written in place, one record per slice, and small slices are coalesced into
+// full records without changing the buffer.
+TEST(SslSocketWriteTest, WriteFromSlices) {
+  const std::string small(1024, 'a');
+  const std::string large(8192, 'b');
+  const std::string huge(SslSocket::MaxWriteSize + 1, 'c');
+  Buffer::BufferFragmentImpl small_fragment(small.data(), small.size(), nullptr);
+  Buffer::BufferFragmentImpl large_fragment(large.data(), large.size(), nullptr);
+  Buffer::BufferFragmentImpl huge_fragment(huge.data(), huge.size(), nullptr);
+  uint8_t scratch[SslSocket::MaxWriteSize];
+
+  Buffer::OwnedImpl buffer;
+  EXPECT_EQ(0, SslSocket::nextWriteSize(buffer));
+
+  buffer.addBufferFragment(large_fragment);
+  buffer.addBufferFragment(small_fragment);
+  EXPECT_EQ(large.size(), SslSocket::nextWriteSize(buffer));
+  EXPECT_EQ(large.data(), SslSocket::writeData(buffer, large.size(), scratch));
+  buffer.drain(large.size());
+
+  buffer.addBufferFragment(large_fragment);
+  EXPECT_EQ(small.size() + large.size(), SslSocket::nextWriteSize(buffer));
+  EXPECT_EQ(scratch, SslSocket::writeData(buffer, small.size() + large.size(), scratch));
+  EXPECT_EQ(small + large,
+            std::string(reinterpret_cast<char*>(scratch), small.size() + large.size()));
+  EXPECT_EQ(small.size() + large.size(), buffer.length());
+  buffer.drain(small.size() + large.size());
+
+  buffer.addBufferFragment(huge_fragment);
+  EXPECT_EQ(SslSocket::MaxWriteSize, SslSocket::nextWriteSize(buffer));
+  EXPECT_EQ(huge.data(), SslSocket::writeData(buffer, SslSocket::MaxWriteSize, scratch));
+  buffer.drain(SslSocket::MaxWriteSize);
+  EXPECT_EQ(1, SslSocket::nextWriteSize(buffer));
+  EXPECT_EQ(huge.data() + SslSocket::MaxWriteSize, SslSocket::writeData(buffer, 1, scratch));
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
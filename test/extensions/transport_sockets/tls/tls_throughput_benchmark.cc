@@ -0,0 +1,178 @@
+// Throughput of the SSL_write path of the TLS transport socket, over write buffers made of slices
+// of various sizes. The connection is set up in memory, so only the cost of building the records,
+// including any copy of the plaintext, and of encrypting them is measured.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+
+#include "extensions/transport_sockets/tls/ssl_socket.h"
+
+#include "benchmark/benchmark.h"
+#include "openssl/ssl.h"
+#include "openssl/x509.h"
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+uint64_t cycles() {
+#ifdef __x86_64__
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// A handshaked client and server connected by a pair of memory BIOs.
+class TlsConnection {
+public:
+  TlsConnection() {
+    bssl::UniquePtr<EVP_PKEY> key(EVP_PKEY_new());
+    EC_KEY* ec_key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+    RELEASE_ASSERT(EC_KEY_generate_key(ec_key) && EVP_PKEY_assign_EC_KEY(key.get(), ec_key), "");
+
+    bssl::UniquePtr<X509> cert(X509_new());
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 3600);
+    X509_set_pubkey(cert.get(), key.get());
+    RELEASE_ASSERT(X509_sign(cert.get(), key.get(), EVP_sha256()), "");
+
+    server_ctx_.reset(SSL_CTX_new(TLS_method()));
+    RELEASE_ASSERT(SSL_CTX_use_certificate(server_ctx_.get(), cert.get()) &&
+                       SSL_CTX_use_PrivateKey(server_ctx_.get(), key.get()),
+                   "");
+    client_ctx_.reset(SSL_CTX_new(TLS_method()));
+
+    client_.reset(SSL_new(client_ctx_.get()));
+    server_.reset(SSL_new(server_ctx_.get()));
+    SSL_set_connect_state(client_.get());
+    SSL_set_accept_state(server_.get());
+
+    // The client BIO fits the largest record, which is read out after each write.
+    BIO* client_bio;
+    BIO* server_bio;
+    RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, 2 * SslSocket::MaxWriteSize, &server_bio,
+                                    2 * SslSocket::MaxWriteSize),
+                   "");
+    SSL_set_bio(client_.get(), client_bio, client_bio);
+    SSL_set_bio(server_.get(), server_bio, server_bio);
+
+    int client_result = 0;
+    int server_result = 0;
+    while (client_result != 1 || server_result != 1) {
+      client_result = SSL_do_handshake(client_.get());
+      server_result = SSL_do_handshake(server_.get());
+      RELEASE_ASSERT(client_result == 1 ||
+                         SSL_get_error(client_.get(), client_result) == SSL_ERROR_WANT_READ,
+                     "");
+      RELEASE_ASSERT(server_result == 1 ||
+                         SSL_get_error(server_.get(), server_result) == SSL_ERROR_WANT_READ,
+                     "");
+    }
+  }
+
+  // Encrypts one record from the client, and discards it.
+  void write(const void* data, uint64_t size) {
+    const int rc = SSL_write(client_.get(), data, size);
+    RELEASE_ASSERT(rc == static_cast<int>(size), "");
+    BIO* server_bio = SSL_get_rbio(server_.get());
+    while (BIO_read(server_bio, sink_, sizeof(sink_)) > 0) {
+    }
+  }
+
+private:
+  bssl::UniquePtr<SSL_CTX> client_ctx_;
+  bssl::UniquePtr<SSL_CTX> server_ctx_;
+  bssl::UniquePtr<SSL> client_;
+  bssl::UniquePtr<SSL> server_;
+  uint8_t sink_[2 * SslSocket::MaxWriteSize];
+};
+
+// Writes buffers of range(1) slices of range(0) bytes each. The slices are fragments, so they are
+// not coalesced when added to the buffer, as is the case for data proxied from the network.
+template <class WriteRecord>
+void tlsWrite(benchmark::State& state, WriteRecord write_record) {
+  const uint64_t slice_size = state.range(0);
+  const uint64_t num_slices = state.range(1);
+  const std::string data(slice_size, 'a');
+  std::vector<std::unique_ptr<Buffer::BufferFragmentImpl>> fragments;
+  for (uint64_t i = 0; i < num_slices; i++) {
+    fragments.push_back(
+        std::make_unique<Buffer::BufferFragmentImpl>(data.data(), data.size(), nullptr));
+  }
+
+  TlsConnection connection;
+  uint64_t bytes = 0;
+  uint64_t elapsed_cycles = 0;
+  for (auto _ : state) {
+    Buffer::OwnedImpl buffer;
+    for (auto& fragment : fragments) {
+      buffer.addBufferFragment(*fragment);
+    }
+    const uint64_t start = cycles();
+    while (buffer.length() > 0) {
+      bytes += write_record(connection, buffer);
+    }
+    elapsed_cycles += cycles() - start;
+  }
+
+  state.SetBytesProcessed(bytes);
+  if (elapsed_cycles > 0) {
+    state.counters["bytes_per_cycle"] = static_cast<double>(bytes) / elapsed_cycles;
+  }
+}
+
+// The write path before the buffer was written from its slices: the front of the buffer is
+// linearized into a single slice, then written as one record.
+void tlsWriteLinearize(benchmark::State& state) {
+  tlsWrite(state, [](TlsConnection& connection, Buffer::OwnedImpl& buffer) {
+    const uint64_t size = std::min(buffer.length(), SslSocket::MaxWriteSize);
+    connection.write(buffer.linearize(size), size);
+    buffer.drain(size);
+    return size;
+  });
+}
+BENCHMARK(tlsWriteLinearize)
+    ->Args({1024, 64})
+    ->Args({4096, 16})
+    ->Args({8192, 8})
+    ->Args({16384, 4})
+    ->Args({65536, 1})
+    ->Args({65536, 16});
+
+// The write path of SslSocket::doWrite().
+void tlsWriteSlices(benchmark::State& state) {
+  uint8_t scratch[SslSocket::MaxWriteSize];
+  tlsWrite(state, [&scratch](TlsConnection& connection, Buffer::OwnedImpl& buffer) {
+    const uint64_t size = SslSocket::nextWriteSize(buffer);
+    connection.write(SslSocket::writeData(buffer, size, scratch), size);
+    buffer.drain(size);
+    return size;
+  });
+}
+BENCHMARK(tlsWriteSlices)
+    ->Args({1024, 64})
+    ->Args({4096, 16})
+    ->Args({8192, 8})
+    ->Args({16384, 4})
+    ->Args({65536, 1})
+    ->Args({65536, 16});
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
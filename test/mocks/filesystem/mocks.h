@@ -23,6 +23,7 @@ public:
   Api::IoCallSizeResult write(absl::string_view buffer) override;
   Api::IoCallBoolResult close() override;
   bool isOpen() const override { return is_open_; };
+  MOCK_METHOD(Api::IoCallBoolResult, sync, ());
   MOCK_METHOD(std::string, path, (), (const));
 
   // The first parameter here must be `const FlagSet&` otherwise it doesn't compile with libstdc++
@@ -52,6 +53,7 @@ public:
   MOCK_METHOD(bool, directoryExists, (const std::string&));
   MOCK_METHOD(ssize_t, fileSize, (const std::string&));
   MOCK_METHOD(std::string, fileReadToEnd, (const std::string&));
+  MOCK_METHOD(Api::IoCallBoolResult, rename, (const std::string&, const std::string&));
   MOCK_METHOD(PathSplitResult, splitPathFromFilename, (absl::string_view));
   MOCK_METHOD(bool, illegalPath, (const std::string&));
 };
@@ -85,6 +85,9 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(IoHandle*, rawIoHandle, ());
+  MOCK_METHOD(void, startRawIo, (RawIoCallbacks & callbacks));
+  MOCK_METHOD(void, stopRawIo, ());
 };
 
 /**
@@ -131,6 +134,9 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(IoHandle*, rawIoHandle, ());
+  MOCK_METHOD(void, startRawIo, (RawIoCallbacks & callbacks));
+  MOCK_METHOD(void, stopRawIo, ());
 
   // Network::ClientConnection
   MOCK_METHOD(void, connect, ());
@@ -180,6 +186,9 @@ public:
   MOCK_METHOD(const StreamInfo::StreamInfo&, streamInfo, (), (const));
   MOCK_METHOD(void, setDelayedCloseTimeout, (std::chrono::milliseconds));
   MOCK_METHOD(absl::string_view, transportFailureReason, (), (const));
+  MOCK_METHOD(IoHandle*, rawIoHandle, ());
+  MOCK_METHOD(void, startRawIo, (RawIoCallbacks & callbacks));
+  MOCK_METHOD(void, stopRawIo, ());
 
   // Network::FilterManagerConnection
   MOCK_METHOD(StreamBuffer, getReadBuffer, ());
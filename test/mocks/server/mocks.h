@@ -97,6 +97,8 @@ public:
   MOCK_METHOD(bool, signalHandlingEnabled, (), (const));
   MOCK_METHOD(bool, mutexTracingEnabled, (), (const));
   MOCK_METHOD(bool, fakeSymbolTableEnabled, (), (const));
+  MOCK_METHOD(const std::string&, statsRegionPath, (), (const));
+  MOCK_METHOD(uint32_t, statsRegionSlots, (), (const));
   MOCK_METHOD(bool, cpusetThreadsEnabled, (), (const));
   MOCK_METHOD(const std::vector<std::string>&, disabledExtensions, (), (const));
   MOCK_METHOD(Server::CommandLineOptionsPtr, toCommandLineOptions, (), (const));
@@ -119,6 +121,8 @@ public:
   bool signal_handling_enabled_{true};
   bool mutex_tracing_enabled_{};
   bool cpuset_threads_enabled_{};
+  std::string stats_region_path_;
+  uint32_t stats_region_slots_{65536};
   std::vector<std::string> disabled_extensions_;
 };
 
@@ -230,6 +234,7 @@ public:
   MOCK_METHOD(void, sendParentAdminShutdownRequest, (time_t & original_start_time));
   MOCK_METHOD(void, sendParentTerminateRequest, ());
   MOCK_METHOD(ServerStatsFromParent, mergeParentStatsIfAny, (Stats::StoreRoot & stats_store));
+  MOCK_METHOD(void, importParentTlsSessions, (Ssl::ContextManager & context_manager));
   MOCK_METHOD(void, shutdown, ());
   MOCK_METHOD(std::string, version, ());
   MOCK_METHOD(Thread::BasicLockable&, logLock, ());
@@ -242,6 +242,7 @@ public:
   MOCK_METHOD(void, recordValue, (uint64_t value));
   MOCK_METHOD(const HistogramStatistics&, cumulativeStatistics, (), (const));
   MOCK_METHOD(const HistogramStatistics&, intervalStatistics, (), (const));
+  MOCK_METHOD(void, forEachBin, (bool cumulative, const BinFn& fn), (const));
 
   // RefcountInterface
   void incRefCount() override { refcount_helper_.incRefCount(); }
@@ -9,6 +9,9 @@ using testing::Invoke;
 namespace Envoy {
 namespace ThreadLocal {
 
+MockUpdateBatch::MockUpdateBatch() = default;
+MockUpdateBatch::~MockUpdateBatch() { destroy_(); }
+
 MockInstance::MockInstance() {
   ON_CALL(*this, allocateSlot()).WillByDefault(Invoke(this, &MockInstance::allocateSlot_));
   ON_CALL(*this, runOnAllThreads(_)).WillByDefault(Invoke(this, &MockInstance::runOnAllThreads1_));
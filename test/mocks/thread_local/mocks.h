@@ -12,6 +12,14 @@
 namespace Envoy {
 namespace ThreadLocal {
 
+class MockUpdateBatch : public UpdateBatch {
+public:
+  MockUpdateBatch();
+  ~MockUpdateBatch() override;
+
+  MOCK_METHOD(void, destroy_, ());
+};
+
 class MockInstance : public Instance {
 public:
   MockInstance();
@@ -26,6 +34,7 @@ public:
   MOCK_METHOD(void, shutdownGlobalThreading, ());
   MOCK_METHOD(void, shutdownThread, ());
   MOCK_METHOD(Event::Dispatcher&, dispatcher, ());
+  MOCK_METHOD(UpdateBatchPtr, batchUpdates, ());
 
   SlotPtr allocateSlot_() { return SlotPtr{new SlotImpl(*this, current_slot_++)}; }
   void runOnAllThreads1_(Event::PostCb cb) { cb(); }
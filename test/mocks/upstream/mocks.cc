@@ -131,6 +131,12 @@ MockThreadLocalCluster::~MockThreadLocalCluster() = default;
 MockClusterUpdateCallbacksHandle::MockClusterUpdateCallbacksHandle() = default;
 MockClusterUpdateCallbacksHandle::~MockClusterUpdateCallbacksHandle() = default;
 
+MockClusterDiscoveryCallbackHandle::MockClusterDiscoveryCallbackHandle() = default;
+MockClusterDiscoveryCallbackHandle::~MockClusterDiscoveryCallbackHandle() = default;
+
+MockOdCdsApiHandle::MockOdCdsApiHandle() = default;
+MockOdCdsApiHandle::~MockOdCdsApiHandle() = default;
+
 MockClusterManager::MockClusterManager(TimeSource&) : MockClusterManager() {}
 
 MockClusterManager::MockClusterManager() {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <list>
 #include <memory>
@@ -285,6 +286,29 @@ public:
   ~MockClusterUpdateCallbacksHandle() override;
 };
 
+class MockClusterDiscoveryCallbackHandle : public ClusterDiscoveryCallbackHandle {
+public:
+  MockClusterDiscoveryCallbackHandle();
+  ~MockClusterDiscoveryCallbackHandle() override;
+};
+
+class MockOdCdsApiHandle : public OdCdsApiHandle {
+public:
+  MockOdCdsApiHandle();
+  ~MockOdCdsApiHandle() override;
+
+  ClusterDiscoveryCallbackHandlePtr
+  requestOnDemandClusterDiscovery(const std::string& name, ClusterDiscoveryCallbackPtr callback,
+                                  std::chrono::milliseconds timeout) override {
+    return ClusterDiscoveryCallbackHandlePtr{
+        requestOnDemandClusterDiscovery_(name, callback, timeout)};
+  }
+
+  MOCK_METHOD(ClusterDiscoveryCallbackHandle*, requestOnDemandClusterDiscovery_,
+              (const std::string& name, ClusterDiscoveryCallbackPtr& callback,
+               std::chrono::milliseconds timeout));
+};
+
 class MockClusterManager : public ClusterManager {
 public:
   explicit MockClusterManager(TimeSource& time_source);
@@ -330,6 +354,10 @@ public:
   MOCK_METHOD(ClusterUpdateCallbacksHandle*, addThreadLocalClusterUpdateCallbacks_,
               (ClusterUpdateCallbacks & callbacks));
   MOCK_METHOD(Config::SubscriptionFactory&, subscriptionFactory, ());
+  MOCK_METHOD(OdCdsApiHandleSharedPtr, allocateOdCdsApi,
+              (const envoy::config::core::v3::ConfigSource& odcds_config,
+               absl::optional<std::chrono::milliseconds> idle_timeout,
+               ProtobufMessage::ValidationVisitor& validation_visitor));
 
   NiceMock<Http::ConnectionPool::MockInstance> conn_pool_;
   NiceMock<Http::MockAsyncClient> async_client_;
@@ -7,6 +7,8 @@
 #include "envoy/network/listen_socket.h"
 #include "envoy/protobuf/message_validator.h"
 
+#include "common/memory/stats.h"
+
 #include "server/filter_chain_manager_impl.h"
 
 #include "extensions/transport_sockets/well_known_names.h"
@@ -162,6 +164,11 @@ const char YamlSingleDstPortBottom[] = R"EOF(
           session_ticket_keys:
             keys:
             - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a")EOF";
+const char YamlServerNamesTop[] = R"EOF(
+    - filter_chain_match:
+        server_names: )EOF";
+const char YamlServerNamesBottom[] = R"EOF(
+        transport_protocol: "tls")EOF";
 } // namespace
 
 class FilterChainBenchmarkFixture : public benchmark::Fixture {
@@ -220,6 +227,77 @@ BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindTest)
     }
   }
 }
+// Each filter chain matches an exact server name and a wildcard domain, as with one certificate
+// per filter chain.
+class ServerNamesBenchmarkFixture : public benchmark::Fixture {
+public:
+  using benchmark::Fixture::SetUp;
+
+  void SetUp(::benchmark::State& state) override {
+    int64_t input_size = state.range(0);
+    std::vector<std::string> server_name_chains;
+    server_name_chains.reserve(input_size);
+    for (int i = 0; i < input_size; i++) {
+      server_name_chains.push_back(absl::StrCat(YamlServerNamesTop, "[\"server", i,
+                                                ".example.com\", \"*.domain", i, ".example.com\"]",
+                                                YamlServerNamesBottom));
+    }
+    listener_yaml_config_ = TestEnvironment::substitute(
+        absl::StrCat(YamlHeader, absl::StrJoin(server_name_chains, "")),
+        Network::Address::IpVersion::v4);
+    TestUtility::loadFromYaml(listener_yaml_config_, listener_config_);
+    filter_chains_ = listener_config_.filter_chains();
+  }
+  std::string listener_yaml_config_;
+  envoy::config::listener::v3::Listener listener_config_;
+  absl::Span<const envoy::config::listener::v3::FilterChain* const> filter_chains_;
+  MockFilterChainFactoryBuilder dummy_builder_;
+  Init::ManagerImpl init_manager_{"fcm_benchmark"};
+};
+
+// NOLINTNEXTLINE(readability-redundant-member-init)
+BENCHMARK_DEFINE_F(ServerNamesBenchmarkFixture, FilterChainManagerBuildTest)
+(::benchmark::State& state) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  for (auto _ : state) {
+    const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+    FilterChainManagerImpl filter_chain_manager{
+        std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+        init_manager_};
+    filter_chain_manager.addFilterChain(filter_chains_, dummy_builder_, filter_chain_manager);
+    state.PauseTiming();
+    const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+    state.counters["memory"] = end_mem - start_mem;
+    state.counters["memory_per_server_name"] = (end_mem - start_mem) / (2 * state.range(0));
+    state.ResumeTiming();
+  }
+}
+
+// Looks up as many server names as there are filter chains, alternating between exact and wildcard
+// matches.
+BENCHMARK_DEFINE_F(ServerNamesBenchmarkFixture, FilterChainFindTest)
+(::benchmark::State& state) {
+  std::vector<MockConnectionSocket> sockets;
+  sockets.reserve(state.range(0));
+  for (int i = 0; i < state.range(0); i++) {
+    const std::string server_name = i % 2 == 0 ? absl::StrCat("server", i, ".example.com")
+                                               : absl::StrCat("www.domain", i, ".example.com");
+    sockets.push_back(std::move(*MockConnectionSocket::createMockConnectionSocket(
+        1234, "127.0.0.1", server_name, "tls", {}, "8.8.8.8", 111)));
+  }
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  FilterChainManagerImpl filter_chain_manager{
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+      init_manager_};
+
+  filter_chain_manager.addFilterChain(filter_chains_, dummy_builder_, filter_chain_manager);
+  for (auto _ : state) {
+    for (int i = 0; i < state.range(0); i++) {
+      filter_chain_manager.findFilterChain(sockets[i]);
+    }
+  }
+}
+
 BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildTest)
     ->Ranges({
         // scale of the chains
@@ -231,6 +309,16 @@ BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindTest)
         {1, 4096},
     });
 
+BENCHMARK_REGISTER_F(ServerNamesBenchmarkFixture, FilterChainManagerBuildTest)
+    ->Arg(1)
+    ->Arg(1000)
+    ->Arg(20000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ServerNamesBenchmarkFixture, FilterChainFindTest)
+    ->Arg(1)
+    ->Arg(1000)
+    ->Arg(20000);
+
 /*
 clang-format off
 
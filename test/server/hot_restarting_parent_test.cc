@@ -1,14 +1,22 @@
+#include <unistd.h>
+
 #include <memory>
 
+#include "common/stats/mapped_stats_region.h"
+
 #include "server/hot_restarting_child.h"
 #include "server/hot_restarting_parent.h"
 
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/environment.h"
 
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::InSequence;
+using testing::Invoke;
 using testing::Return;
 using testing::ReturnRef;
 
@@ -111,6 +119,33 @@ TEST_F(HotRestartingParentTest, ExportStatsToChild) {
   }
 }
 
+// Stats held in a mapped stats region are already visible to the child, so they are not exported.
+TEST_F(HotRestartingParentTest, ExportStatsToChildSkipsMappedStats) {
+  const std::string path = TestEnvironment::temporaryPath("hot_restarting_parent_stats_region");
+  Stats::MappedStatsRegionPtr region = Stats::MappedStatsRegion::create(path, 16, true);
+  region->allocate("mapped_counter", Stats::MappedStatsRegion::Type::Counter);
+  region->allocate("mapped_gauge", Stats::MappedStatsRegion::Type::Gauge);
+  HotRestartingParent::Internal hot_restarting_parent(&server_, region.get());
+
+  Stats::TestUtil::TestStore store;
+  MockListenerManager listener_manager;
+  EXPECT_CALL(server_, listenerManager()).WillRepeatedly(ReturnRef(listener_manager));
+  EXPECT_CALL(listener_manager, numConnections()).WillRepeatedly(Return(0));
+  EXPECT_CALL(server_, stats()).WillRepeatedly(ReturnRef(store));
+
+  store.counter("mapped_counter").inc();
+  store.counter("heap_counter").inc();
+  store.gauge("mapped_gauge", Stats::Gauge::ImportMode::Accumulate).set(1);
+  store.gauge("heap_gauge", Stats::Gauge::ImportMode::Accumulate).set(2);
+  HotRestartMessage::Reply::Stats stats;
+  hot_restarting_parent.exportStatsToChild(&stats);
+  EXPECT_EQ(stats.counter_deltas().end(), stats.counter_deltas().find("mapped_counter"));
+  EXPECT_EQ(1, stats.counter_deltas().at("heap_counter"));
+  EXPECT_EQ(stats.gauges().end(), stats.gauges().find("mapped_gauge"));
+  EXPECT_EQ(2, stats.gauges().at("heap_gauge"));
+  ::unlink(path.c_str());
+}
+
 TEST_F(HotRestartingParentTest, RetainDynamicStats) {
   MockListenerManager listener_manager;
   Stats::SymbolTableImpl parent_symbol_table;
@@ -154,6 +189,28 @@ TEST_F(HotRestartingParentTest, DrainListeners) {
   hot_restarting_parent_.drainListeners();
 }
 
+TEST_F(HotRestartingParentTest, ExportTlsSessionsToChild) {
+  Ssl::MockContextManager context_manager;
+  EXPECT_CALL(server_, sslContextManager()).WillOnce(ReturnRef(context_manager));
+  EXPECT_CALL(context_manager, iterateSessions(_))
+      .WillOnce(Invoke(
+          [](std::function<void(const std::string&, absl::string_view)> callback) -> void {
+            callback("key1", "session1");
+            callback("key1", "session2");
+            callback("key2", absl::string_view("\0\1", 2));
+          }));
+
+  HotRestartMessage::Reply::TlsSessions tls_sessions;
+  hot_restarting_parent_.exportTlsSessionsToChild(&tls_sessions);
+  ASSERT_EQ(3, tls_sessions.sessions_size());
+  EXPECT_EQ("key1", tls_sessions.sessions(0).key());
+  EXPECT_EQ("session1", tls_sessions.sessions(0).session());
+  EXPECT_EQ("key1", tls_sessions.sessions(1).key());
+  EXPECT_EQ("session2", tls_sessions.sessions(1).session());
+  EXPECT_EQ("key2", tls_sessions.sessions(2).key());
+  EXPECT_EQ(std::string("\0\1", 2), tls_sessions.sessions(2).session());
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
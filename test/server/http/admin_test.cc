@@ -16,6 +16,7 @@
 #include "common/http/message_impl.h"
 #include "common/json/json_loader.h"
 #include "common/profiler/profiler.h"
+#include "common/profiler/sampling_profiler.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
 
@@ -102,6 +103,43 @@ TEST_P(AdminInstanceTest, AdminHeapProfiler) {
   EXPECT_FALSE(Profiler::Heap::isProfilerStarted());
 }
 
+TEST_P(AdminInstanceTest, AdminSamplingProfiler) {
+  Buffer::OwnedImpl data;
+  Http::ResponseHeaderMapImpl header_map;
+
+  if (!Profiler::SamplingProfiler::supported()) {
+    EXPECT_EQ(Http::Code::NotImplemented,
+              postCallback("/sampling_profiler?enable=y", header_map, data));
+    return;
+  }
+
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/sampling_profiler", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/sampling_profiler?enable=y&hz=0", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/sampling_profiler?enable=y&hz=1001", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest,
+            postCallback("/sampling_profiler?enable=y&foo=bar", header_map, data));
+  EXPECT_FALSE(Profiler::SamplingProfiler::isRunning());
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/sampling_profiler?enable=y&hz=500", header_map, data));
+  EXPECT_TRUE(Profiler::SamplingProfiler::isRunning());
+  // The gperftools profiler uses the same signal.
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/cpuprofiler?enable=y", header_map, data));
+  EXPECT_FALSE(Profiler::Cpu::profilerEnabled());
+
+  data.drain(data.length());
+  EXPECT_EQ(Http::Code::OK,
+            getCallback("/sampling_profiler/pprof?seconds=10", header_map, data));
+  EXPECT_EQ("application/octet-stream", header_map.ContentType()->value().getStringView());
+  EXPECT_NE(0, data.length());
+  EXPECT_EQ(Http::Code::BadRequest,
+            getCallback("/sampling_profiler/pprof?seconds=x", header_map, data));
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/sampling_profiler?enable=n", header_map, data));
+  EXPECT_FALSE(Profiler::SamplingProfiler::isRunning());
+}
+
 TEST_P(AdminInstanceTest, MutatesErrorWithGet) {
   Buffer::OwnedImpl data;
   Http::ResponseHeaderMapImpl header_map;
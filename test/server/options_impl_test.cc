@@ -86,7 +86,8 @@ TEST_F(OptionsImplTest, All) {
       "--file-flush-interval-msec 9000 "
       "--drain-time-s 60 --log-format [%v] --parent-shutdown-time-s 90 --log-path /foo/bar "
       "--disable-hot-restart --cpuset-threads --allow-unknown-static-fields "
-      "--reject-unknown-dynamic-fields --use-fake-symbol-table 0");
+      "--reject-unknown-dynamic-fields --use-fake-symbol-table 0 "
+      "--stats-region-path /foo/stats --stats-region-slots 1024");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
   EXPECT_EQ("hello", options->configPath());
@@ -108,6 +109,8 @@ TEST_F(OptionsImplTest, All) {
   EXPECT_TRUE(options->allowUnknownStaticFields());
   EXPECT_TRUE(options->rejectUnknownDynamicFields());
   EXPECT_FALSE(options->fakeSymbolTableEnabled());
+  EXPECT_EQ("/foo/stats", options->statsRegionPath());
+  EXPECT_EQ(1024U, options->statsRegionSlots());
 
   options = createOptionsImpl("envoy --mode init_only");
   EXPECT_EQ(Server::Mode::InitOnly, options->mode());
@@ -166,6 +169,8 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setAllowUnkownFields(true);
   options->setRejectUnknownFieldsDynamic(true);
   options->setFakeSymbolTableEnabled(!options->fakeSymbolTableEnabled());
+  options->setStatsRegionPath("/foo/stats");
+  options->setStatsRegionSlots(46);
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
@@ -193,6 +198,8 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_TRUE(options->allowUnknownStaticFields());
   EXPECT_TRUE(options->rejectUnknownDynamicFields());
   EXPECT_EQ(!fake_symbol_table_enabled, options->fakeSymbolTableEnabled());
+  EXPECT_EQ("/foo/stats", options->statsRegionPath());
+  EXPECT_EQ(46U, options->statsRegionSlots());
 
   // Validate that CommandLineOptions is constructed correctly.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -220,6 +227,8 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->hotRestartDisabled(), command_line_options->disable_hot_restart());
   EXPECT_EQ(options->mutexTracingEnabled(), command_line_options->enable_mutex_tracing());
   EXPECT_EQ(options->cpusetThreadsEnabled(), command_line_options->cpuset_threads());
+  EXPECT_EQ(options->statsRegionPath(), command_line_options->stats_region_path());
+  EXPECT_EQ(options->statsRegionSlots(), command_line_options->stats_region_slots());
 }
 
 TEST_F(OptionsImplTest, DefaultParams) {
@@ -232,6 +241,8 @@ TEST_F(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(spdlog::level::warn, options->logLevel());
   EXPECT_FALSE(options->hotRestartDisabled());
   EXPECT_FALSE(options->cpusetThreadsEnabled());
+  EXPECT_EQ("", options->statsRegionPath());
+  EXPECT_EQ(65536U, options->statsRegionSlots());
 
   // Validate that CommandLineOptions is constructed correctly with default params.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -289,6 +300,12 @@ TEST_F(OptionsImplTest, BadCliOption) {
                           MalformedArgvException, "error: unknown IP address version 'foo'");
 }
 
+TEST_F(OptionsImplTest, BadStatsRegionSlots) {
+  EXPECT_THROW_WITH_REGEX(
+      createOptionsImpl("envoy -c hello --stats-region-path /foo/stats --stats-region-slots 0"),
+      MalformedArgvException, "--stats-region-slots must be greater than zero");
+}
+
 TEST_F(OptionsImplTest, ParseComponentLogLevels) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy --mode init_only");
   options->parseComponentLogLevels("upstream:debug,connection:trace");
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "server/server_name_index.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Server {
+namespace {
+
+TEST(ServerNameIndexTest, Empty) {
+  ServerNameIndex<std::string> index;
+  EXPECT_EQ(nullptr, index.find("www.example.com"));
+  EXPECT_EQ(nullptr, index.find(""));
+}
+
+// An exact server name wins over any wildcard domain, and the catch-all entry is only returned
+// when looked up as such.
+TEST(ServerNameIndexTest, Exact) {
+  ServerNameIndex<std::string> index;
+  index["www.example.com"] = "exact";
+  index["*.example.com"] = "wildcard";
+  index[""] = "catch-all";
+  EXPECT_EQ("exact", *index.find("www.example.com"));
+  EXPECT_EQ("catch-all", *index.find(""));
+  EXPECT_EQ(nullptr, index.find("www.example.org"));
+}
+
+// The longest wildcard domain wins, and only matches names with labels in front of it.
+TEST(ServerNameIndexTest, LongestWildcard) {
+  ServerNameIndex<std::string> index;
+  index["*.com"] = "com";
+  index["*.example.com"] = "example.com";
+  index["*.a.b.example.com"] = "a.b.example.com";
+  EXPECT_EQ("example.com", *index.find("www.example.com"));
+  EXPECT_EQ("example.com", *index.find("www.b.example.com"));
+  EXPECT_EQ("a.b.example.com", *index.find("www.a.b.example.com"));
+  EXPECT_EQ("com", *index.find("example.com"));
+  EXPECT_EQ("com", *index.find("www.example2.com"));
+  EXPECT_EQ(nullptr, index.find("com"));
+  EXPECT_EQ(nullptr, index.find(".com"));
+  EXPECT_EQ(nullptr, index.find("www.example.org"));
+  EXPECT_EQ(nullptr, index.find("wwwexample.com."));
+}
+
+// Adding the same name again returns the same value.
+TEST(ServerNameIndexTest, SameValue) {
+  ServerNameIndex<std::string> index;
+  index["www.example.com"] = "exact";
+  index["*.example.com"] = "wildcard";
+  EXPECT_EQ("exact", index["www.example.com"]);
+  EXPECT_EQ("wildcard", index["*.example.com"]);
+}
+
+TEST(ServerNameIndexTest, Iterate) {
+  ServerNameIndex<std::string> index;
+  index["www.example.com"] = "exact";
+  index["*.example.com"] = "example.com";
+  index["*.com"] = "com";
+  index[""] = "catch-all";
+  std::vector<std::string> values;
+  index.iterate([&values](std::string& value) { values.push_back(value); });
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ((std::vector<std::string>{"catch-all", "com", "exact", "example.com"}), values);
+}
+
+} // namespace
+} // namespace Server
+} // namespace Envoy
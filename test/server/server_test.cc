@@ -314,6 +314,9 @@ TEST_P(ServerInstanceImplTest, StatsFlushWhenServerIsStillInitializing) {
   // Wait till stats are flushed to custom sink and validate that the actual flush happens.
   TestUtility::waitForCounterEq(stats_store_, "stats.flushed", 1, time_system_);
   EXPECT_EQ(3L, TestUtility::findGauge(stats_store_, "server.state")->value());
+  EXPECT_LE(TestUtility::findCounter(stats_store_, "server.buffer_slices_reused")->value(),
+            TestUtility::findCounter(stats_store_, "server.buffer_slices_allocated")->value());
+  EXPECT_NE(nullptr, TestUtility::findGauge(stats_store_, "server.buffer_slice_cache_size"));
   EXPECT_EQ(Init::Manager::State::Initializing, server_->initManager().state());
 
   server_->dispatcher().post([&] { server_->shutdown(); });
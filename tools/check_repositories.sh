@@ -25,3 +25,11 @@ if [[ $urls_count != $sha256sums_count ]]; then
   echo "    api/bazel/repositories.bzl"
   exit 1
 fi
+
+# Check whether any data plane API dependency is left without a SHA256 sum. These are fetched
+# by every project that imports the API, and an empty sum downloads the archive unverified.
+if git grep -nE "(\<sha256|_SHA(256)?) = \"\"" -- 'api/bazel/*.bzl'; then
+  echo "Found empty SHA256 sums in the data plane API dependencies."
+  echo "Please pin every dependency in api/bazel/repository_locations.bzl to its SHA256 sum."
+  exit 1
+fi